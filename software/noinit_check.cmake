@@ -0,0 +1,52 @@
+# Checks after the build that the .noinit section (warm restart record, see
+# src/warm_restart.c) is not initialized by the startup code. The section
+# placement is defined by the bricklib2 linker script, which does not know
+# about .noinit: It has to end up as its own section without content in RAM
+# (orphan NOBITS section), outside of .data and .bss.
+#
+# Usage: cmake -DOBJDUMP=<arm-none-eabi-objdump> -DELF=<firmware.elf> -P noinit_check.cmake
+
+execute_process(
+	COMMAND ${OBJDUMP} -h ${ELF}
+	OUTPUT_VARIABLE OBJDUMP_OUTPUT
+	RESULT_VARIABLE OBJDUMP_RESULT
+)
+
+if(NOT OBJDUMP_RESULT EQUAL 0)
+	message(FATAL_ERROR "noinit check: ${OBJDUMP} failed")
+endif()
+
+string(REPLACE "\n" ";" OBJDUMP_LINES "${OBJDUMP_OUTPUT}")
+
+# <index> <name> <size> <vma> <lma> <file offset> <alignment>, followed by a line with the flags
+set(SECTION "")
+foreach(LINE ${OBJDUMP_LINES})
+	if(LINE MATCHES "^ *[0-9]+ ([A-Za-z0-9_.]+) +([0-9a-f]+) +([0-9a-f]+) ")
+		set(SECTION ${CMAKE_MATCH_1})
+		math(EXPR SECTION_SIZE_${SECTION} "0x${CMAKE_MATCH_2}")
+		math(EXPR SECTION_START_${SECTION} "0x${CMAKE_MATCH_3}")
+		math(EXPR SECTION_END_${SECTION} "0x${CMAKE_MATCH_3} + 0x${CMAKE_MATCH_2}")
+	elseif(SECTION AND (LINE MATCHES "^ +([A-Z, _]+)$"))
+		set(SECTION_FLAGS_${SECTION} "${CMAKE_MATCH_1}")
+		set(SECTION "")
+	endif()
+endforeach()
+
+if(NOT DEFINED SECTION_SIZE_.noinit)
+	message(FATAL_ERROR "noinit check: No .noinit section, the warm restart record is placed in a section that is initialized at startup")
+endif()
+
+# Sections with content (LOAD) are copied from flash at startup
+if(SECTION_FLAGS_.noinit MATCHES "LOAD|CONTENTS")
+	message(FATAL_ERROR "noinit check: .noinit has content (${SECTION_FLAGS_.noinit}), it is initialized at startup")
+endif()
+
+foreach(INITIALIZED .data .bss)
+	if(DEFINED SECTION_START_${INITIALIZED})
+		if((SECTION_START_.noinit LESS SECTION_END_${INITIALIZED}) AND (SECTION_START_${INITIALIZED} LESS SECTION_END_.noinit))
+			message(FATAL_ERROR "noinit check: .noinit overlaps ${INITIALIZED}, it is initialized at startup")
+		endif()
+	endif()
+endforeach()
+
+message(STATUS "noinit check: .noinit ${SECTION_SIZE_.noinit} bytes, not initialized at startup")
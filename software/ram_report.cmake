@@ -0,0 +1,114 @@
+# Prints the statically allocated RAM per hardware version after the build
+# and warns if there is not enough RAM left for the stack. Also prints the
+# code size and location (flash or RAM) of the hot functions, to compare the
+# images for a single hardware version and HOT_PATH_IN_RAM with the default.
+#
+# Usage: cmake -DNM=<arm-none-eabi-nm> -DELF=<firmware.elf> [-DHARDWARE_VERSION=<2/3/4>] -P ram_report.cmake
+#
+# All variables are allocated on every hardware version. The report shows
+# how much of it is dead on each version, because it belongs to subsystems
+# that are only available on other hardware versions. The arena (see
+# src/arena.h) is shared between V3 and V4 and counts as used there.
+
+set(RAM_BASE 536870912) # 0x20000000
+set(RAM_SIZE 16384)     # XMC1404: 16kb SRAM
+set(RAM_STACK_MIN 2048) # -Wstack-usage=1024 per function, plus nested calls and IRQs
+
+set(RAM_ONLY_V3 frequency)
+set(RAM_ONLY_V4 eichrecht ove_r37)
+set(RAM_SHARED  arena)
+
+# Called in every main loop iteration, see src/hot_path.h
+set(HOT_FUNCTIONS adc_tick adc_check_result adc_check_count iec61851_tick evse_set_output evse_set_cp_duty_cycle charging_slot_get_max_current phase_control_tick led_tick led_render)
+
+execute_process(
+	COMMAND ${NM} --print-size --size-sort --radix=d ${ELF}
+	OUTPUT_VARIABLE NM_OUTPUT
+	RESULT_VARIABLE NM_RESULT
+)
+
+if(NOT NM_RESULT EQUAL 0)
+	message(WARNING "RAM report: ${NM} failed")
+	return()
+endif()
+
+string(REPLACE "\n" ";" NM_LINES "${NM_OUTPUT}")
+
+math(EXPR RAM_END "${RAM_BASE} + ${RAM_SIZE}")
+
+set(RAM_TOTAL 0)
+set(RAM_CODE 0)
+foreach(LINE ${NM_LINES})
+	# <address> <size> <type> <name>, everything that is located in RAM
+	# (.bss, .data and .ram_code, see src/hot_path.h)
+	if(LINE MATCHES "^([0-9]+) ([0-9]+) ([A-Za-z]) ([A-Za-z0-9_.]+)$")
+		set(ADDRESS ${CMAKE_MATCH_1})
+		set(SIZE ${CMAKE_MATCH_2})
+		set(TYPE ${CMAKE_MATCH_3})
+		set(NAME ${CMAKE_MATCH_4})
+
+		# LTO renames local functions (e.g. adc_check_result.lto_priv.0)
+		if(TYPE MATCHES "[tT]" AND NAME MATCHES "^([A-Za-z0-9_]+)")
+			set(CODE_SYMBOL_${CMAKE_MATCH_1} ${SIZE})
+			set(CODE_RAM_${CMAKE_MATCH_1} FALSE)
+			if((ADDRESS GREATER_EQUAL RAM_BASE) AND (ADDRESS LESS RAM_END))
+				set(CODE_RAM_${CMAKE_MATCH_1} TRUE)
+			endif()
+		endif()
+
+		if((ADDRESS GREATER_EQUAL RAM_BASE) AND (ADDRESS LESS RAM_END))
+			math(EXPR RAM_TOTAL "${RAM_TOTAL} + ${SIZE}")
+			set(RAM_SYMBOL_${NAME} ${SIZE})
+			if(TYPE MATCHES "[tT]")
+				math(EXPR RAM_CODE "${RAM_CODE} + ${SIZE}")
+			endif()
+		endif()
+	endif()
+endforeach()
+
+function(ram_sum OUT)
+	set(SUM 0)
+	foreach(NAME ${ARGN})
+		if(DEFINED RAM_SYMBOL_${NAME})
+			math(EXPR SUM "${SUM} + ${RAM_SYMBOL_${NAME}}")
+		endif()
+	endforeach()
+	set(${OUT} ${SUM} PARENT_SCOPE)
+endfunction()
+
+ram_sum(DEAD_V2 ${RAM_ONLY_V3} ${RAM_ONLY_V4} ${RAM_SHARED})
+ram_sum(DEAD_V3 ${RAM_ONLY_V4})
+ram_sum(DEAD_V4 ${RAM_ONLY_V3})
+ram_sum(ARENA   ${RAM_SHARED})
+
+math(EXPR FREE "${RAM_SIZE} - ${RAM_TOTAL}")
+message(STATUS "RAM report: ${RAM_TOTAL} of ${RAM_SIZE} bytes static (${FREE} bytes left for stack), arena ${ARENA} bytes, code ${RAM_CODE} bytes")
+if(FREE LESS RAM_STACK_MIN)
+	message(WARNING "RAM report: Only ${FREE} bytes left for stack, ${RAM_STACK_MIN} bytes needed")
+endif()
+set(VERSIONS V2 V3 V4)
+if(HARDWARE_VERSION)
+	set(VERSIONS V${HARDWARE_VERSION}) # Image for a single hardware version
+endif()
+
+foreach(VERSION ${VERSIONS})
+	math(EXPR USED "${RAM_TOTAL} - ${DEAD_${VERSION}}")
+	message(STATUS "RAM report: ${VERSION} uses ${USED} bytes, ${DEAD_${VERSION}} bytes belong to other hardware versions")
+endforeach()
+
+set(HOT_TOTAL 0)
+set(HOT_LIST "")
+foreach(NAME ${HOT_FUNCTIONS})
+	if(DEFINED CODE_SYMBOL_${NAME})
+		math(EXPR HOT_TOTAL "${HOT_TOTAL} + ${CODE_SYMBOL_${NAME}}")
+		if(CODE_RAM_${NAME})
+			list(APPEND HOT_LIST "${NAME} ${CODE_SYMBOL_${NAME}} (RAM)")
+		else()
+			list(APPEND HOT_LIST "${NAME} ${CODE_SYMBOL_${NAME}}")
+		endif()
+	else()
+		list(APPEND HOT_LIST "${NAME} inlined")
+	endif()
+endforeach()
+string(REPLACE ";" ", " HOT_LIST "${HOT_LIST}")
+message(STATUS "Hot path report: ${HOT_TOTAL} bytes code: ${HOT_LIST}")
@@ -31,6 +31,8 @@
 
 #include "iec61851.h"
 #include "evse.h"
+#include "hot_path.h"
+#include "cp_replay.h"
 
 #define ADC_DIODE_DROP 650
 
@@ -371,12 +373,18 @@ void adc_init_adc(void) {
 		XMC_VADC_GLOBAL_BackgroundAddChannelToSequence(VADC, adc[i].group_index, adc[i].channel_num);
 	}
 
+	// The end of background scan sets the pending bit of the ADC IRQ. The IRQ itself
+	// stays disabled, the pending bit wakes the core from WFE in cpu_load_tick()
+	// (SEVONPEND, CPU_SLEEP option) and tells it that there are new results, see adc_is_scan_pending().
 	// Uncomment to turn on debug in IRQ (toggles GP output pin when adc conversion is ready)
-//	XMC_VADC_GLOBAL_SetResultEventInterruptNode(VADC, XMC_VADC_SR_SHARED_SR0);
+	XMC_VADC_GLOBAL_BackgroundSetReqSrcEventInterruptNode(VADC, XMC_VADC_SR_SHARED_SR0);
+//	NVIC_SetPriority(ADC_IRQ, 2);
+//	NVIC_EnableIRQ(ADC_IRQ);
+}
 
-//	NVIC_SetPriority(15, 2);
-//	XMC_VADC_GLOBAL_BackgroundSetReqSrcEventInterruptNode(VADC, XMC_VADC_SR_SHARED_SR0);
-//	NVIC_EnableIRQ(15);
+// A background scan finished since the last adc_tick()
+bool adc_is_scan_pending(void) {
+	return NVIC_GetPendingIRQ(ADC_IRQ) != 0;
 }
 
 void adc_init(void) {
@@ -409,7 +417,7 @@ void adc_enable_all(const bool all) {
 	}
 }
 
-void adc_check_result(const uint8_t i) {
+void HOT_PATH adc_check_result(const uint8_t i) {
 	uint32_t result = XMC_VADC_GROUP_GetDetailedResult(adc[i].group, adc[i].result_reg);
 	if(result & (1UL << 31)) {
 
@@ -418,6 +426,11 @@ void adc_check_result(const uint8_t i) {
 		// evaluate any measurements.
 		if(evse_is_cp_connected()) {
 			uint16_t r = result & 0xFFFF;
+#ifdef CP_TRACE_REPLAY
+			if(cp_replay.active) {
+				r = cp_replay_get_raw(i, r);
+			}
+#endif
 			if((i <= 1) && (r < 2048)) {
 				adc[i].result_sum[ADC_NEGATIVE_MEASUREMENT] += r;
 				adc[i].result_count[ADC_NEGATIVE_MEASUREMENT]++;
@@ -447,7 +460,7 @@ void adc_check_result(const uint8_t i) {
 	}
 }
 
-void adc_check_count(const uint8_t i) {
+void HOT_PATH adc_check_count(const uint8_t i) {
 	if(i <= ADC_CHANNEL_VCP2) {
 		if(adc[i].result_count[ADC_NEGATIVE_MEASUREMENT] >= 25) {
 			// We want:
@@ -553,6 +566,7 @@ void adc_check_count(const uint8_t i) {
 			if(i == ADC_CHANNEL_VCP2) {
 				adc_result.cp_pe_is_ignored = false;
 				adc_result.resistance_counter++;
+				hot_path_adc_result();
 
 				// Diode voltage drop 650mV (value is educated guess)
 				// Resistance divider, 910 ohm for WARP2/WARP3 and 1000 ohm for WARP4
@@ -575,7 +589,10 @@ void adc_check_count(const uint8_t i) {
 	}
 }
 
-void adc_tick(void) {
+void HOT_PATH adc_tick(void) {
+	// Cleared before the results are read, a scan that ends afterwards is pending again
+	NVIC_ClearPendingIRQ(ADC_IRQ);
+
 	for(uint8_t i = 0; i < ADC_NUM; i++) {
 		adc_check_result(i);
 	}
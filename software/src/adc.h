@@ -29,6 +29,8 @@
 #include <stdbool.h>
 
 
+#define ADC_IRQ 15 // Shared service request 0 of the VADC, end of background scan
+
 #define ADC_NUM_WITH_PWM 2
 #define ADC_NUM 5
 
@@ -82,5 +84,7 @@ void adc_init(void);
 void adc_tick(void);
 void adc_enable_all(const bool all);
 void adc_ignore_results(const uint8_t count);
+void adc_check_count(const uint8_t i);
+bool adc_is_scan_pending(void);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * arena.h: RAM shared between hardware version specific subsystems
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "frequency.h"
+#include "eichrecht.h"
+
+// Only one hardware version runs at a time, so the buffers of subsystems
+// that are only available on one hardware version share the same RAM.
+// The arena is cleared in hardware_version_init(), afterwards only the
+// subsystem of the detected hardware version may use it.
+
+// V3: Mains frequency measurement
+typedef struct {
+	uint16_t period_buffer[FREQUENCY_BUFFER_SIZE];
+	uint32_t edge_queue_buffer[FREQUENCY_EDGE_QUEUE_SIZE];
+} ArenaFrequency;
+
+// V4: Eichrecht. The buffers can not overlay each other, since the dataset and
+// signature of the previous transaction may still be sent to the host while
+// the dataset of the next transaction is already written to the meter.
+typedef struct {
+	char dataset_in[EICHRECHT_DATASET_IN_SIZE] __attribute__((aligned(4)));
+	char dataset_out[EICHRECHT_DATASET_OUT_SIZE] __attribute__((aligned(4)));
+	char signature[EICHRECHT_SIGNATURE_SIZE] __attribute__((aligned(4)));
+} ArenaEichrecht;
+
+typedef union {
+	ArenaFrequency frequency;
+	ArenaEichrecht eichrecht;
+} Arena;
+
+// Arena usage per hardware version
+#define ARENA_SIZE_V2 0
+#define ARENA_SIZE_V3 sizeof(ArenaFrequency)
+#define ARENA_SIZE_V4 sizeof(ArenaEichrecht)
+
+_Static_assert(sizeof(Arena) == ARENA_SIZE_V4, "Largest arena user changed, update ARENA_SIZE_*");
+
+extern Arena arena;
+
+void arena_init(void);
+
+#endif
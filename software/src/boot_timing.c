@@ -0,0 +1,84 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * boot_timing.c: Timestamps of init functions and boot milestones
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "boot_timing.h"
+
+#include "bricklib2/hal/system_timer/system_timer.h"
+#include "bricklib2/warp/meter.h"
+
+#include "evse.h"
+#include "adc.h"
+#include "eichrecht.h"
+#include "frequency.h"
+
+#include "xmc_device.h"
+
+#include <string.h>
+
+BootTiming boot_timing;
+
+// System timer ms plus SysTick counter for sub-ms resolution
+static uint32_t boot_timing_get_us(void) {
+	uint32_t ms;
+	uint32_t value;
+
+	// Read again if the SysTick interrupt incremented the ms counter in between
+	do {
+		ms    = system_timer_get_ms();
+		value = SysTick->VAL;
+	} while(ms != system_timer_get_ms());
+
+	return ms*1000 + (SysTick->LOAD - value)*1000/(SysTick->LOAD + 1);
+}
+
+// Only the first time a phase is reached is saved
+void boot_timing_mark(const uint8_t phase) {
+	if((phase < BOOT_TIMING_NUM) && (boot_timing.time[phase] == 0)) {
+		boot_timing.time[phase] = boot_timing_get_us();
+		if(boot_timing.time[phase] == 0) {
+			boot_timing.time[phase] = 1;
+		}
+	}
+}
+
+// Called first in main
+void boot_timing_init(void) {
+	memset(&boot_timing, 0, sizeof(BootTiming));
+	boot_timing_mark(BOOT_TIMING_MAIN);
+}
+
+void boot_timing_tick(void) {
+	if(evse.startup_time == 0) {
+		boot_timing_mark(BOOT_TIMING_STARTUP_HOLD_DONE);
+	}
+	if(adc_result.resistance_counter != 0) {
+		boot_timing_mark(BOOT_TIMING_CP_PE_RESISTANCE_VALID);
+	}
+	if(meter.each_value_read_once) {
+		boot_timing_mark(BOOT_TIMING_METER_VALUE);
+	}
+	if(eichrecht.init_done) {
+		boot_timing_mark(BOOT_TIMING_EICHRECHT_INIT_DONE);
+	}
+	if(frequency.valid) {
+		boot_timing_mark(BOOT_TIMING_FREQUENCY_VALID);
+	}
+}
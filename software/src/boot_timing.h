@@ -0,0 +1,86 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * boot_timing.h: Timestamps of init functions and boot milestones
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef BOOT_TIMING_H
+#define BOOT_TIMING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Phase IDs are fixed, they are used as index in get boot timing. New
+// phases get the next free ID, existing IDs are never renumbered or reused.
+// The ID order is not the order of main(), the host sorts the inits by time.
+
+// Inits in main(), the timestamp is taken when the init returns
+#define BOOT_TIMING_MAIN                       0
+#define BOOT_TIMING_RAM_USAGE_INIT             1
+#define BOOT_TIMING_WARM_RESTART_INIT          2
+#define BOOT_TIMING_LOGGING_INIT               3
+#define BOOT_TIMING_HARDWARE_VERSION_INIT      4
+#define BOOT_TIMING_COMMUNICATION_INIT         5
+#define BOOT_TIMING_OVE_R37_INIT               6
+#define BOOT_TIMING_EICHRECHT_INIT             7
+#define BOOT_TIMING_EVSE_INIT                  8
+#define BOOT_TIMING_CHARGING_SLOT_INIT         9
+#define BOOT_TIMING_IEC61851_INIT              10
+#define BOOT_TIMING_LOCK_INIT                  11
+#define BOOT_TIMING_CONTACTOR_CHECK_INIT       12
+#define BOOT_TIMING_LED_INIT                   13
+#define BOOT_TIMING_BUTTON_INIT                14
+#define BOOT_TIMING_ADC_INIT                   15
+#define BOOT_TIMING_DC_FAULT_INIT              16
+#define BOOT_TIMING_RS485_INIT                 17
+#define BOOT_TIMING_METER_INIT                 18
+#define BOOT_TIMING_PHASE_CONTROL_INIT         19
+#define BOOT_TIMING_TMP1075N_INIT              20
+#define BOOT_TIMING_DERATING_INIT              21
+#define BOOT_TIMING_PLC_INIT                   22
+#define BOOT_TIMING_FREQUENCY_INIT             23
+#define BOOT_TIMING_ISKRA_DISPLAY_INIT         24
+#define BOOT_TIMING_HOT_PATH_INIT              25
+#define BOOT_TIMING_WARM_RESTART_RESUME        26
+
+// Milestones after the main loop started
+#define BOOT_TIMING_STARTUP_HOLD_DONE          27 // evse_tick() starts IEC 61851 handling
+#define BOOT_TIMING_DC_FAULT_CALIBRATION_DONE  28
+#define BOOT_TIMING_CP_PE_RESISTANCE_VALID     29
+#define BOOT_TIMING_METER_VALUE                30
+#define BOOT_TIMING_EICHRECHT_INIT_DONE        31
+#define BOOT_TIMING_FREQUENCY_VALID            32
+
+// Inits added later
+#define BOOT_TIMING_CPU_LOAD_INIT              33
+#define BOOT_TIMING_DIGITAL_INPUT_INIT         34
+#define BOOT_TIMING_CP_REPLAY_INIT             35
+
+#define BOOT_TIMING_NUM                        36
+
+typedef struct {
+	uint32_t time[BOOT_TIMING_NUM]; // us since system timer start (wraps after ~71 min), 0 = not reached (yet)
+} BootTiming;
+
+extern BootTiming boot_timing;
+
+void boot_timing_mark(const uint8_t phase);
+void boot_timing_init(void);
+void boot_timing_tick(void);
+
+#endif
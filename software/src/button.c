@@ -31,12 +31,10 @@
 #include "communication.h"
 #include "charging_slot.h"
 #include "iec61851.h"
+#include "digital_input.h"
 
 #include <string.h>
 
-#define BUTTON_DEBOUNCE_STANDARD 100 // ms
-#define BUTTON_DEBOUNCE_LONG     2000 // ms
-
 Button button;
 
 void button_init(void) {
@@ -53,17 +51,25 @@ void button_init(void) {
 	XMC_GPIO_Init(EVSE_BUTTON_PIN, &pin_config_input);
 
 	button.configuration = button_conf_tmp;
-	button.debounce_time = BUTTON_DEBOUNCE_STANDARD;
 
 	button.boot_press_start = system_timer_get_ms();
 }
 
+// The long debounce time is used for the next change of the button state
+static void button_set_debounce_long(void) {
+	button.debounce_long = true;
+	digital_input_set_thresholds(DIGITAL_INPUT_BUTTON, BUTTON_DEBOUNCE_LONG, BUTTON_DEBOUNCE_LONG);
+}
+
 void button_tick(void) {
-	const bool value = XMC_GPIO_GetInput(EVSE_BUTTON_PIN);
+	// The button is debounced by the digital input integrator
+	const bool value = digital_input_get_value(DIGITAL_INPUT_BUTTON);
+	const bool raw   = digital_input_get_raw(DIGITAL_INPUT_BUTTON);
 
 	// Implement boot press time for recovery mode
+	// Uses the pin directly, the integrator starts as released
 	if(!button.boot_done) {
-		if(!value) {
+		if(!XMC_GPIO_GetInput(EVSE_BUTTON_PIN)) {
 			button.boot_press_time = system_timer_get_ms() - button.boot_press_start;
 
 			// Only accept boot press times > 2s
@@ -74,21 +80,24 @@ void button_tick(void) {
 		}
 	}
 
-	if(value != button.last_value) {
-		button.last_value = value;
-		button.last_change_time = system_timer_get_ms();
-
-		// DEBOUNCE button state will be overwritten after debounce time
-		if(!value) {
+	// DEBOUNCE button state will be overwritten after debounce time
+	if(raw != value) {
+		if(!raw) {
 			button.state = BUTTON_STATE_RELEASED_DEBOUNCE;
 		} else {
 			button.state = BUTTON_STATE_PRESSED_DEBOUNCE;
 		}
+	} else if((button.state == BUTTON_STATE_RELEASED_DEBOUNCE) || (button.state == BUTTON_STATE_PRESSED_DEBOUNCE)) {
+		// Bounced back to the stable value
+		button.state = value ? BUTTON_STATE_PRESSED : BUTTON_STATE_RELEASED;
 	}
 
-	if(button.last_change_time != 0 && system_timer_is_time_elapsed_ms(button.last_change_time, button.debounce_time)) {
-		button.last_change_time = 0;
-		button.debounce_time    = BUTTON_DEBOUNCE_STANDARD;
+	if(digital_input_take_edge(DIGITAL_INPUT_BUTTON)) {
+		if(button.debounce_long) {
+			button.debounce_long = false;
+			digital_input_set_thresholds(DIGITAL_INPUT_BUTTON, BUTTON_DEBOUNCE_STANDARD, BUTTON_DEBOUNCE_STANDARD);
+		}
+
 		if(!value) {
 			button.state = BUTTON_STATE_RELEASED;
 			button.release_time = system_timer_get_ms();
@@ -114,7 +123,7 @@ void button_tick(void) {
 					// we increase the button debounce to 2 seconds if the button is configured to also stop charging,
 					// to make sure to never start the charge and stop it again immediately.
 					if(button.configuration & EVSE_V2_BUTTON_CONFIGURATION_STOP_CHARGING) {
-						button.debounce_time = BUTTON_DEBOUNCE_LONG;
+						button_set_debounce_long();
 					}
 				}
 			} else if(iec61851.state == IEC61851_STATE_B) { // B2
@@ -126,7 +135,7 @@ void button_tick(void) {
 					// we increase the button debounce to 2 seconds if the button is configured to also start charging,
 					// to make sure to never stop the charge and start it again immediately.
 					if(button.configuration & EVSE_V2_BUTTON_CONFIGURATION_START_CHARGING) {
-						button.debounce_time = BUTTON_DEBOUNCE_LONG;
+						button_set_debounce_long();
 					}
 				}
 			} else if(iec61851.state == IEC61851_STATE_C) {
@@ -138,7 +147,7 @@ void button_tick(void) {
 					// we increase the button debounce to 2 seconds if the button is configured to also start charging,
 					// to make sure to never stop the charge and start it again immediately.
 					if(button.configuration & EVSE_V2_BUTTON_CONFIGURATION_START_CHARGING) {
-						button.debounce_time = BUTTON_DEBOUNCE_LONG;
+						button_set_debounce_long();
 					}
 				}
 			}
@@ -25,6 +25,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#define BUTTON_DEBOUNCE_STANDARD 100 // ms
+#define BUTTON_DEBOUNCE_LONG     2000 // ms
+
 typedef enum {
 	BUTTON_STATE_RELEASED,
 	BUTTON_STATE_PRESSED,
@@ -35,9 +38,7 @@ typedef enum {
 typedef struct {
 	ButtonState state;
 
-	bool last_value;
-	uint32_t last_change_time;
-	uint32_t debounce_time;
+	bool debounce_long;
 
 	uint8_t configuration;
 
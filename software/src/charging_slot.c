@@ -31,6 +31,8 @@
 #include "iec61851.h"
 #include "configs/config_evse.h"
 #include "phase_control.h"
+#include "hot_path.h"
+#include "digital_input.h"
 
 ChargingSlot charging_slot;
 
@@ -76,7 +78,11 @@ void charging_slot_tick(void) {
 
 	// Handle shutdown input configuration
 	charging_slot.clear_on_disconnect[CHARGING_SLOT_INPUT0] = false;
-	if(evse.shutdown_input_configuration == EVSE_V2_SHUTDOWN_INPUT_IGNORED) {
+	if(digital_input_is_stalled()) {
+		// The input values are frozen if the sampling IRQ does not run, shut down regardless of the configuration
+		charging_slot.active[CHARGING_SLOT_INPUT0]      = true;
+		charging_slot.max_current[CHARGING_SLOT_INPUT0] = 0;
+	} else if(evse.shutdown_input_configuration == EVSE_V2_SHUTDOWN_INPUT_IGNORED) {
 		charging_slot.active[CHARGING_SLOT_INPUT0]      = false;
 		charging_slot.max_current[CHARGING_SLOT_INPUT0] = 32000;
 	} else { // SHUTDOWN_ON_CLOSE, SHUTDOWN_ON_OPEN, 4200_WATT_ON_OPEN, 4200_WATT_ON_CLOSE
@@ -103,7 +109,7 @@ void charging_slot_tick(void) {
 		charging_slot.max_current[CHARGING_SLOT_INPUT1]         = 32000;
 		charging_slot.clear_on_disconnect[CHARGING_SLOT_INPUT1] = false;
 	} else if(evse.input_configuration <= EVSE_V2_INPUT_ACTIVE_HIGH_MAX_25A) { // Configured for max current
-		const bool input        = hardware_version.is_v2 ? XMC_GPIO_GetInput(EVSE_INPUT_GP_PIN) : false;
+		const bool input        = hardware_version.is_v2 ? digital_input_get_value(DIGITAL_INPUT_GP) : false;
 		const bool input_active = (!input && (evse.input_configuration <= EVSE_V2_INPUT_ACTIVE_LOW_MAX_25A)) ||
 								  ( input && (evse.input_configuration >  EVSE_V2_INPUT_ACTIVE_LOW_MAX_25A));
 		if(input_active) {
@@ -121,7 +127,7 @@ void charging_slot_tick(void) {
 	}
 }
 
-uint16_t charging_slot_get_max_current(void) {
+uint16_t HOT_PATH charging_slot_get_max_current(void) {
 	uint16_t max_current = 0xFFFF;
 
 	for(uint8_t i = 0; i < CHARGING_SLOT_NUM; i++) {
@@ -36,6 +36,7 @@
 #define CHARGING_SLOT_LOAD_MANAGEMENT 7
 #define CHARGING_SLOT_EXTERNAL        8
 #define CHARGING_SLOT_OVE_R37         17
+#define CHARGING_SLOT_THERMAL         18
 
 typedef struct {
 	uint16_t max_current_default[CHARGING_SLOT_DEFAULT_NUM];
@@ -49,6 +49,17 @@
 #include "plc.h"
 #include "ove_r37.h"
 #include "iskra_display.h"
+#include "frequency.h"
+#include "derating.h"
+#include "arena.h"
+#include "hot_path.h"
+#include "ram_usage.h"
+#include "warm_restart.h"
+#include "boot_timing.h"
+#include "cpu_load.h"
+#include "digital_input.h"
+#include "cp_replay.h"
+#include "microbenchmark.h"
 
 #define LOW_LEVEL_PASSWORD 0x4223B00B
 
@@ -58,6 +69,11 @@ BootloaderHandleMessageResponse handle_message(const void *message, void *respon
 	// Restart communication watchdog timer.
 	evse.communication_watchdog_time = system_timer_get_ms();
 
+	// Firmware image for another hardware version, only the bootloader functions are available
+	if(!hardware_version_is_image_compatible()) {
+		return HANDLE_MESSAGE_RESPONSE_NOT_SUPPORTED;
+	}
+
 	switch(tfp_get_fid_from_message(message)) {
 		case FID_GET_STATE:                             return length != sizeof(GetState)                         ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_state(message, response);
 		case FID_GET_HARDWARE_CONFIGURATION:            return length != sizeof(GetHardwareConfiguration)         ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_hardware_configuration(message, response);
@@ -133,6 +149,39 @@ BootloaderHandleMessageResponse handle_message(const void *message, void *respon
 		case FID_GET_ENERGY_METER_DISPLAY_TEXT:         return length != sizeof(GetEnergyMeterDisplayText)        ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_energy_meter_display_text(message, response);
 		case FID_SET_ENERGY_METER_DISPLAY_BACKLIGHT:    return length != sizeof(SetEnergyMeterDisplayBacklight)   ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : set_energy_meter_display_backlight(message);
 		case FID_GET_ENERGY_METER_DISPLAY_BACKLIGHT:    return length != sizeof(GetEnergyMeterDisplayBacklight)   ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_energy_meter_display_backlight(message, response);
+		case FID_GET_OVE_R37_STATISTICS:                return length != sizeof(GetOVER37Statistics)              ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_ove_r37_statistics(message, response);
+		case FID_GET_OVE_R37_EVENT:                     return length != sizeof(GetOVER37Event)                   ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_ove_r37_event(message, response);
+		case FID_SET_MAINS_FREQUENCY_CONFIGURATION:     return length != sizeof(SetMainsFrequencyConfiguration)   ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : set_mains_frequency_configuration(message);
+		case FID_GET_MAINS_FREQUENCY_CONFIGURATION:     return length != sizeof(GetMainsFrequencyConfiguration)   ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_mains_frequency_configuration(message, response);
+		case FID_GET_MAINS_FREQUENCY:                   return length != sizeof(GetMainsFrequency)                ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_mains_frequency(message, response);
+		case FID_GET_MAINS_FREQUENCY_SOURCE_COMPARISON: return length != sizeof(GetMainsFrequencySourceComparison) ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_mains_frequency_source_comparison(message, response);
+		case FID_SET_THERMAL_DERATING_CONFIGURATION:    return length != sizeof(SetThermalDeratingConfiguration)  ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : set_thermal_derating_configuration(message);
+		case FID_GET_THERMAL_DERATING_CONFIGURATION:    return length != sizeof(GetThermalDeratingConfiguration)  ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_thermal_derating_configuration(message, response);
+		case FID_GET_THERMAL_DERATING_STATE:            return length != sizeof(GetThermalDeratingState)          ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_thermal_derating_state(message, response);
+#ifdef HOT_PATH_STATISTICS
+		case FID_GET_HOT_PATH_STATISTICS:               return length != sizeof(GetHotPathStatistics)             ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_hot_path_statistics(message, response);
+#endif
+		case FID_GET_RAM_USAGE:                         return length != sizeof(GetRAMUsage)                      ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_ram_usage(message, response);
+		case FID_GET_BOOT_PATH:                         return length != sizeof(GetBootPath)                      ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_boot_path(message, response);
+		case FID_GET_BOOT_TIMING:                       return length != sizeof(GetBootTiming)                    ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_boot_timing(message, response);
+		case FID_GET_CPU_LOAD:                          return length != sizeof(GetCPULoad)                       ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_cpu_load(message, response);
+		case FID_GET_DIGITAL_INPUT:                     return length != sizeof(GetDigitalInput)                  ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_digital_input(message, response);
+#ifdef CP_TRACE_REPLAY
+		case FID_SET_CP_TRACE_REPLAY:                   return length != sizeof(SetCPTraceReplay)                 ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : set_cp_trace_replay(message);
+		case FID_WRITE_CP_TRACE:                        return length != sizeof(WriteCPTrace)                     ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : write_cp_trace(message, response);
+		case FID_GET_CP_TRACE_REPLAY_STATE:             return length != sizeof(GetCPTraceReplayState)            ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_cp_trace_replay_state(message, response);
+		case FID_GET_CP_TRACE_TIMELINE:                 return length != sizeof(GetCPTraceTimeline)               ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_cp_trace_timeline(message, response);
+#endif
+		case FID_SET_LED_ANIMATION_KEYFRAMES:           return length != sizeof(SetLEDAnimationKeyframes)         ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : set_led_animation_keyframes(message);
+		case FID_GET_LED_ANIMATION_KEYFRAMES:           return length != sizeof(GetLEDAnimationKeyframes)         ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_led_animation_keyframes(message, response);
+		case FID_SET_LED_ANIMATION:                     return length != sizeof(SetLEDAnimation)                  ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : set_led_animation(message);
+		case FID_GET_LED_ANIMATION:                     return length != sizeof(GetLEDAnimation)                  ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_led_animation(message, response);
+		case FID_GET_LOCK_STATISTICS:                   return length != sizeof(GetLockStatistics)                ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_lock_statistics(message, response);
+		case FID_GET_EICHRECHT_TRANSACTION_SEQUENCE:    return length != sizeof(GetEichrechtTransactionSequence)  ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_eichrecht_transaction_sequence(message, response);
+#ifdef MICROBENCHMARK
+		case FID_START_MICROBENCHMARK:                  return length != sizeof(StartMicrobenchmark)              ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : start_microbenchmark(message);
+		case FID_GET_MICROBENCHMARK:                    return length != sizeof(GetMicrobenchmark)                ? HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER : get_microbenchmark(message, response);
+#endif
 		default: return HANDLE_MESSAGE_RESPONSE_NOT_SUPPORTED;
 	}
 }
@@ -290,8 +339,8 @@ BootloaderHandleMessageResponse get_low_level_state(const GetLowLevelState *data
 }
 
 BootloaderHandleMessageResponse set_charging_slot(const SetChargingSlot *data) {
-	// The first two slots are read-only
-	if((data->slot < 2) || (data->slot >= CHARGING_SLOT_NUM)) {
+	// The first two slots and the thermal derating slot are read-only
+	if((data->slot < 2) || (data->slot >= CHARGING_SLOT_NUM) || (data->slot == CHARGING_SLOT_THERMAL)) {
 		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
 	}
 
@@ -310,8 +359,8 @@ BootloaderHandleMessageResponse set_charging_slot(const SetChargingSlot *data) {
 }
 
 BootloaderHandleMessageResponse set_charging_slot_max_current(const SetChargingSlotMaxCurrent *data) {
-	// The first two slots are read-only
-	if((data->slot < 2) || (data->slot >= CHARGING_SLOT_NUM)) {
+	// The first two slots and the thermal derating slot are read-only
+	if((data->slot < 2) || (data->slot >= CHARGING_SLOT_NUM) || (data->slot == CHARGING_SLOT_THERMAL)) {
 		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
 	}
 
@@ -328,8 +377,8 @@ BootloaderHandleMessageResponse set_charging_slot_max_current(const SetChargingS
 }
 
 BootloaderHandleMessageResponse set_charging_slot_active(const SetChargingSlotActive *data) {
-	// The first two slots are read-only
-	if((data->slot < 2) || (data->slot >= CHARGING_SLOT_NUM)) {
+	// The first two slots and the thermal derating slot are read-only
+	if((data->slot < 2) || (data->slot >= CHARGING_SLOT_NUM) || (data->slot == CHARGING_SLOT_THERMAL)) {
 		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
 	}
 
@@ -339,8 +388,8 @@ BootloaderHandleMessageResponse set_charging_slot_active(const SetChargingSlotAc
 }
 
 BootloaderHandleMessageResponse set_charging_slot_clear_on_disconnect(const SetChargingSlotClearOnDisconnect *data) {
-	// The first two slots are read-only
-	if((data->slot < 2) || (data->slot >= CHARGING_SLOT_NUM)) {
+	// The first two slots and the thermal derating slot are read-only
+	if((data->slot < 2) || (data->slot >= CHARGING_SLOT_NUM) || (data->slot == CHARGING_SLOT_THERMAL)) {
 		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
 	}
 
@@ -374,7 +423,8 @@ BootloaderHandleMessageResponse get_all_charging_slots(const GetAllChargingSlots
 }
 
 BootloaderHandleMessageResponse set_charging_slot_default(const SetChargingSlotDefault *data) {
-	if((data->slot < 2) || (data->slot >= CHARGING_SLOT_NUM)) {
+	// The thermal derating slot is owned by derating_tick, its default can't be set
+	if((data->slot < 2) || (data->slot >= CHARGING_SLOT_NUM) || (data->slot == CHARGING_SLOT_THERMAL)) {
 		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
 	}
 
@@ -550,7 +600,13 @@ BootloaderHandleMessageResponse get_indicator_led(const GetIndicatorLED *data, G
 }
 
 BootloaderHandleMessageResponse set_indicator_led(const SetIndicatorLED *data, SetIndicatorLED_Response *response) {
-	if((data->indication >= 256) && (data->indication != 1001) && (data->indication != 1002) && (data->indication != 1003) && ((data->indication < 2001) || (data->indication > 2010))) {
+	const bool is_animation = (data->indication >= LED_ANIMATION_INDICATION) && (data->indication < (LED_ANIMATION_INDICATION + LED_ANIMATION_SLOT_NUM));
+	if((data->indication >= 256) && (data->indication != 1001) && (data->indication != 1002) && (data->indication != 1003) && ((data->indication < 2001) || (data->indication > 2010)) && !is_animation) {
+		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+	}
+
+	// Empty animation slot
+	if(is_animation && (led_animation.keyframe_count[data->indication - LED_ANIMATION_INDICATION] == 0)) {
 		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
 	}
 
@@ -561,28 +617,28 @@ BootloaderHandleMessageResponse set_indicator_led(const SetIndicatorLED *data, S
 	led.set_v = data->color_v;
 
 	if(hardware_version.is_v2) {
-		led.h = LED_HUE_BLUE;
-		led.s = 255;
-		led.v = 255;
+		led.api_h = LED_HUE_BLUE;
+		led.api_s = 255;
+		led.api_v = 255;
 	} else if(hardware_version.is_v3 || hardware_version.is_v4) {
 		if(data->color_v == 0) {
-			led.s = 255;
-			led.v = 255;
+			led.api_s = 255;
+			led.api_v = 255;
 			if(data->indication == 1001) {
-				led.h = LED_HUE_OK;
+				led.api_h = LED_HUE_OK;
 			} else if(data->indication == 1002) {
-				led.h = LED_HUE_ERROR;
+				led.api_h = LED_HUE_ERROR;
 			} else if(data->indication == 1003) {
-				led.h = LED_HUE_YELLOW;
+				led.api_h = LED_HUE_YELLOW;
 			} else if((data->indication > 2000) && (data->indication < 2011)) {
-				led.h = LED_HUE_ERROR;
+				led.api_h = LED_HUE_ERROR;
 			} else {
-				led.h = LED_HUE_STANDARD;
+				led.api_h = LED_HUE_STANDARD;
 			}
 		} else {
-			led.h = data->color_h;
-			led.s = data->color_s;
-			led.v = data->color_v;
+			led.api_h = data->color_h;
+			led.api_s = data->color_s;
+			led.api_v = data->color_v;
 		}
 	}
 
@@ -598,19 +654,7 @@ BootloaderHandleMessageResponse set_indicator_led(const SetIndicatorLED *data, S
 
 	// Otherwise we reset the current animation and start the new one
 	if((led.state == LED_STATE_OFF) || (led.state == LED_STATE_ON) || (led.state == LED_STATE_API) || (led.state == LED_STATE_BREATHING)) {
-		response->status     = 0;
-
-		led.api_ack_counter  = 0;
-		led.api_ack_index    = 0;
-		led.api_ack_time     = 0;
-
-		led.api_nack_counter = 0;
-		led.api_nack_index   = 0;
-		led.api_nack_time    = 0;
-
-		led.api_nag_counter  = 0;
-		led.api_nag_index    = 0;
-		led.api_nag_time     = 0;
+		response->status = 0;
 
 		if(data->indication < 0) {
 			// If LED state is currently LED_STATE_OFF or LED_STATE_ON we
@@ -980,9 +1024,10 @@ BootloaderHandleMessageResponse get_charging_protocol(const GetChargingProtocol
 BootloaderHandleMessageResponse set_eichrecht_gateway_identification(const SetEichrechtGatewayIdentification *data, SetEichrechtGatewayIdentification_Response *response) {
 	response->header.length = sizeof(SetEichrechtGatewayIdentification_Response);
 
-	if(hardware_version.is_v4 && meter_supports_eichrecht()) {
-		eichrecht.ocmf.gi[sizeof(eichrecht.ocmf.gi) - 1] = 0;
-		memcpy(eichrecht.ocmf.gi, data->gateway_identification, sizeof(data->gateway_identification));
+	if(eichrecht_is_supported()) {
+		if(!eichrecht_set_gateway_identification(data->gateway_identification, sizeof(data->gateway_identification))) {
+			return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+		}
 
 		response->eichrecht_state = EVSE_V2_EICHRECHT_STATE_OK;
 	} else {
@@ -1003,9 +1048,10 @@ BootloaderHandleMessageResponse get_eichrecht_gateway_identification(const GetEi
 BootloaderHandleMessageResponse set_eichrecht_gateway_serial(const SetEichrechtGatewaySerial *data, SetEichrechtGatewaySerial_Response *response) {
 	response->header.length = sizeof(SetEichrechtGatewaySerial_Response);
 
-	if(hardware_version.is_v4 && meter_supports_eichrecht()) {
-		eichrecht.ocmf.gs[sizeof(eichrecht.ocmf.gs) - 1] = 0;
-		memcpy(eichrecht.ocmf.gs, data->gateway_serial, sizeof(data->gateway_serial));
+	if(eichrecht_is_supported()) {
+		if(!eichrecht_set_gateway_serial(data->gateway_serial, sizeof(data->gateway_serial))) {
+			return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+		}
 
 		response->eichrecht_state = EVSE_V2_EICHRECHT_STATE_OK;
 	} else {
@@ -1026,15 +1072,10 @@ BootloaderHandleMessageResponse get_eichrecht_gateway_serial(const GetEichrechtG
 BootloaderHandleMessageResponse set_eichrecht_user_assignment(const SetEichrechtUserAssignment *data, SetEichrechtUserAssignment_Response *response) {
 	response->header.length = sizeof(SetEichrechtUserAssignment_Response);
 
-	if(hardware_version.is_v4 && meter_supports_eichrecht()) {
-		eichrecht.ocmf.is = data->identification_status;
-		eichrecht.ocmf.if_[0] = data->identification_flags[0];
-		eichrecht.ocmf.if_[1] = data->identification_flags[1];
-		eichrecht.ocmf.if_[2] = data->identification_flags[2];
-		eichrecht.ocmf.if_[3] = data->identification_flags[3];
-		eichrecht.ocmf.it = data->identification_type;
-		eichrecht.ocmf.id[sizeof(eichrecht.ocmf.id) - 1] = 0;
-		memcpy(eichrecht.ocmf.id, data->identification_data, sizeof(data->identification_data));
+	if(eichrecht_is_supported()) {
+		if(!eichrecht_set_user_assignment(data->identification_status, data->identification_flags, data->identification_type, data->identification_data, sizeof(data->identification_data))) {
+			return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+		}
 
 		response->eichrecht_state = EVSE_V2_EICHRECHT_STATE_OK;
 	} else {
@@ -1061,10 +1102,10 @@ BootloaderHandleMessageResponse get_eichrecht_user_assignment(const GetEichrecht
 BootloaderHandleMessageResponse set_eichrecht_charge_point(const SetEichrechtChargePoint *data, SetEichrechtChargePoint_Response *response) {
 	response->header.length = sizeof(SetEichrechtChargePoint_Response);
 
-	if(hardware_version.is_v4 && meter_supports_eichrecht()) {
-		eichrecht.ocmf.ct = data->identification_type;
-		eichrecht.ocmf.ci[sizeof(eichrecht.ocmf.ci) - 1] = 0;
-		memcpy(eichrecht.ocmf.ci, data->identification, sizeof(data->identification));
+	if(eichrecht_is_supported()) {
+		if(!eichrecht_set_charge_point(data->identification_type, data->identification, sizeof(data->identification))) {
+			return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+		}
 
 		response->eichrecht_state = EVSE_V2_EICHRECHT_STATE_OK;
 	} else {
@@ -1086,39 +1127,37 @@ BootloaderHandleMessageResponse get_eichrecht_charge_point(const GetEichrechtCha
 BootloaderHandleMessageResponse set_eichrecht_transaction(const SetEichrechtTransaction *data, SetEichrechtTransaction_Response *response) {
 	response->header.length = sizeof(SetEichrechtTransaction_Response);
 
-	if(hardware_version.is_v4 && meter_supports_eichrecht()) {
-		// Check if transaction is ongoing
-		if(eichrecht.transaction_state > 0) {
-			response->eichrecht_state = EVSE_V2_EICHRECHT_STATE_BUSY;
-			return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
-		}
+	if(eichrecht_is_supported()) {
+		// Measurement status has to fit to the meter state after all queued transactions are done
+		const uint16_t measurement_status = eichrecht_get_expected_measurement_status();
 
 		// Check if measurement status is valid
 		if(data->transaction == 'B' || data->transaction == 'i') {
-			if(meter_iskra.measurement_status != 0) { // 0 = idle
+			if(measurement_status != 0) { // 0 = idle
 				// Should be idle
 				response->eichrecht_state = EVSE_V2_EICHRECHT_STATE_BUSY;
 				return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
 			}
 		} else if(data->transaction == 'E' || data->transaction == 'r') {
-			if(meter_iskra.measurement_status == 0) { // 1 = active, 2 = Active, Error DTM (Date, Time, Message), i.e. power loss, 3 = Active, Error WDR (WD reset), i.e. unexpected reset
+			if(measurement_status == 0) { // 1 = active, 2 = Active, Error DTM (Date, Time, Message), i.e. power loss, 3 = Active, Error WDR (WD reset), i.e. unexpected reset
 				// Should be active
 				response->eichrecht_state = EVSE_V2_EICHRECHT_STATE_BUSY;
 				return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
 			}
 		} else if(data->transaction == 'C' || data->transaction == 'X' || data->transaction == 'T' || data->transaction == 'S' || data->transaction == 'h') {
-			if(meter_iskra.measurement_status != 1) { // 1 = active
+			if(measurement_status != 1) { // 1 = active
 				// Should be active
 				response->eichrecht_state = EVSE_V2_EICHRECHT_STATE_BUSY;
 				return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
 			}
 		}
 
-		eichrecht.transaction = data->transaction;
-		eichrecht.unix_time = data->unix_time;
-		eichrecht.utc_time_offset = data->utc_time_offset;
-		eichrecht.signature_format = data->signature_format;
-		eichrecht.new_transaction = true;
+		// Check if queue is full
+		uint16_t sequence = 0;
+		if(!eichrecht_queue_transaction(data->transaction, data->unix_time, data->utc_time_offset, data->signature_format, &sequence)) {
+			response->eichrecht_state = EVSE_V2_EICHRECHT_STATE_BUSY;
+			return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+		}
 
 		response->eichrecht_state = EVSE_V2_EICHRECHT_STATE_OK;
 	} else {
@@ -1132,13 +1171,13 @@ BootloaderHandleMessageResponse get_eichrecht_transaction_state(const GetEichrec
 	(void)data;
 	response->header.length = sizeof(GetEichrechtTransactionState_Response);
 
-	if(hardware_version.is_v4 && meter_supports_eichrecht()) {
+	if(eichrecht_is_supported()) {
 		response->transaction             = eichrecht.transaction;
 		response->transaction_state       = eichrecht.transaction_state;
 		response->transaction_inner_state = eichrecht.transaction_inner_state;
 		response->measurement_status      = meter_iskra.measurement_status;
 		response->signature_status        = meter_iskra.signature_status;
-		response->eichrecht_state         = eichrecht.transaction_state > 0 ? EVSE_V2_EICHRECHT_STATE_BUSY : EVSE_V2_EICHRECHT_STATE_OK;
+		response->eichrecht_state         = eichrecht.queue_count > 0 ? EVSE_V2_EICHRECHT_STATE_BUSY : EVSE_V2_EICHRECHT_STATE_OK;
 	} else {
 		response->transaction             = 0;
 		response->transaction_state       = 0;
@@ -1280,6 +1319,7 @@ BootloaderHandleMessageResponse set_ove_r37_configuration(const SetOVER37Configu
 		ove_r37.reconnect_wait_s          = data->reconnect_wait_time;
 
 		evse_save_config();
+		ove_r37_request_evaluation();
 	}
 
 	// The start delay is volatile and not saved in eeprom
@@ -1341,6 +1381,451 @@ BootloaderHandleMessageResponse get_energy_meter_display_backlight(const GetEner
 	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
 }
 
+BootloaderHandleMessageResponse get_ove_r37_statistics(const GetOVER37Statistics *data, GetOVER37Statistics_Response *response) {
+	response->header.length       = sizeof(GetOVER37Statistics_Response);
+	response->evaluations         = ove_r37.evaluations;
+	response->evaluations_skipped = ove_r37.evaluations_skipped;
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+BootloaderHandleMessageResponse get_ove_r37_event(const GetOVER37Event *data, GetOVER37Event_Response *response) {
+	response->header.length = sizeof(GetOVER37Event_Response);
+
+	// Events are read one at a time by sequence number. If the requested event
+	// was already overwritten, the oldest available event is returned instead.
+	const OveR37Event *event = ove_r37_get_event(data->sequence);
+	if(event == NULL) {
+		memset(((uint8_t*)response) + sizeof(TFPMessageHeader), 0, sizeof(GetOVER37Event_Response) - sizeof(TFPMessageHeader));
+		response->sequence      = data->sequence;
+		response->sequence_next = ove_r37.event_sequence_next;
+		response->type          = OVE_R37_EVENT_TYPE_NONE;
+		return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+	}
+
+	response->sequence      = event->sequence;
+	response->sequence_next = ove_r37.event_sequence_next;
+	response->type          = event->type;
+	response->flags         = event->flags;
+	response->trip_reason   = event->trip_reason;
+	response->timestamp     = event->start;
+	response->duration      = ove_r37_get_event_duration(event);
+
+	// Extremes are 0 if nothing valid was observed
+	for(uint8_t i = 0; i < 3; i++) {
+		const bool observed      = event->voltage_min[i] <= event->voltage_max[i];
+		response->voltage_min[i] = observed ? event->voltage_min[i] : 0;
+		response->voltage_max[i] = observed ? event->voltage_max[i] : 0;
+	}
+
+	const bool observed     = event->frequency_min <= event->frequency_max;
+	response->frequency_min = observed ? event->frequency_min : 0;
+	response->frequency_max = observed ? event->frequency_max : 0;
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+BootloaderHandleMessageResponse set_mains_frequency_configuration(const SetMainsFrequencyConfiguration *data) {
+	if((data->rocof_window < FREQUENCY_ROCOF_WINDOW_MIN) || (data->rocof_window > FREQUENCY_ROCOF_WINDOW_MAX) ||
+	   (data->source >= FREQUENCY_SOURCE_NUM)) {
+		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+	}
+
+	frequency.source = data->source;
+
+	if(frequency.rocof_window != data->rocof_window) {
+		frequency_set_rocof_window(data->rocof_window);
+	}
+
+	return HANDLE_MESSAGE_RESPONSE_EMPTY;
+}
+
+BootloaderHandleMessageResponse get_mains_frequency_configuration(const GetMainsFrequencyConfiguration *data, GetMainsFrequencyConfiguration_Response *response) {
+	response->header.length = sizeof(GetMainsFrequencyConfiguration_Response);
+	response->rocof_window  = frequency.rocof_window;
+	response->source        = frequency.source;
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+BootloaderHandleMessageResponse get_mains_frequency(const GetMainsFrequency *data, GetMainsFrequency_Response *response) {
+	uint32_t period_min = 0;
+	uint32_t period_max = 0;
+	frequency_get_period_min_max(&period_min, &period_max);
+
+	response->header.length    = sizeof(GetMainsFrequency_Response);
+	response->frequency        = frequency.frequency;
+	response->frequency_valid  = frequency.valid;
+	response->rocof            = frequency.rocof;
+	response->rocof_valid      = frequency.rocof_valid;
+	response->period_min       = period_min;
+	response->period_max       = period_max;
+	response->period_variance  = frequency.period_variance;
+	response->periods_rejected = frequency.period_rejected;
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+BootloaderHandleMessageResponse get_mains_frequency_source_comparison(const GetMainsFrequencySourceComparison *data, GetMainsFrequencySourceComparison_Response *response) {
+	uint32_t count              = 0;
+	uint32_t mean               = 0;
+	uint32_t standard_deviation = 0;
+
+	response->header.length = sizeof(GetMainsFrequencySourceComparison_Response);
+
+	frequency_get_compare(FREQUENCY_SOURCE_TIMER_READ, &count, &mean, &standard_deviation);
+	response->timer_read_count              = count;
+	response->timer_read_mean               = mean;
+	response->timer_read_standard_deviation = standard_deviation;
+
+	frequency_get_compare(FREQUENCY_SOURCE_CAPTURE, &count, &mean, &standard_deviation);
+	response->capture_count              = count;
+	response->capture_mean               = mean;
+	response->capture_standard_deviation = standard_deviation;
+	response->capture_missed             = frequency.capture_missed;
+	response->edges_dropped              = frequency.edge_queue.overflows;
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+BootloaderHandleMessageResponse set_thermal_derating_configuration(const SetThermalDeratingConfiguration *data) {
+	DeratingPoint curve[DERATING_CURVE_POINTS];
+	for(uint8_t i = 0; i < DERATING_CURVE_POINTS; i++) {
+		curve[i].temperature = data->temperature[i];
+		curve[i].current     = data->max_current[i];
+	}
+
+	if(!derating_set_curve(curve, data->hysteresis)) {
+		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+	}
+
+	derating.enabled = data->enabled;
+
+	return HANDLE_MESSAGE_RESPONSE_EMPTY;
+}
+
+BootloaderHandleMessageResponse get_thermal_derating_configuration(const GetThermalDeratingConfiguration *data, GetThermalDeratingConfiguration_Response *response) {
+	response->header.length = sizeof(GetThermalDeratingConfiguration_Response);
+	response->enabled       = derating.enabled;
+	for(uint8_t i = 0; i < DERATING_CURVE_POINTS; i++) {
+		response->temperature[i] = derating.curve[i].temperature;
+		response->max_current[i] = derating.curve[i].current;
+	}
+	response->hysteresis    = derating.hysteresis;
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+BootloaderHandleMessageResponse get_thermal_derating_state(const GetThermalDeratingState *data, GetThermalDeratingState_Response *response) {
+	response->header.length            = sizeof(GetThermalDeratingState_Response);
+	response->temperature              = hardware_version.is_v2 ? 0 : tmp1075n.temperature;
+	response->max_current              = derating.max_current;
+	response->derated                  = derating.slot_active;
+	response->session_active           = derating.session_active;
+	response->session_peak_temperature = derating.session_peak_temperature;
+	response->session_derated_time     = derating_get_session_derated_time();
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+#ifdef HOT_PATH_STATISTICS
+BootloaderHandleMessageResponse get_hot_path_statistics(const GetHotPathStatistics *data, GetHotPathStatistics_Response *response) {
+	uint32_t count, mean_ns, max_ns;
+
+	response->header.length = sizeof(GetHotPathStatistics_Response);
+#ifdef HOT_PATH_IN_RAM
+	response->in_ram        = true;
+#else
+	response->in_ram        = false;
+#endif
+
+	hot_path_get_loop_period(&count, &mean_ns, &max_ns);
+	response->loop_count       = count;
+	response->loop_period_mean = mean_ns;
+	response->loop_period_max  = max_ns;
+
+	hot_path_get_adc_latency(&count, &mean_ns, &max_ns);
+	response->adc_latency_count = count;
+	response->adc_latency_mean  = mean_ns;
+	response->adc_latency_max   = max_ns;
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+#endif
+
+BootloaderHandleMessageResponse get_ram_usage(const GetRAMUsage *data, GetRAMUsage_Response *response) {
+	ram_usage_scan();
+
+	response->header.length = sizeof(GetRAMUsage_Response);
+	response->stack_size    = ram_usage.stack_size;
+	response->stack_used    = ram_usage.stack_used;
+	response->heap_size     = ram_usage.heap_size;
+	response->static_size   = ram_usage.static_size;
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+BootloaderHandleMessageResponse get_boot_path(const GetBootPath *data, GetBootPath_Response *response) {
+	response->header.length = sizeof(GetBootPath_Response);
+	response->boot_path     = warm_restart.resume ? WARM_RESTART_BOOT_PATH_WARM : WARM_RESTART_BOOT_PATH_COLD;
+	response->boot_time     = warm_restart.boot_time;
+	if(warm_restart.resume) {
+		response->warm_restarts          = warm_restart.record.restarts;
+		response->resumed_iec61851_state = warm_restart.record.iec61851_state;
+		response->resumed_contactor      = warm_restart.record.contactor;
+		response->resumed_uptime         = warm_restart.record.uptime;
+	} else {
+		response->warm_restarts          = 0;
+		response->resumed_iec61851_state = 0;
+		response->resumed_contactor      = false;
+		response->resumed_uptime         = 0;
+	}
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+BootloaderHandleMessageResponse get_boot_timing(const GetBootTiming *data, GetBootTiming_Response *response) {
+	if(data->phase >= BOOT_TIMING_NUM) {
+		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+	}
+
+	response->header.length = sizeof(GetBootTiming_Response);
+	response->phase_count   = BOOT_TIMING_NUM;
+	response->time          = boot_timing.time[data->phase];
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+BootloaderHandleMessageResponse get_cpu_load(const GetCPULoad *data, GetCPULoad_Response *response) {
+	response->header.length = sizeof(GetCPULoad_Response);
+	response->load          = cpu_load.load;
+	response->load_peak     = cpu_load_get_peak();
+	response->wakeups       = cpu_load.wakeups_per_second;
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+BootloaderHandleMessageResponse get_digital_input(const GetDigitalInput *data, GetDigitalInput_Response *response) {
+	if(data->input >= DIGITAL_INPUT_NUM) {
+		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+	}
+
+	response->header.length = sizeof(GetDigitalInput_Response);
+	response->input_count   = DIGITAL_INPUT_NUM;
+	response->value         = digital_input.pin[data->input].value;
+	response->edges         = digital_input.pin[data->input].edges;
+	response->glitches      = digital_input.pin[data->input].glitches;
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+#ifdef CP_TRACE_REPLAY
+BootloaderHandleMessageResponse set_cp_trace_replay(const SetCPTraceReplay *data) {
+	if(data->password != CP_REPLAY_PASSWORD) {
+		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+	}
+
+	if((data->vpp > 4095) || (data->vcp_low > 4095)) {
+		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+	}
+
+	if(data->enable) {
+		// Only start without a vehicle and with the contactor off, the replay
+		// must never take over the CP measurement of a running charge.
+		if((iec61851.state != IEC61851_STATE_A) || !XMC_GPIO_GetInput(EVSE_CONTACTOR_PIN)) {
+			return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+		}
+
+		cp_replay_start(data->vpp, data->vcp_low);
+	} else {
+		cp_replay_stop();
+	}
+
+	return HANDLE_MESSAGE_RESPONSE_EMPTY;
+}
+
+BootloaderHandleMessageResponse write_cp_trace(const WriteCPTrace *data, WriteCPTrace_Response *response) {
+	if(data->count > 14) {
+		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+	}
+
+	uint32_t elements[14];
+	memcpy(elements, data->elements, sizeof(elements));
+
+	response->header.length = sizeof(WriteCPTrace_Response);
+	response->written       = cp_replay_write(elements, data->count);
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+BootloaderHandleMessageResponse get_cp_trace_replay_state(const GetCPTraceReplayState *data, GetCPTraceReplayState_Response *response) {
+	response->header.length  = sizeof(GetCPTraceReplayState_Response);
+	response->active         = cp_replay.active;
+	response->sample         = cp_replay.sample;
+	response->queued         = (uint8_t)spsc_queue_get_used(&cp_replay.queue);
+	response->underruns      = cp_replay.underruns;
+	response->timeline_count = cp_replay.timeline_count;
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+BootloaderHandleMessageResponse get_cp_trace_timeline(const GetCPTraceTimeline *data, GetCPTraceTimeline_Response *response) {
+	if(data->index >= cp_replay.timeline_count) {
+		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+	}
+
+	const CPReplayTimelineEntry *entry = &cp_replay.timeline[data->index];
+
+	response->header.length  = sizeof(GetCPTraceTimeline_Response);
+	response->sample         = entry->sample;
+	response->iec61851_state = entry->iec61851_state;
+	response->contactor      = entry->contactor;
+	response->cp_duty_cycle  = entry->cp_duty_cycle;
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+#endif
+
+// Keyframes are written to the upload buffer, set_led_animation copies them to a slot
+BootloaderHandleMessageResponse set_led_animation_keyframes(const SetLEDAnimationKeyframes *data) {
+	if((data->count > 6) || ((data->offset + data->count) > LED_ANIMATION_KEYFRAMES_MAX)) {
+		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+	}
+
+	for(uint8_t i = 0; i < data->count; i++) {
+		LEDKeyframe *keyframe = &led_animation.upload.keyframes[data->offset + i];
+		keyframe->duration    = data->duration[i];
+		keyframe->h           = data->color_h[i];
+		keyframe->s           = data->color_s[i];
+		keyframe->v           = data->color_v[i];
+		keyframe->flags       = data->flags[i];
+		keyframe->reserved    = 0;
+	}
+
+	return HANDLE_MESSAGE_RESPONSE_EMPTY;
+}
+
+BootloaderHandleMessageResponse get_led_animation_keyframes(const GetLEDAnimationKeyframes *data, GetLEDAnimationKeyframes_Response *response) {
+	if((data->slot >= LED_ANIMATION_SLOT_NUM) || (data->offset >= LED_ANIMATION_KEYFRAMES_MAX)) {
+		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+	}
+
+	uint32_t page[EEPROM_PAGE_SIZE/sizeof(uint32_t)];
+	const LEDAnimation *animation = led_animation_read_slot(data->slot, page);
+
+	response->header.length = sizeof(GetLEDAnimationKeyframes_Response);
+	for(uint8_t i = 0; i < 6; i++) {
+		const uint8_t index = (uint8_t)(data->offset + i);
+		if(index < animation->keyframe_count) {
+			response->duration[i] = animation->keyframes[index].duration;
+			response->color_h[i]  = animation->keyframes[index].h;
+			response->color_s[i]  = animation->keyframes[index].s;
+			response->color_v[i]  = animation->keyframes[index].v;
+			response->flags[i]    = animation->keyframes[index].flags;
+		} else {
+			response->duration[i] = 0;
+			response->color_h[i]  = 0;
+			response->color_s[i]  = 0;
+			response->color_v[i]  = 0;
+			response->flags[i]    = 0;
+		}
+	}
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+BootloaderHandleMessageResponse set_led_animation(const SetLEDAnimation *data) {
+	if(!led_animation_set_slot(data->slot, data->keyframe_count, data->loop_start, data->loop_end, data->loop_count, data->repeat)) {
+		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+	}
+
+	return HANDLE_MESSAGE_RESPONSE_EMPTY;
+}
+
+BootloaderHandleMessageResponse get_led_animation(const GetLEDAnimation *data, GetLEDAnimation_Response *response) {
+	if(data->slot >= LED_ANIMATION_SLOT_NUM) {
+		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+	}
+
+	uint32_t page[EEPROM_PAGE_SIZE/sizeof(uint32_t)];
+	const LEDAnimation *animation = led_animation_read_slot(data->slot, page);
+
+	response->header.length  = sizeof(GetLEDAnimation_Response);
+	response->keyframe_count = animation->keyframe_count;
+	response->loop_start     = animation->loop_start;
+	response->loop_end       = animation->loop_end;
+	response->loop_count     = animation->loop_count;
+	response->repeat         = animation->repeat;
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+BootloaderHandleMessageResponse get_lock_statistics(const GetLockStatistics *data, GetLockStatistics_Response *response) {
+	if(data->direction >= LOCK_DIRECTION_NUM) {
+		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+	}
+
+	const LockStatistics *statistics = &lock.statistics[data->direction];
+
+	response->header.length   = sizeof(GetLockStatistics_Response);
+	response->count           = statistics->count;
+	response->retries         = statistics->retries;
+	response->failures        = statistics->failures;
+	response->duration_last   = statistics->duration_last;
+	response->duration_min    = statistics->duration_min;
+	response->duration_mean   = (statistics->count == 0) ? 0 : (uint16_t)(statistics->duration_sum / statistics->count);
+	response->duration_max    = statistics->duration_max;
+	response->duty_cycle_last = statistics->duty_cycle_last;
+	response->ramp_start      = statistics->ramp_start;
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+BootloaderHandleMessageResponse get_eichrecht_transaction_sequence(const GetEichrechtTransactionSequence *data, GetEichrechtTransactionSequence_Response *response) {
+	response->header.length = sizeof(GetEichrechtTransactionSequence_Response);
+
+	if(eichrecht_is_supported()) {
+		response->queued_sequence = eichrecht.sequence_next; // Sequence of the last accepted transaction
+		response->active_sequence = eichrecht.queue_count > 0 ? eichrecht.queue[eichrecht.queue_start].sequence : 0;
+		response->queue_count     = eichrecht.queue_count;
+	} else {
+		response->queued_sequence = 0;
+		response->active_sequence = 0;
+		response->queue_count     = 0;
+	}
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+#ifdef MICROBENCHMARK
+BootloaderHandleMessageResponse start_microbenchmark(const StartMicrobenchmark *data) {
+	if((data->benchmark >= MICROBENCHMARK_NUM) || (data->iterations == 0) || (data->iterations > MICROBENCHMARK_MAX_ITERATIONS)) {
+		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+	}
+
+	if(microbenchmark.state == MICROBENCHMARK_STATE_RUNNING) {
+		return HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER;
+	}
+
+	microbenchmark_start(data->benchmark, data->iterations);
+
+	return HANDLE_MESSAGE_RESPONSE_EMPTY;
+}
+
+BootloaderHandleMessageResponse get_microbenchmark(const GetMicrobenchmark *data, GetMicrobenchmark_Response *response) {
+	response->header.length = sizeof(GetMicrobenchmark_Response);
+	response->benchmark     = microbenchmark.benchmark;
+	response->state         = microbenchmark.state;
+	response->iterations    = microbenchmark.done;
+	response->overhead      = microbenchmark.overhead;
+	response->cycles_min    = microbenchmark.done > 0 ? microbenchmark.cycles_min : 0;
+	response->cycles_mean   = microbenchmark_get_mean();
+	response->cycles_max    = microbenchmark.cycles_max;
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+#endif
+
 
 bool handle_energy_meter_values_callback(void) {
 	static bool is_buffered = false;
@@ -1372,14 +1857,15 @@ bool handle_eichrecht_dataset_low_level_callback(void) {
 	static EichrechtDatasetLowLevel_Callback cb;
 
 	if(!is_buffered) {
-		if(!eichrecht.dataset_out_ready) {
+		// The transaction sequence callback is sent first
+		if(!eichrecht.dataset_out_ready || eichrecht.dataset_out_sequence_pending) {
 			return false;
 		}
 		tfp_make_default_header(&cb.header, bootloader_get_uid(), sizeof(EichrechtDatasetLowLevel_Callback), FID_CALLBACK_EICHRECHT_DATASET_LOW_LEVEL);
 		cb.message_length = eichrecht.dataset_out_length;
 		cb.message_chunk_offset = eichrecht.dataset_out_chunk_offset;
 		const uint8_t length = MIN(60, eichrecht.dataset_out_length - eichrecht.dataset_out_chunk_offset);
-		memcpy(cb.message_chunk_data, &eichrecht.dataset_out[eichrecht.dataset_out_chunk_offset], length);
+		memcpy(cb.message_chunk_data, &arena.eichrecht.dataset_out[eichrecht.dataset_out_chunk_offset], length);
 		if(length < 60) {
 			memset(&cb.message_chunk_data[length], 0, 60 - length);
 		}
@@ -1418,7 +1904,7 @@ bool handle_eichrecht_signature_low_level_callback(void) {
 		cb.message_length = eichrecht.signature_length;
 		cb.message_chunk_offset = eichrecht.signature_chunk_offset;
 		const uint8_t length = MIN(60, eichrecht.signature_length - eichrecht.signature_chunk_offset);
-		memcpy(cb.message_chunk_data, &eichrecht.signature[eichrecht.signature_chunk_offset], length);
+		memcpy(cb.message_chunk_data, &arena.eichrecht.signature[eichrecht.signature_chunk_offset], length);
 		if(length < 60) {
 			memset(&cb.message_chunk_data[length], 0, 60 - length);
 		}
@@ -1441,6 +1927,32 @@ bool handle_eichrecht_signature_low_level_callback(void) {
 	return false;
 }
 
+bool handle_eichrecht_transaction_sequence_callback(void) {
+	static bool is_buffered = false;
+	static EichrechtTransactionSequence_Callback cb;
+
+	if(!is_buffered) {
+		if(!eichrecht.dataset_out_sequence_pending) {
+			return false;
+		}
+		tfp_make_default_header(&cb.header, bootloader_get_uid(), sizeof(EichrechtTransactionSequence_Callback), FID_CALLBACK_EICHRECHT_TRANSACTION_SEQUENCE);
+		cb.transaction_sequence = eichrecht.dataset_out_sequence;
+	}
+
+	if(bootloader_spitfp_is_send_possible(&bootloader_status.st)) {
+		bootloader_spitfp_send_ack_and_message(&bootloader_status, (uint8_t*)&cb, sizeof(EichrechtTransactionSequence_Callback));
+		is_buffered = false;
+
+		// Release the dataset and signature callbacks of this transaction
+		eichrecht.dataset_out_sequence_pending = false;
+		return true;
+	} else {
+		is_buffered = true;
+	}
+
+	return false;
+}
+
 
 void communication_tick(void) {
 	communication_callback_tick();
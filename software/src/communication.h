@@ -274,6 +274,23 @@ void communication_init(void);
 #define EVSE_V2_OVE_R37_FLAGS_CURRENT_VALID 8
 #define EVSE_V2_OVE_R37_FLAGS_FREQUENCY_VALID 16
 
+#define EVSE_V2_OVE_R37_EVENT_TYPE_NONE 0
+#define EVSE_V2_OVE_R37_EVENT_TYPE_TRIP 1
+#define EVSE_V2_OVE_R37_EVENT_TYPE_WAIT 2
+#define EVSE_V2_OVE_R37_EVENT_TYPE_RAMP 3
+#define EVSE_V2_OVE_R37_EVENT_TYPE_SYMMETRY_CAP 4
+#define EVSE_V2_OVE_R37_EVENT_TYPE_START_DELAY 5
+
+#define EVSE_V2_OVE_R37_EVENT_FLAGS_ACTIVE 1
+#define EVSE_V2_OVE_R37_EVENT_FLAGS_RESET 2
+#define EVSE_V2_OVE_R37_EVENT_FLAGS_ABORTED 4
+
+#define EVSE_V2_MAINS_FREQUENCY_SOURCE_TIMER_READ 0
+#define EVSE_V2_MAINS_FREQUENCY_SOURCE_CAPTURE 1
+
+#define EVSE_V2_BOOT_PATH_COLD 0
+#define EVSE_V2_BOOT_PATH_WARM 1
+
 #define EVSE_V2_ENERGY_METER_DISPLAY_BACKLIGHT_OFF 0
 #define EVSE_V2_ENERGY_METER_DISPLAY_BACKLIGHT_ON 1
 #define EVSE_V2_ENERGY_METER_DISPLAY_BACKLIGHT_AUTOMATIC 2
@@ -371,10 +388,38 @@ void communication_init(void);
 #define FID_GET_ENERGY_METER_DISPLAY_TEXT 75
 #define FID_SET_ENERGY_METER_DISPLAY_BACKLIGHT 76
 #define FID_GET_ENERGY_METER_DISPLAY_BACKLIGHT 77
+#define FID_GET_OVE_R37_STATISTICS 78
+#define FID_GET_OVE_R37_EVENT 79
+#define FID_SET_MAINS_FREQUENCY_CONFIGURATION 80
+#define FID_GET_MAINS_FREQUENCY_CONFIGURATION 81
+#define FID_GET_MAINS_FREQUENCY 82
+#define FID_GET_MAINS_FREQUENCY_SOURCE_COMPARISON 83
+#define FID_SET_THERMAL_DERATING_CONFIGURATION 84
+#define FID_GET_THERMAL_DERATING_CONFIGURATION 85
+#define FID_GET_THERMAL_DERATING_STATE 86
+#define FID_GET_HOT_PATH_STATISTICS 87
+#define FID_GET_RAM_USAGE 88
+#define FID_GET_BOOT_PATH 89
+#define FID_GET_BOOT_TIMING 90
+#define FID_GET_CPU_LOAD 91
+#define FID_GET_DIGITAL_INPUT 92
+#define FID_SET_CP_TRACE_REPLAY 93
+#define FID_WRITE_CP_TRACE 94
+#define FID_GET_CP_TRACE_REPLAY_STATE 95
+#define FID_GET_CP_TRACE_TIMELINE 96
+#define FID_START_MICROBENCHMARK 97
+#define FID_GET_MICROBENCHMARK 98
+#define FID_SET_LED_ANIMATION_KEYFRAMES 99
+#define FID_GET_LED_ANIMATION_KEYFRAMES 100
+#define FID_SET_LED_ANIMATION 101
+#define FID_GET_LED_ANIMATION 102
+#define FID_GET_LOCK_STATISTICS 103
+#define FID_GET_EICHRECHT_TRANSACTION_SEQUENCE 104
 
 #define FID_CALLBACK_ENERGY_METER_VALUES 45
 #define FID_CALLBACK_EICHRECHT_DATASET_LOW_LEVEL 59
 #define FID_CALLBACK_EICHRECHT_SIGNATURE_LOW_LEVEL 60
+#define FID_CALLBACK_EICHRECHT_TRANSACTION_SEQUENCE 105
 
 typedef struct {
 	TFPMessageHeader header;
@@ -1108,6 +1153,344 @@ typedef struct {
 	uint8_t backlight;
 } __attribute__((__packed__)) GetEnergyMeterDisplayBacklight_Response;
 
+typedef struct {
+	TFPMessageHeader header;
+} __attribute__((__packed__)) GetOVER37Statistics;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint32_t evaluations;
+	uint32_t evaluations_skipped;
+} __attribute__((__packed__)) GetOVER37Statistics_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint16_t sequence;
+} __attribute__((__packed__)) GetOVER37Event;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint16_t sequence;
+	uint16_t sequence_next;
+	uint8_t type;
+	uint8_t flags;
+	uint8_t trip_reason;
+	uint32_t timestamp;
+	uint32_t duration;
+	uint32_t voltage_min[3];
+	uint32_t voltage_max[3];
+	uint32_t frequency_min;
+	uint32_t frequency_max;
+} __attribute__((__packed__)) GetOVER37Event_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t rocof_window;
+	uint8_t source;
+} __attribute__((__packed__)) SetMainsFrequencyConfiguration;
+
+typedef struct {
+	TFPMessageHeader header;
+} __attribute__((__packed__)) GetMainsFrequencyConfiguration;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t rocof_window;
+	uint8_t source;
+} __attribute__((__packed__)) GetMainsFrequencyConfiguration_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+} __attribute__((__packed__)) GetMainsFrequency;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint32_t frequency;
+	bool frequency_valid;
+	int32_t rocof;
+	bool rocof_valid;
+	uint32_t period_min;
+	uint32_t period_max;
+	uint32_t period_variance;
+	uint32_t periods_rejected;
+} __attribute__((__packed__)) GetMainsFrequency_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+} __attribute__((__packed__)) GetMainsFrequencySourceComparison;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint32_t timer_read_count;
+	uint32_t timer_read_mean;
+	uint32_t timer_read_standard_deviation;
+	uint32_t capture_count;
+	uint32_t capture_mean;
+	uint32_t capture_standard_deviation;
+	uint32_t capture_missed;
+	uint32_t edges_dropped;
+} __attribute__((__packed__)) GetMainsFrequencySourceComparison_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+	bool enabled;
+	int16_t temperature[4];
+	uint16_t max_current[4];
+	uint16_t hysteresis;
+} __attribute__((__packed__)) SetThermalDeratingConfiguration;
+
+typedef struct {
+	TFPMessageHeader header;
+} __attribute__((__packed__)) GetThermalDeratingConfiguration;
+
+typedef struct {
+	TFPMessageHeader header;
+	bool enabled;
+	int16_t temperature[4];
+	uint16_t max_current[4];
+	uint16_t hysteresis;
+} __attribute__((__packed__)) GetThermalDeratingConfiguration_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+} __attribute__((__packed__)) GetThermalDeratingState;
+
+typedef struct {
+	TFPMessageHeader header;
+	int16_t temperature;
+	uint16_t max_current;
+	bool derated;
+	bool session_active;
+	int16_t session_peak_temperature;
+	uint32_t session_derated_time;
+} __attribute__((__packed__)) GetThermalDeratingState_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+} __attribute__((__packed__)) GetHotPathStatistics;
+
+typedef struct {
+	TFPMessageHeader header;
+	bool in_ram;
+	uint32_t loop_count;
+	uint32_t loop_period_mean;
+	uint32_t loop_period_max;
+	uint32_t adc_latency_count;
+	uint32_t adc_latency_mean;
+	uint32_t adc_latency_max;
+} __attribute__((__packed__)) GetHotPathStatistics_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+} __attribute__((__packed__)) GetRAMUsage;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint16_t stack_size;
+	uint16_t stack_used;
+	uint16_t heap_size;
+	uint16_t static_size;
+} __attribute__((__packed__)) GetRAMUsage_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+} __attribute__((__packed__)) GetBootPath;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t boot_path;
+	uint32_t boot_time;
+	uint16_t warm_restarts;
+	uint8_t resumed_iec61851_state;
+	bool resumed_contactor;
+	uint32_t resumed_uptime;
+} __attribute__((__packed__)) GetBootPath_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t phase;
+} __attribute__((__packed__)) GetBootTiming;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t phase_count;
+	uint32_t time;
+} __attribute__((__packed__)) GetBootTiming_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+} __attribute__((__packed__)) GetCPULoad;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint16_t load;
+	uint16_t load_peak;
+	uint32_t wakeups;
+} __attribute__((__packed__)) GetCPULoad_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t input;
+} __attribute__((__packed__)) GetDigitalInput;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t input_count;
+	bool value;
+	uint32_t edges;
+	uint32_t glitches;
+} __attribute__((__packed__)) GetDigitalInput_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint32_t password;
+	bool enable;
+	uint16_t vpp;
+	uint16_t vcp_low;
+} __attribute__((__packed__)) SetCPTraceReplay;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t count;
+	uint32_t elements[14];
+} __attribute__((__packed__)) WriteCPTrace;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t written;
+} __attribute__((__packed__)) WriteCPTrace_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+} __attribute__((__packed__)) GetCPTraceReplayState;
+
+typedef struct {
+	TFPMessageHeader header;
+	bool active;
+	uint32_t sample;
+	uint8_t queued;
+	uint32_t underruns;
+	uint8_t timeline_count;
+} __attribute__((__packed__)) GetCPTraceReplayState_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t index;
+} __attribute__((__packed__)) GetCPTraceTimeline;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint32_t sample;
+	uint8_t iec61851_state;
+	bool contactor;
+	uint16_t cp_duty_cycle;
+} __attribute__((__packed__)) GetCPTraceTimeline_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t benchmark;
+	uint16_t iterations;
+} __attribute__((__packed__)) StartMicrobenchmark;
+
+typedef struct {
+	TFPMessageHeader header;
+} __attribute__((__packed__)) GetMicrobenchmark;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t benchmark;
+	uint8_t state;
+	uint16_t iterations;
+	uint32_t overhead;
+	uint32_t cycles_min;
+	uint32_t cycles_mean;
+	uint32_t cycles_max;
+} __attribute__((__packed__)) GetMicrobenchmark_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t offset;
+	uint8_t count;
+	uint16_t duration[6];
+	uint16_t color_h[6];
+	uint8_t color_s[6];
+	uint8_t color_v[6];
+	uint8_t flags[6];
+} __attribute__((__packed__)) SetLEDAnimationKeyframes;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t slot;
+	uint8_t offset;
+} __attribute__((__packed__)) GetLEDAnimationKeyframes;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint16_t duration[6];
+	uint16_t color_h[6];
+	uint8_t color_s[6];
+	uint8_t color_v[6];
+	uint8_t flags[6];
+} __attribute__((__packed__)) GetLEDAnimationKeyframes_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t slot;
+	uint8_t keyframe_count;
+	uint8_t loop_start;
+	uint8_t loop_end;
+	uint8_t loop_count;
+	bool repeat;
+} __attribute__((__packed__)) SetLEDAnimation;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t slot;
+} __attribute__((__packed__)) GetLEDAnimation;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t keyframe_count;
+	uint8_t loop_start;
+	uint8_t loop_end;
+	uint8_t loop_count;
+	bool repeat;
+} __attribute__((__packed__)) GetLEDAnimation_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint8_t direction;
+} __attribute__((__packed__)) GetLockStatistics;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint32_t count;
+	uint32_t retries;
+	uint32_t failures;
+	uint16_t duration_last;
+	uint16_t duration_min;
+	uint16_t duration_mean;
+	uint16_t duration_max;
+	uint16_t duty_cycle_last;
+	uint16_t ramp_start;
+} __attribute__((__packed__)) GetLockStatistics_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+} __attribute__((__packed__)) GetEichrechtTransactionSequence;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint16_t queued_sequence;
+	uint16_t active_sequence;
+	uint8_t queue_count;
+} __attribute__((__packed__)) GetEichrechtTransactionSequence_Response;
+
+typedef struct {
+	TFPMessageHeader header;
+	uint16_t transaction_sequence;
+} __attribute__((__packed__)) EichrechtTransactionSequence_Callback;
+
 
 
 // Function prototypes
@@ -1185,18 +1568,47 @@ BootloaderHandleMessageResponse set_energy_meter_display_text(const SetEnergyMet
 BootloaderHandleMessageResponse get_energy_meter_display_text(const GetEnergyMeterDisplayText *data, GetEnergyMeterDisplayText_Response *response);
 BootloaderHandleMessageResponse set_energy_meter_display_backlight(const SetEnergyMeterDisplayBacklight *data);
 BootloaderHandleMessageResponse get_energy_meter_display_backlight(const GetEnergyMeterDisplayBacklight *data, GetEnergyMeterDisplayBacklight_Response *response);
+BootloaderHandleMessageResponse get_ove_r37_statistics(const GetOVER37Statistics *data, GetOVER37Statistics_Response *response);
+BootloaderHandleMessageResponse get_ove_r37_event(const GetOVER37Event *data, GetOVER37Event_Response *response);
+BootloaderHandleMessageResponse set_mains_frequency_configuration(const SetMainsFrequencyConfiguration *data);
+BootloaderHandleMessageResponse get_mains_frequency_configuration(const GetMainsFrequencyConfiguration *data, GetMainsFrequencyConfiguration_Response *response);
+BootloaderHandleMessageResponse get_mains_frequency(const GetMainsFrequency *data, GetMainsFrequency_Response *response);
+BootloaderHandleMessageResponse get_mains_frequency_source_comparison(const GetMainsFrequencySourceComparison *data, GetMainsFrequencySourceComparison_Response *response);
+BootloaderHandleMessageResponse set_thermal_derating_configuration(const SetThermalDeratingConfiguration *data);
+BootloaderHandleMessageResponse get_thermal_derating_configuration(const GetThermalDeratingConfiguration *data, GetThermalDeratingConfiguration_Response *response);
+BootloaderHandleMessageResponse get_thermal_derating_state(const GetThermalDeratingState *data, GetThermalDeratingState_Response *response);
+BootloaderHandleMessageResponse get_hot_path_statistics(const GetHotPathStatistics *data, GetHotPathStatistics_Response *response);
+BootloaderHandleMessageResponse get_ram_usage(const GetRAMUsage *data, GetRAMUsage_Response *response);
+BootloaderHandleMessageResponse get_boot_path(const GetBootPath *data, GetBootPath_Response *response);
+BootloaderHandleMessageResponse get_boot_timing(const GetBootTiming *data, GetBootTiming_Response *response);
+BootloaderHandleMessageResponse get_cpu_load(const GetCPULoad *data, GetCPULoad_Response *response);
+BootloaderHandleMessageResponse get_digital_input(const GetDigitalInput *data, GetDigitalInput_Response *response);
+BootloaderHandleMessageResponse set_cp_trace_replay(const SetCPTraceReplay *data);
+BootloaderHandleMessageResponse write_cp_trace(const WriteCPTrace *data, WriteCPTrace_Response *response);
+BootloaderHandleMessageResponse get_cp_trace_replay_state(const GetCPTraceReplayState *data, GetCPTraceReplayState_Response *response);
+BootloaderHandleMessageResponse get_cp_trace_timeline(const GetCPTraceTimeline *data, GetCPTraceTimeline_Response *response);
+BootloaderHandleMessageResponse start_microbenchmark(const StartMicrobenchmark *data);
+BootloaderHandleMessageResponse get_microbenchmark(const GetMicrobenchmark *data, GetMicrobenchmark_Response *response);
+BootloaderHandleMessageResponse set_led_animation_keyframes(const SetLEDAnimationKeyframes *data);
+BootloaderHandleMessageResponse get_led_animation_keyframes(const GetLEDAnimationKeyframes *data, GetLEDAnimationKeyframes_Response *response);
+BootloaderHandleMessageResponse set_led_animation(const SetLEDAnimation *data);
+BootloaderHandleMessageResponse get_led_animation(const GetLEDAnimation *data, GetLEDAnimation_Response *response);
+BootloaderHandleMessageResponse get_lock_statistics(const GetLockStatistics *data, GetLockStatistics_Response *response);
+BootloaderHandleMessageResponse get_eichrecht_transaction_sequence(const GetEichrechtTransactionSequence *data, GetEichrechtTransactionSequence_Response *response);
 
 // Callbacks
 bool handle_energy_meter_values_callback(void);
 bool handle_eichrecht_dataset_low_level_callback(void);
 bool handle_eichrecht_signature_low_level_callback(void);
+bool handle_eichrecht_transaction_sequence_callback(void);
 
 #define COMMUNICATION_CALLBACK_TICK_WAIT_MS 1
-#define COMMUNICATION_CALLBACK_HANDLER_NUM 3
+#define COMMUNICATION_CALLBACK_HANDLER_NUM 4
 #define COMMUNICATION_CALLBACK_LIST_INIT \
 	handle_energy_meter_values_callback, \
 	handle_eichrecht_dataset_low_level_callback, \
 	handle_eichrecht_signature_low_level_callback, \
+	handle_eichrecht_transaction_sequence_callback, \
 
 
 #endif
@@ -0,0 +1,44 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * config_digital_input.h: Digital input sampling configuration
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef CONFIG_DIGITAL_INPUT_H
+#define CONFIG_DIGITAL_INPUT_H
+
+#include "xmc_ccu4.h"
+#include "xmc1_ccu4_map.h"
+
+// Sampling timer: CCU41 slice 3 is not used by any hardware version
+// (CCU41 slice 0-2 are the V3/V4 CP PWM and the V2 LED).
+// 96MHz / 64 = 1.5MHz, period of 1500 ticks = 1kHz sample rate.
+#define DIGITAL_INPUT_TIMER_MODULE    CCU41
+#define DIGITAL_INPUT_TIMER_SLICE     CCU41_CC43
+#define DIGITAL_INPUT_TIMER_SLICE_NUM 3
+#define DIGITAL_INPUT_TIMER_PRESCALER XMC_CCU4_SLICE_PRESCALER_64
+#define DIGITAL_INPUT_TIMER_PERIOD    1500
+#define DIGITAL_INPUT_SAMPLE_RATE     1000 // Hz, thresholds are given in samples = ms
+
+// IRQ: CCU41_SR3 -> IRQ31
+// Don't use SR2, it triggers the ADC background scan on V3/V4.
+#define DIGITAL_INPUT_IRQ_NUM         31
+#define DIGITAL_INPUT_IRQCTRL         XMC_SCU_IRQCTRL_CCU41_SR3_IRQ31
+#define DIGITAL_INPUT_IRQ_PRIO        3
+
+#endif
@@ -25,6 +25,7 @@
 #include "xmc_ccu4.h"
 #include "xmc_eru.h"
 #include "xmc1_eru_map.h"
+#include "xmc1_ccu4_map.h"
 
 #define FREQUENCY_TIMER_MODULE    CCU40
 #define FREQUENCY_TIMER_SLICE     CCU40_CC43
@@ -32,6 +33,10 @@
 #define FREQUENCY_TIMER_PRESCALER XMC_CCU4_SLICE_PRESCALER_64
 #define FREQUENCY_TIMER_CLOCK_HZ  1500000UL
 #define FREQUENCY_MILLIHZ_FACTOR  (FREQUENCY_TIMER_CLOCK_HZ * 1000UL)
+#define FREQUENCY_NOMINAL_TICKS   (FREQUENCY_TIMER_CLOCK_HZ / 50UL)
+
+// Capture: ERU0 OGU3 gated trigger output -> CCU40.CC43 event 0 (same edge as IRQ6)
+#define FREQUENCY_CAPTURE_INPUT   CCU40_IN3_ERU0_GOUT3
 
 // ERU: P2_8 -> ERU0 ETL3 Input B1
 #define FREQUENCY_ERU             XMC_ERU0
@@ -0,0 +1,146 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * cp_replay.c: Replay of recorded/synthetic CP traces through the ADC pipeline
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "cp_replay.h"
+
+#ifdef CP_TRACE_REPLAY
+
+#include "adc.h"
+#include "evse.h"
+#include "iec61851.h"
+#include "hot_path.h"
+
+#include <string.h>
+
+CPReplay cp_replay;
+
+// Called from adc_check_result() for each new ADC result while the replay is active
+uint16_t HOT_PATH cp_replay_get_raw(const uint8_t channel, const uint16_t raw) {
+	switch(channel) {
+		case ADC_CHANNEL_VCP1: {
+			if(cp_replay.remaining == 0) {
+				uint32_t element = 0;
+				if(spsc_queue_pop(&cp_replay.queue, &element)) {
+					cp_replay.vcp1      = CP_REPLAY_ELEMENT_VCP1(element);
+					cp_replay.vcp2      = CP_REPLAY_ELEMENT_VCP2(element);
+					cp_replay.remaining = CP_REPLAY_ELEMENT_COUNT(element);
+					cp_replay.pwm       = CP_REPLAY_ELEMENT_PWM(element);
+					cp_replay.pwm_low   = false;
+				} else {
+					// Repeat the last values, keep the PWM running
+					cp_replay.underruns++;
+					cp_replay.pwm_low = cp_replay.pwm && !cp_replay.pwm_low;
+				}
+			} else if(cp_replay.pwm) {
+				cp_replay.pwm_low = !cp_replay.pwm_low;
+			}
+
+			if(cp_replay.remaining > 0) {
+				cp_replay.remaining--;
+			}
+			cp_replay.sample++;
+
+			return cp_replay.pwm_low ? cp_replay.vcp_low : cp_replay.vcp1;
+		}
+
+		case ADC_CHANNEL_VCP2: return cp_replay.pwm_low ? cp_replay.vcp_low : cp_replay.vcp2;
+		case ADC_CHANNEL_VPP:  return cp_replay.vpp;
+		default:               return raw;
+	}
+}
+
+static void cp_replay_timeline_add(void) {
+	const CPReplayTimelineEntry entry = {
+		.sample         = cp_replay.sample,
+		.iec61851_state = iec61851.state,
+		.contactor      = cp_replay.contactor,
+		.cp_duty_cycle  = evse_get_cp_duty_cycle()
+	};
+
+	if((cp_replay.timeline_count > 0) &&
+	   (entry.iec61851_state == cp_replay.last.iec61851_state) &&
+	   (entry.contactor      == cp_replay.last.contactor) &&
+	   (entry.cp_duty_cycle  == cp_replay.last.cp_duty_cycle)) {
+		return;
+	}
+
+	cp_replay.last = entry;
+	if(cp_replay.timeline_count < CP_REPLAY_TIMELINE_SIZE) {
+		cp_replay.timeline[cp_replay.timeline_count] = entry;
+		cp_replay.timeline_count++;
+	}
+}
+
+// Elements can be written before the start, the first entry
+// of the timeline is the state at the start.
+void cp_replay_start(const uint16_t vpp, const uint16_t vcp_low) {
+	cp_replay.vpp            = vpp;
+	cp_replay.vcp_low        = vcp_low;
+	cp_replay.vcp1           = 0;
+	cp_replay.vcp2           = 0;
+	cp_replay.remaining      = 0;
+	cp_replay.pwm            = false;
+	cp_replay.pwm_low        = false;
+	cp_replay.sample         = 0;
+	cp_replay.underruns      = 0;
+	cp_replay.contactor      = false; // Only started with the contactor off
+	cp_replay.timeline_count = 0;
+	cp_replay_timeline_add();
+
+	// Start with a fresh average
+	adc_ignore_results(1);
+	cp_replay.active = true;
+}
+
+// Stops the replay and drops all queued elements, the timeline is kept
+void cp_replay_stop(void) {
+	cp_replay.active = false;
+	spsc_queue_init(&cp_replay.queue, cp_replay.queue_buffer, CP_REPLAY_QUEUE_SIZE);
+	adc_ignore_results(1);
+}
+
+// Returns the number of written elements (less than count if the queue is full)
+uint8_t cp_replay_write(const uint32_t *elements, const uint8_t count) {
+	const uint16_t available = (uint16_t)(CP_REPLAY_QUEUE_SIZE - spsc_queue_get_used(&cp_replay.queue));
+
+	uint8_t written = 0;
+	while((written < count) && (written < available)) {
+		spsc_queue_push(&cp_replay.queue, elements[written]);
+		written++;
+	}
+
+	return written;
+}
+
+void cp_replay_init(void) {
+	memset(&cp_replay, 0, sizeof(CPReplay));
+	spsc_queue_init(&cp_replay.queue, cp_replay.queue_buffer, CP_REPLAY_QUEUE_SIZE);
+}
+
+void cp_replay_tick(void) {
+	if(!cp_replay.active) {
+		return;
+	}
+
+	cp_replay_timeline_add();
+}
+
+#endif
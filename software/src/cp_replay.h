@@ -0,0 +1,95 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * cp_replay.h: Replay of recorded/synthetic CP traces through the ADC pipeline
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef CP_REPLAY_H
+#define CP_REPLAY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "spsc_queue.h"
+
+// While the replay is active, the raw VCP1/VCP2 ADC results are replaced by
+// the trace written over the API and VPP is replaced by a constant value.
+// The trace is advanced by one sample for each VCP1 result that the ADC
+// pipeline consumes, so the result is deterministic in samples independent
+// of the main loop and API timing. Changes of IEC 61851 state, contactor
+// and CP duty cycle are recorded with the sample index in a timeline.
+// The contactor is never switched by a replayed trace, evse_set_output()
+// only updates the contactor state of the replay (evse_is_contactor_active()).
+//
+// An element is run-length encoded: VCP1 raw (bits 0-11), VCP2 raw
+// (bits 12-23), the number of samples (bits 24-30, 0 = 128) and the PWM
+// flag (bit 31). With PWM every second sample of the element is the low
+// level of the PWM (VCP1 = VCP2 = vcp_low) instead of the given values.
+
+// Only available in images built with the CP_TRACE_REPLAY cmake option.
+// The replay can only be started with the password in IEC 61851 state A
+// with the contactor off.
+
+#define CP_REPLAY_PASSWORD      0x5EB1A7C3
+
+#define CP_REPLAY_QUEUE_SIZE    64
+#define CP_REPLAY_TIMELINE_SIZE 16
+
+#define CP_REPLAY_ELEMENT_VCP1(element)  ((uint16_t)((element) & 0xFFF))
+#define CP_REPLAY_ELEMENT_VCP2(element)  ((uint16_t)(((element) >> 12) & 0xFFF))
+#define CP_REPLAY_ELEMENT_COUNT(element) ((uint8_t)(((((element) >> 24) & 0x7F) == 0) ? 128 : (((element) >> 24) & 0x7F)))
+#define CP_REPLAY_ELEMENT_PWM(element)   (((element) & (1UL << 31)) != 0)
+
+typedef struct {
+	uint32_t sample;   // Sample index of the change
+	uint8_t iec61851_state;
+	bool contactor;
+	uint16_t cp_duty_cycle;
+} CPReplayTimelineEntry;
+
+typedef struct {
+	bool active;
+	uint16_t vpp;             // Raw ADC value
+	uint16_t vcp_low;         // Raw ADC value of the PWM low level
+	uint16_t vcp1;            // Raw ADC values of the current element
+	uint16_t vcp2;
+	uint8_t remaining;        // Samples left of the current element
+	bool pwm;
+	bool pwm_low;             // Current sample is the PWM low level
+	uint32_t sample;          // Number of replayed samples
+	uint32_t underruns;       // Samples without queued element (the last values are repeated)
+	bool contactor;           // Contactor state requested by the charging logic, the GPIO is not switched
+
+	SPSCQueue queue;
+	uint32_t queue_buffer[CP_REPLAY_QUEUE_SIZE];
+
+	CPReplayTimelineEntry timeline[CP_REPLAY_TIMELINE_SIZE];
+	uint8_t timeline_count;   // Stops recording when full
+	CPReplayTimelineEntry last;
+} CPReplay;
+
+extern CPReplay cp_replay;
+
+uint16_t cp_replay_get_raw(const uint8_t channel, const uint16_t raw);
+void cp_replay_start(const uint16_t vpp, const uint16_t vcp_low);
+void cp_replay_stop(void);
+uint8_t cp_replay_write(const uint32_t *elements, const uint8_t count);
+void cp_replay_init(void);
+void cp_replay_tick(void);
+
+#endif
@@ -0,0 +1,127 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * cpu_load.c: Sleep between main loop iterations and CPU load accounting
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "cpu_load.h"
+
+#include "bricklib2/hal/system_timer/system_timer.h"
+
+#include "adc.h"
+#include "soft_timer.h"
+
+#include "xmc_device.h"
+
+#include <string.h>
+
+CPULoad cpu_load;
+
+// Cycle timestamp that also works with interrupts disabled: If the SysTick
+// wrapped but its IRQ did not run yet, the ms counter is one behind.
+static uint32_t cpu_load_get_cycles(void) {
+	const uint32_t ms    = system_timer_get_ms();
+	const uint32_t value = SysTick->VAL;
+	uint32_t cycles      = ms*(SysTick->LOAD + 1) + (SysTick->LOAD - value);
+
+	if((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) && (value > SysTick->LOAD/2)) {
+		cycles += SysTick->LOAD + 1;
+	}
+
+	return cycles;
+}
+
+uint16_t cpu_load_get_peak(void) {
+	uint16_t peak = 0;
+	for(uint8_t i = 0; i < CPU_LOAD_HISTORY_SIZE; i++) {
+		if(cpu_load.history[i] > peak) {
+			peak = cpu_load.history[i];
+		}
+	}
+
+	return peak;
+}
+
+void cpu_load_init(void) {
+	memset(&cpu_load, 0, sizeof(CPULoad));
+	cpu_load.interval_start = cpu_load_get_cycles();
+	cpu_load.last_interval  = system_timer_get_ms();
+
+#ifdef CPU_SLEEP
+	// Pending IRQs are wakeup events for WFE, also if they are disabled
+	SCB->SCR |= SCB_SCR_SEVONPEND_Msk;
+#else
+	cpu_load.iteration_start = cpu_load.interval_start;
+#endif
+}
+
+// Keep as last call in the main loop
+void cpu_load_tick(void) {
+	if(system_timer_is_time_elapsed_ms(cpu_load.last_interval, CPU_LOAD_INTERVAL)) {
+		cpu_load.last_interval += CPU_LOAD_INTERVAL;
+
+		const uint32_t now   = cpu_load_get_cycles();
+		const uint32_t total = now - cpu_load.interval_start;
+		const uint32_t idle  = cpu_load.idle_cycles < total ? cpu_load.idle_cycles : total;
+
+		cpu_load.load                            = (uint16_t)(((uint64_t)(total - idle))*10000/total);
+		cpu_load.wakeups_per_second              = cpu_load.wakeups;
+		cpu_load.history[cpu_load.history_index] = cpu_load.load;
+		cpu_load.history_index                   = (cpu_load.history_index + 1) % CPU_LOAD_HISTORY_SIZE;
+
+		cpu_load.interval_start = now;
+		cpu_load.idle_cycles    = 0;
+		cpu_load.wakeups        = 0;
+	}
+
+	// There is nothing to do if there is no wakeup request (digital input edge),
+	// no finished ADC scan that adc_tick() did not read yet and no soft timer
+	// that is already due.
+	__disable_irq();
+	uint32_t remaining = 0;
+	const bool timer_due = soft_timer_get_next_deadline(&remaining) && (remaining == 0);
+	const bool idle      = !cpu_load.wakeup && !adc_is_scan_pending() && !timer_due;
+
+#ifdef CPU_SLEEP
+	// Interrupts are disabled, so that an IRQ between the check and the WFE can
+	// not be missed: With SEVONPEND every IRQ that becomes pending is an event,
+	// also if it is masked by PRIMASK or disabled in the NVIC (ADC end of
+	// background scan). The event is latched, WFE returns immediately if it
+	// happened after the check. The IRQ handler time is counted as active time.
+	// Wakeup sources are SysTick (1ms), the ADC end of background scan and the
+	// SPITFP, RS485 and frequency IRQs. Deadlines of the soft timers are in ms,
+	// the next SysTick wakes the core when one of them becomes due.
+	if(idle) {
+		const uint32_t start = cpu_load_get_cycles();
+		__WFE();
+		cpu_load.idle_cycles += cpu_load_get_cycles() - start;
+		cpu_load.wakeups++;
+	}
+#else
+	// No sleep: The core keeps polling, a main loop iteration that starts with
+	// nothing to do is counted as idle time.
+	const uint32_t now = cpu_load_get_cycles();
+	if(cpu_load.idle_iteration) {
+		cpu_load.idle_cycles += now - cpu_load.iteration_start;
+	}
+	cpu_load.idle_iteration  = idle;
+	cpu_load.iteration_start = now;
+#endif
+	cpu_load.wakeup = false;
+	__enable_irq();
+}
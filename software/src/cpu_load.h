@@ -0,0 +1,63 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * cpu_load.h: Sleep between main loop iterations and CPU load accounting
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef CPU_LOAD_H
+#define CPU_LOAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CPU_LOAD_INTERVAL     1000 // ms
+#define CPU_LOAD_HISTORY_SIZE 60   // Peak over the last minute
+
+typedef struct {
+	// Set if there is work that has to be done in the next main loop
+	// iteration, the core does not sleep then. Also set from IRQs.
+	volatile bool wakeup;
+
+	uint32_t idle_cycles;
+	uint32_t wakeups;               // WFE wakeups, always 0 without CPU_SLEEP
+	uint32_t interval_start;        // cycles
+	uint32_t last_interval;         // ms
+#ifndef CPU_SLEEP
+	uint32_t iteration_start;       // cycles
+	bool idle_iteration;            // Current main loop iteration started with nothing to do
+#endif
+
+	// Result of the last interval
+	uint16_t load;                  // 1/100 %
+	uint32_t wakeups_per_second;
+	uint16_t history[CPU_LOAD_HISTORY_SIZE];
+	uint8_t history_index;
+} CPULoad;
+
+extern CPULoad cpu_load;
+
+// Keep the core awake for the next main loop iteration
+static inline void cpu_load_wakeup(void) {
+	cpu_load.wakeup = true;
+}
+
+uint16_t cpu_load_get_peak(void);
+void cpu_load_init(void);
+void cpu_load_tick(void);
+
+#endif
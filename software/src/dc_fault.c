@@ -35,6 +35,7 @@
 #include "evse.h"
 #include "communication.h"
 #include "hardware_version.h"
+#include "boot_timing.h"
 
 #include "xmc_gpio.h"
 
@@ -107,6 +108,7 @@ void dc_fault_update_values(void) {
 void dc_fault_calibration_reset(void) {
 	dc_fault.calibration_start    = false;
 	dc_fault.calibration_state    = 0;
+	soft_timer_stop(&dc_fault.calibration_timer);
 	dc_fault.calibration_check[0] = false;
 	dc_fault.calibration_check[1] = false;
 	dc_fault.calibration_check[2] = false;
@@ -122,42 +124,42 @@ void dc_fault_calibration_tick(void) {
 	switch(dc_fault.calibration_state) {
 		case 0: { // Pull TST low
 			XMC_GPIO_SetOutputLow(DC_FAULT_TST_PIN);
-			dc_fault.calibration_time = system_timer_get_ms();
+			soft_timer_start(&dc_fault.calibration_timer, 250);
 			dc_fault.calibration_state++;
 			break;
 		}
 
 		case 1: { // Wait for 250ms (between 30ms and 1.2s OK)
-			if(system_timer_is_time_elapsed_ms(dc_fault.calibration_time, 250)) {
+			if(soft_timer_is_expired(&dc_fault.calibration_timer)) {
 				XMC_GPIO_SetOutputHigh(DC_FAULT_TST_PIN);
-				dc_fault.calibration_time = system_timer_get_ms();
+				soft_timer_start(&dc_fault.calibration_timer, 740);
 				dc_fault.calibration_state++;
 			}
 			break;
 		}
 
 		case 2: { // Wait 740ms for 6x to go high
-			if(system_timer_is_time_elapsed_ms(dc_fault.calibration_time, 740)) {
+			if(soft_timer_is_expired(&dc_fault.calibration_timer)) {
 				dc_fault.calibration_check[0] = XMC_GPIO_GetInput(DC_FAULT_X6_PIN);
-				dc_fault.calibration_time = system_timer_get_ms();
+				soft_timer_start(&dc_fault.calibration_timer, 660);
 				dc_fault.calibration_state++;
 			}
 			break;
 		}
 
 		case 3: { // Wait 660ms for 30x to go high
-			if(system_timer_is_time_elapsed_ms(dc_fault.calibration_time, 660)) {
+			if(soft_timer_is_expired(&dc_fault.calibration_timer)) {
 				dc_fault.calibration_check[1] = XMC_GPIO_GetInput(DC_FAULT_X30_PIN);
-				dc_fault.calibration_time = system_timer_get_ms();
+				soft_timer_start(&dc_fault.calibration_timer, 400);
 				dc_fault.calibration_state++;
 			}
 			break;
 		}
 
 		case 4: { // Wait 400ms. With sensor X804 errror pin goes high, with sensor X904 error pin stays low
-			if(system_timer_is_time_elapsed_ms(dc_fault.calibration_time, 400)) {
+			if(soft_timer_is_expired(&dc_fault.calibration_timer)) {
 				dc_fault.sensor_type = XMC_GPIO_GetInput(DC_FAULT_ERR_PIN) ? DC_FAULT_SENSOR_X804 : DC_FAULT_SENSOR_X904;
-				dc_fault.calibration_time = system_timer_get_ms();
+				soft_timer_start(&dc_fault.calibration_timer, 1200);
 				dc_fault.calibration_state++;
 			}
 			break;
@@ -165,7 +167,7 @@ void dc_fault_calibration_tick(void) {
 
 		case 5: { // Wait 1s for 6x and 30x to go low again
 			// (datasheet says 2030 to 2100ms, we have 3000 in sum)
-			if(system_timer_is_time_elapsed_ms(dc_fault.calibration_time, 1200)) {
+			if(soft_timer_is_expired(&dc_fault.calibration_timer)) {
 				dc_fault.calibration_check[2] = (!XMC_GPIO_GetInput(DC_FAULT_X6_PIN)) && (!XMC_GPIO_GetInput(DC_FAULT_X30_PIN));
 
 				if(dc_fault.calibration_check[0] && dc_fault.calibration_check[1] && dc_fault.calibration_check[2]) {
@@ -183,6 +185,7 @@ void dc_fault_calibration_tick(void) {
 
 				dc_fault.calibration_running = false;
 				dc_fault_calibration_reset();
+				boot_timing_mark(BOOT_TIMING_DC_FAULT_CALIBRATION_DONE);
 			}
 			break;
 		}
@@ -25,6 +25,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "soft_timer.h"
+
 typedef enum {
 	DC_FAULT_NORMAL_CONDITION = 0,
 	DC_FAULT_6MA_DC,
@@ -54,7 +56,7 @@ typedef struct {
 	bool     calibration_start_external;
 	bool     calibration_running;
 	uint8_t  calibration_state;
-	uint32_t calibration_time;
+	SoftTimer calibration_timer;
 	bool     calibration_check[3];
 } DCFault;
 
@@ -0,0 +1,206 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * derating.c: Thermal current derating based on TMP1075N board temperature
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "derating.h"
+
+#include <string.h>
+
+#include "charging_slot.h"
+#include "hardware_version.h"
+#include "iec61851.h"
+#include "tmp1075n.h"
+
+#include "bricklib2/hal/system_timer/system_timer.h"
+#include "bricklib2/utility/util_definitions.h"
+
+Derating derating;
+
+static const DeratingPoint derating_curve_default[DERATING_CURVE_POINTS] = {
+	{7000, 32000},
+	{8000, 16000},
+	{8500,  6000},
+	{9000,     0}
+};
+
+// Use 1 if timer is 0 (0 means "not set")
+static uint32_t derating_now_ms(void) {
+	const uint32_t now = system_timer_get_ms();
+	return now == 0 ? 1 : now;
+}
+
+// Linear interpolation between the curve points. There is no limit below the
+// first point, above the last point the current of the last point is used.
+static uint16_t derating_get_curve_current(const int32_t temperature) {
+	if(temperature < derating.curve[0].temperature) {
+		return DERATING_NO_LIMIT;
+	}
+
+	for(uint8_t i = 1; i < DERATING_CURVE_POINTS; i++) {
+		const DeratingPoint *p0 = &derating.curve[i-1];
+		const DeratingPoint *p1 = &derating.curve[i];
+
+		if(temperature < p1->temperature) {
+			const int32_t dt = p1->temperature - p0->temperature;
+			const int32_t dc = (int32_t)p1->current - (int32_t)p0->current;
+			return (uint16_t)((int32_t)p0->current + dc*(temperature - p0->temperature)/dt);
+		}
+	}
+
+	return derating.curve[DERATING_CURVE_POINTS-1].current;
+}
+
+static uint16_t derating_get_current(const int32_t temperature) {
+	const uint16_t current = derating_get_curve_current(temperature);
+	return current < DERATING_MIN_CURRENT ? 0 : current;
+}
+
+static void derating_update_session(void) {
+	const bool connected = (iec61851.state == IEC61851_STATE_B) ||
+	                       (iec61851.state == IEC61851_STATE_C) ||
+	                       (iec61851.state == IEC61851_STATE_D);
+
+	if(connected && !derating.session_active) {
+		derating.session_active           = true;
+		derating.session_peak_temperature = tmp1075n.temperature;
+		derating.session_derated_time     = 0;
+		derating.session_derated_start    = derating.slot_active ? derating_now_ms() : 0;
+	} else if(!connected && derating.session_active) {
+		// Keep the statistics of the last session until the next one starts
+		derating.session_derated_time  = derating_get_session_derated_time();
+		derating.session_derated_start = 0;
+		derating.session_active        = false;
+	}
+}
+
+static void derating_update_slot(void) {
+	const bool derated = derating.max_current < DERATING_NO_LIMIT;
+	if(derated != derating.slot_active) {
+		if(derating.session_active) {
+			if(derated) {
+				derating.session_derated_start = derating_now_ms();
+			} else {
+				derating.session_derated_time  = derating_get_session_derated_time();
+				derating.session_derated_start = 0;
+			}
+		}
+		derating.slot_active = derated;
+	}
+}
+
+static void derating_update_limit(const int16_t temperature) {
+	if(!derating.enabled) {
+		derating.max_current = DERATING_NO_LIMIT;
+		return;
+	}
+
+	// Reduce the current immediately, increase it only after the temperature
+	// has fallen by the hysteresis.
+	const uint16_t current = derating_get_current(temperature);
+	if(current < derating.max_current) {
+		derating.max_current = current;
+	} else {
+		const uint16_t release = derating_get_current((int32_t)temperature + derating.hysteresis);
+		derating.max_current   = MAX(derating.max_current, release);
+	}
+}
+
+bool derating_set_curve(const DeratingPoint *curve, const uint16_t hysteresis) {
+	if(hysteresis > DERATING_HYSTERESIS_MAX) {
+		return false;
+	}
+
+	// Temperature has to increase and current must not increase
+	for(uint8_t i = 0; i < DERATING_CURVE_POINTS; i++) {
+		if(curve[i].current > DERATING_NO_LIMIT) {
+			return false;
+		}
+
+		if((i > 0) && ((curve[i].temperature <= curve[i-1].temperature) || (curve[i].current > curve[i-1].current))) {
+			return false;
+		}
+	}
+
+	memcpy(derating.curve, curve, sizeof(derating.curve));
+	derating.hysteresis = hysteresis;
+
+	// Re-evaluate the last valid temperature with the new curve
+	derating.max_current = DERATING_NO_LIMIT;
+	derating.read_count  = tmp1075n.read_count - 1;
+
+	return true;
+}
+
+uint32_t derating_get_session_derated_time(void) {
+	if(derating.session_derated_start == 0) {
+		return derating.session_derated_time;
+	}
+
+	return derating.session_derated_time + (system_timer_get_ms() - derating.session_derated_start);
+}
+
+void derating_init(void) {
+	memset(&derating, 0, sizeof(Derating));
+
+	derating.enabled     = true;
+	derating.hysteresis  = DERATING_HYSTERESIS_DEFAULT;
+	derating.max_current = DERATING_NO_LIMIT;
+	memcpy(derating.curve, derating_curve_default, sizeof(derating.curve));
+
+	// Ignore temperature until first read
+	derating.read_count  = tmp1075n.read_count;
+	derating.valid_time  = system_timer_get_ms();
+}
+
+void derating_tick(void) {
+	// No TMP1075N in EVSE V2
+	if(hardware_version.is_v2) {
+		return;
+	}
+
+	derating_update_session();
+
+	// Evaluate once per new temperature reading. After an I2C error the
+	// TMP1075N is re-initialized without a valid temperature, in this case
+	// the last limit is kept.
+	if(tmp1075n.valid && (tmp1075n.read_count != derating.read_count)) {
+		derating.read_count = tmp1075n.read_count;
+		derating.valid_time = system_timer_get_ms();
+
+		const int16_t temperature = tmp1075n.temperature;
+		if(derating.session_active) {
+			derating.session_peak_temperature = MAX(derating.session_peak_temperature, temperature);
+		}
+
+		derating_update_limit(temperature);
+		derating_update_slot();
+
+		// Read temperature faster near the derating threshold
+		tmp1075n.fast_read = derating.enabled && (temperature >= (derating.curve[0].temperature - (int32_t)derating.hysteresis));
+	} else if(derating.enabled && system_timer_is_time_elapsed_ms(derating.valid_time, DERATING_SENSOR_TIMEOUT)) {
+		// No valid temperature for too long, fall back to the minimum current
+		// until the temperature can be read again.
+		derating.max_current = MIN(derating.max_current, DERATING_MIN_CURRENT);
+		derating_update_slot();
+	}
+
+	charging_slot.max_current[CHARGING_SLOT_THERMAL] = derating.max_current;
+	charging_slot.active[CHARGING_SLOT_THERMAL]      = derating.slot_active;
+}
@@ -0,0 +1,68 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * derating.h: Thermal current derating based on TMP1075N board temperature
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef DERATING_H
+#define DERATING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DERATING_CURVE_POINTS          4
+#define DERATING_NO_LIMIT              32000
+#define DERATING_MIN_CURRENT           6000 // Below 6A charging is stopped
+#define DERATING_SENSOR_TIMEOUT        5000 // ms without valid temperature until the current is reduced to the minimum
+
+// Default curve: No derating up to 70°C, 16A at 80°C, 6A at 85°C, stop at 90°C
+#define DERATING_HYSTERESIS_DEFAULT    500 // 5°C
+#define DERATING_HYSTERESIS_MAX        2000
+
+typedef struct {
+	int16_t temperature; // 1/100 °C
+	uint16_t current;    // mA
+} DeratingPoint;
+
+typedef struct {
+	bool enabled;
+	DeratingPoint curve[DERATING_CURVE_POINTS]; // Sorted by temperature
+	uint16_t hysteresis;                        // 1/100 °C
+
+	uint32_t read_count; // Read count of the last evaluated temperature
+	uint32_t valid_time; // Time of the last valid temperature
+
+	// Result
+	uint16_t max_current;
+	bool slot_active;
+
+	// Statistics per charging session (vehicle connected)
+	bool session_active;
+	int16_t session_peak_temperature;
+	uint32_t session_derated_time;   // ms, finished derating periods
+	uint32_t session_derated_start;  // 0 = currently not derated
+} Derating;
+
+extern Derating derating;
+
+bool derating_set_curve(const DeratingPoint *curve, const uint16_t hysteresis);
+uint32_t derating_get_session_derated_time(void);
+void derating_init(void);
+void derating_tick(void);
+
+#endif
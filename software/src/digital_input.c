@@ -0,0 +1,193 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * digital_input.c: Timer sampled digital inputs with per pin integrators
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "digital_input.h"
+
+#include "configs/config_digital_input.h"
+#include "configs/config_evse.h"
+#include "configs/config_button.h"
+#include "configs/config_dc_fault.h"
+#include "configs/config_lock.h"
+
+#include "hardware_version.h"
+#include "button.h"
+#include "cpu_load.h"
+
+#include "bricklib2/logging/logging.h"
+
+#include "xmc_ccu4.h"
+#include "xmc_scu.h"
+
+#include <string.h>
+
+#define DIGITAL_INPUT_SHUTDOWN_DEBOUNCE 10 // ms
+#define DIGITAL_INPUT_GP_DEBOUNCE       10 // ms
+#define DIGITAL_INPUT_DC_FAULT_RISE     50 // ms, the dc fault pins have to be high for 50ms before we accept them as high
+#define DIGITAL_INPUT_DC_FAULT_FALL     0  // ms, low is accepted immediately
+#define DIGITAL_INPUT_LOCK_CLOSED       75 // ms, lock feedback
+#define DIGITAL_INPUT_LOCK_OPENED       50 // ms
+
+DigitalInput digital_input;
+
+// Called with DIGITAL_INPUT_SAMPLE_RATE. Each pin has an up/down integrator
+// that counts towards the opposite of the current stable value: It counts up
+// for each sample that differs and down for each sample that matches. The
+// stable value changes when the integrator reaches the threshold.
+#define digital_input_irq IRQ_Hdlr_31
+void __attribute__((optimize("-O3"))) __attribute__ ((section (".ram_code"))) digital_input_irq(void) {
+	bool edge = false;
+
+	digital_input.samples++;
+
+	for(uint8_t i = 0; i < DIGITAL_INPUT_NUM; i++) {
+		DigitalInputPin *input = &digital_input.pin[i];
+		if(input->port == NULL) {
+			continue;
+		}
+
+		const bool raw = XMC_GPIO_GetInput(input->port, input->pin);
+		input->raw = raw;
+
+		if(raw != input->value) {
+			input->integrator++;
+			if(input->integrator >= (raw ? input->rise_threshold : input->fall_threshold)) {
+				input->integrator = 0;
+				input->value      = raw;
+				input->edges++;
+				edge = true;
+			}
+		} else if(input->integrator > 0) {
+			input->integrator--;
+			if(input->integrator == 0) {
+				input->glitches++;
+			}
+		}
+	}
+
+	// Only wake the main loop if there is something to handle
+	if(edge) {
+		cpu_load_wakeup();
+	}
+}
+
+// Returns true once for each change of the stable value since the last call.
+// Multiple changes in between are merged, the current value can be read with
+// digital_input_get_value().
+bool digital_input_take_edge(const uint8_t input) {
+	const uint32_t edges = digital_input.pin[input].edges;
+	if(edges != digital_input.pin[input].edges_taken) {
+		digital_input.pin[input].edges_taken = edges;
+		return true;
+	}
+
+	return false;
+}
+
+void digital_input_set_thresholds(const uint8_t input, const uint16_t rise_threshold, const uint16_t fall_threshold) {
+	__disable_irq();
+	digital_input.pin[input].rise_threshold = rise_threshold;
+	digital_input.pin[input].fall_threshold = fall_threshold;
+	__enable_irq();
+}
+
+// The stable value starts with the current pin level, not with low until the integrator saturates
+static void digital_input_init_pin(const uint8_t input, XMC_GPIO_PORT_t *const port, const uint8_t pin, const uint16_t rise_threshold, const uint16_t fall_threshold) {
+	digital_input.pin[input].port           = port;
+	digital_input.pin[input].pin            = pin;
+	digital_input.pin[input].rise_threshold = rise_threshold;
+	digital_input.pin[input].fall_threshold = fall_threshold;
+	digital_input.pin[input].raw            = XMC_GPIO_GetInput(port, pin);
+	digital_input.pin[input].value          = digital_input.pin[input].raw;
+}
+
+// The pins themselves are configured as inputs by evse_init(), lock_init(), button_init() and dc_fault_init().
+void digital_input_init(void) {
+	memset(&digital_input, 0, sizeof(DigitalInput));
+
+	digital_input_init_pin(DIGITAL_INPUT_SHUTDOWN,       EVSE_SHUTDOWN_PIN, DIGITAL_INPUT_SHUTDOWN_DEBOUNCE, DIGITAL_INPUT_SHUTDOWN_DEBOUNCE);
+	digital_input_init_pin(DIGITAL_INPUT_BUTTON,         EVSE_BUTTON_PIN,   BUTTON_DEBOUNCE_STANDARD,        BUTTON_DEBOUNCE_STANDARD);
+	digital_input_init_pin(DIGITAL_INPUT_DC_FAULT_X6,    DC_FAULT_X6_PIN,   DIGITAL_INPUT_DC_FAULT_RISE,     DIGITAL_INPUT_DC_FAULT_FALL);
+	digital_input_init_pin(DIGITAL_INPUT_DC_FAULT_X30,   DC_FAULT_X30_PIN,  DIGITAL_INPUT_DC_FAULT_RISE,     DIGITAL_INPUT_DC_FAULT_FALL);
+	digital_input_init_pin(DIGITAL_INPUT_DC_FAULT_ERROR, DC_FAULT_ERR_PIN,  DIGITAL_INPUT_DC_FAULT_RISE,     DIGITAL_INPUT_DC_FAULT_FALL);
+	if(hardware_version.is_v2) {
+		digital_input_init_pin(DIGITAL_INPUT_GP,         EVSE_INPUT_GP_PIN, DIGITAL_INPUT_GP_DEBOUNCE,       DIGITAL_INPUT_GP_DEBOUNCE);
+	}
+	if(hardware_version.is_v4) {
+		digital_input_init_pin(DIGITAL_INPUT_LOCK_FEEDBACK, EVSE_LOCK_FEEDBACK_PIN, DIGITAL_INPUT_LOCK_CLOSED, DIGITAL_INPUT_LOCK_OPENED);
+	}
+
+	// The button starts as released, same as the previous debouncing in button.c:
+	// A press that is held at boot is handled as a press (boot press time for recovery).
+	digital_input.pin[DIGITAL_INPUT_BUTTON].raw   = false;
+	digital_input.pin[DIGITAL_INPUT_BUTTON].value = false;
+
+	// CCU41 is already initialized and its prescaler is running (CP PWM on V3/V4, LED on V2).
+	// Don't call XMC_CCU4_Init() again here, it would stop the prescaler.
+	const XMC_CCU4_SLICE_COMPARE_CONFIG_t compare_config = {
+		.timer_mode          = XMC_CCU4_SLICE_TIMER_COUNT_MODE_EA,
+		.monoshot            = false,
+		.shadow_xfer_clear   = 0,
+		.dither_timer_period = 0,
+		.dither_duty_cycle   = 0,
+		.prescaler_mode      = XMC_CCU4_SLICE_PRESCALER_MODE_NORMAL,
+		.mcm_enable          = 0,
+		.prescaler_initval   = DIGITAL_INPUT_TIMER_PRESCALER,
+		.float_limit         = 0,
+		.dither_limit        = 0,
+		.passive_level       = XMC_CCU4_SLICE_OUTPUT_PASSIVE_LEVEL_LOW,
+		.timer_concatenation = 0
+	};
+
+	XMC_CCU4_SLICE_CompareInit(DIGITAL_INPUT_TIMER_SLICE, &compare_config);
+	XMC_CCU4_SLICE_SetTimerPeriodMatch(DIGITAL_INPUT_TIMER_SLICE, DIGITAL_INPUT_TIMER_PERIOD-1);
+	XMC_CCU4_EnableShadowTransfer(DIGITAL_INPUT_TIMER_MODULE, XMC_CCU4_SHADOW_TRANSFER_SLICE_3 | XMC_CCU4_SHADOW_TRANSFER_PRESCALER_SLICE_3);
+
+	XMC_CCU4_SLICE_EnableEvent(DIGITAL_INPUT_TIMER_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH);
+	XMC_CCU4_SLICE_SetInterruptNode(DIGITAL_INPUT_TIMER_SLICE, XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH, XMC_CCU4_SLICE_SR_ID_3);
+
+	NVIC_SetPriority((IRQn_Type)DIGITAL_INPUT_IRQ_NUM, DIGITAL_INPUT_IRQ_PRIO);
+	XMC_SCU_SetInterruptControl(DIGITAL_INPUT_IRQ_NUM, DIGITAL_INPUT_IRQCTRL);
+	NVIC_EnableIRQ((IRQn_Type)DIGITAL_INPUT_IRQ_NUM);
+
+	XMC_CCU4_EnableClock(DIGITAL_INPUT_TIMER_MODULE, DIGITAL_INPUT_TIMER_SLICE_NUM);
+	XMC_CCU4_SLICE_StartTimer(DIGITAL_INPUT_TIMER_SLICE);
+
+	soft_timer_start(&digital_input.stall_timer, DIGITAL_INPUT_STALL_TIMEOUT);
+}
+
+// Checks that the sampling IRQ still runs. If it does not (e.g. wrong IRQ routing),
+// the stable values are frozen, the shutdown input is forced then.
+void digital_input_tick(void) {
+	if(!soft_timer_is_expired(&digital_input.stall_timer)) {
+		return;
+	}
+	soft_timer_start(&digital_input.stall_timer, DIGITAL_INPUT_STALL_TIMEOUT);
+
+	const uint32_t samples = digital_input.samples;
+	const bool stalled     = samples == digital_input.samples_checked;
+	if(stalled && !digital_input.stalled) {
+		loge("Digital input sampling stalled\n\r");
+		digital_input.stalls++;
+	}
+
+	digital_input.stalled         = stalled;
+	digital_input.samples_checked = samples;
+}
@@ -0,0 +1,93 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * digital_input.h: Timer sampled digital inputs with per pin integrators
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef DIGITAL_INPUT_H
+#define DIGITAL_INPUT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "xmc_gpio.h"
+
+#include "soft_timer.h"
+
+#define DIGITAL_INPUT_SHUTDOWN        0
+#define DIGITAL_INPUT_GP              1 // V2 only
+#define DIGITAL_INPUT_BUTTON          2
+#define DIGITAL_INPUT_DC_FAULT_X6     3 // Only sampled for get_digital_input, dc_fault reads the pins directly
+#define DIGITAL_INPUT_DC_FAULT_X30    4
+#define DIGITAL_INPUT_DC_FAULT_ERROR  5
+#define DIGITAL_INPUT_LOCK_FEEDBACK   6 // V4 only
+
+#define DIGITAL_INPUT_NUM             7
+
+// The sampling IRQ has to run at least once in this time, otherwise the stable
+// values are frozen and the shutdown input is forced (see charging_slot_tick()).
+#define DIGITAL_INPUT_STALL_TIMEOUT   10 // ms
+
+typedef struct {
+	XMC_GPIO_PORT_t *port; // NULL = not available on this hardware version
+	uint8_t pin;
+
+	// Number of samples (ms) the integrator needs to change the stable value
+	// to high/low, 0 = change on the first sample.
+	uint16_t rise_threshold;
+	uint16_t fall_threshold;
+	uint16_t integrator; // Counts towards the opposite of the stable value
+
+	volatile bool raw;   // Last sample
+	volatile bool value; // Stable value
+	volatile uint32_t edges;
+	volatile uint32_t glitches; // Integrator went back to 0 without a change of the stable value
+
+	uint32_t edges_taken; // Only used by digital_input_take_edge()
+} DigitalInputPin;
+
+typedef struct {
+	DigitalInputPin pin[DIGITAL_INPUT_NUM];
+
+	volatile uint32_t samples; // Incremented by the sampling IRQ
+	uint32_t samples_checked;
+	SoftTimer stall_timer;
+	bool stalled;
+	uint32_t stalls;
+} DigitalInput;
+
+extern DigitalInput digital_input;
+
+static inline bool digital_input_get_value(const uint8_t input) {
+	return digital_input.pin[input].value;
+}
+
+static inline bool digital_input_get_raw(const uint8_t input) {
+	return digital_input.pin[input].raw;
+}
+
+static inline bool digital_input_is_stalled(void) {
+	return digital_input.stalled;
+}
+
+bool digital_input_take_edge(const uint8_t input);
+void digital_input_set_thresholds(const uint8_t input, const uint16_t rise_threshold, const uint16_t fall_threshold);
+void digital_input_init(void);
+void digital_input_tick(void);
+
+#endif
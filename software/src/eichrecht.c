@@ -27,6 +27,9 @@
 #include "bricklib2/warp/modbus.h"
 #include "bricklib2/hal/system_timer/system_timer.h"
 
+#include "evse.h"
+#include "arena.h"
+
 static const char *if_strings[] = {
     "RFID_NONE", "RFID_PLAIN", "RFID_RELATED", "RFID_PSK", "OCPP_NONE", "OCPP_RS", "OCPP_AUTH", "OCPP_RS_TLS", "OCPP_AUTH_TLS", "OCPP_CACHE", "OCPP_WHITELIST", "OCPP_CERTIFIED", "ISO15118_NONE", "ISO15118_PNC", "PLMN_NONE", "PLMN_RING", "PLMN_SMS"
 };
@@ -41,15 +44,6 @@ static const char *ct_strings[] = {
 
 Eichrecht eichrecht;
 
-void eichrecht_init(void) {
-    memset(&eichrecht, 0, sizeof(Eichrecht));
-
-    // Eichrecht support only on v4 hardware
-    if(!hardware_version.is_v4) {
-        return;
-    }
-}
-
 const char *eichrecht_get_if_string(uint8_t index) {
     if (index < ARRAY_SIZE(if_strings)) {
         return if_strings[index];
@@ -58,9 +52,9 @@ const char *eichrecht_get_if_string(uint8_t index) {
     }
 }
 
-const char *eichrecht_get_it_string(void) {
-    if (eichrecht.ocmf.it < ARRAY_SIZE(it_strings)) {
-        return it_strings[eichrecht.ocmf.it];
+const char *eichrecht_get_it_string(uint8_t index) {
+    if (index < ARRAY_SIZE(it_strings)) {
+        return it_strings[index];
     } else {
         return "";
     }
@@ -92,7 +86,145 @@ static char *itoa_p(uint8_t value, char *str) {
 	return str + 1;
 }
 
-void eichrecht_create_dataset(void) {
+// Copies string from API (not necessarily null-terminated) into dst (length+1 bytes).
+// Returns false if the string contains characters that can't be used in the JSON dataset.
+static bool eichrecht_copy_string(char *dst, const char *src, const uint8_t length) {
+    for(uint8_t i = 0; i < length; i++) {
+        if(src[i] == '\0') {
+            break;
+        }
+        if((uint8_t)src[i] < 0x20) {
+            return false;
+        }
+    }
+
+    memcpy(dst, src, length);
+    dst[length] = '\0';
+    return true;
+}
+
+// Appends str to ptr with JSON escaping. ptr needs space for 2*strlen(str) bytes.
+static char *eichrecht_escape_string(char *ptr, const char *str) {
+    while(*str != '\0') {
+        if((*str == '"') || (*str == '\\')) {
+            *ptr++ = '\\';
+        }
+        *ptr++ = *str++;
+    }
+
+    return ptr;
+}
+
+static void eichrecht_update_dataset_prefix(void) {
+    char *ptr = eichrecht.ocmf.dataset_prefix;
+
+    ptr = stpcpy(ptr, "{\"FV\":\"1.3\",\"GI\":\"");
+    ptr = eichrecht_escape_string(ptr, eichrecht.ocmf.gi);
+    ptr = stpcpy(ptr, "\",\"GS\":\"");
+    ptr = eichrecht_escape_string(ptr, eichrecht.ocmf.gs);
+    ptr = stpcpy(ptr, "\",\"PG\":\"\",\"MV\":\"\",\"MM\":\"\",\"MS\":\"\",\"MF\":\"\",\"IS\":");
+
+    eichrecht.ocmf.dataset_prefix_length = (uint16_t)(ptr - eichrecht.ocmf.dataset_prefix);
+}
+
+static void eichrecht_update_dataset_suffix(void) {
+    char *ptr = eichrecht.ocmf.dataset_suffix;
+
+    ptr = stpcpy(ptr, "\",\"CF\":\"");
+
+    uint32_t fw = BOOTLOADER_FIRMWARE_CONFIGURATION_POINTER->firmware_version;
+    ptr = itoa_p((fw >> 16) & 0xFF, ptr);
+    *ptr++ = '.';
+    ptr = itoa_p((fw >> 8)  & 0xFF, ptr);
+    *ptr++ = '.';
+    ptr = itoa_p((fw >> 0)  & 0xFF, ptr);
+
+    ptr = stpcpy(ptr, "\",\"CT\":\"");
+    ptr = stpcpy(ptr, eichrecht_get_ct_string());
+    ptr = stpcpy(ptr, "\",\"CI\":\"");
+    ptr = eichrecht_escape_string(ptr, eichrecht.ocmf.ci);
+    ptr = stpcpy(ptr, "\",\"RD\":[]}");
+
+    eichrecht.ocmf.dataset_suffix_length = (uint16_t)(ptr - eichrecht.ocmf.dataset_suffix);
+}
+
+static void eichrecht_update_id_escaped(void) {
+    char *ptr = eichrecht_escape_string(eichrecht.ocmf.id_escaped, eichrecht.ocmf.id);
+    *ptr = '\0';
+
+    eichrecht.ocmf.id_escaped_length = (uint8_t)(ptr - eichrecht.ocmf.id_escaped);
+}
+
+bool eichrecht_set_gateway_identification(const char *gi, const uint8_t length) {
+    if((length >= sizeof(eichrecht.ocmf.gi)) || !eichrecht_copy_string(eichrecht.ocmf.gi, gi, length)) {
+        return false;
+    }
+
+    eichrecht_update_dataset_prefix();
+    return true;
+}
+
+bool eichrecht_set_gateway_serial(const char *gs, const uint8_t length) {
+    if((length >= sizeof(eichrecht.ocmf.gs)) || !eichrecht_copy_string(eichrecht.ocmf.gs, gs, length)) {
+        return false;
+    }
+
+    eichrecht_update_dataset_prefix();
+    return true;
+}
+
+bool eichrecht_set_user_assignment(const bool is, const uint8_t *if_, const uint8_t it, const char *id, const uint8_t length) {
+    if((length >= sizeof(eichrecht.ocmf.id)) || !eichrecht_copy_string(eichrecht.ocmf.id, id, length)) {
+        return false;
+    }
+
+    eichrecht.ocmf.is = is;
+    memcpy(eichrecht.ocmf.if_, if_, sizeof(eichrecht.ocmf.if_));
+    eichrecht.ocmf.it = it;
+
+    eichrecht_update_id_escaped();
+    return true;
+}
+
+bool eichrecht_set_charge_point(const uint8_t ct, const char *ci, const uint8_t length) {
+    if((length >= sizeof(eichrecht.ocmf.ci)) || !eichrecht_copy_string(eichrecht.ocmf.ci, ci, length)) {
+        return false;
+    }
+
+    eichrecht.ocmf.ct = ct;
+
+    eichrecht_update_dataset_suffix();
+    return true;
+}
+
+// Eichrecht is supported if the meter supports it. Until the meter is detected after boot
+// we assume that the last known meter is still connected, so the host can already start a transaction.
+bool eichrecht_is_supported(void) {
+    if(!hardware_version.is_v4) {
+        return false;
+    }
+
+    if(meter_supports_eichrecht()) {
+        return true;
+    }
+
+    return (meter.type == METER_TYPE_UNKNOWN) && eichrecht.meter_cache_valid;
+}
+
+void eichrecht_init(void) {
+    memset(&eichrecht, 0, sizeof(Eichrecht));
+
+    // Eichrecht support only on v4 hardware
+    if(!hardware_version.is_v4) {
+        return;
+    }
+
+    eichrecht_update_dataset_prefix();
+    eichrecht_update_dataset_suffix();
+    eichrecht_update_id_escaped();
+}
+
+void eichrecht_create_dataset(const EichrechtTransaction *t) {
     // WM3M4C manual:
     // JSON names must be in specified order and without whitespaces. Downloaded message should look like
     // {"FV":"1.0","GI":"","GS":"","PG":"","MV":"","MM":"","MS":"","MF":"","IS":true,"IF":[],"IT":"NONE","ID":"","CT":"EVSEID","CI":"","RD":[]}
@@ -116,25 +248,25 @@ void eichrecht_create_dataset(void) {
     // "CI":"",
     // "RD":[]
     // }
+    //
+    // The static parts (FV to IS and CF to RD) are cached and only rebuilt if the configuration changes.
+    // Only the user assignment (IS, IF, IT, ID) is put together here, from the snapshot taken when the transaction was queued.
 
-    memset(eichrecht.dataset_in, 0, sizeof(eichrecht.dataset_in));
-
-    // The absolute maximum size of the dataset here is known (since all possible strings are predefined).
+    // The absolute maximum size of the dataset here is known (all possible strings are predefined
+    // and the user strings are limited and escaped at set time, 484 bytes worst case).
     // The dataset size was chosen big enough to hold the maximum possible size.
     // Thus we can use unsafe string functions here.
-    char *ptr = eichrecht.dataset_in;
+    char *ptr = arena.eichrecht.dataset_in;
 
-    ptr = stpcpy(ptr, "{\"FV\":\"1.3\",\"GI\":\"");
-    ptr = stpcpy(ptr, eichrecht.ocmf.gi);
-    ptr = stpcpy(ptr, "\",\"GS\":\"");
-    ptr = stpcpy(ptr, eichrecht.ocmf.gs);
-    ptr = stpcpy(ptr, "\",\"PG\":\"\",\"MV\":\"\",\"MM\":\"\",\"MS\":\"\",\"MF\":\"\",\"IS\":");
-    ptr = stpcpy(ptr, eichrecht.ocmf.is ? "true" : "false");
+    memcpy(ptr, eichrecht.ocmf.dataset_prefix, eichrecht.ocmf.dataset_prefix_length);
+    ptr += eichrecht.ocmf.dataset_prefix_length;
+
+    ptr = stpcpy(ptr, t->is ? "true" : "false");
     ptr = stpcpy(ptr, ",\"IF\":[");
 
     bool first = true;
     for (int i = 0; i < 4; i++) {
-        const char *if_string = eichrecht_get_if_string(eichrecht.ocmf.if_[i]);
+        const char *if_string = eichrecht_get_if_string(t->if_[i]);
         if (if_string) {
             if (!first) {
                 *ptr++ = ',';
@@ -147,25 +279,138 @@ void eichrecht_create_dataset(void) {
     }
 
     ptr = stpcpy(ptr, "],\"IT\":\"");
-    ptr = stpcpy(ptr, eichrecht_get_it_string());
+    ptr = stpcpy(ptr, eichrecht_get_it_string(t->it));
     ptr = stpcpy(ptr, "\",\"ID\":\"");
-    ptr = stpcpy(ptr, eichrecht.ocmf.id);
-    ptr = stpcpy(ptr, "\",\"CF\":\"");
+    memcpy(ptr, t->id_escaped, t->id_escaped_length);
+    ptr += t->id_escaped_length;
 
-    uint32_t fw = BOOTLOADER_FIRMWARE_CONFIGURATION_POINTER->firmware_version;
-    ptr = itoa_p((fw >> 16) & 0xFF, ptr);
-    *ptr++ = '.';
-    ptr = itoa_p((fw >> 8)  & 0xFF, ptr);
-    *ptr++ = '.';
-    ptr = itoa_p((fw >> 0)  & 0xFF, ptr);
+    memcpy(ptr, eichrecht.ocmf.dataset_suffix, eichrecht.ocmf.dataset_suffix_length);
+    ptr += eichrecht.ocmf.dataset_suffix_length;
 
-    ptr = stpcpy(ptr, "\",\"CT\":\"");
-    ptr = stpcpy(ptr, eichrecht_get_ct_string());
-    ptr = stpcpy(ptr, "\",\"CI\":\"");
-    ptr = stpcpy(ptr, eichrecht.ocmf.ci);
-    ptr = stpcpy(ptr, "\",\"RD\":[]}");
+    eichrecht.dataset_in_length = (uint16_t)(ptr - arena.eichrecht.dataset_in);
+
+    // Null-terminator doubles as padding byte if the dataset is written with odd length
+    *ptr = '\0';
+}
+
+bool eichrecht_queue_transaction(const char transaction, const uint32_t unix_time, const int16_t utc_time_offset, const uint16_t signature_format, uint16_t *sequence) {
+    if(eichrecht.queue_count >= EICHRECHT_TRANSACTION_QUEUE_SIZE) {
+        return false;
+    }
+
+    EichrechtTransaction *t = &eichrecht.queue[(eichrecht.queue_start + eichrecht.queue_count) % EICHRECHT_TRANSACTION_QUEUE_SIZE];
+
+    // Sequence number 0 is never used
+    eichrecht.sequence_next++;
+    if(eichrecht.sequence_next == 0) {
+        eichrecht.sequence_next = 1;
+    }
+
+    t->sequence          = eichrecht.sequence_next;
+    t->transaction       = transaction;
+    t->unix_time         = unix_time;
+    t->utc_time_offset   = utc_time_offset;
+    t->signature_format  = signature_format;
+    t->is                = eichrecht.ocmf.is;
+    t->it                = eichrecht.ocmf.it;
+    t->id_escaped_length = eichrecht.ocmf.id_escaped_length;
+    memcpy(t->if_, eichrecht.ocmf.if_, sizeof(t->if_));
+    memcpy(t->id_escaped, eichrecht.ocmf.id_escaped, sizeof(t->id_escaped));
+
+    eichrecht.queue_count++;
+    *sequence = t->sequence;
+
+    return true;
+}
+
+// Measurement status of the meter after all queued transactions are done.
+// Used to check if a new transaction fits to the transactions that are already queued.
+uint16_t eichrecht_get_expected_measurement_status(void) {
+    if(eichrecht.queue_count == 0) {
+        return meter_iskra.measurement_status;
+    }
+
+    const char last = eichrecht.queue[(eichrecht.queue_start + eichrecht.queue_count - 1) % EICHRECHT_TRANSACTION_QUEUE_SIZE].transaction;
+    if(last == 'E' || last == 'r') {
+        return 0; // idle
+    }
+
+    return 1; // active
+}
+
+// Removes the transaction in progress from the queue
+static void eichrecht_queue_pop(void) {
+    if(eichrecht.queue_count == 0) {
+        return;
+    }
+
+    eichrecht.queue_start = (eichrecht.queue_start + 1) % EICHRECHT_TRANSACTION_QUEUE_SIZE;
+    eichrecht.queue_count--;
+}
+
+static void eichrecht_abort_transactions_without_meter(void) {
+    // Transactions were never started on the meter, so there is no modbus request to clear
+    eichrecht.timeout_counter += eichrecht.queue_count;
+    eichrecht.queue_start = 0;
+    eichrecht.queue_count = 0;
+
+    eichrecht.transaction_state = 0;
+    eichrecht.transaction_inner_state = 0;
+    eichrecht.transaction_state_time = 0;
+}
+
+// meter_iskra calls eichrecht_iskra_init_tick until the public key is read from the meter.
+// The key read uses the inner state of the transactions, a transaction in progress is started again afterwards.
+static void eichrecht_read_public_key_again(void) {
+    if(eichrecht.transaction_state > 0) {
+        eichrecht.transaction_state = 1;
+        eichrecht.transaction_inner_state = 0;
+        eichrecht.transaction_state_time = 0;
+        modbus_clear_request(&rs485);
+    }
+
+    eichrecht.init_done = false;
 }
 
+static void eichrecht_check_meter_cache(void) {
+    if(meter.type == METER_TYPE_UNKNOWN) {
+        // The cached meter and public key are used until the meter is detected
+        if(eichrecht.meter_cache_valid) {
+            eichrecht.init_done = true;
+        }
+
+        // Transactions that were accepted based on the cached meter wait for the meter detection
+        if((eichrecht.transaction_state > 0) && system_timer_is_time_elapsed_ms(eichrecht.transaction_start_time, EICHRECHT_METER_DETECT_TIMEOUT)) {
+            eichrecht_abort_transactions_without_meter();
+        }
+        return;
+    }
+
+    if(!eichrecht.meter_cache_valid) {
+        return;
+    }
+
+    // Meter detection found a different meter than the cached one.
+    // The cached public key is invalid, it is read again by eichrecht_iskra_init_tick if the new meter supports eichrecht.
+    if(!meter_supports_eichrecht() || (meter.type != eichrecht.meter_cache_type) || (meter.slave_address != eichrecht.meter_cache_address)) {
+        eichrecht.meter_cache_valid = false;
+        eichrecht.meter_cache_save  = true;
+        eichrecht.public_key_verified = false;
+        memset(eichrecht.public_key, 0, sizeof(eichrecht.public_key));
+
+        if(!meter_supports_eichrecht() && (eichrecht.queue_count > 0)) {
+            eichrecht_abort_transactions_without_meter();
+        }
+        eichrecht_read_public_key_again();
+        return;
+    }
+
+    // Same meter as cached: Verify the cached public key in the background,
+    // between transactions. A changed key is saved by eichrecht_iskra_init_tick.
+    if(!eichrecht.public_key_verified && eichrecht.init_done && (eichrecht.transaction_state == 0)) {
+        eichrecht_read_public_key_again();
+    }
+}
 
 void eichrecht_tick(void) {
     // Eichrecht support only on v4 hardware
@@ -173,10 +418,25 @@ void eichrecht_tick(void) {
         return;
     }
 
-    if(eichrecht.new_transaction) {
-        eichrecht_create_dataset();
-        eichrecht.new_transaction = false;
-        eichrecht.transaction_state = 1;
+    // Start next queued transaction
+    if((eichrecht.transaction_state == 0) && (eichrecht.queue_count > 0)) {
+        const EichrechtTransaction *t = &eichrecht.queue[eichrecht.queue_start];
+
+        eichrecht.transaction            = t->transaction;
+        eichrecht.transaction_sequence   = t->sequence;
+        eichrecht.unix_time              = t->unix_time;
+        eichrecht.utc_time_offset        = t->utc_time_offset;
+        eichrecht.signature_format       = t->signature_format;
+        eichrecht_create_dataset(t);
+        eichrecht.transaction_state      = 1;
+        eichrecht.transaction_start_time = system_timer_get_ms();
+    }
+
+    eichrecht_check_meter_cache();
+
+    if(eichrecht.meter_cache_save) {
+        eichrecht.meter_cache_save = false;
+        evse_save_config();
     }
 }
 
@@ -266,11 +526,11 @@ bool eichrecht_iskra_write_dataset(void) {
         }
 
         case 1: { // Write dataset
-            uint16_t length = MIN(240, strlen(eichrecht.dataset_in) - eichrecht.dataset_in_index);
+            uint16_t length = MIN(240, (uint16_t)(eichrecht.dataset_in_length - eichrecht.dataset_in_index));
             if((length & 1) == 1) {
                 length++; // Make even
             }
-            meter_write_string(meter.slave_address, 7100+1 + (eichrecht.dataset_in_index / 2), &eichrecht.dataset_in[eichrecht.dataset_in_index], length);
+            meter_write_string(meter.slave_address, 7100+1 + (eichrecht.dataset_in_index / 2), &arena.eichrecht.dataset_in[eichrecht.dataset_in_index], length);
 
             eichrecht.transaction_inner_state++;
             eichrecht.dataset_in_index += length;
@@ -281,7 +541,7 @@ bool eichrecht_iskra_write_dataset(void) {
 			bool ret = meter_get_write_register_response(MODBUS_FC_WRITE_MULTIPLE_REGISTERS);
 			if(ret) {
 				modbus_clear_request(&rs485);
-                if(eichrecht.dataset_in_index < strlen(eichrecht.dataset_in)) {
+                if(eichrecht.dataset_in_index < eichrecht.dataset_in_length) {
                     // More to write
                     eichrecht.transaction_inner_state = 1;
                 } else {
@@ -294,8 +554,7 @@ bool eichrecht_iskra_write_dataset(void) {
 
         case 3: { // Write dataset length
             MeterRegisterType payload;
-            payload.u16_single = strlen(eichrecht.dataset_in);
-            //payload.u16_single = 4;
+            payload.u16_single = eichrecht.dataset_in_length;
 
             meter_write_register(MODBUS_FC_WRITE_SINGLE_REGISTER, meter.slave_address, 7056+1, &payload);
             eichrecht.transaction_inner_state++;
@@ -390,7 +649,11 @@ bool eichrecht_iskra_get_signature_status(uint16_t *status) {
 bool eichrecht_iskra_read_dataset(void) {
     switch(eichrecht.transaction_inner_state) {
         case 0: {
-            memset(eichrecht.dataset_out, 0, sizeof(eichrecht.dataset_out));
+            // Wait until dataset and signature of previous transaction are sent
+            if (eichrecht.dataset_out_ready || eichrecht.signature_ready) {
+                return false;
+            }
+            memset(arena.eichrecht.dataset_out, 0, sizeof(arena.eichrecht.dataset_out));
             eichrecht.dataset_out_index = 0;
             eichrecht.dataset_out_length = 0;
             eichrecht.transaction_inner_state++;
@@ -429,7 +692,7 @@ bool eichrecht_iskra_read_dataset(void) {
                 length = 120;
             }
 
-            bool ret = meter_get_read_registers_response_string(MODBUS_FC_READ_HOLDING_REGISTERS, &eichrecht.dataset_out[eichrecht.dataset_out_index*2], length*2); // length here is in bytes
+            bool ret = meter_get_read_registers_response_string(MODBUS_FC_READ_HOLDING_REGISTERS, &arena.eichrecht.dataset_out[eichrecht.dataset_out_index*2], length*2); // length here is in bytes
             if(ret) {
                 modbus_clear_request(&rs485);
                 eichrecht.dataset_out_index += length;
@@ -440,6 +703,8 @@ bool eichrecht_iskra_read_dataset(void) {
                 } else {
                     // Done
                     eichrecht.transaction_inner_state = 0;
+                    eichrecht.dataset_out_sequence = eichrecht.transaction_sequence;
+                    eichrecht.dataset_out_sequence_pending = true;
                     eichrecht.dataset_out_ready = true;
                     return true;
                 }
@@ -457,7 +722,7 @@ bool eichrecht_iskra_read_signature(void) {
             if (eichrecht.dataset_out_ready) {
                 return false;
             }
-            memset(eichrecht.signature, 0, sizeof(eichrecht.signature));
+            memset(arena.eichrecht.signature, 0, sizeof(arena.eichrecht.signature));
             eichrecht.signature_index = 0;
             eichrecht.transaction_inner_state++;
             return false;
@@ -495,7 +760,7 @@ bool eichrecht_iskra_read_signature(void) {
                 length = 120;
             }
 
-            bool ret = meter_get_read_registers_response_string(MODBUS_FC_READ_HOLDING_REGISTERS, &eichrecht.signature[eichrecht.signature_index], length);
+            bool ret = meter_get_read_registers_response_string(MODBUS_FC_READ_HOLDING_REGISTERS, &arena.eichrecht.signature[eichrecht.signature_index], length);
             if(ret) {
                 modbus_clear_request(&rs485);
                 eichrecht.signature_index += length;
@@ -517,10 +782,10 @@ bool eichrecht_iskra_read_signature(void) {
     return false;
 }
 
-bool eichrecht_iskra_read_public_key(void) {
+bool eichrecht_iskra_read_public_key(char *public_key) {
     switch(eichrecht.transaction_inner_state) {
         case 0: {
-            memset(eichrecht.public_key, 0, sizeof(eichrecht.public_key));
+            memset(public_key, 0, 64);
             eichrecht.transaction_inner_state++;
             return false;
         }
@@ -532,7 +797,7 @@ bool eichrecht_iskra_read_public_key(void) {
         }
 
         case 2: { // read public key from holding registers
-            bool ret = meter_get_read_registers_response_string(MODBUS_FC_READ_HOLDING_REGISTERS, eichrecht.public_key, 64);
+            bool ret = meter_get_read_registers_response_string(MODBUS_FC_READ_HOLDING_REGISTERS, public_key, 64);
             if(ret) {
                 modbus_clear_request(&rs485);
                 eichrecht.transaction_inner_state = 0;
@@ -546,6 +811,11 @@ bool eichrecht_iskra_read_public_key(void) {
 }
 
 void eichrecht_reset_transaction(void) {
+    // Transaction in progress is done (or aborted), continue with next one in queue
+    if(eichrecht.transaction_state > 0) {
+        eichrecht_queue_pop();
+    }
+
     eichrecht.transaction_state = 0;
     eichrecht.transaction_inner_state = 0;
     eichrecht.transaction_state_time = 0;
@@ -596,8 +866,21 @@ bool eichrecht_iskra_tick_next_state(void) {
 
 // This is called by meter_iskra when eichrecht.init_done == false
 void eichrecht_iskra_init_tick(void) {
-    if(eichrecht_iskra_read_public_key()) {
-        eichrecht.init_done = true;
+    if(eichrecht_iskra_read_public_key(eichrecht.public_key_read)) {
+        // Verify cached meter and public key, update EEPROM if anything changed
+        if(!eichrecht.meter_cache_valid ||
+           (eichrecht.meter_cache_type != meter.type) ||
+           (eichrecht.meter_cache_address != meter.slave_address) ||
+           (memcmp(eichrecht.public_key, eichrecht.public_key_read, sizeof(eichrecht.public_key)) != 0)) {
+            memcpy(eichrecht.public_key, eichrecht.public_key_read, sizeof(eichrecht.public_key));
+            eichrecht.meter_cache_type    = (uint8_t)meter.type;
+            eichrecht.meter_cache_address = meter.slave_address;
+            eichrecht.meter_cache_valid   = true;
+            eichrecht.meter_cache_save    = true;
+        }
+
+        eichrecht.public_key_verified = true;
+        eichrecht.init_done           = true;
     }
 }
 
@@ -27,6 +27,22 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// Sizes of the cached dataset parts. Strings are escaped at set time,
+// so every user provided character can take up to two bytes in the dataset.
+#define EICHRECHT_DATASET_PREFIX_SIZE 208 // {"FV":..."GI":<82>..."GS":<50>..."IS":
+#define EICHRECHT_DATASET_SUFFIX_SIZE 96  // ","CF":<11>..."CT":<6>..."CI":<40>..."RD":[]}
+#define EICHRECHT_ID_ESCAPED_SIZE     81  // <80> + null-terminator
+
+// Sizes of the dataset and signature buffers in the arena (v4 only, see arena.h)
+#define EICHRECHT_DATASET_IN_SIZE     512
+#define EICHRECHT_DATASET_OUT_SIZE    1024
+#define EICHRECHT_SIGNATURE_SIZE      256
+
+// Time a transaction may wait for the meter to be detected after boot
+#define EICHRECHT_METER_DETECT_TIMEOUT 30000
+
+#define EICHRECHT_TRANSACTION_QUEUE_SIZE 4
+
 typedef struct {
     // General Information
     char gi[42]; // Gateway Identification
@@ -41,8 +57,33 @@ typedef struct {
     // Charge Point
     uint8_t ct; // Identification Type
     char ci[21]; // Identification
+
+    // Escaped identification data, used in per-transaction section
+    char id_escaped[EICHRECHT_ID_ESCAPED_SIZE];
+    uint8_t id_escaped_length;
+
+    // Cached static parts of dataset (GI, GS before and CF, CT, CI after per-transaction section)
+    char dataset_prefix[EICHRECHT_DATASET_PREFIX_SIZE];
+    uint16_t dataset_prefix_length;
+    char dataset_suffix[EICHRECHT_DATASET_SUFFIX_SIZE];
+    uint16_t dataset_suffix_length;
 } OCMF;
 
+typedef struct {
+    uint16_t sequence;
+    char transaction;
+    uint32_t unix_time;
+    int16_t utc_time_offset;
+    uint16_t signature_format;
+
+    // Snapshot of OCMF user assignment at the time the transaction was queued
+    bool is;
+    uint8_t if_[4];
+    uint8_t it;
+    char id_escaped[EICHRECHT_ID_ESCAPED_SIZE];
+    uint8_t id_escaped_length;
+} EichrechtTransaction;
+
 typedef struct {
     OCMF ocmf;
 
@@ -52,33 +93,61 @@ typedef struct {
     uint8_t transaction_inner_state;
     uint32_t transaction_state_time;
 
+    // Transactions are executed in order, the first queue entry is the one in progress
+    EichrechtTransaction queue[EICHRECHT_TRANSACTION_QUEUE_SIZE];
+    uint8_t queue_start;
+    uint8_t queue_count;
+    uint16_t sequence_next;
+
     char transaction;
+    uint16_t transaction_sequence;
     uint32_t unix_time;
     int16_t utc_time_offset;
     uint16_t signature_format;
-    bool new_transaction;
     uint32_t timeout_counter;
 
-    char dataset_in[512] __attribute__((aligned(4)));
+    // Dataset and signature buffers are in arena.eichrecht
     uint16_t dataset_in_index;
+    uint16_t dataset_in_length;
 
-    char dataset_out[1024] __attribute__((aligned(4)));
     uint16_t dataset_out_index;
     uint16_t dataset_out_length;
     bool dataset_out_ready;
     uint16_t dataset_out_chunk_offset;
+    uint16_t dataset_out_sequence;
+    bool dataset_out_sequence_pending; // Sequence callback not yet sent, holds back dataset and signature callbacks
 
-    char signature[256] __attribute__((aligned(4)));
     uint16_t signature_index;
     uint16_t signature_length;
     bool signature_ready;
     uint16_t signature_chunk_offset;
 
     char public_key[64] __attribute__((aligned(4)));
+    char public_key_read[64] __attribute__((aligned(4)));
+
+    // Last known meter (persisted in EEPROM together with public key).
+    // Used optimistically after boot until the meter is detected and the public key is read again.
+    // With a valid cache init_done is set immediately, the key is verified in the background.
+    bool meter_cache_valid;
+    bool public_key_verified; // Public key was read from the detected meter
+    uint8_t meter_cache_type;
+    uint8_t meter_cache_address;
+    bool meter_cache_save;
+    uint32_t transaction_start_time;
 } Eichrecht;
 
 extern Eichrecht eichrecht;
 
+bool eichrecht_set_gateway_identification(const char *gi, const uint8_t length);
+bool eichrecht_set_gateway_serial(const char *gs, const uint8_t length);
+bool eichrecht_set_user_assignment(const bool is, const uint8_t *if_, const uint8_t it, const char *id, const uint8_t length);
+bool eichrecht_set_charge_point(const uint8_t ct, const char *ci, const uint8_t length);
+
+bool eichrecht_is_supported(void);
+bool eichrecht_queue_transaction(const char transaction, const uint32_t unix_time, const int16_t utc_time_offset, const uint16_t signature_format, uint16_t *sequence);
+uint16_t eichrecht_get_expected_measurement_status(void);
+void eichrecht_create_dataset(const EichrechtTransaction *t);
+
 void eichrecht_init(void);
 void eichrecht_tick(void);
 void eichrecht_iskra_tick(void);
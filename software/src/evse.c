@@ -22,6 +22,7 @@
 #include "evse.h"
 
 #include <float.h>
+#include <string.h>
 
 #include "configs/config_evse.h"
 #include "bricklib2/hal/ccu4_pwm/ccu4_pwm.h"
@@ -36,6 +37,7 @@
 #include "iec61851.h"
 #include "lock.h"
 #include "led.h"
+#include "led_animation.h"
 #include "dc_fault.h"
 #include "communication.h"
 #include "charging_slot.h"
@@ -44,6 +46,12 @@
 #include "hardware_version.h"
 #include "phase_control.h"
 #include "ove_r37.h"
+#include "eichrecht.h"
+#include "hot_path.h"
+#include "warm_restart.h"
+#include "soft_timer.h"
+#include "digital_input.h"
+#include "cp_replay.h"
 
 #include "xmc_scu.h"
 #include "xmc_ccu4.h"
@@ -64,10 +72,38 @@ void __attribute__((optimize("-O3"))) __attribute__ ((section (".ram_code"))) ev
 #endif
 
 
-void evse_set_output(const float cp_duty_cycle, const bool contactor) {
+// Contactor state as seen by the charging logic. While a CP trace is replayed
+// the contactor GPIO is not switched, the state is kept by the replay instead.
+bool HOT_PATH evse_is_contactor_active(void) {
+#ifdef CP_TRACE_REPLAY
+	if(cp_replay.active) {
+		return cp_replay.contactor;
+	}
+#endif
+
+	return !XMC_GPIO_GetInput(EVSE_CONTACTOR_PIN); // Active low
+}
+
+static void evse_switch_contactor(const bool contactor) {
+#ifdef CP_TRACE_REPLAY
+	if(cp_replay.active) {
+		cp_replay.contactor = contactor;
+		return;
+	}
+#endif
+
+	if(contactor) {
+		XMC_GPIO_SetOutputLow(EVSE_CONTACTOR_PIN);
+	} else {
+		XMC_GPIO_SetOutputHigh(EVSE_CONTACTOR_PIN);
+	}
+}
+
+void HOT_PATH evse_set_output(const float cp_duty_cycle, const bool contactor) {
 	static uint32_t last_resistance_counter_on_off = 0;
 	static uint32_t last_resistance_counter_off_on = 0;
 	evse_set_cp_duty_cycle(cp_duty_cycle);
+	hot_path_output_set();
 
 	// If the contactor is to be enabled and the lock is currently
 	// not completely closed, we start the locking procedure and return.
@@ -81,7 +117,7 @@ void evse_set_output(const float cp_duty_cycle, const bool contactor) {
 	}
 #endif
 
-	if(((bool)!XMC_GPIO_GetInput(EVSE_CONTACTOR_PIN)) != contactor) {
+	if(evse_is_contactor_active() != contactor) {
 		if(((cp_duty_cycle == 0) || (cp_duty_cycle == 1000)) && (!contactor) && (last_resistance_counter_off_on == 0) && (last_resistance_counter_on_off == 0)) {
 			// If the duty cycle is set to either 0% or 100% PWM and the contactor is supposed to be turned off,
 			// it is possible that the WARP Charger wants to turn off the charging session while the car
@@ -95,20 +131,20 @@ void evse_set_output(const float cp_duty_cycle, const bool contactor) {
 			//       This function is only called in non-emergency cases.
 
 			if(adc_result.cp_pe_resistance <= iec61851_get_cp_resistance_threshold(IEC61851_STATE_B)) {
-				if(evse.contactor_turn_off_time == 0) {
-					evse.contactor_turn_off_time = system_timer_get_ms();
+				if(!soft_timer_is_running(&evse.contactor_turn_off_timer)) {
+					soft_timer_start(&evse.contactor_turn_off_timer, 6*1000);
 					return;
-				} else if(system_timer_is_time_elapsed_ms(evse.contactor_turn_off_time, 6*1000)) {
+				} else if(soft_timer_is_expired(&evse.contactor_turn_off_timer)) {
 					// The car has to respond within 3 seconds (see IEC 61851-1 standard table A.6 sequence 10.1).
 					// But according to Table A.6 sequence 10.2 the EVSE shall wait 6 seconds to turn the contactor off
 					// if the EV does not respond to the change in CP signal. So we wait for 6 seconds here.
-					evse.contactor_turn_off_time = 0;
+					soft_timer_stop(&evse.contactor_turn_off_timer);
 					evse.contactor_maybe_switched_under_load = true;
 				} else {
 					return;
 				}
 			} else {
-				evse.contactor_turn_off_time = 0;
+				soft_timer_stop(&evse.contactor_turn_off_timer);
 			}
 		}
 
@@ -171,11 +207,8 @@ void evse_set_output(const float cp_duty_cycle, const bool contactor) {
 
 			// Reset the "maybe switched under load" flag
 			evse.contactor_maybe_switched_under_load = false;
-
-			XMC_GPIO_SetOutputLow(EVSE_CONTACTOR_PIN);
-		} else {
-			XMC_GPIO_SetOutputHigh(EVSE_CONTACTOR_PIN);
 		}
+		evse_switch_contactor(contactor);
 
 		evse.last_contactor_switch = system_timer_get_ms();
 	}
@@ -267,6 +300,14 @@ void evse_load_config(void) {
 		ove_r37.reconnect_wait_s          = page[EVSE_CONFIG_OVE_R37_RECONNECT_WAIT_POS];
 	}
 
+	// Last known meter and its public key, used until the meter is detected again after boot
+	if((page[EVSE_CONFIG_MAGIC10_POS] == EVSE_CONFIG_MAGIC10) && (page[EVSE_CONFIG_METER_TYPE_POS] != METER_TYPE_UNKNOWN)) {
+		eichrecht.meter_cache_valid   = true;
+		eichrecht.meter_cache_type    = page[EVSE_CONFIG_METER_TYPE_POS];
+		eichrecht.meter_cache_address = page[EVSE_CONFIG_METER_ADDRESS_POS];
+		memcpy(eichrecht.public_key, &page[EVSE_CONFIG_PUBLIC_KEY_POS], sizeof(eichrecht.public_key));
+	}
+
 	// Handle charging slot defaults
 	EVSEChargingSlotDefault *slot_default = (EVSEChargingSlotDefault *)(&page[EVSE_CONFIG_SLOT_DEFAULT_POS]);
 	if(slot_default->magic == EVSE_CONFIG_SLOT_MAGIC) {
@@ -364,6 +405,15 @@ void evse_save_config(void) {
 	page[EVSE_CONFIG_OVE_R37_RECONNECT_WAIT_POS] = ove_r37.reconnect_wait_s;
 	page[EVSE_CONFIG_OVE_R37_START_DELAY_POS]    = 0;
 
+	page[EVSE_CONFIG_MAGIC10_POS]         = EVSE_CONFIG_MAGIC10;
+	if(eichrecht.meter_cache_valid) {
+		page[EVSE_CONFIG_METER_TYPE_POS]    = eichrecht.meter_cache_type;
+		page[EVSE_CONFIG_METER_ADDRESS_POS] = eichrecht.meter_cache_address;
+		memcpy(&page[EVSE_CONFIG_PUBLIC_KEY_POS], eichrecht.public_key, sizeof(eichrecht.public_key));
+	} else {
+		page[EVSE_CONFIG_METER_TYPE_POS]    = METER_TYPE_UNKNOWN;
+	}
+
 	// Handle charging slot defaults
 	EVSEChargingSlotDefault *slot_default = (EVSEChargingSlotDefault *)(&page[EVSE_CONFIG_SLOT_DEFAULT_POS]);
 	for(uint8_t i = 0; i < 18; i++) {
@@ -378,7 +428,10 @@ void evse_save_config(void) {
 void evse_factory_reset(void) {
 	uint32_t page[EEPROM_PAGE_SIZE/sizeof(uint32_t)] = {0};
 	bootloader_write_eeprom_page(EVSE_CONFIG_PAGE, page);
+	bootloader_write_eeprom_page(LED_ANIMATION_PAGE, page); // Persistent LED animation slots
 
+	// Configuration is gone, don't resume with the old state
+	warm_restart_invalidate();
 	NVIC_SystemReset();
 }
 
@@ -681,35 +734,22 @@ void evse_v3_init_cp_pwm(void) {
 //	NVIC_EnableIRQ(30);
 }
 
+// The shutdown input is debounced (10ms) by the digital input integrator.
+// If the sampling stalled the input value is unknown, this is handled as shutdown.
 bool evse_is_shutdown(void) {
-	static bool last_return = false;
-	static bool change_time = 0;
+	if(digital_input_is_stalled()) {
+		return true;
+	}
+
+	const bool input = digital_input_get_value(DIGITAL_INPUT_SHUTDOWN);
 
-	bool new_return = false;
 	if((evse.shutdown_input_configuration == EVSE_V2_SHUTDOWN_INPUT_SHUTDOWN_ON_CLOSE) || (evse.shutdown_input_configuration == EVSE_V2_SHUTDOWN_INPUT_4200_WATT_ON_CLOSE)) {
-		if(!XMC_GPIO_GetInput(EVSE_SHUTDOWN_PIN)) {
-			new_return = true;
-		}
+		return !input;
 	} else if((evse.shutdown_input_configuration == EVSE_V2_SHUTDOWN_INPUT_SHUTDOWN_ON_OPEN) || (evse.shutdown_input_configuration == EVSE_V2_SHUTDOWN_INPUT_4200_WATT_ON_OPEN)) {
-		if(XMC_GPIO_GetInput(EVSE_SHUTDOWN_PIN)) {
-			new_return = true;
-		}
-	}
-
-	// 10ms debounce
-	if((new_return != last_return) && (change_time = 0)) {
-		change_time = system_timer_get_ms();
-		return last_return;
-	} else if(new_return != last_return) {
-		if(system_timer_is_time_elapsed_ms(change_time, 10)) {
-			last_return = new_return;
-			change_time = 0;
-		} else {
-			return last_return;
-		}
+		return input;
 	}
 
-	return new_return;
+	return false;
 }
 
 void evse_cp_connect(void) {
@@ -790,7 +830,7 @@ void evse_init(void) {
 	evse.factory_reset_time = 0;
 	evse.car_stopped_charging = false;
 	evse.communication_watchdog_time = 0;
-	evse.contactor_turn_off_time = 0;
+	soft_timer_stop(&evse.contactor_turn_off_timer);
 	evse.last_duty_cycle_change_time = 0;
 }
 
@@ -816,8 +856,8 @@ void evse_tick_debug(void) {
 }
 
 void evse_tick(void) {
-	if(evse.startup_time != 0 && !system_timer_is_time_elapsed_ms(evse.startup_time, 1000)) {
-		// Wait for 1s so everything can start/boot properly
+	if(evse.startup_time != 0 && !system_timer_is_time_elapsed_ms(evse.startup_time, warm_restart.resume ? WARM_RESTART_STARTUP_HOLD : 1000)) {
+		// Wait for 1s so everything can start/boot properly (shorter after a warm restart)
 		return;
 	}
 
@@ -832,6 +872,7 @@ void evse_tick(void) {
 		evse.startup_time = 0;
 
 		// Start a dc fault module calibration on startup
+		// (after a warm restart in state B/C it is deferred until the next state A)
 		dc_fault.calibration_start = true;
 
 		// Return to make sure that the dc fault tick is called at least once before the iec61851 tick.
@@ -848,6 +889,8 @@ void evse_tick(void) {
 	if((evse.communication_watchdog_time != 0) && system_timer_is_time_elapsed_ms(evse.communication_watchdog_time, 1000*60*5)) {
 		// Only restart EVSE if brick-communication-watchdog triggers if no car is connected
 		if(iec61851.state == IEC61851_STATE_A) {
+			// Cold start, the slots set by the Brick (load management, external) must not survive
+			warm_restart_invalidate();
 			NVIC_SystemReset();
 		}
 	}
@@ -26,6 +26,7 @@
 #include <stdbool.h>
 
 #include "iec61851.h"
+#include "soft_timer.h"
 
 #define EVSE_CP_PWM_PERIOD    48000 // 1kHz
 #define EVSE_BOOST_MODE_US    4     // 1 us = 0.06A
@@ -69,6 +70,10 @@
 #define EVSE_CONFIG_OVE_R37_RECONNECT_WAIT_POS 25
 #define EVSE_CONFIG_OVE_R37_START_DELAY_POS    26
 #define EVSE_CONFIG_MAGIC9_POS                 27
+#define EVSE_CONFIG_METER_TYPE_POS             28
+#define EVSE_CONFIG_METER_ADDRESS_POS          29
+#define EVSE_CONFIG_MAGIC10_POS                30
+#define EVSE_CONFIG_PUBLIC_KEY_POS             31 // 16 words (64 bytes)
 #define EVSE_CONFIG_SLOT_DEFAULT_POS           48
 
 typedef struct {
@@ -86,6 +91,7 @@ typedef struct {
 #define EVSE_CONFIG_MAGIC7              0x92345678
 #define EVSE_CONFIG_MAGIC8              0x23456742
 #define EVSE_CONFIG_MAGIC9              0x34567893
+#define EVSE_CONFIG_MAGIC10             0x45678934
 #define EVSE_CONFIG_SLOT_MAGIC          0x62870616
 
 #define EVSE_STORAGE_PAGES              16
@@ -116,7 +122,7 @@ typedef struct {
 
 	uint32_t communication_watchdog_time;
 
-	uint32_t contactor_turn_off_time;
+	SoftTimer contactor_turn_off_timer;
 
 	bool boost_mode_enabled;
 
@@ -132,6 +138,7 @@ extern EVSE evse;
 void evse_cp_connect(void);
 void evse_cp_disconnect(void);
 bool evse_is_cp_connected(void);
+bool evse_is_contactor_active(void);
 bool evse_is_shutdown(void);
 void evse_save_config(void);
 void evse_set_output(const float cp_duty_cycle, const bool contactor);
@@ -26,6 +26,7 @@
 
 #include "configs/config_frequency.h"
 #include "hardware_version.h"
+#include "arena.h"
 #include "bricklib2/hal/system_timer/system_timer.h"
 #include "bricklib2/utility/util_definitions.h"
 
@@ -34,28 +35,171 @@
 #include "xmc_scu.h"
 
 #include <string.h>
+#include <math.h>
 
 Frequency frequency;
 
-// ERU0_SR3 -> IRQ6: Called on each rising edge of the 50 Hz PE check signal
-void __attribute__((optimize("-O3"))) IRQ_Hdlr_6(void) {
-	const uint16_t current = (uint16_t)XMC_CCU4_SLICE_GetTimerValue(FREQUENCY_TIMER_SLICE);
+_Static_assert(FREQUENCY_BUFFER_SIZE == 256, "buffer_index is an uint8_t and has to wrap at FREQUENCY_BUFFER_SIZE");
+_Static_assert(SPSC_QUEUE_IS_POWER_OF_TWO(FREQUENCY_EDGE_QUEUE_SIZE), "Edge queue size has to be a power of two");
 
-	// Unsigned 16-bit subtraction handles timer wrap-around correctly
-	const uint16_t delta = current - frequency.last_timer_value;
+static inline void frequency_compare_add(FrequencyCompare *compare, const uint16_t delta) {
+	if((delta >= FREQUENCY_MIN_TICKS) && (delta <= FREQUENCY_MAX_TICKS)) {
+		const int32_t diff = (int32_t)delta - (int32_t)FREQUENCY_NOMINAL_TICKS;
+		compare->count++;
+		compare->sum    += diff;
+		compare->sum_sq += (uint32_t)(diff*diff);
+	}
+}
+
+// Accounting of one edge, called from frequency_tick() for each edge in the queue
+static void frequency_handle_edge(const uint16_t delta_timer_read, const uint16_t delta_capture) {
+	const bool capture_new = delta_capture != 0;
+
+	frequency_compare_add(&frequency.compare[FREQUENCY_SOURCE_TIMER_READ], delta_timer_read);
+	if(capture_new) {
+		frequency_compare_add(&frequency.compare[FREQUENCY_SOURCE_CAPTURE], delta_capture);
+	} else {
+		frequency.capture_missed++;
+	}
+
+	uint16_t delta = delta_timer_read;
+	if(frequency.source == FREQUENCY_SOURCE_CAPTURE) {
+		delta = delta_capture;
+	}
 
 	// Only accept periods in the plausible range
 	if((delta >= FREQUENCY_MIN_TICKS) && (delta <= FREQUENCY_MAX_TICKS)) {
-		frequency.period_buffer[frequency.buffer_index] = delta;
-		frequency.buffer_index++;
+		const uint8_t index     = frequency.buffer_index;
+		const uint16_t evicted  = arena.frequency.period_buffer[index];
+		const uint16_t recent   = arena.frequency.period_buffer[(uint8_t)(index - frequency.rocof_window)];
+		const uint16_t previous = arena.frequency.period_buffer[(uint8_t)(index - 2*frequency.rocof_window)];
+
+		// Running sums: Subtract the evicted period and add the new one
+		frequency.period_sum         = frequency.period_sum - evicted + delta;
+		frequency.period_sum_sq      = frequency.period_sum_sq - (uint32_t)evicted*evicted + (uint32_t)delta*delta;
+		frequency.rocof_sum_recent   = frequency.rocof_sum_recent - recent + delta;
+		frequency.rocof_sum_previous = frequency.rocof_sum_previous - previous + recent;
+
+		arena.frequency.period_buffer[index] = delta;
+		frequency.buffer_index++; // Wraps at FREQUENCY_BUFFER_SIZE
+
+		if(frequency.period_count < FREQUENCY_BUFFER_SIZE) {
+			frequency.period_count++;
+		}
+		frequency.period_total++;
+
+		if(delta < frequency.period_min) {
+			frequency.period_min = delta;
+		}
+		if(delta > frequency.period_max) {
+			frequency.period_max = delta;
+		}
+	} else {
+		frequency.period_rejected++;
 	}
+}
+
+// ERU0_SR3 -> IRQ6: Called on each rising edge of the 50 Hz PE check signal.
+// Only takes the timer values, the accounting is done in frequency_tick().
+void __attribute__((optimize("-O3"))) IRQ_Hdlr_6(void) {
+	const uint16_t current = (uint16_t)XMC_CCU4_SLICE_GetTimerValue(FREQUENCY_TIMER_SLICE);
 
+	// Unsigned 16-bit subtraction handles timer wrap-around correctly
+	const uint16_t delta_timer_read = current - frequency.last_timer_value;
 	frequency.last_timer_value = current;
+
+	// The same edge latches the timer into capture register 1, the previous
+	// capture is moved to capture register 0. The period is measured
+	// completely in hardware and does not depend on IRQ latency.
+	const uint32_t capture1      = XMC_CCU4_SLICE_GetCaptureRegisterValue(FREQUENCY_TIMER_SLICE, 1);
+	const uint32_t capture0      = XMC_CCU4_SLICE_GetCaptureRegisterValue(FREQUENCY_TIMER_SLICE, 0);
+	const bool capture_new       = (capture1 & CCU4_CC4_CV_FFL_Msk) != 0;
+	const uint16_t delta_capture = capture_new ? (uint16_t)(capture1 - capture0) : 0; // 0 = no new capture
+
+	spsc_queue_push(&frequency.edge_queue, FREQUENCY_EDGE(delta_timer_read, delta_capture));
 	frequency.last_edge_ms = system_timer_get_ms();
 }
 
+static uint32_t frequency_ticks_to_ns(const uint32_t ticks) {
+	return (uint32_t)(((uint64_t)ticks * 1000000000ULL) / FREQUENCY_TIMER_CLOCK_HZ);
+}
+
+void frequency_set_rocof_window(const uint8_t window) {
+	if(!hardware_version.is_v3) {
+		frequency.rocof_window = window;
+		return;
+	}
+
+	// Recalculate the window sums from the period buffer
+	frequency.rocof_window       = window;
+	frequency.rocof_sum_recent   = 0;
+	frequency.rocof_sum_previous = 0;
+	for(uint16_t i = 1; i <= window; i++) {
+		frequency.rocof_sum_recent   += arena.frequency.period_buffer[(uint8_t)(frequency.buffer_index - i)];
+		frequency.rocof_sum_previous += arena.frequency.period_buffer[(uint8_t)(frequency.buffer_index - i - window)];
+	}
+	frequency.rocof_valid = false;
+}
+
+// Returns min/max period since the last call
+void frequency_get_period_min_max(uint32_t *min_ns, uint32_t *max_ns) {
+	if(!hardware_version.is_v3) {
+		*min_ns = 0;
+		*max_ns = 0;
+		return;
+	}
+
+	const uint16_t min = frequency.period_min;
+	const uint16_t max = frequency.period_max;
+	frequency.period_min = UINT16_MAX;
+	frequency.period_max = 0;
+
+	if(min > max) {
+		*min_ns = 0;
+		*max_ns = 0;
+	} else {
+		*min_ns = frequency_ticks_to_ns(min);
+		*max_ns = frequency_ticks_to_ns(max);
+	}
+}
+
+// Returns mean and standard deviation of the periods measured by the given source since the last call
+void frequency_get_compare(const uint8_t source, uint32_t *count, uint32_t *mean_ns, uint32_t *standard_deviation_ns) {
+	*count                 = 0;
+	*mean_ns               = 0;
+	*standard_deviation_ns = 0;
+
+	if(!hardware_version.is_v3 || (source >= FREQUENCY_SOURCE_NUM)) {
+		return;
+	}
+
+	const FrequencyCompare compare = frequency.compare[source];
+	memset(&frequency.compare[source], 0, sizeof(FrequencyCompare));
+
+	if(compare.count == 0) {
+		return;
+	}
+
+	const float n        = (float)compare.count;
+	const float mean     = (float)compare.sum / n;
+	const float variance = (float)compare.sum_sq / n - mean*mean;
+	const float tick_ns  = 1000000000.0f / (float)FREQUENCY_TIMER_CLOCK_HZ;
+
+	*count                 = compare.count;
+	*mean_ns               = (uint32_t)(((float)FREQUENCY_NOMINAL_TICKS + mean) * tick_ns);
+	*standard_deviation_ns = variance > 0.0f ? (uint32_t)(sqrtf(variance) * tick_ns) : 0;
+}
+
 void frequency_init(void) {
 	memset(&frequency, 0, sizeof(Frequency));
+	frequency.period_min   = UINT16_MAX;
+	frequency.rocof_window = FREQUENCY_ROCOF_WINDOW_DEFAULT;
+#ifdef FREQUENCY_CAPTURE
+	frequency.source       = FREQUENCY_SOURCE_CAPTURE;
+#else
+	frequency.source       = FREQUENCY_SOURCE_TIMER_READ;
+#endif
+	spsc_queue_init(&frequency.edge_queue, arena.frequency.edge_queue_buffer, FREQUENCY_EDGE_QUEUE_SIZE);
 
 	// Frequency measurement only available on V3
 	if(!hardware_version.is_v3) {
@@ -65,29 +209,37 @@ void frequency_init(void) {
 	XMC_CCU4_Init(FREQUENCY_TIMER_MODULE, XMC_CCU4_SLICE_MCMS_ACTION_TRANSFER_PR_CR);
 	XMC_CCU4_StartPrescaler(FREQUENCY_TIMER_MODULE);
 
-	const XMC_CCU4_SLICE_COMPARE_CONFIG_t timer_config = {
-		.timer_mode          = XMC_CCU4_SLICE_TIMER_COUNT_MODE_EA,
-		.monoshot            = false,
-		.shadow_xfer_clear   = 0,
-		.dither_timer_period = 0,
-		.dither_duty_cycle   = 0,
+	// Free running timer in capture mode. The timer value is read in the IRQ
+	// (FREQUENCY_SOURCE_TIMER_READ) and latched on the PE check edge by the
+	// capture logic (FREQUENCY_SOURCE_CAPTURE).
+	const XMC_CCU4_SLICE_CAPTURE_CONFIG_t capture_config = {
+		.fifo_enable         = false,
+		.timer_clear_mode    = XMC_CCU4_SLICE_TIMER_CLEAR_MODE_NEVER,
+		.same_event          = false,
+		.ignore_full_flag    = true,
 		.prescaler_mode      = XMC_CCU4_SLICE_PRESCALER_MODE_NORMAL,
-		.mcm_enable          = 0,
 		.prescaler_initval   = FREQUENCY_TIMER_PRESCALER,
 		.float_limit         = 0,
-		.dither_limit        = 0,
-		.passive_level       = XMC_CCU4_SLICE_OUTPUT_PASSIVE_LEVEL_LOW,
 		.timer_concatenation = 0
 	};
 
-	XMC_CCU4_SLICE_CompareInit(FREQUENCY_TIMER_SLICE, &timer_config);
+	const XMC_CCU4_SLICE_EVENT_CONFIG_t event_config = {
+		.duration     = XMC_CCU4_SLICE_EVENT_FILTER_DISABLED,
+		.edge         = XMC_CCU4_SLICE_EVENT_EDGE_SENSITIVITY_RISING_EDGE,
+		.level        = XMC_CCU4_SLICE_EVENT_LEVEL_SENSITIVITY_ACTIVE_HIGH,
+		.mapped_input = FREQUENCY_CAPTURE_INPUT
+	};
+
+	XMC_CCU4_SLICE_CaptureInit(FREQUENCY_TIMER_SLICE, &capture_config);
+	XMC_CCU4_SLICE_ConfigureEvent(FREQUENCY_TIMER_SLICE, XMC_CCU4_SLICE_EVENT_0, &event_config);
+	XMC_CCU4_SLICE_Capture0Config(FREQUENCY_TIMER_SLICE, XMC_CCU4_SLICE_EVENT_0);
 	XMC_CCU4_SLICE_SetTimerPeriodMatch(FREQUENCY_TIMER_SLICE, 0xFFFFU);
 	XMC_CCU4_EnableShadowTransfer(FREQUENCY_TIMER_MODULE, XMC_CCU4_SHADOW_TRANSFER_SLICE_3 | XMC_CCU4_SHADOW_TRANSFER_PRESCALER_SLICE_3);
 	XMC_CCU4_EnableClock(FREQUENCY_TIMER_MODULE, (uint8_t)FREQUENCY_TIMER_SLICE_NUM);
 	XMC_CCU4_SLICE_StartTimer(FREQUENCY_TIMER_SLICE);
 
 	// ETL3 Input B1 = P2_8, source = B only, detect rising edge
-	// Output trigger to OGU3, which generates service request
+	// Output trigger to OGU3, which generates service request and the capture event
 	XMC_ERU_ETL_SetInput(FREQUENCY_ERU, FREQUENCY_ERU_ETL_CHANNEL, XMC_ERU_ETL_INPUT_A0, FREQUENCY_ERU_INPUT_B);
 	XMC_ERU_ETL_SetSource(FREQUENCY_ERU, FREQUENCY_ERU_ETL_CHANNEL, XMC_ERU_ETL_SOURCE_B);
 	XMC_ERU_ETL_SetEdgeDetection(FREQUENCY_ERU, FREQUENCY_ERU_ETL_CHANNEL, XMC_ERU_ETL_EDGE_DETECTION_RISING);
@@ -99,9 +251,6 @@ void frequency_init(void) {
 	NVIC_SetPriority((IRQn_Type)FREQUENCY_IRQ_NUM, 3U);
 	XMC_SCU_SetInterruptControl(FREQUENCY_IRQ_NUM, FREQUENCY_IRQCTRL);
 	NVIC_EnableIRQ((IRQn_Type)FREQUENCY_IRQ_NUM);
-
-	frequency.start_ms = system_timer_get_ms();
-	frequency.start_ms = MIN(1, frequency.start_ms);
 }
 
 void frequency_tick(void) {
@@ -109,28 +258,50 @@ void frequency_tick(void) {
 		return;
 	}
 
-	// Wait for 6s after start to be sure that full buffer is read (have to wait for at least 255/50 = 5.1s).
-	if((frequency.start_ms != 0) && system_timer_is_time_elapsed_ms(frequency.start_ms, 6*1000)) {
-		frequency.start_ms = 0;
-		return;
+	uint32_t edges[FREQUENCY_EDGE_QUEUE_SIZE];
+	const uint16_t count = spsc_queue_drain(&frequency.edge_queue, edges, FREQUENCY_EDGE_QUEUE_SIZE);
+	for(uint16_t i = 0; i < count; i++) {
+		frequency_handle_edge(FREQUENCY_EDGE_TIMER_READ(edges[i]), FREQUENCY_EDGE_CAPTURE(edges[i]));
 	}
 
 	// Check for timeout (PE disconnected or no 50 Hz present)
 	if((frequency.last_edge_ms != 0) && system_timer_is_time_elapsed_ms(frequency.last_edge_ms, FREQUENCY_TIMEOUT_MS)) {
-		frequency.valid = false;
+		frequency.valid       = false;
+		frequency.rocof_valid = false;
 		return;
 	}
 
-	// Update once per 0.5s
-	if(system_timer_is_time_elapsed_ms(frequency.last_update, 500)) {
-		uint32_t sum = 0;
-		for(uint16_t i = 0; i < FREQUENCY_BUFFER_SIZE; i++) {
-			sum += frequency.period_buffer[i];
-		}
+	// Update on every new period, frequency_handle_edge() maintains the sums
+	if(frequency.period_total == frequency.last_period_total) {
+		return;
+	}
 
-		frequency.frequency = ((((uint64_t)(FREQUENCY_MILLIHZ_FACTOR))*((uint64_t)FREQUENCY_BUFFER_SIZE)) / ((uint64_t)sum));
-		frequency.valid = true;
+	const uint32_t sum          = frequency.period_sum;
+	const uint64_t sum_sq       = frequency.period_sum_sq;
+	const uint32_t sum_recent   = frequency.rocof_sum_recent;
+	const uint32_t sum_previous = frequency.rocof_sum_previous;
+	const uint8_t window        = frequency.rocof_window;
+	frequency.last_period_total = frequency.period_total;
 
-		frequency.last_update = system_timer_get_ms();
+	// The buffer has to be full once (have to wait for at least 256/50 = 5.1s)
+	if(frequency.period_count < FREQUENCY_BUFFER_SIZE) {
+		return;
 	}
+
+	frequency.frequency = ((((uint64_t)(FREQUENCY_MILLIHZ_FACTOR))*((uint64_t)FREQUENCY_BUFFER_SIZE)) / ((uint64_t)sum));
+	frequency.valid = true;
+
+	// var = (N*sum(x^2) - sum(x)^2) / N^2, converted from ticks^2 to ns^2.
+	// The numerator is clamped to avoid overflow, the result saturates anyway.
+	const uint64_t ns2_per_tick2  = 1000000000000000000ULL / ((uint64_t)FREQUENCY_TIMER_CLOCK_HZ*FREQUENCY_TIMER_CLOCK_HZ);
+	const uint64_t variance_num   = (uint64_t)FREQUENCY_BUFFER_SIZE*sum_sq - (uint64_t)sum*sum;
+	const uint64_t variance_ns    = MIN(variance_num, UINT64_MAX / ns2_per_tick2) * ns2_per_tick2 / ((uint64_t)FREQUENCY_BUFFER_SIZE*FREQUENCY_BUFFER_SIZE);
+	frequency.period_variance     = (uint32_t)MIN(variance_ns, UINT32_MAX);
+
+	// ROCOF: Difference of the mean frequency of both windows divided by
+	// the time between the centers of the windows
+	const int64_t f_recent   = (int64_t)(((uint64_t)FREQUENCY_MILLIHZ_FACTOR*window) / sum_recent);
+	const int64_t f_previous = (int64_t)(((uint64_t)FREQUENCY_MILLIHZ_FACTOR*window) / sum_previous);
+	frequency.rocof          = (int32_t)(((f_recent - f_previous) * 2 * (int64_t)FREQUENCY_TIMER_CLOCK_HZ) / (int64_t)(sum_recent + sum_previous));
+	frequency.rocof_valid    = true;
 }
@@ -26,29 +26,80 @@
 #include <stdbool.h>
 
 #include "configs/config_frequency.h"
+#include "spsc_queue.h"
 
-#define FREQUENCY_BUFFER_SIZE 256
+#define FREQUENCY_BUFFER_SIZE 256 // Indexed with uint8_t buffer_index
 #define FREQUENCY_TIMEOUT_MS  1000
 
+// Edges from the IRQ to frequency_tick(), 16 edges = 320ms at 50 Hz.
+// An edge is the timer read delta (low 16 bits) and the capture delta (high 16 bits, 0 = no new capture).
+#define FREQUENCY_EDGE_QUEUE_SIZE 16
+#define FREQUENCY_EDGE(timer_read, capture) ((uint32_t)(timer_read) | ((uint32_t)(capture) << 16))
+#define FREQUENCY_EDGE_TIMER_READ(edge)     ((uint16_t)((edge) & 0xFFFF))
+#define FREQUENCY_EDGE_CAPTURE(edge)        ((uint16_t)((edge) >> 16))
+
 // Sanity bounds for a single period measurement (reject glitches / harmonics)
 #define FREQUENCY_MIN_TICKS   20000
 #define FREQUENCY_MAX_TICKS   50000
 
+// ROCOF is calculated from the mean frequency of the last window of periods
+// compared to the window of periods before it
+#define FREQUENCY_ROCOF_WINDOW_DEFAULT 25 // 0.5s
+#define FREQUENCY_ROCOF_WINDOW_MIN     1
+#define FREQUENCY_ROCOF_WINDOW_MAX     (FREQUENCY_BUFFER_SIZE/2)
+
+// Period measurement source. Both are always measured for comparison, the
+// capture is only used for the frequency with the FREQUENCY_CAPTURE option
+// (capture input routing not verified on V3 hardware yet).
+#define FREQUENCY_SOURCE_TIMER_READ    0 // Timer value read in IRQ (includes IRQ latency jitter)
+#define FREQUENCY_SOURCE_CAPTURE       1 // Timer value latched by CCU4 capture in hardware
+#define FREQUENCY_SOURCE_NUM           2
+
+// Statistics of both sources for comparison, relative to FREQUENCY_NOMINAL_TICKS
 typedef struct {
-	uint16_t period_buffer[FREQUENCY_BUFFER_SIZE];
-	uint8_t buffer_index;
+	uint32_t count;
+	int64_t sum;
+	uint64_t sum_sq;
+} FrequencyCompare;
+
+typedef struct {
+	// Written by IRQ
+	SPSCQueue edge_queue;        // Buffer is in arena.frequency
 	uint16_t last_timer_value;
+	uint32_t last_edge_ms;
 
-	uint32_t frequency; // Measured mains frequency in 1/1000 Hz (e.g. 50000 = 50.00 Hz)
-	bool valid;         // True once enough samples have been collected and signal is present
+	// Period buffer is in arena.frequency
+	uint8_t buffer_index;
 
-	uint32_t last_edge_ms;
-	uint32_t last_update;
-	uint32_t start_ms;
+	// Maintained by frequency_handle_edge()
+	uint32_t period_sum;         // Running sum of period_buffer
+	uint64_t period_sum_sq;      // Running sum of squares of period_buffer
+	uint16_t period_count;       // Number of filled entries in period_buffer
+	uint32_t period_total;       // Number of accepted periods since start
+	uint32_t period_rejected;    // Number of periods rejected by FREQUENCY_MIN_TICKS/FREQUENCY_MAX_TICKS
+	uint16_t period_min;         // Since last read
+	uint16_t period_max;         // Since last read
+	uint8_t rocof_window;        // In periods
+	uint32_t rocof_sum_recent;   // Sum of the last rocof_window periods
+	uint32_t rocof_sum_previous; // Sum of the rocof_window periods before
+	uint32_t capture_missed;     // Edges without new capture value
+	FrequencyCompare compare[FREQUENCY_SOURCE_NUM];
+	uint8_t source;
+
+	uint32_t frequency;       // Measured mains frequency in 1/1000 Hz (e.g. 50000 = 50.00 Hz)
+	bool valid;               // True once enough samples have been collected and signal is present
+	int32_t rocof;            // Rate of change of frequency in 1/1000 Hz per second
+	bool rocof_valid;
+	uint32_t period_variance; // Variance of the periods in period_buffer in ns^2
+
+	uint32_t last_period_total;
 } Frequency;
 
 extern Frequency frequency;
 
+void frequency_set_rocof_window(const uint8_t window);
+void frequency_get_period_min_max(uint32_t *min_ns, uint32_t *max_ns);
+void frequency_get_compare(const uint8_t source, uint32_t *count, uint32_t *mean_ns, uint32_t *standard_deviation_ns);
 void frequency_init(void);
 void frequency_tick(void);
 
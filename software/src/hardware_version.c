@@ -27,6 +27,9 @@
 #include "configs/config_dc_fault.h"
 #include "configs/config_evse.h"
 
+#include "arena.h"
+#include "warm_restart.h"
+
 #include "bricklib2/hal/system_timer/system_timer.h"
 
 #include "xmc_gpio.h"
@@ -63,11 +66,14 @@ static const HardwareVersionPortPin hardware_version_v3[] = {
 	{EVSE_V3_PHASE_SWITCH_PIN}
 };
 
+#ifdef HARDWARE_VERSION_FIXED
+// Image for a single hardware version: hardware_version is a constant (see hardware_version.h)
+static bool hardware_version_image_mismatch = false;
+#else
 HardwareVersion hardware_version;
+#endif
 
-void hardware_version_init(void) {
-	memset(&hardware_version, 0, sizeof(HardwareVersion));
-
+static void hardware_version_detect(HardwareVersion *detected) {
 	const XMC_GPIO_CONFIG_t pin_config_input_down = {
 		.mode             = XMC_GPIO_MODE_INPUT_PULL_DOWN,
 		.input_hysteresis = XMC_GPIO_INPUT_HYSTERESIS_STANDARD
@@ -88,22 +94,50 @@ void hardware_version_init(void) {
 
 	// V2 = floating
 	if (pull_up && !pull_down) {
-		hardware_version.is_v2 = true;
-		hardware_version.is_v3 = false;
-		hardware_version.is_v4 = false;
+		detected->is_v2 = true;
 	// v3 = pull low
 	} else if(!pull_up && !pull_down) {
-		hardware_version.is_v2 = false;
-		hardware_version.is_v3 = true;
-		hardware_version.is_v4 = false;
+		detected->is_v3 = true;
 	// v4 = pull high
 	} else if(pull_up && pull_down) {
-		hardware_version.is_v2 = false;
-		hardware_version.is_v3 = false;
-		hardware_version.is_v4 = true;
+		detected->is_v4 = true;
 	}
 }
 
+void hardware_version_init(void) {
+	HardwareVersion detected;
+	memset(&detected, 0, sizeof(HardwareVersion));
+
+	// After a warm restart the hardware version is known, skip the 100ms detection
+	if(warm_restart.resume) {
+		detected.is_v2 = warm_restart.record.hardware_version == 2;
+		detected.is_v3 = warm_restart.record.hardware_version == 3;
+		detected.is_v4 = warm_restart.record.hardware_version == 4;
+	} else {
+		hardware_version_detect(&detected);
+	}
+
+#ifdef HARDWARE_VERSION_FIXED
+	hardware_version_image_mismatch = (detected.is_v2 != hardware_version.is_v2) ||
+	                                  (detected.is_v3 != hardware_version.is_v3) ||
+	                                  (detected.is_v4 != hardware_version.is_v4);
+#else
+	hardware_version = detected;
+#endif
+
+	// The arena is used by the hardware version specific subsystems
+	arena_init();
+}
+
+// False if this is an image for a single hardware version and it runs on another one
+bool hardware_version_is_image_compatible(void) {
+#ifdef HARDWARE_VERSION_FIXED
+	return !hardware_version_image_mismatch;
+#else
+	return true;
+#endif
+}
+
 XMC_GPIO_PORT_t *hardware_version_get_port(const uint8_t pin_num) {
 	if(hardware_version.is_v2) {
 		return hardware_version_v2[pin_num].port;
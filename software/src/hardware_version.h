@@ -37,9 +37,25 @@ typedef struct {
 	uint8_t pin;
 } HardwareVersionPortPin;
 
+#ifdef HARDWARE_VERSION_FIXED
+// Image for a single hardware version (cmake -DHARDWARE_VERSION=2/3/4).
+// All hardware version checks are folded to constants and the code
+// for the other hardware versions is removed by the compiler.
+#if (HARDWARE_VERSION_FIXED != 2) && (HARDWARE_VERSION_FIXED != 3) && (HARDWARE_VERSION_FIXED != 4)
+#error "HARDWARE_VERSION_FIXED has to be 2, 3 or 4"
+#endif
+
+static const HardwareVersion hardware_version = {
+	.is_v2 = HARDWARE_VERSION_FIXED == 2,
+	.is_v3 = HARDWARE_VERSION_FIXED == 3,
+	.is_v4 = HARDWARE_VERSION_FIXED == 4
+};
+#else
 extern HardwareVersion hardware_version;
+#endif
 
 void hardware_version_init(void);
+bool hardware_version_is_image_compatible(void);
 XMC_GPIO_PORT_t *hardware_version_get_port(const uint8_t pin_num);
 uint8_t hardware_version_get_pin(const uint8_t pin_num);
 #endif
@@ -0,0 +1,105 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * hot_path.c: Optional RAM execution of the ADC/IEC61851 hot path and its timing
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "hot_path.h"
+
+#include "bricklib2/hal/system_timer/system_timer.h"
+
+#include "xmc_device.h"
+
+#include <string.h>
+
+#ifdef HOT_PATH_STATISTICS
+HotPath hot_path;
+#endif
+
+// CPU cycle timestamp from system timer and SysTick counter.
+// Wraps after 2^32 cycles (~89s at 48MHz), only use it for short durations.
+uint32_t HOT_PATH hot_path_get_cycles(void) {
+	uint32_t ms;
+	uint32_t value;
+
+	// Read again if the SysTick interrupt incremented the ms counter in between
+	do {
+		ms    = system_timer_get_ms();
+		value = SysTick->VAL;
+	} while(ms != system_timer_get_ms());
+
+	return ms*(SysTick->LOAD + 1) + (SysTick->LOAD - value);
+}
+
+uint32_t hot_path_cycles_to_ns(const uint32_t cycles) {
+	return (uint32_t)(((uint64_t)cycles)*1000000000ULL/SystemCoreClock);
+}
+
+#ifdef HOT_PATH_STATISTICS
+static inline void hot_path_add(uint32_t *count, uint64_t *sum, uint32_t *max, const uint32_t cycles) {
+	(*count)++;
+	*sum += cycles;
+	if(cycles > *max) {
+		*max = cycles;
+	}
+}
+
+static void hot_path_get(uint32_t *count, uint64_t *sum, uint32_t *max, uint32_t *count_out, uint32_t *mean_ns, uint32_t *max_ns) {
+	*count_out = *count;
+	*mean_ns   = *count > 0 ? hot_path_cycles_to_ns((uint32_t)(*sum / *count)) : 0;
+	*max_ns    = hot_path_cycles_to_ns(*max);
+
+	*count = 0;
+	*sum   = 0;
+	*max   = 0;
+}
+
+void hot_path_get_loop_period(uint32_t *count, uint32_t *mean_ns, uint32_t *max_ns) {
+	hot_path_get(&hot_path.loop_count, &hot_path.loop_sum, &hot_path.loop_max, count, mean_ns, max_ns);
+}
+
+void hot_path_get_adc_latency(uint32_t *count, uint32_t *mean_ns, uint32_t *max_ns) {
+	hot_path_get(&hot_path.adc_count, &hot_path.adc_sum, &hot_path.adc_max, count, mean_ns, max_ns);
+}
+
+// Called when a new CP/PE resistance is available
+void HOT_PATH hot_path_adc_result(void) {
+	hot_path.adc_time    = hot_path_get_cycles();
+	hot_path.adc_pending = true;
+}
+
+// Called when evse_set_output() applies the CP PWM and contactor state, the
+// first call after a new CP/PE resistance measures the ADC to output latency
+void HOT_PATH hot_path_output_set(void) {
+	if(hot_path.adc_pending) {
+		hot_path.adc_pending = false;
+		hot_path_add(&hot_path.adc_count, &hot_path.adc_sum, &hot_path.adc_max, hot_path_get_cycles() - hot_path.adc_time);
+	}
+}
+
+void hot_path_init(void) {
+	memset(&hot_path, 0, sizeof(HotPath));
+	hot_path.loop_last = hot_path_get_cycles();
+}
+
+void HOT_PATH hot_path_tick(void) {
+	const uint32_t now = hot_path_get_cycles();
+	hot_path_add(&hot_path.loop_count, &hot_path.loop_sum, &hot_path.loop_max, now - hot_path.loop_last);
+	hot_path.loop_last = now;
+}
+#endif
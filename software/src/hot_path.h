@@ -0,0 +1,77 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * hot_path.h: Optional RAM execution of the ADC/IEC61851 hot path and its timing
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef HOT_PATH_H
+#define HOT_PATH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Functions and tables that are used in every main loop iteration.
+// With "cmake -DHOT_PATH_IN_RAM=ON" they are executed from RAM (no flash
+// wait states) and optimized for speed instead of size.
+// Calls from RAM to flash are out of range for BL, the linker adds veneers.
+#ifdef HOT_PATH_IN_RAM
+#define HOT_PATH       __attribute__((optimize("-O2"))) __attribute__((section(".ram_code")))
+#define HOT_PATH_CONST __attribute__((section(".data.hot_path"))) // Copied to RAM at startup with .data
+#else
+#define HOT_PATH
+#define HOT_PATH_CONST
+#endif
+
+// The statistics are only collected with "cmake -DHOT_PATH_STATISTICS=ON",
+// otherwise the calls in the main loop, adc_check_count() and
+// evse_set_output() are empty. They are in CPU cycles and reset on read.
+typedef struct {
+	// Main loop period
+	uint32_t loop_last;
+	uint32_t loop_count;
+	uint64_t loop_sum;
+	uint32_t loop_max;
+
+	// Time from new CP/PE resistance in adc_check_count() to evse_set_output()
+	bool adc_pending;
+	uint32_t adc_time;
+	uint32_t adc_count;
+	uint64_t adc_sum;
+	uint32_t adc_max;
+} HotPath;
+
+extern HotPath hot_path;
+
+uint32_t hot_path_get_cycles(void);
+uint32_t hot_path_cycles_to_ns(const uint32_t cycles);
+
+#ifdef HOT_PATH_STATISTICS
+void hot_path_get_loop_period(uint32_t *count, uint32_t *mean_ns, uint32_t *max_ns);
+void hot_path_get_adc_latency(uint32_t *count, uint32_t *mean_ns, uint32_t *max_ns);
+void hot_path_adc_result(void);
+void hot_path_output_set(void);
+void hot_path_init(void);
+void hot_path_tick(void);
+#else
+static inline void hot_path_adc_result(void) {}
+static inline void hot_path_output_set(void) {}
+static inline void hot_path_init(void) {}
+static inline void hot_path_tick(void) {}
+#endif
+
+#endif
@@ -39,6 +39,8 @@
 #include "communication.h"
 #include "charging_slot.h"
 #include "phase_control.h"
+#include "hot_path.h"
+#include "soft_timer.h"
 
 IEC61851 iec61851;
 
@@ -60,7 +62,7 @@ IEC61851 iec61851;
 
 // CP resistance for state A, B, C, D and E/F with 10% hysteresis between states.
 // This hysteresis is made to conform to the IEC 61851-1 A.4.11 "Optional hysteresis test"
-const uint16_t cp_resistance_state[5][4] = {
+const uint16_t cp_resistance_state[5][4] HOT_PATH_CONST = {
 	// State A (ev not connected) transition to
 	{
 		9000,  // state A (10000 -10%)
@@ -99,7 +101,7 @@ const uint16_t cp_resistance_state[5][4] = {
 };
 
 // Returns the resistance threshold for the given state that will be transitioned to
-uint16_t iec61851_get_cp_resistance_threshold(IEC61851State transition_to_state) {
+uint16_t HOT_PATH iec61851_get_cp_resistance_threshold(IEC61851State transition_to_state) {
 	return cp_resistance_state[iec61851.state][transition_to_state];
 }
 
@@ -235,8 +237,29 @@ float iec61851_get_duty_cycle_for_ma(uint32_t ma) {
 	return BETWEEN(80.0f, duty_cycle, 1000.0f);
 }
 
+// Deadlines after the B1->B2 transition, see iec61851_handle_ev_wakeup()
+static const uint32_t iec61851_ev_wakeup_deadlines[IEC61851_EV_WAKEUP_STAGES] = {
+	90*1000,                                                                    // First CP disconnect
+	90*1000 + 4*1000,                                                           // CP connect
+	90*1000 + 4*1000 + 30*1000,                                                 // Second CP disconnect
+	90*1000 + 4*1000 + 30*1000 + 30*1000,                                       // CP connect
+	90*1000 + 4*1000 + 30*1000 + 30*1000 + 30*1000,                             // Third wakeup (state F)
+	90*1000 + 4*1000 + 30*1000 + 30*1000 + 30*1000 + 4*1000,                    // End of state F
+	90*1000 + 4*1000 + 30*1000 + 30*1000 + 30*1000 + 4*1000 + 30*1000,          // Fourth wakeup (state F)
+	90*1000 + 4*1000 + 30*1000 + 30*1000 + 30*1000 + 4*1000 + 30*1000 + 30*1000 // End of state F
+};
+
+// Re-arm the timer for the next deadline, all deadlines are relative to the B1->B2 transition
+static void iec61851_ev_wakeup_timer_handler(SoftTimer *timer) {
+	iec61851.ev_wakeup_stage++;
+	if(iec61851.ev_wakeup_stage < IEC61851_EV_WAKEUP_STAGES) {
+		soft_timer_start_from(timer, soft_timer_get_start(timer), iec61851_ev_wakeup_deadlines[iec61851.ev_wakeup_stage]);
+	}
+}
+
 void iec61851_reset_ev_wakeup(void) {
-	iec61851.state_b1b2_transition_time = 0;
+	soft_timer_stop(&iec61851.ev_wakeup_timer);
+	iec61851.ev_wakeup_stage = 0;
 	iec61851.state_b1b2_transition_seen = false;
 	iec61851.currently_beeing_woken_up = false;
 	iec61851.force_state_f = false;
@@ -292,11 +315,9 @@ void iec61851_handle_ev_wakeup(uint32_t ma) {
 		// until the EVSE does a CP disconnect wakeup. The normal B1->B2 wakeup
 		// timeout is 90 seconds. Set the transition time 80s in the past so the
 		// first CP disconnect fires after ~10 seconds instead.
-		if(iec61851.first_b1b2_transition && (iec61851.charging_protocol == EVSE_V2_CHARGING_PROTOCOL_IEC61851_TEMPORARY)) {
-			iec61851.state_b1b2_transition_time = system_timer_get_ms() - 80*1000;
-		} else {
-			iec61851.state_b1b2_transition_time = system_timer_get_ms();
-		}
+		const uint32_t transition_time = (iec61851.first_b1b2_transition && (iec61851.charging_protocol == EVSE_V2_CHARGING_PROTOCOL_IEC61851_TEMPORARY)) ? system_timer_get_ms() - 80*1000 : system_timer_get_ms();
+		iec61851.ev_wakeup_stage = 0;
+		soft_timer_start_from(&iec61851.ev_wakeup_timer, transition_time, iec61851_ev_wakeup_deadlines[0]);
 		iec61851.first_b1b2_transition = false;
 		iec61851.state_b1b2_transition_seen = false;
 	}
@@ -308,7 +329,7 @@ void iec61851_handle_ev_wakeup(uint32_t ma) {
 	// EV wakeup handling according to IEC61851-1 Annex A.5.3
 	// According to the standard we should do the wakeup only once and only for 4 seconds.
 	// In the wild we know of EVs that need 30s of wakeup... So we try it two times: First with 4 seconds and after that with 30 seconds.
-	if((iec61851.state_b1b2_transition_time != 0) && (!evse.control_pilot_disconnect)) {
+	if(soft_timer_is_running(&iec61851.ev_wakeup_timer) && (!evse.control_pilot_disconnect)) {
 		// Only consider to use state F for ev-wakeup if last state C is at least 1 hour ago
 		const bool use_state_f = (iec61851.force_state_f_time != 0) && system_timer_is_time_elapsed_ms(iec61851.force_state_f_time, 1000*60*60);
 
@@ -319,17 +340,17 @@ void iec61851_handle_ev_wakeup(uint32_t ma) {
 		}
 
 		// Wait for 30 seconds for the EV to wake up for fourth wakeup (state F)
-		if(use_state_f && system_timer_is_time_elapsed_ms(iec61851.state_b1b2_transition_time, 90*1000 + 4*1000 + 30*1000 + 30*1000 + 30*1000 + 4*1000 + 30*1000 + 30*1000)) {
+		if(use_state_f && (iec61851.ev_wakeup_stage >= 8)) {
 			if(iec61851.force_state_f) {
 				iec61851.currently_beeing_woken_up = false;
 				iec61851.force_state_f = false;
 			} else {
-				iec61851.state_b1b2_transition_time = 0;
+				soft_timer_stop(&iec61851.ev_wakeup_timer);
 			}
 		}
 
 		// Wait for another 30 seconds for fourth wakeup (state F)
-		else if(use_state_f && system_timer_is_time_elapsed_ms(iec61851.state_b1b2_transition_time, 90*1000 + 4*1000 + 30*1000 + 30*1000 + 30*1000 + 4*1000 + 30*1000)) {
+		else if(use_state_f && (iec61851.ev_wakeup_stage >= 7)) {
 			if(evse.ev_wakeup_enabled) {
 				if(!iec61851.force_state_f) {
 					iec61851.currently_beeing_woken_up = true;
@@ -339,7 +360,7 @@ void iec61851_handle_ev_wakeup(uint32_t ma) {
 		}
 
 		// Wait for 30 seconds for the EV to wake up for third wakeup (state F)
-		else if(use_state_f && system_timer_is_time_elapsed_ms(iec61851.state_b1b2_transition_time, 90*1000 + 4*1000 + 30*1000 + 30*1000 + 30*1000 + 4*1000)) {
+		else if(use_state_f && (iec61851.ev_wakeup_stage >= 6)) {
 			if(iec61851.force_state_f) {
 				iec61851.currently_beeing_woken_up = false;
 				iec61851.force_state_f = false;
@@ -347,7 +368,7 @@ void iec61851_handle_ev_wakeup(uint32_t ma) {
 		}
 
 		// Wait for another 4 seconds for third wakeup (state F)
-		else if(use_state_f && system_timer_is_time_elapsed_ms(iec61851.state_b1b2_transition_time, 90*1000 + 4*1000 + 30*1000 + 30*1000 + 30*1000)) {
+		else if(use_state_f && (iec61851.ev_wakeup_stage >= 5)) {
 			if(evse.ev_wakeup_enabled) {
 				if(!iec61851.force_state_f) {
 					iec61851.currently_beeing_woken_up = true;
@@ -357,18 +378,18 @@ void iec61851_handle_ev_wakeup(uint32_t ma) {
 		}
 
 		// Wait for 30 seconds for the EV to wake up for second wakeup
-		else if(system_timer_is_time_elapsed_ms(iec61851.state_b1b2_transition_time, 90*1000 + 4*1000 + 30*1000 + 30*1000)) {
+		else if(iec61851.ev_wakeup_stage >= 4) {
 			if(!evse_is_cp_connected()) {
 				iec61851.currently_beeing_woken_up = false;
 				evse_cp_connect();
 				if(!use_state_f) {
-					iec61851.state_b1b2_transition_time = 0;
+					soft_timer_stop(&iec61851.ev_wakeup_timer);
 				}
 			}
 		}
 
 		// Wait for another 30 seconds for the second wakeup.
-		else if(system_timer_is_time_elapsed_ms(iec61851.state_b1b2_transition_time, 90*1000 + 4*1000 + 30*1000)) {
+		else if(iec61851.ev_wakeup_stage >= 3) {
 			if(evse.ev_wakeup_enabled) {
 				iec61851.currently_beeing_woken_up = true;
 				evse_cp_disconnect();
@@ -376,7 +397,7 @@ void iec61851_handle_ev_wakeup(uint32_t ma) {
 		}
 
 		// Wait for 4 seconds for the EV to wake up
-		else if(system_timer_is_time_elapsed_ms(iec61851.state_b1b2_transition_time, 90*1000 + 4*1000)) {
+		else if(iec61851.ev_wakeup_stage >= 2) {
 			if(!evse_is_cp_connected()) {
 				iec61851.currently_beeing_woken_up = false;
 				evse_cp_connect();
@@ -389,7 +410,7 @@ void iec61851_handle_ev_wakeup(uint32_t ma) {
 
 		// Wait for 90 seconds for the EV to change resistance and IEC61851 state change to C
 		// If this does not happen and ev wakeup is enabled we disconnect CP.
-		else if(system_timer_is_time_elapsed_ms(iec61851.state_b1b2_transition_time, 90*1000)) {
+		else if(iec61851.ev_wakeup_stage >= 1) {
 			if(evse.ev_wakeup_enabled) {
 				iec61851.currently_beeing_woken_up = true;
 				evse_cp_disconnect();
@@ -470,7 +491,7 @@ void iec61851_state_ef(void) {
 	iec61851_reset_ev_wakeup();
 }
 
-void iec61851_tick(void) {
+void HOT_PATH iec61851_tick(void) {
 	if((hardware_version.is_v3 || hardware_version.is_v4) && (contactor_check.error & 1)) { // PE error should have highest priority
 		led_set_blinking(4);
 		iec61851_set_state(IEC61851_STATE_EF);
@@ -603,6 +624,8 @@ void iec61851_init(void) {
 		iec61851.boot_time = 1;
 	}
 
+	iec61851.ev_wakeup_timer.callback = iec61851_ev_wakeup_timer_handler;
+
 	iec61851_diode_error_reset(true);
 }
 
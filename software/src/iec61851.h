@@ -25,6 +25,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "soft_timer.h"
+
 // Resistance between PP/PE
 // 1000..2200 Ohm => 13A
 // 330..1000 Ohm  => 20A
@@ -34,6 +36,8 @@
 #define IEC61851_PP_RESISTANCE_20A  330
 #define IEC61851_PP_RESISTANCE_32A  150
 
+#define IEC61851_EV_WAKEUP_STAGES 8
+
 typedef enum {
 	IEC61851_STATE_A  = 0, // Standby
 	IEC61851_STATE_B  = 1, // Vehicle Detected
@@ -59,7 +63,8 @@ typedef struct {
 	uint32_t last_error_time;
 	uint32_t last_state_c_end_time;
 
-	uint32_t state_b1b2_transition_time;
+	SoftTimer ev_wakeup_timer; // Started on B1->B2 transition, runs until the EV wakeup is reset
+	uint8_t ev_wakeup_stage;   // Number of EV wakeup deadlines that have passed
 	uint32_t state_b1b2_transition_seen;
 
 	bool first_b1b2_transition;
@@ -31,6 +31,7 @@
 #include "communication.h"
 #include "iec61851.h"
 #include "button.h"
+#include "soft_timer.h"
 
 #define ISKRA_DISPLAY_REG_BACKLIGHT     (7061+1) // On/Off
 #define ISKRA_DISPLAY_REG_LCD_PARAMS    (7062+1) // Row 2 mode bitmask
@@ -117,7 +118,7 @@ bool iskra_display_has_work(void) {
 
 void iskra_display_modbus_tick(void) {
 	if(iskra_display.state != 0) {
-		if(system_timer_is_time_elapsed_ms(iskra_display.state_time, ISKRA_DISPLAY_TIMEOUT)) {
+		if(soft_timer_is_expired(&iskra_display.state_timer)) {
 			modbus_clear_request(&rs485);
 			iskra_display.text_pending            = false;
 			iskra_display.backlight_written       = iskra_display.backlight_desired;
@@ -129,14 +130,15 @@ void iskra_display_modbus_tick(void) {
 
 	switch(iskra_display.state) {
 		case 0: { // idle -> start next operation
-			iskra_display.state_time = system_timer_get_ms();
 			if(iskra_display_backlight_write_needed()) {
 				MeterRegisterType payload;
 				payload.u16_single = iskra_display.backlight_desired ? 1 : 0;
 				meter_write_register(MODBUS_FC_WRITE_SINGLE_REGISTER, meter.slave_address, ISKRA_DISPLAY_REG_BACKLIGHT, &payload);
+				soft_timer_start(&iskra_display.state_timer, ISKRA_DISPLAY_TIMEOUT);
 				iskra_display.state = 1;
 			} else if(iskra_display.text_pending) {
 				meter_write_string(meter.slave_address, ISKRA_DISPLAY_REG_CUSTOM_STRING, iskra_display.text, ISKRA_DISPLAY_TEXT_LENGTH);
+				soft_timer_start(&iskra_display.state_timer, ISKRA_DISPLAY_TIMEOUT);
 				iskra_display.state = 2;
 			}
 			break;
@@ -156,7 +158,7 @@ void iskra_display_modbus_tick(void) {
 			if(meter_get_write_register_response(MODBUS_FC_WRITE_MULTIPLE_REGISTERS)) {
 				modbus_clear_request(&rs485);
 				meter_write_string(meter.slave_address, ISKRA_DISPLAY_REG_CUSTOM_LABEL, iskra_display.label, ISKRA_DISPLAY_LABEL_LENGTH);
-				iskra_display.state_time = system_timer_get_ms();
+				soft_timer_start(&iskra_display.state_timer, ISKRA_DISPLAY_TIMEOUT);
 				iskra_display.state = 3;
 			}
 			break;
@@ -176,7 +178,7 @@ void iskra_display_modbus_tick(void) {
 					payload.u16_single = ISKRA_DISPLAY_LCD_PARAMS_CUSTOM_STRING;
 				}
 				meter_write_register(MODBUS_FC_WRITE_SINGLE_REGISTER, meter.slave_address, ISKRA_DISPLAY_REG_LCD_PARAMS, &payload);
-				iskra_display.state_time = system_timer_get_ms();
+				soft_timer_start(&iskra_display.state_timer, ISKRA_DISPLAY_TIMEOUT);
 				iskra_display.state = 4;
 			}
 			break;
@@ -25,6 +25,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "soft_timer.h"
+
 #define ISKRA_DISPLAY_TEXT_LENGTH  8
 #define ISKRA_DISPLAY_LABEL_LENGTH 4
 
@@ -47,7 +49,7 @@ typedef struct {
     uint8_t meter_type_last;
 
     uint8_t state;
-    uint32_t state_time;
+    SoftTimer state_timer; // Timeout of the current modbus write
 } IskraDisplay;
 
 extern IskraDisplay iskra_display;
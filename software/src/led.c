@@ -72,71 +72,141 @@ const uint16_t led_cie1931[256] = {
 #define LED_OFF LED_MIN_DUTY_CYCLE
 
 
-void led_hsv_to_rgb(const uint16_t h, const uint8_t s, const uint8_t v, uint8_t *r, uint8_t *g, uint8_t *b) {
-	if(s == 0) {
-		*r = v;
-		*g = v;
-		*b = v;
-	} else {
-		const uint8_t i = h / 60;
-		const uint8_t p = (256*v - s*v) / 256;
-
-		if(i & 1) {
-			const int32_t q = (256*60*v - h*s*v + 60*s*v*i) / (256*60);
-			switch(i) {
-				case 1: *r = q; *g = v; *b = p; break;
-				case 3: *r = p; *g = q; *b = v; break;
-				case 5: *r = v; *g = p; *b = q; break;
-			}
-		} else {
-			const int32_t t = (256*60*v + h*s*v - 60*s*v*(i+1)) / (256*60);
-			switch(i) {
-				case 0: *r = v; *g = t; *b = p; break;
-				case 2: *r = p; *g = v; *b = t; break;
-				case 4: *r = t; *g = p; *b = v; break;
-			}
-		}
+// Position of the hue within its 60 degree sector: (h % 60)*256/60
+static const uint8_t led_hue_ramp[60] = {
+	0, 4, 8, 12, 17, 21, 25, 29, 34, 38,
+	42, 46, 51, 55, 59, 64, 68, 72, 76, 81,
+	85, 89, 93, 98, 102, 106, 110, 115, 119, 123,
+	128, 132, 136, 140, 145, 149, 153, 157, 162, 166,
+	170, 174, 179, 183, 187, 192, 196, 200, 204, 209,
+	213, 217, 221, 226, 230, 234, 238, 243, 247, 251,
+};
+
+// All RGB channels are proportional to v, with the channel scale (0-256)
+// depending only on hue and saturation. The scales are calculated once
+// when hue or saturation change, a change of v (breathing, API indication)
+// only needs one multiplication and one led_cie1931 lookup per channel.
+static void led_hsv_to_scale(const uint16_t h, const uint8_t s, uint16_t scale[LED_CHANNEL_NUM]) {
+	const uint8_t i     = h / 60;
+	const uint16_t ramp = led_hue_ramp[h - i*60];
+	const uint16_t full = 256;
+	const uint16_t p    = (uint16_t)(256 - s);
+	const uint16_t q    = (uint16_t)(256 - ((s*ramp) >> 8));         // Falling edge of the sector
+	const uint16_t t    = (uint16_t)(256 - ((s*(256 - ramp)) >> 8)); // Rising edge of the sector
+
+	switch(i) {
+		case 0:  scale[LED_CHANNEL_R] = full; scale[LED_CHANNEL_G] = t;    scale[LED_CHANNEL_B] = p;    break;
+		case 1:  scale[LED_CHANNEL_R] = q;    scale[LED_CHANNEL_G] = full; scale[LED_CHANNEL_B] = p;    break;
+		case 2:  scale[LED_CHANNEL_R] = p;    scale[LED_CHANNEL_G] = full; scale[LED_CHANNEL_B] = t;    break;
+		case 3:  scale[LED_CHANNEL_R] = p;    scale[LED_CHANNEL_G] = q;    scale[LED_CHANNEL_B] = full; break;
+		case 4:  scale[LED_CHANNEL_R] = t;    scale[LED_CHANNEL_G] = p;    scale[LED_CHANNEL_B] = full; break;
+		case 5:  scale[LED_CHANNEL_R] = full; scale[LED_CHANNEL_G] = p;    scale[LED_CHANNEL_B] = q;    break;
+		default: scale[LED_CHANNEL_R] = 0;    scale[LED_CHANNEL_G] = 0;    scale[LED_CHANNEL_B] = 0;    break;
 	}
 }
 
+static inline uint8_t led_scale_value(const uint8_t v, const uint16_t scale) {
+	return (uint8_t)((v*scale) >> 8);
+}
+
+void led_hsv_to_rgb(const uint16_t h, const uint8_t s, const uint8_t v, uint8_t *r, uint8_t *g, uint8_t *b) {
+	uint16_t scale[LED_CHANNEL_NUM];
+	led_hsv_to_scale(h, s, scale);
+
+	*r = led_scale_value(v, scale[LED_CHANNEL_R]);
+	*g = led_scale_value(v, scale[LED_CHANNEL_G]);
+	*b = led_scale_value(v, scale[LED_CHANNEL_B]);
+}
+
+// Only sets the color (and stops a running animation), the PWM is updated by led_render()
 void led_update(const uint16_t h, const uint8_t s, const uint8_t v) {
+	led_animation_stop(&led.player);
 	led.h = h;
 	led.s = s;
 	led.v = v;
-	led_hsv_to_rgb(h, s, v, &led.r, &led.g, &led.b);
+}
+
+// Called every LED_RENDER_PERIOD, only changed compare values are written
+void led_render(void) {
+	if(led.player.animation != NULL) {
+		led_animation_get_hsv(&led.player, &led.h, &led.s, &led.v);
+	}
+
+	if(led.render_valid && (led.h == led.render_h) && (led.s == led.render_s) && (led.v == led.render_v)) {
+		return;
+	}
 
-	uint16_t compare_value_b = led_cie1931[led.b];
+	if(!led.render_valid || (led.h != led.render_h) || (led.s != led.render_s)) {
+		led_hsv_to_scale(led.h, led.s, led.scale);
+	}
+
+	led.render_h     = led.h;
+	led.render_s     = led.s;
+	led.render_v     = led.v;
+	led.render_valid = true;
+
+	led.r = led_scale_value(led.v, led.scale[LED_CHANNEL_R]);
+	led.g = led_scale_value(led.v, led.scale[LED_CHANNEL_G]);
+	led.b = led_scale_value(led.v, led.scale[LED_CHANNEL_B]);
+
+	const uint16_t compare_value_b = led_cie1931[led.b];
 	if(hardware_version.is_v2) {
-		XMC_CCU4_SLICE_SetTimerCompareMatch(EVSE_V2_LED_SLICE, compare_value_b);
-		XMC_CCU4_EnableShadowTransfer(EVSE_V2_LED_CCU, (XMC_CCU4_SHADOW_TRANSFER_SLICE_0 << (EVSE_V2_LED_SLICE_NUMBER*4)) | (XMC_CCU4_SHADOW_TRANSFER_PRESCALER_SLICE_0 << (EVSE_V2_LED_SLICE_NUMBER*4)));
+		if(compare_value_b != led.compare[LED_CHANNEL_B]) {
+			led.compare[LED_CHANNEL_B] = compare_value_b;
+			XMC_CCU4_SLICE_SetTimerCompareMatch(EVSE_V2_LED_SLICE, compare_value_b);
+			XMC_CCU4_EnableShadowTransfer(EVSE_V2_LED_CCU, (XMC_CCU4_SHADOW_TRANSFER_SLICE_0 << (EVSE_V2_LED_SLICE_NUMBER*4)) | (XMC_CCU4_SHADOW_TRANSFER_PRESCALER_SLICE_0 << (EVSE_V2_LED_SLICE_NUMBER*4)));
+		}
 	} else if(hardware_version.is_v3 || hardware_version.is_v4) {
-		uint16_t compare_value_r = led_cie1931[led.r];
-		uint16_t compare_value_g = led_cie1931[led.g];
-		XMC_CCU8_SLICE_SetTimerCompareMatch(EVSE_V3_LED_R_SLICE, XMC_CCU8_SLICE_COMPARE_CHANNEL_1, compare_value_r);
-		XMC_CCU8_SLICE_SetTimerCompareMatch(EVSE_V3_LED_G_SLICE, XMC_CCU8_SLICE_COMPARE_CHANNEL_1, compare_value_g);
-		XMC_CCU8_SLICE_SetTimerCompareMatch(EVSE_V3_LED_B_SLICE, XMC_CCU8_SLICE_COMPARE_CHANNEL_1, compare_value_b);
-		XMC_CCU8_EnableShadowTransfer(EVSE_V3_LED_R_CCU, EVSE_V3_LED_R_SHADOW);
-		XMC_CCU8_EnableShadowTransfer(EVSE_V3_LED_G_CCU, EVSE_V3_LED_G_SHADOW);
-		XMC_CCU8_EnableShadowTransfer(EVSE_V3_LED_B_CCU, EVSE_V3_LED_B_SHADOW);
+		const uint16_t compare_value_r = led_cie1931[led.r];
+		const uint16_t compare_value_g = led_cie1931[led.g];
+		if(compare_value_r != led.compare[LED_CHANNEL_R]) {
+			led.compare[LED_CHANNEL_R] = compare_value_r;
+			XMC_CCU8_SLICE_SetTimerCompareMatch(EVSE_V3_LED_R_SLICE, XMC_CCU8_SLICE_COMPARE_CHANNEL_1, compare_value_r);
+			XMC_CCU8_EnableShadowTransfer(EVSE_V3_LED_R_CCU, EVSE_V3_LED_R_SHADOW);
+		}
+		if(compare_value_g != led.compare[LED_CHANNEL_G]) {
+			led.compare[LED_CHANNEL_G] = compare_value_g;
+			XMC_CCU8_SLICE_SetTimerCompareMatch(EVSE_V3_LED_G_SLICE, XMC_CCU8_SLICE_COMPARE_CHANNEL_1, compare_value_g);
+			XMC_CCU8_EnableShadowTransfer(EVSE_V3_LED_G_CCU, EVSE_V3_LED_G_SHADOW);
+		}
+		if(compare_value_b != led.compare[LED_CHANNEL_B]) {
+			led.compare[LED_CHANNEL_B] = compare_value_b;
+			XMC_CCU8_SLICE_SetTimerCompareMatch(EVSE_V3_LED_B_SLICE, XMC_CCU8_SLICE_COMPARE_CHANNEL_1, compare_value_b);
+			XMC_CCU8_EnableShadowTransfer(EVSE_V3_LED_B_CCU, EVSE_V3_LED_B_SHADOW);
+		}
 	}
 }
 
-void led_reset_api_state(void) {
-	led.api_indication   = -1;
-	led.api_start        = 0;
-	led.api_duration     = 0;
+static void led_render_timer_handler(SoftTimer *timer) {
+	led_render();
+}
 
-	led.api_ack_counter  = 0;
-	led.api_ack_index    = 0;
-	led.api_ack_time     = 0;
+// Starts the animation if it is not already playing
+static void led_play(const LEDAnimation *animation, const uint8_t index) {
+	if(led.player.animation != animation) {
+		led_animation_start(&led.player, animation, index);
+	}
+}
 
-	led.api_nack_counter = 0;
-	led.api_nack_index   = 0;
-	led.api_nack_time    = 0;
+// Slots are loaded from the EEPROM when they are played. The player is restarted
+// if another slot is loaded or the slot was changed (led_animation_set_slot()).
+static void led_play_slot(const uint8_t slot) {
+	if(led_animation.play_slot != slot) {
+		led_animation_stop(&led.player);
+		led_animation_load_slot(slot);
+	}
 
-	led.api_nag_counter  = 0;
-	led.api_nag_index    = 0;
-	led.api_nag_time     = 0;
+	if(led_animation.play.keyframe_count == 0) {
+		return;
+	}
+
+	led_play(&led_animation.play, 0);
+}
+
+void led_reset_api_state(void) {
+	led.api_indication = -1;
+	led.api_start      = 0;
+	led.api_duration   = 0;
 }
 
 void led_set_enumerate(void) {
@@ -188,10 +258,7 @@ void led_set_breathing(void) {
 	}
 
 	// Otherwise start breathing from LED-on-condition
-	led.state           = LED_STATE_BREATHING;
-	led.breathing_time  = 0;
-	led.breathing_index = 255;
-	led.breathing_up    = false;
+	led.state = LED_STATE_BREATHING;
 }
 
 void led_set_blinking(const uint8_t num) {
@@ -205,12 +272,10 @@ void led_set_blinking(const uint8_t num) {
 		led_reset_api_state();
 	}
 
-	led.state           = LED_STATE_BLINKING;
-	led.blink_num       = num;
-	led.blink_count     = num;
-	led.blink_on        = false;
-	led.blink_last_time = system_timer_get_ms();
+	led.state     = LED_STATE_BLINKING;
+	led.blink_num = num;
 
+	// Stops the current animation, blinking starts with the wait
 	led_update(0, 0, 0);
 }
 
@@ -222,7 +287,6 @@ void led_set_on(const bool force) {
 		return;
 	}
 
-	led_hsv_to_rgb(led.h, led.s, led.v, &led.r, &led.g, &led.b);
 	led.on_time = system_timer_get_ms();
 	led.state = LED_STATE_ON;
 	led_update(LED_HUE_STANDARD, 255, 255);
@@ -351,8 +415,7 @@ void led_init_v3(void) {
 void led_init(void) {
 	memset(&led, 0, sizeof(LED));
 
-	led_hsv_to_rgb(led.h, led.s, led.v, &led.r, &led.g, &led.b);
-
+	// Compare values are initialized with 0, same as led.compare
 	if(hardware_version.is_v2) {
 		led_init_v2();
 	} else if(hardware_version.is_v3 || hardware_version.is_v4) {
@@ -361,6 +424,10 @@ void led_init(void) {
 
 	led_update(0, 0, 0);
 	led_reset_api_state();
+	led_animation_init();
+
+	led.render_timer.callback = led_render_timer_handler;
+	soft_timer_start_periodic(&led.render_timer, LED_RENDER_PERIOD);
 
 	led.state = LED_STATE_FLICKER;
 }
@@ -379,156 +446,63 @@ void led_tick_status_on(void) {
 }
 
 void led_tick_status_blinking(const bool is_external) {
-	if(led.blink_count >= led.blink_num) {
-		if(system_timer_is_time_elapsed_ms(led.blink_last_time, LED_BLINK_DURATION_WAIT)) {
-			led.blink_last_time         = system_timer_get_ms();
-			led.blink_count             = 0;
-			led.currently_in_wait_state = true;
-		}
-	} else if(led.blink_on) {
-		if(system_timer_is_time_elapsed_ms(led.blink_last_time, LED_BLINK_DURATION_ON)) {
-			led.blink_last_time = system_timer_get_ms();
-			led_update(0, 0, 0);
-
-			led.blink_on = false;
-			led.blink_count++;
-		}
+	if(hardware_version.is_v2) {
+		led_animation_set_base(&led.player, LED_HUE_STANDARD, 255, 255); // default v2
+	} else if(is_external && (led.set_v != 0)) {
+		led_animation_set_base(&led.player, led.set_h, led.set_s, led.set_v); // custom v3 through API
 	} else {
-		if(system_timer_is_time_elapsed_ms(led.blink_last_time, LED_BLINK_DURATION_OFF)) {
-			led.blink_last_time = system_timer_get_ms();
-			if(hardware_version.is_v2) {
-				led_update(LED_HUE_STANDARD, 255, 255); // default v2
-			} else if(is_external && (led.set_v != 0)) {
-				led_update(led.set_h, led.set_s, led.set_v); // custom v3 through API
-			} else {
-				led_update(LED_HUE_RED, 255, 255); // default v3
-			}
-			led.blink_on = true;
-		}
+		led_animation_set_base(&led.player, LED_HUE_RED, 255, 255); // default v3
+	}
+
+	if(led.player.animation != &led_animation_blink) {
+		led_animation_start(&led.player, &led_animation_blink, is_external ? 0 : LED_ANIMATION_BLINK_WAIT);
+		led.player.loop_count = (uint8_t)led.blink_num;
 	}
 }
 
 void led_tick_status_flicker(void) {
-	if(system_timer_is_time_elapsed_ms(led.flicker_last_time, LED_FLICKER_DURATION)) {
-		if(led.flicker_on) {
-			led_update(hardware_version.is_v2 ? LED_HUE_STANDARD : LED_HUE_BOOTING, 255, 255);
-		} else {
-			led_update(0, 0, 0);
-		}
-		led.flicker_last_time = system_timer_get_ms();
-		led.flicker_on        = ! led.flicker_on;
-	}
+	led_animation_set_base(&led.player, hardware_version.is_v2 ? LED_HUE_STANDARD : LED_HUE_BOOTING, 255, 255);
+	led_play(&led_animation_flicker, 0);
 }
 
 void led_tick_status_breathing(void) {
-	if(!system_timer_is_time_elapsed_ms(led.breathing_time, 5)) {
-		return;
-	}
-	led.breathing_time = system_timer_get_ms();
-
-	if(led.breathing_up) {
-		led.breathing_index += 1;
-	} else {
-		led.breathing_index -= 1;
-	}
-	led.breathing_index = BETWEEN(0, led.breathing_index, 255);
-
-	if(led.breathing_index == 0) {
-		led.breathing_up = true;
-	} else if(led.breathing_index == 255) {
-		led.breathing_up = false;
-	}
-
 	if(hardware_version.is_v2 || ((led.enumerator_h[0] == 0) && (led.enumerator_s[0] == 0) && (led.enumerator_v[0] == 0))) {
-		led_update(LED_HUE_STANDARD, 255, led.breathing_index);
+		led_animation_set_base(&led.player, LED_HUE_STANDARD, 255, 255);
 	} else {
-		led_update(led.enumerator_h[led.enumerate_value], 255, led.breathing_index);
-	}
-}
-
-void led_tick_status_api_ack(void) {
-	if((led.api_ack_counter < 3) && (system_timer_is_time_elapsed_ms(led.api_ack_time, 2))) {
-		led_update(led.h, led.s, led.api_ack_index);
-		led.api_ack_index++;
-		led.api_ack_time+=2;
-		if(led.api_ack_index == 0) {
-			led.api_ack_counter++;
-		}
-	} else if((led.api_ack_counter >= 3) && (system_timer_is_time_elapsed_ms(led.api_ack_time, 2000))) {
-		led.api_ack_index           = 0;
-		led.api_ack_counter         = 0;
-		led.api_ack_time            = system_timer_get_ms();
-		led.currently_in_wait_state = true;
+		led_animation_set_base(&led.player, led.enumerator_h[led.enumerate_value], 255, 255);
 	}
-}
 
-void led_tick_status_api_nack(void) {
-	if((led.api_nack_counter < 1) && (system_timer_is_time_elapsed_ms(led.api_nack_time, 1))) {
-		led_update(led.h, led.s, 255-led.api_nack_index);
-		led.api_nack_index++;
-		led.api_nack_time++;
-		if(led.api_nack_index == 0) {
-			led.api_nack_counter++;
-		}
-	} else if((led.api_nack_counter >= 1) && (system_timer_is_time_elapsed_ms(led.api_nack_time, 400))) {
-		led.api_nack_index          = 0;
-		led.api_nack_counter        = 0;
-		led.api_nack_time           = system_timer_get_ms();
-		led.currently_in_wait_state = true;
-	}
-}
-
-void led_tick_status_api_nag(void) {
-	if((led.api_nag_counter == 0) && (system_timer_is_time_elapsed_ms(led.api_nag_time, 1))) {
-		led_update(led.h, led.s, led.api_nag_index);
-		led.api_nag_index++;
-		led.api_nag_time++;
-		if(led.api_nag_index == 0) {
-			led.api_nag_counter++;
-		}
-	} else if((led.api_nag_counter == 1) && (system_timer_is_time_elapsed_ms(led.api_nag_time, 1))) {
-		led_update(led.h, led.s, 255-led.api_nag_index);
-		led.api_nag_index++;
-		led.api_nag_time++;
-		if(led.api_nag_index == 0) {
-			led.api_nag_counter++;
-		}
-	} else if((led.api_nag_counter >= 2) && (system_timer_is_time_elapsed_ms(led.api_nag_time, 400))) {
-		led.api_nag_index           = 0;
-		led.api_nag_counter         = 0;
-		led.api_nag_time            = system_timer_get_ms();
-		led.currently_in_wait_state = true;
-	}
+	led_play(&led_animation_breathing, 0);
 }
 
 void led_tick_status_api(void) {
-	led.currently_in_wait_state = false;
-
 	if((led.api_indication >= 0) && (led.api_indication <= 255)) {
-		led_update(led.h, led.s, led.api_indication);
+		led_update(led.api_h, led.api_s, led.api_indication);
 	} else if(led.api_indication == 1001) {
-		led_tick_status_api_ack();
+		led_animation_set_base(&led.player, led.api_h, led.api_s, 255);
+		led_play(&led_animation_ack, 0);
 	} else if(led.api_indication == 1002) {
-		led_tick_status_api_nack();
+		led_animation_set_base(&led.player, led.api_h, led.api_s, 255);
+		led_play(&led_animation_nack, 0);
 	} else if(led.api_indication == 1003) {
-		led_tick_status_api_nag();
+		led_animation_set_base(&led.player, led.api_h, led.api_s, 255);
+		led_play(&led_animation_nag, 0);
 	} else if(led.api_indication > 2000 && led.api_indication < 2011) {
 		if(led.blink_external != led.api_indication) {
-			// If external blinking is activated, turn LED off and start in off state
-			// with last time set to now.
+			// If external blinking is activated, turn LED off and start in off state.
 			// This way we don't waste any time and the first blinking pattern already has
 			// the correct amount of blinks.
 			led_update(0, 0, 0);
-			led.blink_num       = (uint32_t)(led.api_indication - 2000);
-			led.blink_count     = 0;
-			led.blink_on        = false;
-			led.blink_last_time = system_timer_get_ms();
-			led.blink_external  = led.api_indication;
+			led.blink_num      = (uint32_t)(led.api_indication - 2000);
+			led.blink_external = led.api_indication;
 		}
 		led_tick_status_blinking(true);
+	} else if((led.api_indication >= LED_ANIMATION_INDICATION) && (led.api_indication < (LED_ANIMATION_INDICATION + LED_ANIMATION_SLOT_NUM))) {
+		led_animation_set_base(&led.player, led.api_h, led.api_s, led.api_v);
+		led_play_slot((uint8_t)(led.api_indication - LED_ANIMATION_INDICATION));
 	}
 
-	if(system_timer_is_time_elapsed_ms(led.api_start, led.api_duration) && !led.currently_in_wait_state) {
+	if(system_timer_is_time_elapsed_ms(led.api_start, led.api_duration)) {
 		led_reset_api_state();
 		led_set_on(true);
 		led.blink_external = -1;
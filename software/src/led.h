@@ -25,6 +25,9 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "soft_timer.h"
+#include "led_animation.h"
+
 #define LED_FLICKER_DURATION    50
 
 #define LED_BLINK_DURATION_ON   250
@@ -58,6 +61,13 @@
 
 #define LED_ENUMERATOR_NUM 8
 
+#define LED_RENDER_PERIOD 10 // ms, 100 Hz
+
+#define LED_CHANNEL_R   0
+#define LED_CHANNEL_G   1
+#define LED_CHANNEL_B   2
+#define LED_CHANNEL_NUM 3
+
 typedef enum {
 	LED_STATE_OFF,
 	LED_STATE_ON,
@@ -74,35 +84,14 @@ typedef struct {
 	uint32_t on_time;
 
 	uint32_t blink_num;
-	uint32_t blink_count;
-	bool blink_on;
-	uint32_t blink_last_time;
 	int16_t blink_external;
 
-	bool flicker_on;
-	uint32_t flicker_last_time;
-
-	uint32_t breathing_time;
-	int16_t breathing_index;
-	bool breathing_up;
-
 	int16_t api_indication;
 	uint16_t api_duration;
 	uint32_t api_start;
-
-	uint8_t api_ack_counter;
-	uint8_t api_ack_index;
-	uint32_t api_ack_time;
-
-	uint8_t api_nack_counter;
-	uint8_t api_nack_index;
-	uint32_t api_nack_time;
-
-	uint8_t api_nag_counter;
-	uint8_t api_nag_index;
-	uint32_t api_nag_time;
-
-	bool currently_in_wait_state;
+	uint16_t api_h; // Color of the API indication, base color of the animations
+	uint8_t api_s;
+	uint8_t api_v;
 
 	uint16_t set_h;
 	uint8_t set_s;
@@ -115,6 +104,18 @@ typedef struct {
 	uint8_t g;
 	uint8_t b;
 
+	// Flicker, breathing, blinking and API animations, evaluated by led_render()
+	LEDAnimationPlayer player;
+
+	// Color of led_update() or the animation is rendered by led_render()
+	SoftTimer render_timer;
+	bool render_valid;
+	uint16_t render_h;
+	uint8_t render_s;
+	uint8_t render_v;
+	uint16_t scale[LED_CHANNEL_NUM];   // Channel scales of render_h/render_s
+	uint16_t compare[LED_CHANNEL_NUM]; // Current compare values
+
 	uint16_t enumerator_h[LED_ENUMERATOR_NUM];
 	uint8_t enumerator_s[LED_ENUMERATOR_NUM];
 	uint8_t enumerator_v[LED_ENUMERATOR_NUM];
@@ -132,6 +133,8 @@ void led_set_on(const bool force);
 void led_set_blinking(const uint8_t num);
 void led_set_breathing(void);
 void led_set_enumerate(void);
+void led_hsv_to_rgb(const uint16_t h, const uint8_t s, const uint8_t v, uint8_t *r, uint8_t *g, uint8_t *b);
+void led_render(void);
 
 void led_init(void);
 void led_tick(void);
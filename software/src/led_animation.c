@@ -0,0 +1,325 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * led_animation.c: Keyframe animations of the status LED
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "led_animation.h"
+
+#include "bricklib2/hal/system_timer/system_timer.h"
+#include "bricklib2/bootloader/bootloader.h"
+
+#include "led.h"
+
+#include <string.h>
+
+_Static_assert((LED_ANIMATION_SLOT_POS*sizeof(uint32_t) + LED_ANIMATION_SLOT_NUM*sizeof(LEDAnimation)) <= EEPROM_PAGE_SIZE, "LED animation slots don't fit in EEPROM page");
+
+#define LED_ANIMATION_END 0xFF
+
+LEDAnimationStorage led_animation;
+
+// Toggles between base color and off
+const LEDAnimation led_animation_flicker = {
+	.keyframe_count = 2, .loop_start = 0, .loop_end = 1, .loop_count = 1, .repeat = true,
+	.keyframes = {
+		{.duration = LED_FLICKER_DURATION, .v = 255, .flags = LED_ANIMATION_BASE_COLOR},
+		{.duration = LED_FLICKER_DURATION, .v = 0,   .flags = LED_ANIMATION_BASE_COLOR},
+	}
+};
+
+// Fades out and in again in 255 steps of 5ms each
+const LEDAnimation led_animation_breathing = {
+	.keyframe_count = 2, .loop_start = 0, .loop_end = 1, .loop_count = 1, .repeat = true,
+	.keyframes = {
+		{.duration = 255*5, .v = 255, .flags = LED_ANIMATION_BASE_COLOR | LED_ANIMATION_INTERPOLATION_LINEAR},
+		{.duration = 255*5, .v = 0,   .flags = LED_ANIMATION_BASE_COLOR | LED_ANIMATION_INTERPOLATION_LINEAR},
+	}
+};
+
+// The number of blinks is the loop count of the player
+const LEDAnimation led_animation_blink = {
+	.keyframe_count = 3, .loop_start = 0, .loop_end = 1, .loop_count = 1, .repeat = true,
+	.keyframes = {
+		{.duration = LED_BLINK_DURATION_OFF,  .v = 0,   .flags = LED_ANIMATION_BASE_COLOR},
+		{.duration = LED_BLINK_DURATION_ON,   .v = 255, .flags = LED_ANIMATION_BASE_COLOR},
+		{.duration = LED_BLINK_DURATION_WAIT, .v = 0,   .flags = LED_ANIMATION_BASE_COLOR},
+	}
+};
+
+// Three ramps up, then on for 2s
+const LEDAnimation led_animation_ack = {
+	.keyframe_count = 3, .loop_start = 0, .loop_end = 1, .loop_count = 3, .repeat = true,
+	.keyframes = {
+		{.duration = 512,  .v = 0,   .flags = LED_ANIMATION_BASE_COLOR | LED_ANIMATION_INTERPOLATION_LINEAR},
+		{.duration = 0,    .v = 255, .flags = LED_ANIMATION_BASE_COLOR},
+		{.duration = 2000, .v = 255, .flags = LED_ANIMATION_BASE_COLOR},
+	}
+};
+
+// Ramp down, then off for 400ms
+const LEDAnimation led_animation_nack = {
+	.keyframe_count = 2, .loop_start = 0, .loop_end = 1, .loop_count = 1, .repeat = true,
+	.keyframes = {
+		{.duration = 256, .v = 255, .flags = LED_ANIMATION_BASE_COLOR | LED_ANIMATION_INTERPOLATION_LINEAR},
+		{.duration = 400, .v = 0,   .flags = LED_ANIMATION_BASE_COLOR},
+	}
+};
+
+// Ramp up and down, then off for 400ms
+const LEDAnimation led_animation_nag = {
+	.keyframe_count = 3, .loop_start = 0, .loop_end = 2, .loop_count = 1, .repeat = true,
+	.keyframes = {
+		{.duration = 256, .v = 0,   .flags = LED_ANIMATION_BASE_COLOR | LED_ANIMATION_INTERPOLATION_LINEAR},
+		{.duration = 256, .v = 255, .flags = LED_ANIMATION_BASE_COLOR | LED_ANIMATION_INTERPOLATION_LINEAR},
+		{.duration = 400, .v = 0,   .flags = LED_ANIMATION_BASE_COLOR},
+	}
+};
+
+// Next keyframe in playback order, LED_ANIMATION_END if the last keyframe is held.
+// is_loop is set for the jump back to the start of the loop.
+static uint8_t led_animation_next(const LEDAnimationPlayer *player, bool *is_loop) {
+	const LEDAnimation *animation = player->animation;
+
+	*is_loop = false;
+	if((player->index == animation->loop_end) && ((player->loop_count == 0) || ((player->loop_pass + 1) < player->loop_count))) {
+		*is_loop = true;
+		return animation->loop_start;
+	}
+
+	if((player->index + 1) < animation->keyframe_count) {
+		return (uint8_t)(player->index + 1);
+	}
+
+	return animation->repeat ? 0 : LED_ANIMATION_END;
+}
+
+static void led_animation_advance(LEDAnimationPlayer *player, const uint32_t now) {
+	for(uint8_t steps = 0; !player->done; steps++) {
+		const uint16_t duration = player->animation->keyframes[player->index].duration;
+		if((uint32_t)(now - player->keyframe_start) < duration) {
+			return;
+		}
+
+		if(steps >= LED_ANIMATION_STEPS_MAX) {
+			// Far behind (e.g. during a flash write), continue from now
+			player->keyframe_start = now;
+			return;
+		}
+
+		bool is_loop;
+		const uint8_t next = led_animation_next(player, &is_loop);
+		if(next == LED_ANIMATION_END) {
+			player->done = true;
+			return;
+		}
+
+		if(is_loop) {
+			player->loop_pass++;
+		} else if(next == 0) {
+			player->loop_pass = 0;
+		}
+
+		player->keyframe_start += duration;
+		player->index           = next;
+	}
+}
+
+static void led_animation_get_keyframe_hsv(const LEDAnimationPlayer *player, const LEDKeyframe *keyframe, uint16_t *h, uint8_t *s, uint8_t *v) {
+	if(keyframe->flags & LED_ANIMATION_BASE_COLOR) {
+		*h = player->base_h;
+		*s = player->base_s;
+		*v = (uint8_t)((keyframe->v*(player->base_v + 1)) >> 8);
+	} else {
+		*h = keyframe->h;
+		*s = keyframe->s;
+		*v = keyframe->v;
+	}
+}
+
+void led_animation_start(LEDAnimationPlayer *player, const LEDAnimation *animation, const uint8_t index) {
+	player->animation      = animation;
+	player->index          = index;
+	player->loop_pass      = 0;
+	player->loop_count     = animation->loop_count;
+	player->done           = false;
+	player->keyframe_start = system_timer_get_ms();
+}
+
+// Color of the running animation at the current time, integer interpolation only
+void led_animation_get_hsv(LEDAnimationPlayer *player, uint16_t *h, uint8_t *s, uint8_t *v) {
+	const uint32_t now = system_timer_get_ms();
+	led_animation_advance(player, now);
+
+	const LEDKeyframe *keyframe = &player->animation->keyframes[player->index];
+	led_animation_get_keyframe_hsv(player, keyframe, h, s, v);
+
+	if(player->done || (keyframe->duration == 0) || ((keyframe->flags & LED_ANIMATION_INTERPOLATION_MASK) != LED_ANIMATION_INTERPOLATION_LINEAR)) {
+		return;
+	}
+
+	bool is_loop;
+	const uint8_t next = led_animation_next(player, &is_loop);
+	if(next == LED_ANIMATION_END) {
+		return;
+	}
+
+	uint16_t next_h;
+	uint8_t next_s;
+	uint8_t next_v;
+	led_animation_get_keyframe_hsv(player, &player->animation->keyframes[next], &next_h, &next_s, &next_v);
+
+	// Position in keyframe 0-255, elapsed < duration <= 65535
+	const int32_t position = (int32_t)(((now - player->keyframe_start)*256) / keyframe->duration);
+
+	int32_t diff_h = next_h - *h;
+	if(diff_h > 180) {
+		diff_h -= 360;
+	} else if(diff_h < -180) {
+		diff_h += 360;
+	}
+
+	int32_t new_h = *h + (diff_h*position)/256;
+	if(new_h < 0) {
+		new_h += 360;
+	} else if(new_h >= 360) {
+		new_h -= 360;
+	}
+
+	*h = (uint16_t)new_h;
+	*s = (uint8_t)(*s + ((next_s - *s)*position)/256);
+	*v = (uint8_t)(*v + ((next_v - *v)*position)/256);
+}
+
+static bool led_animation_is_valid(const LEDAnimation *animation) {
+	if((animation->keyframe_count == 0) || (animation->keyframe_count > LED_ANIMATION_KEYFRAMES_MAX)) {
+		return false;
+	}
+
+	if((animation->loop_start > animation->loop_end) || (animation->loop_end >= animation->keyframe_count)) {
+		return false;
+	}
+
+	uint32_t duration_loop  = 0;
+	uint32_t duration_total = 0;
+	for(uint8_t i = 0; i < animation->keyframe_count; i++) {
+		const LEDKeyframe *keyframe = &animation->keyframes[i];
+		if((keyframe->h >= 360) ||
+		   ((keyframe->flags & ~(LED_ANIMATION_INTERPOLATION_MASK | LED_ANIMATION_BASE_COLOR)) != 0) ||
+		   ((keyframe->flags & LED_ANIMATION_INTERPOLATION_MASK) > LED_ANIMATION_INTERPOLATION_LINEAR)) {
+			return false;
+		}
+
+		duration_total += keyframe->duration;
+		if((i >= animation->loop_start) && (i <= animation->loop_end)) {
+			duration_loop += keyframe->duration;
+		}
+	}
+
+	// An endless loop or repeat without duration would never advance in time
+	if((animation->loop_count == 0) && (duration_loop == 0)) {
+		return false;
+	}
+
+	if(animation->repeat && (duration_total == 0)) {
+		return false;
+	}
+
+	return true;
+}
+
+// Reads the EEPROM page with the slots, invalid slots (or all slots on first startup) are cleared
+static void led_animation_read_page(uint32_t *page) {
+	bootloader_read_eeprom_page(LED_ANIMATION_PAGE, page);
+
+	LEDAnimation *slots = (LEDAnimation *)&page[LED_ANIMATION_SLOT_POS];
+	for(uint8_t i = 0; i < LED_ANIMATION_SLOT_NUM; i++) {
+		if((page[LED_ANIMATION_MAGIC_POS] != LED_ANIMATION_MAGIC) || !led_animation_is_valid(&slots[i])) {
+			memset(&slots[i], 0, sizeof(LEDAnimation));
+		}
+	}
+}
+
+// Returns the slot in the given EEPROM page buffer (EEPROM_PAGE_SIZE bytes)
+const LEDAnimation *led_animation_read_slot(const uint8_t slot, uint32_t *page) {
+	led_animation_read_page(page);
+	return &((const LEDAnimation *)&page[LED_ANIMATION_SLOT_POS])[slot];
+}
+
+// Loads the slot into led_animation.play if it is not already loaded.
+// A player that plays led_animation.play has to be restarted if another slot is loaded.
+const LEDAnimation *led_animation_load_slot(const uint8_t slot) {
+	if(led_animation.play_slot != slot) {
+		uint32_t page[EEPROM_PAGE_SIZE/sizeof(uint32_t)];
+		memcpy(&led_animation.play, led_animation_read_slot(slot, page), sizeof(LEDAnimation));
+		led_animation.play_slot = slot;
+	}
+
+	return &led_animation.play;
+}
+
+// Validates the uploaded keyframes and saves them to the slot
+bool led_animation_set_slot(const uint8_t slot, const uint8_t keyframe_count, const uint8_t loop_start, const uint8_t loop_end, const uint8_t loop_count, const bool repeat) {
+	if(slot >= LED_ANIMATION_SLOT_NUM) {
+		return false;
+	}
+
+	LEDAnimation *upload   = &led_animation.upload;
+	upload->keyframe_count = keyframe_count;
+	upload->loop_start     = loop_start;
+	upload->loop_end       = loop_end;
+	upload->loop_count     = loop_count;
+	upload->repeat         = repeat;
+	if(!led_animation_is_valid(upload)) {
+		return false;
+	}
+
+	// Unused keyframes are cleared, the saved page does not depend on earlier uploads
+	memset(&upload->keyframes[keyframe_count], 0, (size_t)(LED_ANIMATION_KEYFRAMES_MAX - keyframe_count)*sizeof(LEDKeyframe));
+
+	// Only save to flash if the animation changed
+	uint32_t page[EEPROM_PAGE_SIZE/sizeof(uint32_t)];
+	LEDAnimation *slots = (LEDAnimation *)&page[LED_ANIMATION_SLOT_POS];
+	led_animation_read_page(page);
+	if(memcmp(&slots[slot], upload, sizeof(LEDAnimation)) != 0) {
+		memcpy(&slots[slot], upload, sizeof(LEDAnimation));
+		page[LED_ANIMATION_MAGIC_POS] = LED_ANIMATION_MAGIC;
+		bootloader_write_eeprom_page(LED_ANIMATION_PAGE, page);
+
+		// The slot is loaded again when it is played, see led_tick_status_api()
+		if(led_animation.play_slot == slot) {
+			led_animation.play_slot = LED_ANIMATION_SLOT_NONE;
+		}
+	}
+	led_animation.keyframe_count[slot] = keyframe_count;
+
+	return true;
+}
+
+void led_animation_init(void) {
+	memset(&led_animation, 0, sizeof(LEDAnimationStorage));
+	led_animation.play_slot = LED_ANIMATION_SLOT_NONE;
+
+	uint32_t page[EEPROM_PAGE_SIZE/sizeof(uint32_t)];
+	led_animation_read_page(page);
+
+	const LEDAnimation *slots = (const LEDAnimation *)&page[LED_ANIMATION_SLOT_POS];
+	for(uint8_t i = 0; i < LED_ANIMATION_SLOT_NUM; i++) {
+		led_animation.keyframe_count[i] = slots[i].keyframe_count;
+	}
+}
@@ -0,0 +1,133 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * led_animation.h: Keyframe animations of the status LED
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef LED_ANIMATION_H
+#define LED_ANIMATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// An animation is a list of keyframes. Each keyframe has a color and the
+// time until the next keyframe in playback order. With linear interpolation
+// the color moves from the keyframe to the next one (hue the short way
+// around the color wheel), otherwise it is held until the next keyframe.
+// Keyframes with duration 0 are passed immediately (e.g. for a sawtooth).
+//
+// The keyframes loop_start to loop_end are played loop_count times (0 = forever),
+// after the last keyframe the animation starts again if repeat is set,
+// otherwise the last keyframe is held.
+//
+// Keyframes with LED_ANIMATION_BASE_COLOR use hue and saturation of the
+// base color given by the player (e.g. the color of the API indication),
+// v is scaled with the v of the base color.
+//
+// The built-in patterns (flicker, breathing, blinking, API ack/nack/nag)
+// are animations in flash. LED_ANIMATION_SLOT_NUM animations can be
+// uploaded over the API, they are saved in the EEPROM. Only the slot that is
+// played is kept in RAM, it is loaded from the EEPROM when it is started.
+
+#define LED_ANIMATION_KEYFRAMES_MAX 14
+#define LED_ANIMATION_SLOT_NUM      2
+#define LED_ANIMATION_SLOT_NONE     0xFF
+#define LED_ANIMATION_INDICATION    3001 // Indication of slot 0 for set_indicator_led
+#define LED_ANIMATION_STEPS_MAX     32   // Keyframes that are passed per evaluation before the time is resynchronized
+
+#define LED_ANIMATION_INTERPOLATION_STEP   0
+#define LED_ANIMATION_INTERPOLATION_LINEAR 1
+#define LED_ANIMATION_INTERPOLATION_MASK   0x0F
+#define LED_ANIMATION_BASE_COLOR           0x80
+
+#define LED_ANIMATION_BLINK_WAIT 2 // Keyframe of led_animation_blink with the wait before the blinks
+
+#define LED_ANIMATION_PAGE      2
+#define LED_ANIMATION_MAGIC_POS 0
+#define LED_ANIMATION_SLOT_POS  1
+#define LED_ANIMATION_MAGIC     0x3E9A5C21
+
+typedef struct {
+	uint16_t duration; // ms until the next keyframe
+	uint16_t h;
+	uint8_t s;
+	uint8_t v;
+	uint8_t flags;     // Interpolation and LED_ANIMATION_BASE_COLOR
+	uint8_t reserved;
+} LEDKeyframe;
+
+typedef struct {
+	uint8_t keyframe_count;
+	uint8_t loop_start;
+	uint8_t loop_end;
+	uint8_t loop_count;
+	bool repeat;
+	uint8_t reserved[3];
+	LEDKeyframe keyframes[LED_ANIMATION_KEYFRAMES_MAX];
+} LEDAnimation;
+
+typedef struct {
+	const LEDAnimation *animation; // NULL = no animation
+	uint8_t index;                 // Current keyframe
+	uint8_t loop_pass;             // Completed passes of the loop
+	uint8_t loop_count;            // Loop count of the animation, can be changed while playing
+	bool done;                     // Last keyframe reached without repeat
+	uint32_t keyframe_start;       // ms
+
+	uint16_t base_h;
+	uint8_t base_s;
+	uint8_t base_v;
+} LEDAnimationPlayer;
+
+typedef struct {
+	LEDAnimation upload;                            // Keyframes written over the API, saved to a slot by led_animation_set_slot()
+	LEDAnimation play;                              // Slot loaded by led_animation_load_slot()
+	uint8_t play_slot;                              // LED_ANIMATION_SLOT_NONE if play is not loaded
+	uint8_t keyframe_count[LED_ANIMATION_SLOT_NUM]; // 0 = empty slot
+} LEDAnimationStorage;
+
+extern LEDAnimationStorage led_animation;
+
+extern const LEDAnimation led_animation_flicker;
+extern const LEDAnimation led_animation_breathing;
+extern const LEDAnimation led_animation_blink;
+extern const LEDAnimation led_animation_ack;
+extern const LEDAnimation led_animation_nack;
+extern const LEDAnimation led_animation_nag;
+
+// Called by led_tick() in every main loop iteration
+static inline void led_animation_stop(LEDAnimationPlayer *player) {
+	player->animation = NULL;
+}
+
+static inline void led_animation_set_base(LEDAnimationPlayer *player, const uint16_t h, const uint8_t s, const uint8_t v) {
+	player->base_h = h;
+	player->base_s = s;
+	player->base_v = v;
+}
+
+void led_animation_start(LEDAnimationPlayer *player, const LEDAnimation *animation, const uint8_t index);
+void led_animation_get_hsv(LEDAnimationPlayer *player, uint16_t *h, uint8_t *s, uint8_t *v);
+
+const LEDAnimation *led_animation_read_slot(const uint8_t slot, uint32_t *page);
+const LEDAnimation *led_animation_load_slot(const uint8_t slot);
+bool led_animation_set_slot(const uint8_t slot, const uint8_t keyframe_count, const uint8_t loop_start, const uint8_t loop_end, const uint8_t loop_count, const bool repeat);
+void led_animation_init(void);
+
+#endif
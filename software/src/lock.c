@@ -27,10 +27,13 @@
 #include "bricklib2/hal/ccu4_pwm/ccu4_pwm.h"
 #include "bricklib2/logging/logging.h"
 #include "bricklib2/hal/system_timer/system_timer.h"
+#include "bricklib2/utility/util_definitions.h"
 #include "configs/config_evse.h"
 #include "configs/config_lock.h"
 #include "evse.h"
 #include "hardware_version.h"
+#include "soft_timer.h"
+#include "digital_input.h"
 
 Lock lock;
 
@@ -99,24 +102,39 @@ LockState lock_get_state(void) {
 	return lock.state;
 }
 
+static void lock_start_attempt(const uint8_t direction) {
+	lock.duty_cycle  = lock.statistics[direction].ramp_start;
+	lock.retry_pause = false;
+	soft_timer_start(&lock.attempt_timer, LOCK_ATTEMPT_TIMEOUT);
+}
+
 void lock_set_locked(const bool locked) {
+	const uint8_t direction = locked ? LOCK_DIRECTION_CLOSE : LOCK_DIRECTION_OPEN;
 	if(locked) {
 		if((lock.state == LOCK_STATE_CLOSING) || (lock.state == LOCK_STATE_CLOSE)) {
 			return;
 		}
-
-		lock.state = LOCK_STATE_CLOSING;
-		lock.duty_cycle = 0;
-		lock_pwm_set(0, 0);
 	} else {
 		if((lock.state == LOCK_STATE_OPENING) || (lock.state == LOCK_STATE_OPEN)) {
 			return;
 		}
+	}
 
-		lock.state = LOCK_STATE_OPENING;
-		lock.duty_cycle = 0;
-		lock_pwm_set(0, 0);
+	// Don't retry a failed direction in every tick
+	if((lock.state == LOCK_STATE_ERROR) && (lock.error_direction == direction) && !soft_timer_is_expired(&lock.error_timer)) {
+		return;
 	}
+
+	lock.state           = locked ? LOCK_STATE_CLOSING : LOCK_STATE_OPENING;
+	lock.operation_start = system_timer_get_ms();
+	lock.attempt         = 0;
+	lock_pwm_set(0, 0);
+	lock_start_attempt(direction);
+
+	// The feedback time is always within this operation
+	lock.feedback_raw        = digital_input_get_raw(DIGITAL_INPUT_LOCK_FEEDBACK);
+	lock.feedback_time       = lock.operation_start;
+	lock.feedback_duty_cycle = lock.duty_cycle;
 }
 
 void lock_init(void) {
@@ -136,45 +154,105 @@ void lock_init(void) {
 	XMC_GPIO_Init(EVSE_LOCK_FEEDBACK_PIN, &pin_config_feedback);
 }
 
+static void lock_operation_done(const uint8_t direction, const uint32_t feedback_time) {
+	LockStatistics *statistics = &lock.statistics[direction];
+	const uint16_t duration    = (uint16_t)MIN(feedback_time - lock.operation_start, UINT16_MAX);
+
+	statistics->count++;
+	statistics->duration_last   = duration;
+	statistics->duration_sum   += duration;
+	if((statistics->count == 1) || (duration < statistics->duration_min)) {
+		statistics->duration_min = duration;
+	}
+	if(duration > statistics->duration_max) {
+		statistics->duration_max = duration;
+	}
+	statistics->duty_cycle_last = lock.feedback_duty_cycle;
+
+	// Feedback was already in the target state at the start: The lock did not
+	// move, there is nothing to learn from this operation.
+	if(duration == 0) {
+		// Keep ramp_start
+	} else if((lock.attempt == 0) && (lock.feedback_duty_cycle < EVSE_LOCK_PWM_PERIOD)) {
+		// Healthy lock: Moved during the ramp in the first attempt
+		statistics->ramp_start = (uint16_t)((3*statistics->ramp_start + lock.feedback_duty_cycle/2)/4);
+	} else {
+		statistics->ramp_start = 0;
+	}
+
+	lock.duty_cycle = 0;
+	lock_pwm_set(0, 0);
+	soft_timer_stop(&lock.attempt_timer);
+}
+
+static void lock_stalled(const uint8_t direction) {
+	LockStatistics *statistics = &lock.statistics[direction];
+
+	lock.duty_cycle        = 0;
+	lock_pwm_set(0, 0);
+	statistics->ramp_start = 0;
+
+	if(lock.attempt < LOCK_RETRIES_MAX) {
+		lock.attempt++;
+		lock.retry_pause = true;
+		statistics->retries++;
+		soft_timer_start(&lock.attempt_timer, LOCK_RETRY_PAUSE);
+	} else {
+		loge("Lock stalled (direction %d)\n\r", direction);
+		statistics->failures++;
+		lock.state           = LOCK_STATE_ERROR;
+		lock.error_direction = direction;
+		soft_timer_stop(&lock.attempt_timer);
+		soft_timer_start(&lock.error_timer, LOCK_ERROR_RETRY_TIME);
+	}
+}
+
 void lock_tick(void) {
 	if(!hardware_version.is_v4) {
 		return;
 	}
 
 	if((lock.state == LOCK_STATE_CLOSING) || (lock.state == LOCK_STATE_OPENING)) {
-		// This creates about 1 second of slow PWM run-up to reduce power draw from lock motor
+		const uint8_t direction = (lock.state == LOCK_STATE_CLOSING) ? LOCK_DIRECTION_CLOSE : LOCK_DIRECTION_OPEN;
+
+		// Motor is off between stalled attempts
+		if(lock.retry_pause) {
+			if(soft_timer_is_expired(&lock.attempt_timer)) {
+				lock_start_attempt(direction);
+			}
+			return;
+		}
+
+		// This creates a slow PWM run-up to reduce power draw from lock motor
 		if(system_timer_is_time_elapsed_ms(lock.last_duty_cycle_update, 1)) {
 			lock.last_duty_cycle_update = system_timer_get_ms();
-			lock.duty_cycle += 3;
+			lock.duty_cycle += LOCK_RAMP_STEP;
 			if(lock.duty_cycle > EVSE_LOCK_PWM_PERIOD) {
 				lock.duty_cycle = EVSE_LOCK_PWM_PERIOD;
 			}
 		}
 
-		const bool lock_closed = XMC_GPIO_GetInput(EVSE_LOCK_FEEDBACK_PIN);
-		const uint32_t lock_time = system_timer_get_ms();
-
-		if(lock_closed) {
-			lock.opened_time = 0;
-			if(lock.closed_time == 0) {
-				lock.closed_time = lock_time;
-			}
-		} else {
-			lock.closed_time = 0;
-			if(lock.opened_time == 0) {
-				lock.opened_time = lock_time;
-			}
+		// The feedback is debounced by the digital input integrator (75ms closed, 50ms opened).
+		// The lock moved where the last raw change happened, the time and duty cycle are taken from there.
+		const bool feedback_raw = digital_input_get_raw(DIGITAL_INPUT_LOCK_FEEDBACK);
+		if(feedback_raw != lock.feedback_raw) {
+			lock.feedback_raw        = feedback_raw;
+			lock.feedback_time       = system_timer_get_ms();
+			lock.feedback_duty_cycle = lock.duty_cycle;
 		}
 
-		if((lock.state == LOCK_STATE_CLOSING) && lock_closed && system_timer_is_time_elapsed_ms(lock.closed_time, 75)) {
+		const bool lock_closed = digital_input_get_value(DIGITAL_INPUT_LOCK_FEEDBACK);
+
+		if((lock.state == LOCK_STATE_CLOSING) && lock_closed) {
 			lock.state = LOCK_STATE_CLOSE;
-			lock.duty_cycle = 0;
-			lock_pwm_set(0, 0);
+			lock_operation_done(direction, lock.feedback_time);
 			return;
-		} else if((lock.state == LOCK_STATE_OPENING) && !lock_closed && system_timer_is_time_elapsed_ms(lock.opened_time, 50)) {
+		} else if((lock.state == LOCK_STATE_OPENING) && !lock_closed) {
 			lock.state = LOCK_STATE_OPEN;
-			lock.duty_cycle = 0;
-			lock_pwm_set(0, 0);
+			lock_operation_done(direction, lock.feedback_time);
+			return;
+		} else if(soft_timer_is_expired(&lock.attempt_timer)) {
+			lock_stalled(direction);
 			return;
 		}
 
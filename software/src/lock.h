@@ -25,8 +25,33 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "soft_timer.h"
+
 #define EVSE_LOCK_PWM_PERIOD 4800  // 10kHz
 
+// The motor is driven with a PWM ramp (LOCK_RAMP_STEP per ms) until the
+// feedback is stable. If the feedback does not change within
+// LOCK_ATTEMPT_TIMEOUT the motor is stalled, it is turned off for
+// LOCK_RETRY_PAUSE and the operation is retried up to LOCK_RETRIES_MAX times.
+// After that the lock goes to LOCK_STATE_ERROR, the same direction is
+// only requested again after LOCK_ERROR_RETRY_TIME.
+//
+// The ramp starts at the learned ramp_start of the direction: half of the
+// duty cycle at which the feedback changed (averaged), as long as the lock
+// moved before the ramp reached the full duty cycle without a retry.
+// Otherwise the ramp starts at 0 again. Operations where the feedback was
+// already in the target state at the start (duration 0) don't change it.
+
+#define LOCK_RAMP_STEP         3     // Duty cycle per ms, 1.6s to full duty cycle
+#define LOCK_ATTEMPT_TIMEOUT   3000  // ms
+#define LOCK_RETRY_PAUSE       500   // ms
+#define LOCK_RETRIES_MAX       2
+#define LOCK_ERROR_RETRY_TIME  60000 // ms
+
+#define LOCK_DIRECTION_CLOSE 0
+#define LOCK_DIRECTION_OPEN  1
+#define LOCK_DIRECTION_NUM   2
+
 typedef enum {
 	LOCK_STATE_INIT,
 	LOCK_STATE_OPEN,
@@ -37,10 +62,32 @@ typedef enum {
 } LockState;
 
 typedef struct {
-	uint32_t closed_time;
-	uint32_t opened_time;
+	uint32_t count;            // Completed operations
+	uint32_t retries;          // Stalled attempts that were retried
+	uint32_t failures;         // Operations that failed after all retries
+	uint16_t duration_last;    // ms from request to feedback change, including retries
+	uint16_t duration_min;
+	uint16_t duration_max;
+	uint32_t duration_sum;
+	uint16_t duty_cycle_last;  // Duty cycle when the feedback changed
+	uint16_t ramp_start;       // Learned duty cycle at the start of the ramp
+} LockStatistics;
+
+typedef struct {
+	SoftTimer attempt_timer; // Stall timeout or retry pause
+	SoftTimer error_timer;
 	uint32_t last_duty_cycle_update;
 	uint16_t duty_cycle;
+	uint16_t feedback_duty_cycle; // Duty cycle at the last raw feedback change
+	uint32_t feedback_time;       // ms, last raw feedback change
+	bool feedback_raw;
+
+	uint32_t operation_start;
+	uint8_t attempt;
+	bool retry_pause;
+	uint8_t error_direction;
+
+	LockStatistics statistics[LOCK_DIRECTION_NUM];
 
 	LockState state;
 } Lock;
@@ -48,33 +48,96 @@
 #include "frequency.h"
 #include "ove_r37.h"
 #include "iskra_display.h"
+#include "derating.h"
+#include "hot_path.h"
+#include "ram_usage.h"
+#include "warm_restart.h"
+#include "boot_timing.h"
+#include "cpu_load.h"
+#include "soft_timer.h"
+#include "digital_input.h"
+#include "cp_replay.h"
+#include "microbenchmark.h"
 
 int main(void) {
+	boot_timing_init(); // Keep first, takes the main() timestamp
+	ram_usage_init(); // Keep before all other inits, paints the stack
+	boot_timing_mark(BOOT_TIMING_RAM_USAGE_INIT);
+	warm_restart_init(); // Keep before hardware_version_init()
+	boot_timing_mark(BOOT_TIMING_WARM_RESTART_INIT);
 	logging_init();
+	boot_timing_mark(BOOT_TIMING_LOGGING_INIT);
 	logd("Start EVSE Bricklet 2.0\n\r");
 
 	hardware_version_init();
+	boot_timing_mark(BOOT_TIMING_HARDWARE_VERSION_INIT);
 	communication_init();
+	boot_timing_mark(BOOT_TIMING_COMMUNICATION_INIT);
+
+	// Image for another hardware version: Don't touch any of the hardware,
+	// only keep the bootloader running, so the correct firmware can be flashed.
+	if(!hardware_version_is_image_compatible()) {
+		logd("Firmware image is not for this hardware version\n\r");
+		while(true) {
+			bootloader_tick();
+		}
+	}
+
 	ove_r37_init(); // Keep before evse_init()
+	boot_timing_mark(BOOT_TIMING_OVE_R37_INIT);
+	eichrecht_init(); // Keep before evse_init()
+	boot_timing_mark(BOOT_TIMING_EICHRECHT_INIT);
 	evse_init();
+	boot_timing_mark(BOOT_TIMING_EVSE_INIT);
 	charging_slot_init();
+	boot_timing_mark(BOOT_TIMING_CHARGING_SLOT_INIT);
 	iec61851_init();
+	boot_timing_mark(BOOT_TIMING_IEC61851_INIT);
 	lock_init();
+	boot_timing_mark(BOOT_TIMING_LOCK_INIT);
 	contactor_check_init();
+	boot_timing_mark(BOOT_TIMING_CONTACTOR_CHECK_INIT);
 	led_init();
+	boot_timing_mark(BOOT_TIMING_LED_INIT);
 	button_init();
+	boot_timing_mark(BOOT_TIMING_BUTTON_INIT);
 	adc_init();
+	boot_timing_mark(BOOT_TIMING_ADC_INIT);
 	dc_fault_init();
+	boot_timing_mark(BOOT_TIMING_DC_FAULT_INIT);
+	digital_input_init(); // Keep after evse_init(), lock_init(), button_init() and dc_fault_init()
+	boot_timing_mark(BOOT_TIMING_DIGITAL_INPUT_INIT);
 	rs485_init();
+	boot_timing_mark(BOOT_TIMING_RS485_INIT);
 	meter_init();
+	boot_timing_mark(BOOT_TIMING_METER_INIT);
 	phase_control_init();
+	boot_timing_mark(BOOT_TIMING_PHASE_CONTROL_INIT);
 	tmp1075n_init();
-	eichrecht_init();
+	boot_timing_mark(BOOT_TIMING_TMP1075N_INIT);
+	derating_init();
+	boot_timing_mark(BOOT_TIMING_DERATING_INIT);
 	plc_init();
+	boot_timing_mark(BOOT_TIMING_PLC_INIT);
 	frequency_init();
+	boot_timing_mark(BOOT_TIMING_FREQUENCY_INIT);
 	iskra_display_init();
+	boot_timing_mark(BOOT_TIMING_ISKRA_DISPLAY_INIT);
+	hot_path_init();
+	boot_timing_mark(BOOT_TIMING_HOT_PATH_INIT);
+	cpu_load_init();
+	boot_timing_mark(BOOT_TIMING_CPU_LOAD_INIT);
+#ifdef CP_TRACE_REPLAY
+	cp_replay_init();
+	boot_timing_mark(BOOT_TIMING_CP_REPLAY_INIT);
+#endif
+	warm_restart_resume(); // Keep after all other inits
+	boot_timing_mark(BOOT_TIMING_WARM_RESTART_RESUME);
 
 	while(true) {
+		hot_path_tick();
+		soft_timer_tick(); // Keep before the ticks that use timers
+		digital_input_tick(); // Keep before the ticks that use the input values
 		bootloader_tick();
 		communication_tick();
 		lock_tick();
@@ -89,10 +152,21 @@ int main(void) {
 		charging_slot_tick();
 		phase_control_tick();
 		tmp1075n_tick();
+		derating_tick();
 		eichrecht_tick();
 		plc_tick();
 		frequency_tick();
 		ove_r37_tick();
 		iskra_display_tick();
+#ifdef CP_TRACE_REPLAY
+		cp_replay_tick();
+#endif
+#ifdef MICROBENCHMARK
+		microbenchmark_tick();
+#endif
+		ram_usage_tick();
+		warm_restart_tick();
+		boot_timing_tick();
+		cpu_load_tick(); // Keep last, sleeps until the next IRQ if nothing is due (CPU_SLEEP option)
 	}
 }
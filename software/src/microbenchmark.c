@@ -0,0 +1,300 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * microbenchmark.c: Cycle measurement of firmware hot functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "microbenchmark.h"
+
+#ifdef MICROBENCHMARK
+
+#include "bricklib2/hal/system_timer/system_timer.h"
+#include "bricklib2/protocols/tfp/tfp.h"
+
+#include "communication.h"
+#include "hardware_version.h"
+#include "hot_path.h"
+#include "adc.h"
+#include "iec61851.h"
+#include "evse.h"
+#include "charging_slot.h"
+#include "led.h"
+#include "eichrecht.h"
+#include "ove_r37.h"
+#include "frequency.h"
+
+#include <string.h>
+
+// Raw ADC values for the adc_check_count() benchmarks
+#define MICROBENCHMARK_RAW_VCP2 3465 // ~9.1V, 2700 ohm with 910 ohm divider (state B)
+#define MICROBENCHMARK_RAW_VPP  1026 // ~0.8V, 220 ohm with 1k/2k divider of v2/v3 (32A cable)
+
+typedef struct {
+	bool (*is_available)(void);
+	void (*setup)(const uint8_t arg); // Untimed
+	void (*run)(const uint8_t arg);   // Timed
+	uint8_t arg;
+} MicrobenchmarkFunction;
+
+Microbenchmark microbenchmark;
+
+// Results are written to volatile sinks so that the calls are not removed
+static volatile uint32_t microbenchmark_sink;
+static volatile float microbenchmark_sink_float;
+
+static EichrechtTransaction microbenchmark_transaction;
+static uint32_t microbenchmark_message[2];   // uint32_t for alignment of the TFP header
+static uint32_t microbenchmark_response[20]; // Max TFP message size is 80 byte
+
+static const uint32_t microbenchmark_cp_pe_resistance[] = {
+	[IEC61851_STATE_A]  = 0xFFFFFFFF,
+	[IEC61851_STATE_B]  = 2700,
+	[IEC61851_STATE_C]  = 880,
+	[IEC61851_STATE_D]  = 240,
+	[IEC61851_STATE_EF] = 50,
+};
+
+static bool microbenchmark_is_v3(void) {
+	return hardware_version.is_v3;
+}
+
+static bool microbenchmark_is_v4(void) {
+	return hardware_version.is_v4;
+}
+
+// The dataset is created in the arena, which is used by a transaction in progress
+static bool microbenchmark_is_eichrecht_idle(void) {
+	return hardware_version.is_v4 && (eichrecht.queue_count == 0);
+}
+
+static void microbenchmark_setup_none(const uint8_t arg) {
+}
+
+static void microbenchmark_run_none(const uint8_t arg) {
+}
+
+static void microbenchmark_setup_adc_check_count(const uint8_t i) {
+	const int32_t raw = i == ADC_CHANNEL_VCP2 ? MICROBENCHMARK_RAW_VCP2 : MICROBENCHMARK_RAW_VPP;
+
+	adc[i].result_sum[ADC_POSITIVE_MEASUREMENT]               = 25*raw;
+	adc[i].result_count[ADC_POSITIVE_MEASUREMENT]             = 25;
+	adc[i].result_count[ADC_NEGATIVE_MEASUREMENT]             = 0;
+	adc[i].ignore_count                                       = 0;
+	adc[ADC_CHANNEL_VCP1].result_mv[ADC_POSITIVE_MEASUREMENT] = 12000;
+}
+
+static void microbenchmark_run_adc_check_count(const uint8_t i) {
+	adc_check_count(i);
+}
+
+// Stay in the given state: Matching CP/PE resistance, no diode check and no ignored ADC results
+static void microbenchmark_setup_iec61851_tick(const uint8_t state) {
+	iec61851.state                                            = state;
+	iec61851.diode_error_counter                              = 0;
+	adc_result.cp_pe_resistance                               = microbenchmark_cp_pe_resistance[state];
+	adc_result.cp_pe_is_ignored                               = false;
+	adc[ADC_CHANNEL_VCP1].ignore_count                        = 0;
+	adc[ADC_CHANNEL_VCP2].ignore_count                        = 0;
+	adc[ADC_CHANNEL_VCP1].result_mv[ADC_NEGATIVE_MEASUREMENT] = 0;
+}
+
+static void microbenchmark_run_iec61851_tick(const uint8_t arg) {
+	iec61851_tick();
+}
+
+static void microbenchmark_run_iec61851_get_duty_cycle_for_ma(const uint8_t arg) {
+	microbenchmark_sink_float = iec61851_get_duty_cycle_for_ma(16000);
+}
+
+static void microbenchmark_setup_evse_set_cp_duty_cycle(const uint8_t arg) {
+	microbenchmark.duty_cycle = evse_get_cp_duty_cycle();
+}
+
+static void microbenchmark_run_evse_set_cp_duty_cycle(const uint8_t arg) {
+	evse_set_cp_duty_cycle(microbenchmark.duty_cycle);
+}
+
+static void microbenchmark_run_charging_slot_get_max_current(const uint8_t arg) {
+	microbenchmark_sink = charging_slot_get_max_current();
+}
+
+// Different hue in each iteration to cover all sectors
+static void microbenchmark_setup_led_hsv_to_rgb(const uint8_t arg) {
+	microbenchmark.hue = (uint16_t)((microbenchmark.hue + 7) % 360);
+}
+
+static void microbenchmark_run_led_hsv_to_rgb(const uint8_t arg) {
+	uint8_t r, g, b;
+	led_hsv_to_rgb(microbenchmark.hue, 255, 200, &r, &g, &b);
+	microbenchmark_sink = (uint32_t)r | ((uint32_t)g << 8) | ((uint32_t)b << 16);
+}
+
+// Transaction with the current OCMF user assignment, see eichrecht_queue_transaction()
+static void microbenchmark_setup_eichrecht_create_dataset(const uint8_t arg) {
+	EichrechtTransaction *t = &microbenchmark_transaction;
+
+	t->sequence          = 1;
+	t->transaction       = 'B';
+	t->unix_time         = 1767225600;
+	t->utc_time_offset   = 60;
+	t->signature_format  = 0;
+	t->is                = eichrecht.ocmf.is;
+	t->it                = eichrecht.ocmf.it;
+	t->id_escaped_length = eichrecht.ocmf.id_escaped_length;
+	memcpy(t->if_, eichrecht.ocmf.if_, sizeof(t->if_));
+	memcpy(t->id_escaped, eichrecht.ocmf.id_escaped, sizeof(t->id_escaped));
+}
+
+static void microbenchmark_run_eichrecht_create_dataset(const uint8_t arg) {
+	eichrecht_create_dataset(&microbenchmark_transaction);
+}
+
+static void microbenchmark_setup_ove_r37_tick(const uint8_t arg) {
+	ove_r37_request_evaluation();
+}
+
+static void microbenchmark_run_ove_r37_tick(const uint8_t arg) {
+	ove_r37_tick();
+}
+
+// Pretend a new period to force the statistics update
+static void microbenchmark_setup_frequency_tick(const uint8_t arg) {
+	frequency.last_period_total = frequency.period_total - 1;
+}
+
+static void microbenchmark_run_frequency_tick(const uint8_t arg) {
+	frequency_tick();
+}
+
+static void microbenchmark_setup_handle_message(const uint8_t arg) {
+	GetState *message = (GetState*)microbenchmark_message;
+
+	memset(microbenchmark_message, 0, sizeof(microbenchmark_message));
+	message->header.length = sizeof(GetState);
+	message->header.fid    = FID_GET_STATE;
+}
+
+static void microbenchmark_run_handle_message(const uint8_t arg) {
+	microbenchmark_sink = (uint32_t)handle_message(microbenchmark_message, microbenchmark_response);
+}
+
+static void microbenchmark_run_led_tick(const uint8_t arg) {
+	led_tick();
+}
+
+static void microbenchmark_setup_led_render(const uint8_t arg) {
+	led.render_valid = false;
+	for(uint8_t i = 0; i < LED_CHANNEL_NUM; i++) {
+		led.compare[i] = UINT16_MAX;
+	}
+}
+
+static void microbenchmark_run_led_render(const uint8_t arg) {
+	led_render();
+}
+
+static const MicrobenchmarkFunction microbenchmark_functions[MICROBENCHMARK_NUM] = {
+	[MICROBENCHMARK_ADC_CHECK_COUNT_VCP2]           = {NULL,                             microbenchmark_setup_adc_check_count,           microbenchmark_run_adc_check_count,                  ADC_CHANNEL_VCP2},
+	[MICROBENCHMARK_ADC_CHECK_COUNT_VPP]            = {NULL,                             microbenchmark_setup_adc_check_count,           microbenchmark_run_adc_check_count,                  ADC_CHANNEL_VPP},
+	[MICROBENCHMARK_IEC61851_TICK_A]                = {NULL,                             microbenchmark_setup_iec61851_tick,             microbenchmark_run_iec61851_tick,                    IEC61851_STATE_A},
+	[MICROBENCHMARK_IEC61851_TICK_B]                = {NULL,                             microbenchmark_setup_iec61851_tick,             microbenchmark_run_iec61851_tick,                    IEC61851_STATE_B},
+	[MICROBENCHMARK_IEC61851_TICK_C]                = {NULL,                             microbenchmark_setup_iec61851_tick,             microbenchmark_run_iec61851_tick,                    IEC61851_STATE_C},
+	[MICROBENCHMARK_IEC61851_TICK_D]                = {NULL,                             microbenchmark_setup_iec61851_tick,             microbenchmark_run_iec61851_tick,                    IEC61851_STATE_D},
+	[MICROBENCHMARK_IEC61851_TICK_EF]               = {NULL,                             microbenchmark_setup_iec61851_tick,             microbenchmark_run_iec61851_tick,                    IEC61851_STATE_EF},
+	[MICROBENCHMARK_IEC61851_GET_DUTY_CYCLE_FOR_MA] = {NULL,                             microbenchmark_setup_none,                      microbenchmark_run_iec61851_get_duty_cycle_for_ma,   0},
+	[MICROBENCHMARK_EVSE_SET_CP_DUTY_CYCLE]         = {NULL,                             microbenchmark_setup_evse_set_cp_duty_cycle,    microbenchmark_run_evse_set_cp_duty_cycle,           0},
+	[MICROBENCHMARK_CHARGING_SLOT_GET_MAX_CURRENT]  = {NULL,                             microbenchmark_setup_none,                      microbenchmark_run_charging_slot_get_max_current,    0},
+	[MICROBENCHMARK_LED_HSV_TO_RGB]                 = {NULL,                             microbenchmark_setup_led_hsv_to_rgb,            microbenchmark_run_led_hsv_to_rgb,                   0},
+	[MICROBENCHMARK_EICHRECHT_CREATE_DATASET]       = {microbenchmark_is_eichrecht_idle, microbenchmark_setup_eichrecht_create_dataset,  microbenchmark_run_eichrecht_create_dataset,         0},
+	[MICROBENCHMARK_OVE_R37_TICK]                   = {microbenchmark_is_v4,             microbenchmark_setup_ove_r37_tick,              microbenchmark_run_ove_r37_tick,                     0},
+	[MICROBENCHMARK_FREQUENCY_TICK]                 = {microbenchmark_is_v3,             microbenchmark_setup_frequency_tick,            microbenchmark_run_frequency_tick,                   0},
+	[MICROBENCHMARK_HANDLE_MESSAGE]                 = {NULL,                             microbenchmark_setup_handle_message,            microbenchmark_run_handle_message,                   0},
+	[MICROBENCHMARK_LED_TICK]                       = {NULL,                             microbenchmark_setup_none,                      microbenchmark_run_led_tick,                         0},
+	[MICROBENCHMARK_LED_RENDER]                     = {NULL,                             microbenchmark_setup_led_render,                microbenchmark_run_led_render,                       0},
+};
+
+static uint32_t microbenchmark_measure(const MicrobenchmarkFunction *function) {
+	function->setup(function->arg);
+
+	const uint32_t start = hot_path_get_cycles();
+	function->run(function->arg);
+	return hot_path_get_cycles() - start;
+}
+
+void microbenchmark_start(const uint8_t benchmark, const uint16_t iterations) {
+	const MicrobenchmarkFunction *function = &microbenchmark_functions[benchmark];
+
+	memset(&microbenchmark, 0, sizeof(Microbenchmark));
+	microbenchmark.benchmark  = benchmark;
+	microbenchmark.iterations = iterations;
+	microbenchmark.cycles_min = UINT32_MAX;
+
+	if((function->is_available != NULL) && !function->is_available()) {
+		microbenchmark.state = MICROBENCHMARK_STATE_NOT_AVAILABLE;
+		return;
+	}
+
+	// Cost of the measurement itself (function pointer calls and cycle counter)
+	const MicrobenchmarkFunction empty = {NULL, microbenchmark_setup_none, microbenchmark_run_none, 0};
+	microbenchmark.overhead = UINT32_MAX;
+	for(uint8_t i = 0; i < MICROBENCHMARK_OVERHEAD_RUNS; i++) {
+		const uint32_t cycles = microbenchmark_measure(&empty);
+		if(cycles < microbenchmark.overhead) {
+			microbenchmark.overhead = cycles;
+		}
+	}
+
+	microbenchmark.state = MICROBENCHMARK_STATE_RUNNING;
+}
+
+uint32_t microbenchmark_get_mean(void) {
+	if(microbenchmark.done == 0) {
+		return 0;
+	}
+
+	return (uint32_t)(microbenchmark.cycles_sum / microbenchmark.done);
+}
+
+void microbenchmark_tick(void) {
+	if(microbenchmark.state != MICROBENCHMARK_STATE_RUNNING) {
+		return;
+	}
+
+	const MicrobenchmarkFunction *function = &microbenchmark_functions[microbenchmark.benchmark];
+	const uint32_t batch_start = system_timer_get_ms();
+
+	while((microbenchmark.done < microbenchmark.iterations) && !system_timer_is_time_elapsed_ms(batch_start, MICROBENCHMARK_BATCH_MS)) {
+		const uint32_t measured = microbenchmark_measure(function);
+		const uint32_t cycles   = measured > microbenchmark.overhead ? measured - microbenchmark.overhead : 0;
+
+		microbenchmark.cycles_sum += cycles;
+		if(cycles < microbenchmark.cycles_min) {
+			microbenchmark.cycles_min = cycles;
+		}
+		if(cycles > microbenchmark.cycles_max) {
+			microbenchmark.cycles_max = cycles;
+		}
+		microbenchmark.done++;
+	}
+
+	if(microbenchmark.done >= microbenchmark.iterations) {
+		microbenchmark.state = MICROBENCHMARK_STATE_DONE;
+	}
+}
+
+#endif
@@ -0,0 +1,89 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * microbenchmark.h: Cycle measurement of firmware hot functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef MICROBENCHMARK_H
+#define MICROBENCHMARK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Only available in the image built with "cmake -DMICROBENCHMARK=ON".
+// The benchmarks call the real functions with fixed inputs on the running
+// EVSE (the state functions of IEC 61851 switch the outputs!). This image
+// is for the test bench only and the EVSE has to be reset after a run.
+//
+// Each iteration runs an untimed setup (fixed inputs) and the timed
+// function. The cycles of an empty measurement are subtracted. IRQs stay
+// enabled, min is the undisturbed runtime, max includes IRQs.
+// Iterations are executed in batches of up to MICROBENCHMARK_BATCH_MS in
+// microbenchmark_tick(), so communication keeps working during long runs.
+
+#define MICROBENCHMARK_ADC_CHECK_COUNT_VCP2           0  // CP/PE resistance of the running hardware version
+#define MICROBENCHMARK_ADC_CHECK_COUNT_VPP            1  // PP/PE resistance of the running hardware version
+#define MICROBENCHMARK_IEC61851_TICK_A                2
+#define MICROBENCHMARK_IEC61851_TICK_B                3
+#define MICROBENCHMARK_IEC61851_TICK_C                4
+#define MICROBENCHMARK_IEC61851_TICK_D                5
+#define MICROBENCHMARK_IEC61851_TICK_EF               6
+#define MICROBENCHMARK_IEC61851_GET_DUTY_CYCLE_FOR_MA 7
+#define MICROBENCHMARK_EVSE_SET_CP_DUTY_CYCLE         8  // Unchanged duty cycle
+#define MICROBENCHMARK_CHARGING_SLOT_GET_MAX_CURRENT  9
+#define MICROBENCHMARK_LED_HSV_TO_RGB                 10
+#define MICROBENCHMARK_EICHRECHT_CREATE_DATASET       11 // v4, without transaction in progress
+#define MICROBENCHMARK_OVE_R37_TICK                   12 // v4, with evaluation
+#define MICROBENCHMARK_FREQUENCY_TICK                 13 // v3, with statistics update
+#define MICROBENCHMARK_HANDLE_MESSAGE                 14 // Get State
+#define MICROBENCHMARK_LED_TICK                       15 // Current LED state, without rendering
+#define MICROBENCHMARK_LED_RENDER                     16 // New color, all compare values written
+#define MICROBENCHMARK_NUM                            17
+
+#define MICROBENCHMARK_STATE_IDLE          0
+#define MICROBENCHMARK_STATE_RUNNING       1
+#define MICROBENCHMARK_STATE_DONE          2
+#define MICROBENCHMARK_STATE_NOT_AVAILABLE 3 // Not available on this hardware version or in the current state
+
+#define MICROBENCHMARK_MAX_ITERATIONS 10000
+#define MICROBENCHMARK_BATCH_MS       2
+#define MICROBENCHMARK_OVERHEAD_RUNS                  16
+
+typedef struct {
+	uint8_t benchmark;
+	uint8_t state;
+	uint16_t iterations;
+	uint16_t done;
+
+	uint32_t overhead;   // Cycles of an empty measurement
+	uint32_t cycles_min;
+	uint32_t cycles_max;
+	uint64_t cycles_sum;
+
+	// Inputs of the current iteration, set by the setup functions
+	uint16_t hue;
+	float duty_cycle;
+} Microbenchmark;
+
+extern Microbenchmark microbenchmark;
+
+void microbenchmark_start(const uint8_t benchmark, const uint16_t iterations);
+uint32_t microbenchmark_get_mean(void);
+void microbenchmark_tick(void);
+
+#endif
@@ -27,6 +27,7 @@
 #include "charging_slot.h"
 #include "hardware_version.h"
 #include "iec61851.h"
+#include "soft_timer.h"
 
 #include "bricklib2/warp/meter.h"
 #include "bricklib2/hal/system_timer/system_timer.h"
@@ -120,8 +121,78 @@ static bool ove_r37_reconnect_supply_ok(void) {
 	return true;
 }
 
+// Running extremes are updated once per evaluation for the open events only.
+static void ove_r37_event_update_extremes(OveR37Event *event) {
+	if(ove_r37.voltage_valid) {
+		for(uint8_t i = 0; i < 3; i++) {
+			if(ove_r37.phase_connected[i]) {
+				event->voltage_min[i] = MIN(event->voltage_min[i], ove_r37.voltage[i]);
+				event->voltage_max[i] = MAX(event->voltage_max[i], ove_r37.voltage[i]);
+			}
+		}
+	}
+
+	if(ove_r37.frequency_valid) {
+		event->frequency_min = MIN(event->frequency_min, ove_r37.frequency);
+		event->frequency_max = MAX(event->frequency_max, ove_r37.frequency);
+	}
+}
+
+static void ove_r37_event_close(const uint8_t type, const uint8_t flags) {
+	const uint8_t index = ove_r37.event_open[type];
+	if(index == OVE_R37_EVENT_NOT_OPEN) {
+		return;
+	}
+
+	OveR37Event *event = &ove_r37.events[index];
+	event->flags    = flags;
+	event->duration = system_timer_get_ms() - event->start;
+
+	ove_r37.event_open[type] = OVE_R37_EVENT_NOT_OPEN;
+}
+
+static void ove_r37_event_open(const uint8_t type) {
+	ove_r37_event_close(type, 0);
+
+	const uint8_t index = ove_r37.event_sequence_next % OVE_R37_EVENT_RING_SIZE;
+
+	// The oldest event is overwritten, it is not updated anymore
+	for(uint8_t t = 0; t < OVE_R37_EVENT_TYPE_NUM; t++) {
+		if(ove_r37.event_open[t] == index) {
+			ove_r37.event_open[t] = OVE_R37_EVENT_NOT_OPEN;
+		}
+	}
+
+	OveR37Event *event = &ove_r37.events[index];
+	memset(event, 0, sizeof(OveR37Event));
+	event->sequence    = ove_r37.event_sequence_next;
+	event->type        = type;
+	event->flags       = OVE_R37_EVENT_FLAG_ACTIVE;
+	event->trip_reason = ove_r37.trip_reason;
+	event->start       = system_timer_get_ms();
+
+	event->voltage_min[0] = event->voltage_min[1] = event->voltage_min[2] = UINT32_MAX;
+	event->frequency_min  = UINT32_MAX;
+	ove_r37_event_update_extremes(event);
+
+	ove_r37.event_sequence_next++;
+	if(ove_r37.event_count < OVE_R37_EVENT_RING_SIZE) {
+		ove_r37.event_count++;
+	}
+	ove_r37.event_open[type] = index;
+}
+
+static void ove_r37_event_update_open(void) {
+	for(uint8_t t = 0; t < OVE_R37_EVENT_TYPE_NUM; t++) {
+		if(ove_r37.event_open[t] != OVE_R37_EVENT_NOT_OPEN) {
+			ove_r37_event_update_extremes(&ove_r37.events[ove_r37.event_open[t]]);
+		}
+	}
+}
+
 void ove_r37_init(void) {
 	memset(&ove_r37, 0, sizeof(OveR37));
+	memset(ove_r37.event_open, OVE_R37_EVENT_NOT_OPEN, sizeof(ove_r37.event_open));
 
 	if(!hardware_version.is_v4) {
 		return;
@@ -138,25 +209,136 @@ void ove_r37_init(void) {
 	ove_r37.ramp_limit     = OVE_R37_NO_LIMIT;
 	ove_r37.max_current    = 0;
 	ove_r37.slot_active    = false;
+
+	ove_r37.evaluate_pending = true;
 }
 
-void ove_r37_tick(void) {
-	if(!hardware_version.is_v4) {
+static bool ove_r37_evaluation_due(void) {
+	bool due = ove_r37.evaluate_pending;
+	ove_r37.evaluate_pending = false;
+
+	// New meter sample
+	if(meter.register_fast_time != ove_r37.last_sample_time) {
+		ove_r37.last_sample_time = meter.register_fast_time;
+		due = true;
+	}
+
+	// Meter data became stale. Checked every tick, so the stale guarantee is unchanged.
+	const bool fresh = !system_timer_is_time_elapsed_ms(meter.register_fast_time, OVE_R37_METER_STALE_MS);
+	if(fresh != ove_r37.last_fresh) {
+		ove_r37.last_fresh = fresh;
+		due = true;
+	}
+
+	if((meter.available != ove_r37.last_meter_available) || ((uint8_t)meter.type != ove_r37.last_meter_type)) {
+		ove_r37.last_meter_available = meter.available;
+		ove_r37.last_meter_type      = (uint8_t)meter.type;
+		due = true;
+	}
+
+	for(uint8_t i = 0; i < 3; i++) {
+		if(meter.phases_connected[i] != ove_r37.last_phases_connected[i]) {
+			ove_r37.last_phases_connected[i] = meter.phases_connected[i];
+			due = true;
+		}
+	}
+
+	const bool charge_requested = (iec61851.state == IEC61851_STATE_B) ||
+	                              (iec61851.state == IEC61851_STATE_C);
+	if(charge_requested != ove_r37.last_charge_requested) {
+		ove_r37.last_charge_requested = charge_requested;
+		due = true;
+	}
+
+	// Next timer deadline (undervoltage observation, boot window, wait time, ramp step, start delay)
+	if(soft_timer_is_expired(&ove_r37.deadline_timer)) {
+		due = true;
+	}
+
+	return due;
+}
+
+static void ove_r37_schedule(const uint32_t now, const uint32_t start, const uint32_t duration) {
+	const uint32_t elapsed   = now - start;
+	const uint32_t remaining = (elapsed >= duration) ? 0 : (duration - elapsed);
+
+	// All deadlines are scheduled with the same now, the timeout is the remaining time of the earliest one
+	if(!soft_timer_is_running(&ove_r37.deadline_timer) || (remaining < ove_r37.deadline_timer.timeout)) {
+		soft_timer_start_from(&ove_r37.deadline_timer, now, remaining);
+	}
+}
+
+// Schedule the next evaluation for the earliest pending timer.
+// A timer that is already elapsed but did not trigger yet is evaluated again in the next tick.
+static void ove_r37_schedule_next_evaluation(const bool changed) {
+	const uint32_t now = system_timer_get_ms();
+	soft_timer_stop(&ove_r37.deadline_timer);
+
+	if(!ove_r37.enabled) {
 		return;
 	}
 
+	// A state change can enable further transitions (as before in the next tick)
+	if(changed) {
+		ove_r37_schedule(now, now, 0);
+	}
+
+	if((ove_r37.undervoltage_since != 0) && !(ove_r37.trip_reason & OVE_R37_TRIP_UNDERVOLTAGE)) {
+		ove_r37_schedule(now, ove_r37.undervoltage_since, ove_r37.undervoltage_observe_ms);
+	}
+
+	switch(ove_r37.state) {
+		case OVE_R37_STATE_BOOT:
+			ove_r37_schedule(now, ove_r37.boot_start, OVE_R37_BOOT_WINDOW_MS);
+			break;
+
+		case OVE_R37_STATE_WAIT:
+			ove_r37_schedule(now, ove_r37.wait_start, (uint32_t)ove_r37.reconnect_wait_s * 1000U);
+			break;
+
+		case OVE_R37_STATE_RAMP: {
+			// Elapsed time at which the ramp limit increases by the next mA
+			const uint32_t step         = (uint32_t)(((uint64_t)(now - ove_r37.ramp_start) * OVE_R37_RAMP_RATE_MA_PER_MIN) / 60000U) + 1;
+			const uint32_t next_elapsed = (uint32_t)(((uint64_t)step * 60000U + OVE_R37_RAMP_RATE_MA_PER_MIN - 1) / OVE_R37_RAMP_RATE_MA_PER_MIN);
+			ove_r37_schedule(now, ove_r37.ramp_start, next_elapsed);
+			break;
+		}
+
+		default: break;
+	}
+
+	if(ove_r37.start_delay_active) {
+		ove_r37_schedule(now, ove_r37.start_delay_ref, ove_r37.start_delay_ms);
+	}
+}
+
+static void ove_r37_evaluate(void) {
+	ove_r37.evaluations++;
+
 	ove_r37_update_measurements();
+	ove_r37_event_update_open();
 
 	if(!ove_r37.enabled) {
+		for(uint8_t t = 0; t < OVE_R37_EVENT_TYPE_NUM; t++) {
+			ove_r37_event_close(t, OVE_R37_EVENT_FLAG_ABORTED);
+		}
+
 		ove_r37.state              = OVE_R37_STATE_DISABLED;
 		ove_r37.trip_reason        = OVE_R37_TRIP_NONE;
 		ove_r37.symmetry_limit     = OVE_R37_NO_LIMIT;
 		ove_r37.ramp_limit         = OVE_R37_NO_LIMIT;
 		ove_r37.start_delay_active = false;
-		ove_r37_update_charging_slot();
+		ove_r37_schedule_next_evaluation(false);
 		return;
 	}
 
+	const OveR37State state              = ove_r37.state;
+	const uint8_t trip_reason            = ove_r37.trip_reason;
+	const uint32_t undervoltage_since    = ove_r37.undervoltage_since;
+	const uint32_t wait_start            = ove_r37.wait_start;
+	const uint16_t symmetry_limit        = ove_r37.symmetry_limit;
+	const bool start_delay_active        = ove_r37.start_delay_active;
+
 	// A charge is requested once a vehicle is connected (IEC state B or C).
 	ove_r37.charge_requested = (iec61851.state == IEC61851_STATE_B) ||
 	                           (iec61851.state == IEC61851_STATE_C);
@@ -177,7 +359,41 @@ void ove_r37_tick(void) {
 	ove_r37_check_phase_symmetry();
 	ove_r37_apply_start_delay();
 
-	// Apply the combined result.
+	if(symmetry_limit != ove_r37.symmetry_limit) {
+		if(ove_r37.symmetry_limit == OVE_R37_NO_LIMIT) {
+			ove_r37_event_close(OVE_R37_EVENT_TYPE_SYMMETRY_CAP, 0);
+		} else {
+			ove_r37_event_open(OVE_R37_EVENT_TYPE_SYMMETRY_CAP);
+		}
+	}
+
+	const bool changed = (state              != ove_r37.state)              ||
+	                     (trip_reason        != ove_r37.trip_reason)        ||
+	                     (undervoltage_since != ove_r37.undervoltage_since) ||
+	                     (wait_start         != ove_r37.wait_start)         ||
+	                     (symmetry_limit     != ove_r37.symmetry_limit)     ||
+	                     (start_delay_active != ove_r37.start_delay_active);
+
+	ove_r37_schedule_next_evaluation(changed);
+}
+
+void ove_r37_request_evaluation(void) {
+	ove_r37.evaluate_pending = true;
+}
+
+void ove_r37_tick(void) {
+	if(!hardware_version.is_v4) {
+		return;
+	}
+
+	if(ove_r37_evaluation_due()) {
+		ove_r37_evaluate();
+	} else {
+		ove_r37.evaluations_skipped++;
+	}
+
+	// Apply the combined result. This is cheap and keeps the slot in sync
+	// even if it is changed from somewhere else.
 	ove_r37_update_charging_slot();
 }
 
@@ -211,6 +427,8 @@ void ove_r37_check_undervoltage_trip(void) {
 			ove_r37.trip_reason |= OVE_R37_TRIP_UNDERVOLTAGE;
 			if((ove_r37.state == OVE_R37_STATE_NORMAL) || (ove_r37.state == OVE_R37_STATE_RAMP)) {
 				ove_r37.state = OVE_R37_STATE_TRIPPED;
+				ove_r37_event_close(OVE_R37_EVENT_TYPE_RAMP, OVE_R37_EVENT_FLAG_ABORTED);
+				ove_r37_event_open(OVE_R37_EVENT_TYPE_TRIP);
 			}
 		}
 	} else {
@@ -276,6 +494,7 @@ void ove_r37_check_boot_lockout(void) {
 	if(ove_r37.charge_requested) {
 		ove_r37.state      = OVE_R37_STATE_TRIPPED;
 		ove_r37.wait_start = 0;
+		ove_r37_event_open(OVE_R37_EVENT_TYPE_TRIP);
 		return;
 	}
 
@@ -296,6 +515,7 @@ void ove_r37_check_reconnect_conditions(void) {
 	if(!ove_r37_reconnect_supply_ok()) {
 		ove_r37.state      = OVE_R37_STATE_TRIPPED;
 		ove_r37.wait_start = 0;
+		ove_r37_event_close(OVE_R37_EVENT_TYPE_WAIT, OVE_R37_EVENT_FLAG_RESET);
 		return;
 	}
 
@@ -303,6 +523,7 @@ void ove_r37_check_reconnect_conditions(void) {
 	if(ove_r37.state == OVE_R37_STATE_TRIPPED) {
 		ove_r37.state      = OVE_R37_STATE_WAIT;
 		ove_r37.wait_start = ove_r37_now_ms();
+		ove_r37_event_open(OVE_R37_EVENT_TYPE_WAIT);
 	}
 
 	// Resume charging readiness once the wait time has elapsed.
@@ -311,6 +532,9 @@ void ove_r37_check_reconnect_conditions(void) {
 		ove_r37.state       = OVE_R37_STATE_RAMP;
 		ove_r37.ramp_start  = ove_r37_now_ms();
 		ove_r37.ramp_limit  = OVE_R37_RAMP_START_MA;
+		ove_r37_event_close(OVE_R37_EVENT_TYPE_WAIT, 0);
+		ove_r37_event_close(OVE_R37_EVENT_TYPE_TRIP, 0);
+		ove_r37_event_open(OVE_R37_EVENT_TYPE_RAMP);
 	}
 }
 
@@ -328,6 +552,7 @@ void ove_r37_apply_power_ramp(void) {
 		// Ramp finished: Release the limit and return to normal operation.
 		ove_r37.ramp_limit = OVE_R37_NO_LIMIT;
 		ove_r37.state      = OVE_R37_STATE_NORMAL;
+		ove_r37_event_close(OVE_R37_EVENT_TYPE_RAMP, 0);
 	} else {
 		ove_r37.ramp_limit = (uint16_t)limit;
 	}
@@ -391,9 +616,13 @@ void ove_r37_arm_start_delay(uint16_t seconds) {
 	ove_r37.start_delay_ref    = ove_r37_now_ms();
 	ove_r37.start_delay_ms     = (uint32_t)(seconds * 1000U);
 	ove_r37.start_delay_active = true;
+	ove_r37_event_open(OVE_R37_EVENT_TYPE_START_DELAY);
 
 	// Apply the charging slot immediately to avoid race condition.
 	ove_r37_update_charging_slot();
+
+	// Schedule the expiry of the start delay
+	ove_r37_request_evaluation();
 }
 
 uint16_t ove_r37_get_start_delay_remaining_s(void) {
@@ -418,6 +647,7 @@ void ove_r37_apply_start_delay(void) {
 	// that connects during the delay window is held off until expiry.
 	if(system_timer_is_time_elapsed_ms(ove_r37.start_delay_ref, ove_r37.start_delay_ms)) {
 		ove_r37.start_delay_active = false;
+		ove_r37_event_close(OVE_R37_EVENT_TYPE_START_DELAY, 0);
 	}
 }
 
@@ -469,3 +699,27 @@ uint8_t ove_r37_get_flags(void) {
 	       (ove_r37.frequency_valid    ? OVE_R37_FLAG_FREQUENCY_VALID    : 0) |
 	       (ove_r37.start_delay_active ? OVE_R37_FLAG_START_DELAY_ACTIVE : 0);
 }
+
+// Returns the event with the given sequence number. If it was already
+// overwritten the oldest available event is returned instead.
+const OveR37Event *ove_r37_get_event(const uint16_t sequence) {
+	const uint16_t age = (uint16_t)(ove_r37.event_sequence_next - sequence);
+	if((ove_r37.event_count == 0) || (age == 0) || (age > 0x8000)) {
+		return NULL;
+	}
+
+	uint16_t available = sequence;
+	if(age > ove_r37.event_count) {
+		available = (uint16_t)(ove_r37.event_sequence_next - ove_r37.event_count);
+	}
+
+	return &ove_r37.events[available % OVE_R37_EVENT_RING_SIZE];
+}
+
+uint32_t ove_r37_get_event_duration(const OveR37Event *event) {
+	if(event->flags & OVE_R37_EVENT_FLAG_ACTIVE) {
+		return system_timer_get_ms() - event->start;
+	}
+
+	return event->duration;
+}
@@ -25,6 +25,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "soft_timer.h"
+
 #define OVE_R37_NOMINAL_VOLTAGE_MV               230000
 #define OVE_R37_METER_STALE_MS                   1000
 
@@ -75,6 +77,22 @@
 
 #define OVE_R37_BOOT_WINDOW_MS                   30000
 
+// Grid event recorder
+#define OVE_R37_EVENT_RING_SIZE                  8      // Power of two
+#define OVE_R37_EVENT_NOT_OPEN                   0xFF
+
+#define OVE_R37_EVENT_TYPE_NONE                  0
+#define OVE_R37_EVENT_TYPE_TRIP                  1      // Tripped (or boot lock-out) until reconnect
+#define OVE_R37_EVENT_TYPE_WAIT                  2      // Reconnect wait time
+#define OVE_R37_EVENT_TYPE_RAMP                  3      // Power ramp after reconnect
+#define OVE_R37_EVENT_TYPE_SYMMETRY_CAP          4      // 16 A symmetry cap active
+#define OVE_R37_EVENT_TYPE_START_DELAY           5      // Randomized start delay
+#define OVE_R37_EVENT_TYPE_NUM                   6
+
+#define OVE_R37_EVENT_FLAG_ACTIVE                (1 << 0) // Event not finished yet
+#define OVE_R37_EVENT_FLAG_RESET                 (1 << 1) // Wait time reset by renewed violation
+#define OVE_R37_EVENT_FLAG_ABORTED               (1 << 2) // Ended by trip or disable
+
 typedef enum {
 	OVE_R37_STATE_DISABLED = 0,
 	OVE_R37_STATE_NORMAL,
@@ -84,6 +102,21 @@ typedef enum {
 	OVE_R37_STATE_BOOT,
 } OveR37State;
 
+typedef struct {
+	uint16_t sequence;
+	uint8_t type;
+	uint8_t flags;
+	uint8_t trip_reason;
+	uint32_t start;
+	uint32_t duration;
+
+	// Extremes observed while the event is active
+	uint32_t voltage_min[3];
+	uint32_t voltage_max[3];
+	uint32_t frequency_min;
+	uint32_t frequency_max;
+} OveR37Event;
+
 typedef struct {
 	bool enabled;
 	uint16_t undervoltage_threshold_pu; // 1/1000 pu, default 800 (5.9.8)
@@ -127,12 +160,35 @@ typedef struct {
 	// Result
 	uint16_t max_current;
 	bool slot_active;
+
+	// Event-driven evaluation: The checks only run if an input changed
+	// (new meter sample, meter freshness, vehicle state, configuration)
+	// or if the next timer deadline is reached.
+	bool evaluate_pending;
+	uint32_t last_sample_time;
+	bool last_fresh;
+	bool last_meter_available;
+	uint8_t last_meter_type;
+	bool last_phases_connected[3];
+	bool last_charge_requested;
+
+	SoftTimer deadline_timer;
+
+	uint32_t evaluations;
+	uint32_t evaluations_skipped;
+
+	// Grid event ring, index is sequence % OVE_R37_EVENT_RING_SIZE
+	OveR37Event events[OVE_R37_EVENT_RING_SIZE];
+	uint16_t event_sequence_next;
+	uint8_t event_count;
+	uint8_t event_open[OVE_R37_EVENT_TYPE_NUM];
 } OveR37;
 
 extern OveR37 ove_r37;
 
 void ove_r37_init(void);
 void ove_r37_tick(void);
+void ove_r37_request_evaluation(void);
 
 void ove_r37_check_undervoltage_trip(void);
 void ove_r37_check_voltage_range(void);
@@ -147,5 +203,7 @@ uint16_t ove_r37_get_start_delay_remaining_s(void);
 void ove_r37_update_charging_slot(void);
 
 uint8_t ove_r37_get_flags(void);
+const OveR37Event *ove_r37_get_event(const uint16_t sequence);
+uint32_t ove_r37_get_event_duration(const OveR37Event *event);
 
 #endif
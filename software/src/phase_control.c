@@ -181,7 +181,7 @@ void phase_control_tick(void) {
 
 
 	// Only switch phase if contactor is not active.
-	const bool contactor_inactive = XMC_GPIO_GetInput(EVSE_CONTACTOR_PIN); // Contactor pin is active low
+	const bool contactor_inactive = !evse_is_contactor_active();
 	const bool cp_disconnected = !evse_is_cp_connected();
 	if(contactor_inactive && (cp_disconnected || iec61851.instant_phase_switch_allowed)) {
 		if(phase_control.requested == 1) {
@@ -200,15 +200,35 @@ void phase_control_tick(void) {
 	}
 }
 
+static uint32_t phase_control_get_wait_ms_before_reconnect(void) {
+	// Normally we wait for 45 seconds before reconnecting the CP. That means that we simulate
+	// an unplug of the type 2 connector and a re-plug-in after 45 seconds.
+	// The IEC61851 does not specify a time for this. By trial and error we found out that
+	// some EVs (BMW iX3, Cupra Tavascan) need 45 seconds to recognize the re-plug-in properly.
+	// We use this as default and allow the user to change it.
+
+	// However, if the contactor was switched under load, we fear that the EV may not have noticed
+	// that we wanted to stop charging. In this case we wait for at least a full minute to absolutely
+	// make sure that the EV notices what is going on (even if the user configured 15s).
+	//
+	// Note that this only happens if the EV does not respond to the CP signal change within 6 seconds
+	// while the standard specifies that the EV needs to respond within 3 seconds.
+	// So this should only happen if the EV charger has some kind of hang-up
+	// (we have seen this hang-up with Polestar chargers).
+
+	const uint32_t user_configuration = (phase_control.phase_switch_wait_time == EVSE_V2_PHASE_SWITCH_WAIT_TIME_DEFAULT) ? PHASE_CONTROL_PHASE_SWITCH_WAIT_TIME_DEFAULT : (PHASE_CONTROL_PHASE_SWITCH_WAIT_TIME_MINIMUM + (phase_control.phase_switch_wait_time * PHASE_CONTROL_PHASE_SWITCH_WAIT_TIME_INCREMENT));
+	return evse.contactor_maybe_switched_under_load ? MAX(user_configuration, PHASE_CONTROL_PHASE_SWITCH_WAIT_TIME_UNDER_LOAD) : user_configuration;
+}
+
 void phase_control_done(void) {
 	phase_control.progress_state = 0;
-	phase_control.progress_state_time = 0;
+	soft_timer_stop(&phase_control.progress_state_timer);
 	phase_control.in_progress = false;
 }
 
 // Special phase changing state that is handled similar to the normal IEC61851 states
 void phase_control_state_phase_change(void) {
-	const bool contactor_active = !XMC_GPIO_GetInput(EVSE_CONTACTOR_PIN);
+	const bool contactor_active = evse_is_contactor_active();
 	const bool cp_connected = evse_is_cp_connected();
 	const uint16_t duty_cycle = evse_get_cp_duty_cycle();
 
@@ -227,14 +247,14 @@ void phase_control_state_phase_change(void) {
 			phase_control.progress_state = 4;
 		}
 
-		phase_control.progress_state_time = system_timer_get_ms();
+		// State 3 waits 100ms before CP disconnect
+		soft_timer_start(&phase_control.progress_state_timer, 100);
 	}
 
 	switch(phase_control.progress_state) {
 		case 1: { // PWM 100%
 			evse_set_output(1000, contactor_active);
 			phase_control.progress_state = 2;
-			phase_control.progress_state_time = system_timer_get_ms();
 			break;
 		}
 
@@ -244,17 +264,16 @@ void phase_control_state_phase_change(void) {
 			evse_set_output(1000, false); // Disable contactor
 			if(!contactor_active) {
 				phase_control.progress_state = 3;
-				phase_control.progress_state_time = system_timer_get_ms();
+				soft_timer_start(&phase_control.progress_state_timer, 100);
 			}
 			break;
 		}
 
 		case 3: { // CP disconnect
-			if(system_timer_is_time_elapsed_ms(phase_control.progress_state_time, 100)) {
+			if(soft_timer_is_expired(&phase_control.progress_state_timer)) {
 				// Disconnect CP
 				evse_cp_disconnect();
 				phase_control.progress_state = 4;
-				phase_control.progress_state_time = system_timer_get_ms();
 
 				// After CP disconnect it is as if the EV was disconnected, so can switch the phases
 				// now until the contactor is turned on again.
@@ -266,48 +285,36 @@ void phase_control_state_phase_change(void) {
 		case 4: { // Phase switch
 			if(phase_control.current == phase_control.requested) {
 				phase_control.progress_state = 5;
-				phase_control.progress_state_time = system_timer_get_ms();
+				soft_timer_start(&phase_control.progress_state_timer, phase_control_get_wait_ms_before_reconnect());
 			}
 			break;
 		}
 
 		case 5: { // CP Connect
-			// Normally we wait for 45 seconds before reconnecting the CP. That means that we simulate
-			// an unplug of the type 2 connector and a re-plug-in after 45 seconds.
-			// The IEC61851 does not specify a time for this. By trial and error we found out that
-			// some EVs (BMW iX3, Cupra Tavascan) need 45 seconds to recognize the re-plug-in properly.
-			// We use this as default and allow the user to change it.
-
-			// However, if the contactor was switched under load, we fear that the EV may not have noticed
-			// that we wanted to stop charging. In this case we wait for at least a full minute to absolutely
-			// make sure that the EV notices what is going on (even if the user configured 15s).
-			//
-			// Note that this only happens if the EV does not respond to the CP signal change within 6 seconds
-			// while the standard specifies that the EV needs to respond within 3 seconds.
-			// So this should only happen if the EV charger has some kind of hang-up
-			// (we have seen this hang-up with Polestar chargers).
-
-			const uint32_t user_configuration = (phase_control.phase_switch_wait_time == EVSE_V2_PHASE_SWITCH_WAIT_TIME_DEFAULT) ? PHASE_CONTROL_PHASE_SWITCH_WAIT_TIME_DEFAULT : (PHASE_CONTROL_PHASE_SWITCH_WAIT_TIME_MINIMUM + (phase_control.phase_switch_wait_time * PHASE_CONTROL_PHASE_SWITCH_WAIT_TIME_INCREMENT));
-			const uint32_t wait_ms_before_reconnect = evse.contactor_maybe_switched_under_load ? MAX(user_configuration, PHASE_CONTROL_PHASE_SWITCH_WAIT_TIME_UNDER_LOAD) : user_configuration;
+			// The configuration can change while we wait, the wait time is always relative to the start of state 5
+			const uint32_t wait_ms_before_reconnect = phase_control_get_wait_ms_before_reconnect();
+			if(wait_ms_before_reconnect != phase_control.progress_state_timer.timeout) {
+				soft_timer_start_from(&phase_control.progress_state_timer, soft_timer_get_start(&phase_control.progress_state_timer), wait_ms_before_reconnect);
+			}
 
 			// Connect CP
-			if(system_timer_is_time_elapsed_ms(phase_control.progress_state_time, wait_ms_before_reconnect)) {
+			if(soft_timer_is_expired(&phase_control.progress_state_timer)) {
 				evse_cp_connect();
 				phase_control.progress_state = 6;
-				phase_control.progress_state_time = system_timer_get_ms();
+				soft_timer_start(&phase_control.progress_state_timer, 100);
 			}
 			break;
 		}
 
 		case 6: { // PWM x%
-			if(system_timer_is_time_elapsed_ms(phase_control.progress_state_time, 100)) {
+			if(soft_timer_is_expired(&phase_control.progress_state_timer)) {
 				uint32_t ma = iec61851_get_max_ma();
 				evse_set_output(iec61851_get_duty_cycle_for_ma(ma), false);
 				// If the car is currently allowed to charge and the IEC61851 state was C before the state change
 				// we wait for the car to start charging again before phase switch is done
 				if((ma != 0) && (iec61851.state == IEC61851_STATE_C)) {
 					phase_control.progress_state = 7;
-					phase_control.progress_state_time = system_timer_get_ms();
+					soft_timer_start(&phase_control.progress_state_timer, 10*1000);
 				} else {
 					phase_control_done();
 				}
@@ -322,7 +329,7 @@ void phase_control_state_phase_change(void) {
 				phase_control_done();
 			// If nobody wants to charge after 10 seconds we give up
 			// IEC61851 state will go to B through normal state machine
-			} else if(system_timer_is_time_elapsed_ms(phase_control.progress_state_time, 10*1000)) {
+			} else if(soft_timer_is_expired(&phase_control.progress_state_timer)) {
 				phase_control_done();
 			}
 		}
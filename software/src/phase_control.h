@@ -25,6 +25,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "soft_timer.h"
+
 #define PHASE_CONTROL_PHASE_SWITCH_WAIT_TIME_DEFAULT    (60*1000UL) // ms
 #define PHASE_CONTROL_PHASE_SWITCH_WAIT_TIME_INCREMENT   (5*1000UL) // ms
 #define PHASE_CONTROL_PHASE_SWITCH_WAIT_TIME_MINIMUM    (10*1000UL) // ms
@@ -38,7 +40,7 @@ typedef struct {
 
 	bool in_progress;
 	uint8_t progress_state;
-	uint32_t progress_state_time;
+	SoftTimer progress_state_timer;
 
 	uint32_t autoswitch_time;
 	bool autoswitch_done;
@@ -0,0 +1,76 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * ram_usage.c: Stack high-water mark and RAM usage
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "ram_usage.h"
+
+#include "bricklib2/hal/system_timer/system_timer.h"
+
+#include "xmc_device.h"
+
+#include <string.h>
+
+// Defined in XMC1 linker script. The stack grows down from __stack_end
+// to __stack_start, the heap is the rest of the RAM after .bss.
+extern uint32_t __stack_start;
+extern uint32_t __stack_end;
+extern uint32_t Heap_Bank1_Start;
+extern uint32_t Heap_Bank1_End;
+
+RAMUsage ram_usage;
+
+// Find lowest stack word that was overwritten since it was painted.
+// Words below the last high-water mark are never used again, so we only
+// have to look at the part of the stack that was unused at the last scan.
+void ram_usage_scan(void) {
+	uint32_t *word = ram_usage.scan_start;
+	while((word < &__stack_end) && (*word == RAM_USAGE_PATTERN)) {
+		word++;
+	}
+
+	ram_usage.scan_start = word;
+	ram_usage.stack_used = (uint16_t)((uint32_t)&__stack_end - (uint32_t)word);
+}
+
+// Called first in main, before any interrupt is enabled
+void ram_usage_init(void) {
+	memset(&ram_usage, 0, sizeof(RAMUsage));
+
+	ram_usage.stack_size  = (uint16_t)((uint32_t)&__stack_end   - (uint32_t)&__stack_start);
+	ram_usage.heap_size   = (uint16_t)((uint32_t)&Heap_Bank1_End - (uint32_t)&Heap_Bank1_Start);
+	ram_usage.static_size = (uint16_t)(RAM_USAGE_SRAM_SIZE - ram_usage.stack_size - ram_usage.heap_size);
+
+	// Paint the unused part of the stack
+	uint32_t *end = (uint32_t*)__get_MSP() - RAM_USAGE_PAINT_MARGIN;
+	for(uint32_t *word = &__stack_start; word < end; word++) {
+		*word = RAM_USAGE_PATTERN;
+	}
+
+	ram_usage.scan_start = &__stack_start;
+	ram_usage_scan();
+	ram_usage.last_scan = system_timer_get_ms();
+}
+
+void ram_usage_tick(void) {
+	if(system_timer_is_time_elapsed_ms(ram_usage.last_scan, RAM_USAGE_SCAN_INTERVAL)) {
+		ram_usage.last_scan = system_timer_get_ms();
+		ram_usage_scan();
+	}
+}
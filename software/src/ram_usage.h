@@ -0,0 +1,49 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * ram_usage.h: Stack high-water mark and RAM usage
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef RAM_USAGE_H
+#define RAM_USAGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RAM_USAGE_SRAM_SIZE     16384 // XMC1404: 16kb SRAM
+#define RAM_USAGE_PATTERN       0xA5C3A5C3
+#define RAM_USAGE_PAINT_MARGIN  16    // Words below the current stack pointer that are not painted
+#define RAM_USAGE_SCAN_INTERVAL 1000  // ms
+
+typedef struct {
+	uint16_t stack_size;
+	uint16_t stack_used;    // High-water mark since boot
+	uint16_t heap_size;     // Unused RAM after .bss (no malloc is used)
+	uint16_t static_size;   // Everything else (.data, .bss, .ram_code)
+
+	uint32_t *scan_start;   // Lowest stack word that is not used yet
+	uint32_t last_scan;
+} RAMUsage;
+
+extern RAMUsage ram_usage;
+
+void ram_usage_scan(void);
+void ram_usage_init(void);
+void ram_usage_tick(void);
+
+#endif
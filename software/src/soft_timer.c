@@ -0,0 +1,141 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * soft_timer.c: One-shot and periodic software timers in a deadline queue
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "soft_timer.h"
+
+#include "bricklib2/hal/system_timer/system_timer.h"
+
+#include <stddef.h>
+
+static SoftTimer *soft_timer_queue = NULL;
+
+static inline bool soft_timer_is_before(const uint32_t a, const uint32_t b) {
+	return ((int32_t)(a - b)) < 0;
+}
+
+static void soft_timer_remove(SoftTimer *timer) {
+	if(!timer->queued) {
+		return;
+	}
+
+	SoftTimer **node = &soft_timer_queue;
+	while(*node != NULL) {
+		if(*node == timer) {
+			*node = timer->next;
+			break;
+		}
+		node = &(*node)->next;
+	}
+
+	timer->next   = NULL;
+	timer->queued = false;
+}
+
+// Timers with the same deadline expire in the order they were started
+static void soft_timer_insert(SoftTimer *timer) {
+	SoftTimer **node = &soft_timer_queue;
+	while((*node != NULL) && !soft_timer_is_before(timer->deadline, (*node)->deadline)) {
+		node = &(*node)->next;
+	}
+
+	timer->next   = *node;
+	*node         = timer;
+	timer->queued = true;
+}
+
+// Start one-shot timer that expires timeout ms after start (start may be in the past)
+void soft_timer_start_from(SoftTimer *timer, const uint32_t start, const uint32_t timeout) {
+	soft_timer_remove(timer);
+
+	timer->deadline = start + timeout;
+	timer->timeout  = timeout;
+	timer->running  = true;
+	timer->expired  = false;
+	timer->periodic = false;
+
+	soft_timer_insert(timer);
+}
+
+void soft_timer_start(SoftTimer *timer, const uint32_t timeout) {
+	soft_timer_start_from(timer, system_timer_get_ms(), timeout);
+}
+
+void soft_timer_start_periodic(SoftTimer *timer, const uint32_t period) {
+	soft_timer_start_from(timer, system_timer_get_ms(), (period == 0) ? 1 : period);
+	timer->periodic = true;
+}
+
+void soft_timer_stop(SoftTimer *timer) {
+	soft_timer_remove(timer);
+
+	timer->running = false;
+	timer->expired = false;
+}
+
+// Start time of the current timeout/period
+uint32_t soft_timer_get_start(const SoftTimer *timer) {
+	return timer->deadline - timer->timeout;
+}
+
+uint32_t soft_timer_get_remaining(const SoftTimer *timer) {
+	if(!timer->queued) {
+		return 0;
+	}
+
+	const uint32_t now = system_timer_get_ms();
+	if(!soft_timer_is_before(now, timer->deadline)) {
+		return 0;
+	}
+
+	return timer->deadline - now;
+}
+
+// Time until the next timer expires, returns false if no timer is started
+bool soft_timer_get_next_deadline(uint32_t *remaining) {
+	if(soft_timer_queue == NULL) {
+		return false;
+	}
+
+	*remaining = soft_timer_get_remaining(soft_timer_queue);
+	return true;
+}
+
+void soft_timer_tick(void) {
+	const uint32_t now = system_timer_get_ms();
+
+	while((soft_timer_queue != NULL) && !soft_timer_is_before(now, soft_timer_queue->deadline)) {
+		SoftTimer *timer = soft_timer_queue;
+		soft_timer_queue = timer->next;
+		timer->next      = NULL;
+		timer->queued    = false;
+		timer->expired   = true;
+
+		if(timer->periodic) {
+			timer->deadline += timer->timeout;
+			soft_timer_insert(timer);
+		}
+
+		// The callback may restart or stop the timer
+		if(timer->callback != NULL) {
+			timer->callback(timer);
+		}
+	}
+}
@@ -0,0 +1,64 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * soft_timer.h: One-shot and periodic software timers in a deadline queue
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef SOFT_TIMER_H
+#define SOFT_TIMER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Timers are owned by the modules (zero-initialized = stopped) and only used
+// from the main loop, not from IRQs. Started timers are kept in a queue
+// sorted by deadline, so soft_timer_tick() only has to look at the first one.
+// Deadlines are compared with signed difference, timeouts have to be < 2^31 ms.
+
+typedef struct SoftTimer SoftTimer;
+typedef void (*SoftTimerCallback)(SoftTimer *timer);
+
+struct SoftTimer {
+	SoftTimer *next;            // Next timer in queue
+	SoftTimerCallback callback; // Optional, called from soft_timer_tick() when the timer expires
+	uint32_t deadline;          // ms
+	uint32_t timeout;           // ms, period for periodic timers
+	bool running;               // Started and not stopped, a one-shot timer stays running after it expired
+	bool queued;
+	bool expired;               // Set on (first) expiry, reset on start
+	bool periodic;
+};
+
+static inline bool soft_timer_is_running(const SoftTimer *timer) {
+	return timer->running;
+}
+
+static inline bool soft_timer_is_expired(const SoftTimer *timer) {
+	return timer->expired;
+}
+
+void soft_timer_start_from(SoftTimer *timer, const uint32_t start, const uint32_t timeout);
+void soft_timer_start(SoftTimer *timer, const uint32_t timeout);
+void soft_timer_start_periodic(SoftTimer *timer, const uint32_t period);
+void soft_timer_stop(SoftTimer *timer);
+uint32_t soft_timer_get_start(const SoftTimer *timer);
+uint32_t soft_timer_get_remaining(const SoftTimer *timer);
+bool soft_timer_get_next_deadline(uint32_t *remaining);
+void soft_timer_tick(void);
+
+#endif
@@ -0,0 +1,140 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * spsc_queue.h: Lock-free single producer/single consumer queue (IRQ -> main loop)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// One producer (typically an IRQ) and one consumer (typically the main loop).
+// head is only written by the producer, tail only by the consumer, so no
+// locking is needed. Both are free running and only masked on access, the
+// fill level is head - tail (also correct after the 16-bit wrap).
+//
+// The size has to be a power of two and <= 32768. The buffer is owned by the
+// user of the queue, so it can be placed in the arena.
+//
+// Barriers: The element has to be written before the producer publishes the
+// new head and it has to be read before the consumer releases the slot with
+// the new tail. Cortex-M0 does not reorder memory accesses, but the compiler
+// does. __DMB() is both a compiler and a hardware barrier.
+#ifndef SPSC_QUEUE_BARRIER
+#include "xmc_device.h"
+#define SPSC_QUEUE_BARRIER() __DMB()
+#endif
+
+typedef struct {
+	uint32_t *buffer;
+	uint16_t mask;               // size - 1
+
+	volatile uint16_t head;      // Written by producer
+	volatile uint16_t tail;      // Written by consumer
+
+	volatile uint32_t overflows; // Elements dropped because the queue was full, written by producer
+	volatile uint16_t max_used;  // High-water mark of the fill level, written by producer
+} SPSCQueue;
+
+#define SPSC_QUEUE_IS_POWER_OF_TWO(size) (((size) != 0) && (((size) & ((size) - 1)) == 0) && ((size) <= 32768))
+
+static inline void spsc_queue_init(SPSCQueue *queue, uint32_t *buffer, const uint16_t size) {
+	queue->buffer    = buffer;
+	queue->mask      = (uint16_t)(size - 1);
+	queue->head      = 0;
+	queue->tail      = 0;
+	queue->overflows = 0;
+	queue->max_used  = 0;
+}
+
+static inline uint16_t spsc_queue_get_used(const SPSCQueue *queue) {
+	return (uint16_t)(queue->head - queue->tail);
+}
+
+static inline bool spsc_queue_is_empty(const SPSCQueue *queue) {
+	return queue->head == queue->tail;
+}
+
+// Producer: Returns false and counts an overflow if the queue is full
+static inline bool spsc_queue_push(SPSCQueue *queue, const uint32_t value) {
+	const uint16_t head = queue->head;
+	const uint16_t used = (uint16_t)(head - queue->tail);
+	if(used > queue->mask) {
+		queue->overflows++;
+		return false;
+	}
+
+	queue->buffer[head & queue->mask] = value;
+	SPSC_QUEUE_BARRIER();
+	queue->head = (uint16_t)(head + 1);
+
+	if(used >= queue->max_used) {
+		queue->max_used = (uint16_t)(used + 1);
+	}
+
+	return true;
+}
+
+// Consumer: Returns the oldest element without removing it
+static inline bool spsc_queue_peek(const SPSCQueue *queue, uint32_t *value) {
+	const uint16_t tail = queue->tail;
+	if(queue->head == tail) {
+		return false;
+	}
+
+	SPSC_QUEUE_BARRIER();
+	*value = queue->buffer[tail & queue->mask];
+	return true;
+}
+
+// Consumer: Removes and returns the oldest element
+static inline bool spsc_queue_pop(SPSCQueue *queue, uint32_t *value) {
+	if(!spsc_queue_peek(queue, value)) {
+		return false;
+	}
+
+	SPSC_QUEUE_BARRIER();
+	queue->tail = (uint16_t)(queue->tail + 1);
+	return true;
+}
+
+// Consumer: Removes up to max elements and returns the number of elements.
+// Only one barrier pair for the whole batch.
+static inline uint16_t spsc_queue_drain(SPSCQueue *queue, uint32_t *values, const uint16_t max) {
+	const uint16_t tail = queue->tail;
+	uint16_t count      = (uint16_t)(queue->head - tail);
+	if(count > max) {
+		count = max;
+	}
+	if(count == 0) {
+		return 0;
+	}
+
+	SPSC_QUEUE_BARRIER();
+	for(uint16_t i = 0; i < count; i++) {
+		values[i] = queue->buffer[(uint16_t)(tail + i) & queue->mask];
+	}
+	SPSC_QUEUE_BARRIER();
+	queue->tail = (uint16_t)(tail + count);
+
+	return count;
+}
+
+#endif
@@ -35,7 +35,10 @@ void tmp1075n_init(void) {
 		return;
 	}
 
+	// Keep the read count, a re-initialization after an I2C error is no new reading
+	const uint32_t read_count = tmp1075n.read_count;
 	memset(&tmp1075n, 0, sizeof(TMP1075N));
+	tmp1075n.read_count = read_count;
 
 	tmp1075n.i2c_fifo.baudrate         = TMP1075N_I2C_BAUDRATE;
 	tmp1075n.i2c_fifo.address          = TMP1075N_I2C_ADDRESS;
@@ -98,7 +101,9 @@ void tmp1075n_tick(void) {
 				value = value | 0xF000;
 			}
 			tmp1075n.temperature = ((((int32_t)value) * 625) / 100);
-			tmp1075n.last_read = system_timer_get_ms();
+			tmp1075n.valid       = true;
+			tmp1075n.read_count++;
+			tmp1075n.last_read   = system_timer_get_ms();
 
 			// Temperature is read, set state back to idle.
 			// The next read will be started after the timeout that is handled below.
@@ -126,8 +131,8 @@ void tmp1075n_tick(void) {
 	}
 
 	if((state == I2C_FIFO_STATE_IDLE) || (state & I2C_FIFO_STATE_READY)) {
-		// Read temperature once per 500ms
-		if(system_timer_is_time_elapsed_ms(tmp1075n.last_read, 500)) {
+		// Read temperature once per 500ms (100ms near the derating threshold)
+		if(system_timer_is_time_elapsed_ms(tmp1075n.last_read, tmp1075n.fast_read ? TMP1075N_READ_INTERVAL_FAST_MS : TMP1075N_READ_INTERVAL_MS)) {
 			i2c_fifo_read_direct(&tmp1075n.i2c_fifo, 2, false);
 		}
 	}
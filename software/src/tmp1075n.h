@@ -24,11 +24,17 @@
 
 #include "bricklib2/hal/i2c_fifo/i2c_fifo.h"
 
+#define TMP1075N_READ_INTERVAL_MS      500
+#define TMP1075N_READ_INTERVAL_FAST_MS 100
+
 typedef struct {
 	I2CFifo i2c_fifo;
 	int16_t temperature;
+	bool valid;          // Temperature was read since the last (re-)initialization
+	uint32_t read_count; // Incremented for each completed read, kept on re-initialization
 
 	uint32_t last_read;
+	bool fast_read; // Set by thermal derating near the derating threshold
 } TMP1075N;
 
 extern TMP1075N tmp1075n;
@@ -0,0 +1,181 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * warm_restart.c: Resume charging after watchdog or software reset
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include "warm_restart.h"
+
+#include "configs/config.h"
+#include "configs/config_evse.h"
+#include "bricklib2/hal/system_timer/system_timer.h"
+#include "bricklib2/warp/contactor_check.h"
+
+#include "hardware_version.h"
+#include "iec61851.h"
+#include "evse.h"
+#include "dc_fault.h"
+#include "phase_control.h"
+
+#include "xmc_gpio.h"
+
+#include <string.h>
+#include <stddef.h>
+
+// Not initialized by the startup code, survives a reset as long as the power is not lost.
+// The content is random after power-up (or may have been overwritten by the bootloader),
+// which is caught by the magic and checksum.
+// The bricklib2 linker script does not know .noinit, it has to stay an orphan section
+// without content outside of .data and .bss. This is checked after the build by noinit_check.cmake.
+static WarmRestartRecord warm_restart_record __attribute__((section(".noinit")));
+
+_Static_assert(offsetof(WarmRestartRecord, checksum) == (sizeof(WarmRestartRecord) - sizeof(uint32_t)), "Checksum has to be the last word of the record");
+
+WarmRestart warm_restart;
+
+// Record from another firmware version is not used
+static uint32_t warm_restart_get_magic(void) {
+	return WARM_RESTART_MAGIC ^ ((FIRMWARE_VERSION_MAJOR << 16) | (FIRMWARE_VERSION_MINOR << 8) | FIRMWARE_VERSION_REVISION);
+}
+
+static uint32_t warm_restart_get_checksum(const WarmRestartRecord *record) {
+	const uint32_t *word = (const uint32_t*)record;
+	uint32_t checksum = WARM_RESTART_MAGIC;
+	for(uint8_t i = 0; i < offsetof(WarmRestartRecord, checksum)/sizeof(uint32_t); i++) {
+		checksum = ((checksum << 5) | (checksum >> 27)) ^ word[i];
+	}
+
+	return ~checksum;
+}
+
+static bool warm_restart_is_record_valid(const WarmRestartRecord *record) {
+	return (record->magic == warm_restart_get_magic()) &&
+	       (record->checksum == warm_restart_get_checksum(record)) &&
+	       (record->restarts < WARM_RESTART_MAX_RESTARTS) &&
+	       (record->hardware_version >= 2) && (record->hardware_version <= 4) &&
+	       (record->iec61851_state <= IEC61851_STATE_C);
+}
+
+// Next reset is a cold boot
+void warm_restart_invalidate(void) {
+	warm_restart_record.magic    = 0;
+	warm_restart_record.checksum = 0;
+}
+
+static void warm_restart_save(void) {
+	// Only resume with intact PE and DC fault status. In any error state the next boot is a cold boot.
+	if(((dc_fault.state & 0b111) != DC_FAULT_NORMAL_CONDITION) ||
+	   (contactor_check.error != 0) ||
+	   (iec61851.state > IEC61851_STATE_C)) {
+		warm_restart_invalidate();
+		return;
+	}
+
+	WarmRestartRecord record;
+	memset(&record, 0, sizeof(WarmRestartRecord));
+
+	record.magic                = warm_restart_get_magic();
+	record.uptime               = system_timer_get_ms();
+	record.hardware_version     = hardware_version.is_v2 ? 2 : (hardware_version.is_v3 ? 3 : 4);
+	record.iec61851_state       = iec61851.state;
+	record.charging_protocol    = iec61851.charging_protocol;
+	record.phases               = phase_control.current;
+	record.dc_fault_sensor_type = dc_fault.sensor_type;
+	record.contactor            = !XMC_GPIO_GetInput(EVSE_CONTACTOR_PIN);
+
+	// Count consecutive warm restarts until we have been running for a while
+	if(warm_restart.resume && !system_timer_is_time_elapsed_ms(warm_restart.boot_start, WARM_RESTART_STABLE_UPTIME)) {
+		record.restarts = warm_restart.record.restarts;
+	}
+
+	record.button_max_current  = charging_slot.max_current[CHARGING_SLOT_BUTTON];
+	record.button_active_clear = (charging_slot.active[CHARGING_SLOT_BUTTON] << 0) | (charging_slot.clear_on_disconnect[CHARGING_SLOT_BUTTON] << 1);
+
+	record.checksum = warm_restart_get_checksum(&record);
+	warm_restart_record = record;
+}
+
+// Called after all modules are initialized, before the first tick
+void warm_restart_resume(void) {
+	if(!warm_restart.resume) {
+		return;
+	}
+
+	const WarmRestartRecord *record = &warm_restart.record;
+
+	// Only the button slot is restored, a stop by button press has to survive the reset.
+	// The slots of the host (load management, external, ...) keep their defaults as after
+	// a cold boot: A reset requested by the host is handled by the bootloader, so the
+	// record can't be invalidated on that path, and the host expects a reset to clear them.
+	// The slots of inputs, OVE R37 and thermal derating are updated in every tick.
+	charging_slot.max_current[CHARGING_SLOT_BUTTON]         = record->button_max_current;
+	charging_slot.active[CHARGING_SLOT_BUTTON]              = record->button_active_clear & (1 << 0);
+	charging_slot.clear_on_disconnect[CHARGING_SLOT_BUTTON] = record->button_active_clear & (1 << 1);
+
+	if((record->phases == 1) || (record->phases == phase_control.phases_connected)) {
+		phase_control.current   = record->phases;
+		phase_control.requested = record->phases;
+		if(phase_control.current == 1) {
+			XMC_GPIO_SetOutputHigh(EVSE_PHASE_SWITCH_PIN);
+		} else {
+			XMC_GPIO_SetOutputLow(EVSE_PHASE_SWITCH_PIN);
+		}
+	}
+
+	// The sensor type is otherwise only known after the DC fault calibration
+	dc_fault.sensor_type = record->dc_fault_sensor_type;
+
+	// Continue in the state from before the reset. The DC fault calibration is started
+	// after the startup hold as usual, but it only runs in state A. So the self-test is
+	// deferred until the EV is disconnected.
+	// The contactor is not switched on here, evse_set_output() still waits for the
+	// diode check and the CP/PE resistance measurements as after a cold boot.
+	iec61851.state                 = record->iec61851_state;
+	iec61851.charging_protocol     = record->charging_protocol;
+	iec61851.first_b1b2_transition = iec61851.state == IEC61851_STATE_A;
+}
+
+// Called first in main, before the hardware version is detected
+void warm_restart_init(void) {
+	memset(&warm_restart, 0, sizeof(WarmRestart));
+	warm_restart.boot_start = system_timer_get_ms();
+
+	if(warm_restart_is_record_valid(&warm_restart_record)) {
+		warm_restart.resume = true;
+		warm_restart.record = warm_restart_record;
+		warm_restart.record.restarts++;
+	}
+
+	// A new record is written after the first tick
+	warm_restart_invalidate();
+}
+
+void warm_restart_tick(void) {
+	// Boot is done when the IEC 61851 state machine runs
+	if((warm_restart.boot_time == 0) && (evse.startup_time == 0) && !dc_fault.calibration_running) {
+		warm_restart.boot_time = system_timer_get_ms() - warm_restart.boot_start;
+		if(warm_restart.boot_time == 0) {
+			warm_restart.boot_time = 1;
+		}
+	}
+
+	if(system_timer_is_time_elapsed_ms(warm_restart.last_save, WARM_RESTART_SAVE_INTERVAL)) {
+		warm_restart.last_save = system_timer_get_ms();
+		warm_restart_save();
+	}
+}
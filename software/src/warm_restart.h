@@ -0,0 +1,73 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * warm_restart.h: Resume charging after watchdog or software reset
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef WARM_RESTART_H
+#define WARM_RESTART_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "charging_slot.h"
+
+#define WARM_RESTART_MAGIC            0x57524D52 // "WRMR"
+#define WARM_RESTART_SAVE_INTERVAL    100   // ms
+#define WARM_RESTART_STARTUP_HOLD     100   // ms, instead of 1s after cold boot
+#define WARM_RESTART_MAX_RESTARTS     3     // Consecutive warm restarts before we fall back to cold boot
+#define WARM_RESTART_STABLE_UPTIME    60000 // ms, uptime after which the consecutive warm restarts are reset
+
+#define WARM_RESTART_BOOT_PATH_COLD   0
+#define WARM_RESTART_BOOT_PATH_WARM   1
+
+// Kept in RAM that is not initialized at startup. Only used
+// after a reset if the checksum is valid.
+typedef struct {
+	uint32_t magic;                                  // WARM_RESTART_MAGIC ^ firmware version
+	uint32_t uptime;                                 // ms at last save
+	uint16_t restarts;                               // Consecutive warm restarts
+	uint8_t hardware_version;                        // 2, 3 or 4
+	uint8_t iec61851_state;
+	uint8_t charging_protocol;
+	uint8_t phases;
+	uint8_t dc_fault_sensor_type;
+	bool contactor;
+	uint16_t button_max_current;                     // Stop charging by button press
+	uint8_t button_active_clear;                     // Bit 0 = active, bit 1 = clear on disconnect
+	uint8_t reserved;                                // The checksum covers all bytes, no padding
+	uint32_t checksum;
+} WarmRestartRecord;
+
+typedef struct {
+	bool resume;               // Warm path taken at this boot
+	WarmRestartRecord record;  // Copy of record from before the reset (valid if resume is true)
+
+	uint32_t boot_start;
+	uint32_t boot_time;        // ms from start of main until IEC 61851 state machine runs, 0 = not ready yet
+	uint32_t last_save;
+} WarmRestart;
+
+extern WarmRestart warm_restart;
+
+void warm_restart_invalidate(void);
+void warm_restart_resume(void);
+void warm_restart_init(void);
+void warm_restart_tick(void);
+
+#endif
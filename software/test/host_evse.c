@@ -0,0 +1,635 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * host_evse.c: Host build of the EVSE 2.0 firmware for tests/evse_v2_simulator.py
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+// The firmware of an EVSE 2.0 (hardware version 2) on a virtual clock: The
+// inits and the main loop of main.c with the real modules, TFP messages go
+// through handle_message() of communication.c. Only the peripherals without
+// a host model are stubs (see below): frequency measurement, TMP1075N, RAM
+// usage, Iskra display, RS485/meter (no meter connected) and the contactor
+// check of bricklib2 (state from the AC pins, never an error).
+//
+// The hardware around the bricklet is emulated on the pins and ADC results:
+// The tester bricklets of tests/evse_v2_tester.py (CP/PE resistance and
+// diode, PP/PE resistance, shutdown input, AC1/AC2), the button, the config
+// jumper, the DC fault sensor (passes the calibration) and the GP output
+// that is wired to the GP input. Each virtual ms has two ADC scans with a
+// main loop iteration after each, as in test_cp_replay.c. The CP PWM phase
+// of the scans follows the duty cycle of the firmware.
+//
+// The program is driven line by line on stdin, each command is answered by
+// exactly one line on stdout. Callbacks of the firmware are written as
+// "callback <hex>" lines before the answer.
+//   input <cp_pe> <pp_pe> <diode> <shutdown> <ac1> <ac2> <button> <jumper>
+//                    Resistances in ohm (0 = open), the others 0/1, the
+//                    jumper (0-8, as get_hardware_configuration) is read
+//                    at boot                                 -> ok
+//   run <ms>         Advance the virtual clock               -> ok
+//   message <hex>    TFP message to the bricklet             -> response [<hex>]
+//   analog           CP/PE (PWM average) and PP/PE voltage   -> analog <mv> <mv>
+//   state            Debug output                            -> state <text>
+//
+// A reset (reset function, NVIC_SystemReset()) boots a new firmware process
+// with the EEPROM content of the old one, it writes "reset <firmware version>"
+// (also at startup). A message or run that resets the firmware is not
+// answered, the "reset" line comes instead. The boot is done with the first
+// command after "reset" that is not input, so the jumper can be set first.
+//
+// Usage: host_evse [uid]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "configs/config.h"
+
+#include "bricklib2/bootloader/bootloader.h"
+#include "bricklib2/hal/system_timer/system_timer.h"
+#include "bricklib2/protocols/tfp/tfp.h"
+#include "bricklib2/utility/communication_callback.h"
+#include "bricklib2/utility/util_definitions.h"
+#include "bricklib2/warp/rs485.h"
+#include "bricklib2/warp/meter.h"
+#include "bricklib2/warp/contactor_check.h"
+#include "communication.h"
+
+#include "evse.h"
+#include "iec61851.h"
+#include "lock.h"
+#include "led.h"
+#include "button.h"
+#include "adc.h"
+#include "dc_fault.h"
+#include "charging_slot.h"
+#include "hardware_version.h"
+#include "phase_control.h"
+#include "tmp1075n.h"
+#include "eichrecht.h"
+#include "plc.h"
+#include "frequency.h"
+#include "ove_r37.h"
+#include "iskra_display.h"
+#include "derating.h"
+#include "hot_path.h"
+#include "ram_usage.h"
+#include "warm_restart.h"
+#include "boot_timing.h"
+#include "cpu_load.h"
+#include "soft_timer.h"
+#include "digital_input.h"
+#include "configs/config_evse.h"
+#include "configs/config_button.h"
+#include "configs/config_contactor_check.h"
+#include "configs/config_dc_fault.h"
+#include "configs/config_hardware_version.h"
+
+#define HOST_EVSE_SAMPLES_PER_MS     2
+#define HOST_EVSE_VCP_HIGH_MV        12000
+#define HOST_EVSE_VCP_LOW_MV         -12000
+#define HOST_EVSE_DIODE_DROP_MV      650
+#define HOST_EVSE_CP_DIVIDER         910 // EVSE 2.0 CP measurement resistor
+#define HOST_EVSE_PP_OPEN_MV         3333
+
+#define HOST_EVSE_EXIT_RESET         42
+#define HOST_EVSE_UID_DEFAULT        0x3A2F1E54
+
+// The DC fault sensor signals X6 and X30 for this time after the test pin
+// was released (rising edge), the calibration checks them at +740ms and
+// +1400ms and expects both low again at +3000ms
+#define HOST_EVSE_DC_FAULT_TEST_START 100
+#define HOST_EVSE_DC_FAULT_TEST_END   2050
+
+#define HOST_EVSE_METER_VALUES_NUM   88 // values_length of get_all_energy_meter_values
+#define HOST_EVSE_LINE_LENGTH        512
+
+typedef struct {
+	uint32_t cp_pe_resistance; // 0 = open
+	uint32_t pp_pe_resistance; // 0 = open
+	bool diode;
+	bool shutdown_closed;
+	bool ac1_live;
+	bool ac2_live;
+	bool button_pressed;
+	uint8_t jumper;
+} HostEVSEInput;
+
+static HostEVSEInput host_evse_input = {
+	.jumper = EVSE_CONFIG_JUMPER_CURRENT_32A
+};
+
+static uint32_t host_evse_uid = HOST_EVSE_UID_DEFAULT;
+static bool host_evse_booted = false;
+static uint32_t host_evse_pwm_accumulator = 0;
+static bool host_evse_dc_fault_test_last = true;
+static uint32_t host_evse_dc_fault_test_time = 0;
+
+// EEPROM content that survives a reset, shared with the parent process
+static uint32_t (*host_evse_eeprom)[EEPROM_PAGE_SIZE/sizeof(uint32_t)];
+
+// Sampling IRQ of the digital inputs, not in the header
+void IRQ_Hdlr_31(void);
+
+// Stubs: Peripherals without a host model -----------------------------------------
+
+Frequency frequency;
+TMP1075N tmp1075n;
+RAMUsage ram_usage;
+IskraDisplay iskra_display;
+
+void frequency_set_rocof_window(const uint8_t window) {
+	frequency.rocof_window = window;
+}
+
+void frequency_get_period_min_max(uint32_t *min_ns, uint32_t *max_ns) {
+	*min_ns = 0;
+	*max_ns = 0;
+}
+
+void frequency_get_compare(const uint8_t source, uint32_t *count, uint32_t *mean_ns, uint32_t *standard_deviation_ns) {
+	*count                 = 0;
+	*mean_ns               = 0;
+	*standard_deviation_ns = 0;
+}
+
+void frequency_init(void) {
+	frequency.rocof_window = FREQUENCY_ROCOF_WINDOW_DEFAULT;
+}
+
+void frequency_tick(void) {}
+
+// EVSE 2.0 has no temperature sensor
+void tmp1075n_init(void) {}
+void tmp1075n_tick(void) {}
+
+void ram_usage_scan(void) {}
+void ram_usage_init(void) {}
+void ram_usage_tick(void) {}
+
+void iskra_display_init(void) {}
+void iskra_display_tick(void) {}
+
+void rs485_init(void) {}
+void rs485_tick(void) {}
+void modbus_clear_request(RS485 *rs) {}
+
+void meter_init(void) {}
+void meter_tick(void) {}
+
+bool meter_supports_eichrecht(void) {
+	return false;
+}
+
+// No meter connected: All values are zero, streamed in chunks like the bricklib2 meter
+BootloaderHandleMessageResponse meter_fill_communication_values(GenericMeterValues_Response *response) {
+	static uint16_t offset = 0;
+
+	response->header.length = sizeof(GenericMeterValues_Response);
+	response->values_chunk_offset = offset;
+	memset(response->values_chunk_data, 0, sizeof(response->values_chunk_data));
+
+	offset += ARRAY_SIZE(response->values_chunk_data);
+	if(offset >= HOST_EVSE_METER_VALUES_NUM) {
+		offset = 0;
+	}
+
+	return HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE;
+}
+
+void contactor_check_init(void) {
+	memset(&contactor_check, 0, sizeof(ContactorCheck));
+}
+
+// AC1/AC2 are active low, bit 0 = AC1 live, bit 1 = AC2 live
+void contactor_check_tick(void) {
+	contactor_check.state = (!XMC_GPIO_GetInput(CONTACTOR_CHECK_AC1_PIN) ? 1 : 0) | (!XMC_GPIO_GetInput(CONTACTOR_CHECK_AC2_PIN) ? 2 : 0);
+	contactor_check.error = 0;
+}
+
+// SPITFP transport: Messages of the firmware are written on stdout --------------
+
+static bool (*host_evse_callbacks[])(void) = {
+	COMMUNICATION_CALLBACK_LIST_INIT
+};
+
+uint32_t bootloader_get_uid(void) {
+	return host_evse_uid;
+}
+
+bool bootloader_spitfp_is_send_possible(SPITFP *st) {
+	return true;
+}
+
+static void host_evse_print_hex(const char *prefix, const uint8_t *data, const uint8_t length) {
+	printf("%s", prefix);
+	for(uint8_t i = 0; i < length; i++) {
+		printf("%02x", data[i]);
+	}
+	printf("\n");
+}
+
+void bootloader_spitfp_send_ack_and_message(BootloaderStatus *bs, uint8_t *data, const uint8_t length) {
+	host_evse_print_hex("callback ", data, length);
+}
+
+// Messages are handled between the main loop iterations (host_evse_message())
+void bootloader_tick(void) {}
+
+void communication_callback_init(void) {}
+
+// One callback per tick, as the bricklib2 round-robin
+void communication_callback_tick(void) {
+	static uint8_t index = 0;
+
+	host_evse_callbacks[index]();
+	index = (index + 1) % ARRAY_SIZE(host_evse_callbacks);
+}
+
+// Hardware around the bricklet ---------------------------------------------------
+
+static void host_evse_set_input(XMC_GPIO_PORT_t *const port, const uint8_t pin, const bool high) {
+	port->FLOAT &= ~(1UL << pin);
+	if(high) {
+		port->IN |= 1UL << pin;
+	} else {
+		port->IN &= ~(1UL << pin);
+	}
+}
+
+static void host_evse_set_floating(XMC_GPIO_PORT_t *const port, const uint8_t pin) {
+	port->FLOAT |= 1UL << pin;
+}
+
+// Jumper pins for the configuration, as in evse_init_jumper(): o = open, h = high, l = low
+static void host_evse_set_jumper_pin(XMC_GPIO_PORT_t *const port, const uint8_t pin, const char level) {
+	if(level == 'o') {
+		host_evse_set_floating(port, pin);
+	} else {
+		host_evse_set_input(port, pin, level == 'h');
+	}
+}
+
+// Pins that are read once at boot
+static void host_evse_init_pins(void) {
+	// EVSE 2.0: Hardware version detection pin is floating
+	host_evse_set_floating(HARDWARE_VERSION_DETECTION);
+
+	// Same order as EVSE_CONFIG_JUMPER_* for EVSE 2.0, jumper 8 (unconfigured) has both pins low
+	static const char jumper_pins[][2] = {
+		{'o', 'l'}, {'h', 'l'}, {'l', 'o'}, {'o', 'o'}, {'h', 'o'}, {'l', 'h'}, {'o', 'h'}, {'h', 'h'}, {'l', 'l'}
+	};
+	const uint8_t jumper = MIN(host_evse_input.jumper, ARRAY_SIZE(jumper_pins) - 1);
+	host_evse_set_jumper_pin(EVSE_V2_CONFIG_JUMPER_PIN0, jumper_pins[jumper][0]);
+	host_evse_set_jumper_pin(EVSE_V2_CONFIG_JUMPER_PIN1, jumper_pins[jumper][1]);
+}
+
+// Input pins, updated every ms
+static void host_evse_update_pins(void) {
+	host_evse_set_input(EVSE_V2_SHUTDOWN_PIN, !host_evse_input.shutdown_closed);
+	host_evse_set_input(EVSE_BUTTON_PIN, !host_evse_input.button_pressed);
+	host_evse_set_input(CONTACTOR_CHECK_AC1_PIN, !host_evse_input.ac1_live);
+	host_evse_set_input(CONTACTOR_CHECK_AC2_PIN, !host_evse_input.ac2_live);
+
+	// GP output switches the GP input to ground
+	host_evse_set_input(EVSE_V2_INPUT_GP_PIN, !XMC_GPIO_GetInput(EVSE_V2_OUTPUT_GP_PIN));
+
+	// DC fault sensor: Self test after the test pin is released
+	const bool test = XMC_GPIO_GetInput(DC_FAULT_V2_TST_PIN);
+	if(test && !host_evse_dc_fault_test_last) {
+		host_evse_dc_fault_test_time = system_timer_get_ms();
+	}
+	host_evse_dc_fault_test_last = test;
+
+	const uint32_t test_ms = system_timer_get_ms() - host_evse_dc_fault_test_time;
+	const bool self_test   = (host_evse_dc_fault_test_time != 0) && (test_ms >= HOST_EVSE_DC_FAULT_TEST_START) && (test_ms < HOST_EVSE_DC_FAULT_TEST_END);
+	host_evse_set_input(DC_FAULT_V2_X6_PIN,  self_test);
+	host_evse_set_input(DC_FAULT_V2_X30_PIN, self_test);
+	host_evse_set_input(DC_FAULT_V2_ERR_PIN, false);
+}
+
+// CP/PE voltage behind the measurement resistor (VCP2) in the high or low phase of the PWM
+static int32_t host_evse_get_cp_mv(const bool high) {
+	const int32_t r = (int32_t)host_evse_input.cp_pe_resistance;
+	if(r == 0) {
+		return high ? HOST_EVSE_VCP_HIGH_MV : HOST_EVSE_VCP_LOW_MV;
+	}
+
+	if(high) {
+		return (r*HOST_EVSE_VCP_HIGH_MV + (host_evse_input.diode ? HOST_EVSE_CP_DIVIDER*HOST_EVSE_DIODE_DROP_MV : 0))/(r + HOST_EVSE_CP_DIVIDER);
+	}
+
+	// The diode of the EV blocks the negative half
+	return host_evse_input.diode ? HOST_EVSE_VCP_LOW_MV : r*HOST_EVSE_VCP_LOW_MV/(r + HOST_EVSE_CP_DIVIDER);
+}
+
+static int32_t host_evse_get_pp_mv(void) {
+	const int32_t r = (int32_t)host_evse_input.pp_pe_resistance;
+	if(r == 0) {
+		return HOST_EVSE_PP_OPEN_MV;
+	}
+
+	return 10000*r/(2000 + 3*r);
+}
+
+// Inverse of the VCP conversion in adc_check_count()
+static uint16_t host_evse_mv_to_raw_vcp(const int32_t mv) {
+	return (uint16_t)BETWEEN(0, ((mv + 13200)*273 + 880)/1760, 4095);
+}
+
+// Inverse of the PP conversion in adc_check_count()
+static uint16_t host_evse_mv_to_raw_pp(const int32_t mv) {
+	return (uint16_t)BETWEEN(0, (mv*273 + 110)/220, 4095);
+}
+
+// One ADC background scan, the PWM phase of the sample follows the duty cycle (1000 = always high)
+static void host_evse_scan(void) {
+	host_evse_pwm_accumulator += evse_get_cp_duty_cycle();
+	const bool high = host_evse_pwm_accumulator >= 1000;
+	if(high) {
+		host_evse_pwm_accumulator -= 1000;
+	}
+
+	const uint16_t raw[ADC_NUM] = {
+		[ADC_CHANNEL_VCP1] = host_evse_mv_to_raw_vcp(high ? HOST_EVSE_VCP_HIGH_MV : HOST_EVSE_VCP_LOW_MV),
+		[ADC_CHANNEL_VCP2] = host_evse_mv_to_raw_vcp(host_evse_get_cp_mv(high)),
+		[ADC_CHANNEL_VPP]  = host_evse_mv_to_raw_pp(host_evse_get_pp_mv()),
+		[ADC_CHANNEL_V12P] = (uint16_t)(HOST_EVSE_VCP_HIGH_MV*273/880),
+		[ADC_CHANNEL_V12M] = host_evse_mv_to_raw_vcp(HOST_EVSE_VCP_LOW_MV)
+	};
+
+	for(uint8_t i = 0; i < ADC_NUM; i++) {
+		adc[i].group->result[adc[i].result_reg] = raw[i] | (1UL << 31);
+	}
+}
+
+// Firmware ----------------------------------------------------------------------
+
+// Same order as main()
+static void host_evse_boot(void) {
+	host_evse_init_pins();
+	host_evse_update_pins();
+
+	boot_timing_init();
+	ram_usage_init();
+	warm_restart_init();
+	hardware_version_init();
+	communication_init();
+	ove_r37_init();
+	eichrecht_init();
+	evse_init();
+	charging_slot_init();
+	iec61851_init();
+	lock_init();
+	contactor_check_init();
+	led_init();
+	button_init();
+	adc_init();
+	dc_fault_init();
+	digital_input_init();
+	rs485_init();
+	meter_init();
+	phase_control_init();
+	tmp1075n_init();
+	derating_init();
+	plc_init();
+	frequency_init();
+	iskra_display_init();
+	hot_path_init();
+	cpu_load_init();
+	warm_restart_resume();
+
+	host_evse_booted = true;
+}
+
+// Same order as the main loop
+static void host_evse_loop(void) {
+	hot_path_tick();
+	soft_timer_tick();
+	digital_input_tick();
+	bootloader_tick();
+	communication_tick();
+	lock_tick();
+	contactor_check_tick();
+	led_tick();
+	button_tick();
+	adc_tick();
+	evse_tick();
+	dc_fault_tick();
+	rs485_tick();
+	meter_tick();
+	charging_slot_tick();
+	phase_control_tick();
+	tmp1075n_tick();
+	derating_tick();
+	eichrecht_tick();
+	plc_tick();
+	frequency_tick();
+	ove_r37_tick();
+	iskra_display_tick();
+	ram_usage_tick();
+	warm_restart_tick();
+	boot_timing_tick();
+	cpu_load_tick();
+}
+
+static void host_evse_tick_ms(void) {
+	system_timer_shim_ms++;
+	host_evse_update_pins();
+	IRQ_Hdlr_31();
+
+	for(uint8_t i = 0; i < HOST_EVSE_SAMPLES_PER_MS; i++) {
+		host_evse_scan();
+		host_evse_loop();
+	}
+}
+
+static void host_evse_exit(const int status) {
+	memcpy(host_evse_eeprom, bootloader_shim_eeprom, sizeof(bootloader_shim_eeprom));
+	fflush(stdout);
+	_exit(status);
+}
+
+// NVIC_SystemReset() of the shim aborts, the EEPROM writes before it are kept
+static void host_evse_system_reset(int signal_number) {
+	host_evse_exit(HOST_EVSE_EXIT_RESET);
+}
+
+// Bootloader part of the message handling, the rest is handle_message()
+static void host_evse_message(const char *hex) {
+	TFPMessageFull request;
+	TFPMessageFull response;
+	memset(&request, 0, sizeof(request));
+	memset(&response, 0, sizeof(response));
+
+	const uint8_t length = MIN(strlen(hex)/2, sizeof(request));
+	for(uint8_t i = 0; i < length; i++) {
+		unsigned int value;
+		sscanf(&hex[i*2], "%2x", &value);
+		((uint8_t*)&request)[i] = (uint8_t)value;
+	}
+
+	if(tfp_get_fid_from_message(&request) == 243) { // reset
+		printf("response\n");
+		host_evse_exit(HOST_EVSE_EXIT_RESET);
+	}
+
+	const BootloaderHandleMessageResponse handle = handle_message(&request, &response);
+	const bool return_expected = request.header.other_options & TFP_MESSAGE_OPTIONS_RETURN_EXPECTED;
+
+	response.header.uid           = request.header.uid;
+	response.header.fid           = request.header.fid;
+	response.header.other_options = request.header.other_options;
+	response.header.error         = 0;
+
+	switch(handle) {
+		case HANDLE_MESSAGE_RESPONSE_NEW_MESSAGE: {
+			host_evse_print_hex("response ", (uint8_t*)&response, response.header.length);
+			return;
+		}
+
+		case HANDLE_MESSAGE_RESPONSE_EMPTY: {
+			break;
+		}
+
+		case HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER:
+		case HANDLE_MESSAGE_RESPONSE_NOT_SUPPORTED: {
+			response.header.error = ((handle == HANDLE_MESSAGE_RESPONSE_INVALID_PARAMETER) ? 1 : 2) << TFP_MESSAGE_ERROR_SHIFT;
+			break;
+		}
+
+		default: {
+			printf("response\n");
+			return;
+		}
+	}
+
+	if(!return_expected) {
+		printf("response\n");
+		return;
+	}
+
+	response.header.length = sizeof(TFPMessageHeader);
+	host_evse_print_hex("response ", (uint8_t*)&response, response.header.length);
+}
+
+static void host_evse_command(const char *line) {
+	char command[16];
+	if(sscanf(line, "%15s", command) != 1) {
+		printf("error\n");
+		return;
+	}
+
+	if(strcmp(command, "input") == 0) {
+		unsigned int cp_pe, pp_pe, diode, shutdown_closed, ac1, ac2, button_pressed, jumper;
+		if(sscanf(line + 5, "%u %u %u %u %u %u %u %u", &cp_pe, &pp_pe, &diode, &shutdown_closed, &ac1, &ac2, &button_pressed, &jumper) != 8) {
+			printf("error\n");
+			return;
+		}
+
+		host_evse_input = (HostEVSEInput){cp_pe, pp_pe, diode, shutdown_closed, ac1, ac2, button_pressed, (uint8_t)jumper};
+		printf("ok\n");
+		return;
+	}
+
+	if(!host_evse_booted) {
+		host_evse_boot();
+	}
+
+	if(strcmp(command, "run") == 0) {
+		unsigned int ms = 0;
+		sscanf(line + 3, "%u", &ms);
+		for(uint32_t i = 0; i < ms; i++) {
+			host_evse_tick_ms();
+		}
+		printf("ok\n");
+	} else if(strcmp(command, "message") == 0) {
+		host_evse_message(line + 8);
+	} else if(strcmp(command, "analog") == 0) {
+		// CP/PE average over the PWM period as seen by a voltmeter, CP disconnected = 0V
+		const uint16_t duty_cycle = evse_get_cp_duty_cycle();
+		int32_t cp_mv = 0;
+		if(!XMC_GPIO_GetInput(EVSE_V2_CP_DISCONNECT_PIN)) {
+			cp_mv = (host_evse_get_cp_mv(true)*duty_cycle + host_evse_get_cp_mv(false)*(1000 - duty_cycle))/1000;
+		}
+		printf("analog %d %d\n", cp_mv, host_evse_get_pp_mv());
+	} else if(strcmp(command, "state") == 0) {
+		printf("state IEC 61851 state %c, duty cycle %u, contactor %d, max current %umA, CP/PE %u, PP/PE %u, uptime %ums\n",
+		       "ABCDE"[iec61851.state], evse_get_cp_duty_cycle(), evse_is_contactor_active(), iec61851_get_max_ma(),
+		       adc_result.cp_pe_resistance, adc_result.pp_pe_resistance, system_timer_get_ms());
+	} else {
+		printf("error\n");
+	}
+}
+
+static void host_evse_run(void) {
+	signal(SIGABRT, host_evse_system_reset);
+	memcpy(bootloader_shim_eeprom, host_evse_eeprom, sizeof(bootloader_shim_eeprom));
+	bootloader_shim_firmware_configuration.firmware_version = (FIRMWARE_VERSION_MAJOR << 16) | (FIRMWARE_VERSION_MINOR << 8) | FIRMWARE_VERSION_REVISION;
+
+	printf("reset %d.%d.%d\n", FIRMWARE_VERSION_MAJOR, FIRMWARE_VERSION_MINOR, FIRMWARE_VERSION_REVISION);
+	fflush(stdout);
+
+	// Unbuffered, the commands after a reset are read by the next process
+	setvbuf(stdin, NULL, _IONBF, 0);
+
+	char line[HOST_EVSE_LINE_LENGTH];
+	while(fgets(line, sizeof(line), stdin) != NULL) {
+		host_evse_command(line);
+		fflush(stdout);
+	}
+
+	host_evse_exit(0);
+}
+
+int main(int argc, char **argv) {
+	if(argc > 1) {
+		host_evse_uid = (uint32_t)strtoul(argv[1], NULL, 0);
+	}
+
+	host_evse_eeprom = mmap(NULL, sizeof(bootloader_shim_eeprom), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if(host_evse_eeprom == MAP_FAILED) {
+		return 1;
+	}
+	memset(host_evse_eeprom, 0, sizeof(bootloader_shim_eeprom));
+
+	// Each boot of the firmware is a new process, so all static variables start from scratch
+	while(true) {
+		fflush(stdout);
+
+		const pid_t pid = fork();
+		if(pid == 0) {
+			host_evse_run();
+		}
+
+		int status = 0;
+		if((pid < 0) || (waitpid(pid, &status, 0) != pid)) {
+			return 1;
+		}
+
+		if(WIFEXITED(status) && (WEXITSTATUS(status) == HOST_EVSE_EXIT_RESET)) {
+			continue;
+		}
+
+		return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+	}
+}
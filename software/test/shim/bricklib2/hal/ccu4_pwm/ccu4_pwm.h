@@ -0,0 +1,32 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * ccu4_pwm.h: Host shim of the bricklib2 CCU4 PWM
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef CCU4_PWM_H
+#define CCU4_PWM_H
+
+#include <stdint.h>
+
+#include "bricklib2/hal/system_timer/system_timer.h"
+
+static inline void ccu4_pwm_set_duty_cycle(const uint8_t ccu4_slice_number, const uint16_t duty_cycle) {}
+static inline uint16_t ccu4_pwm_get_period(const uint8_t ccu4_slice_number) { return 64000; }
+
+#endif
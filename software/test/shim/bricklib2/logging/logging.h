@@ -0,0 +1,39 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * logging.h: Host shim of bricklib2 logging (logging disabled)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include "bricklib2/hal/system_timer/system_timer.h"
+
+#define LOGGING_NONE  0
+#define LOGGING_LEVEL LOGGING_NONE
+
+// Logging is disabled, the arguments are still used so that values that
+// are only computed for the log don't trigger unused warnings
+static inline void logging_shim_discard(const char *format, ...) {}
+
+#define logd(...) logging_shim_discard(__VA_ARGS__)
+#define logi(...) logging_shim_discard(__VA_ARGS__)
+#define logw(...) logging_shim_discard(__VA_ARGS__)
+#define loge(...) logging_shim_discard(__VA_ARGS__)
+
+#endif
@@ -0,0 +1,104 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * meter.h: Host shim of the bricklib2 meter interface
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef METER_H
+#define METER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <string.h>
+
+#include "bricklib2/bootloader/bootloader.h"
+#include "bricklib2/protocols/tfp/tfp.h"
+#include "modbus.h"
+
+#define METER_TYPE_UNKNOWN       0
+#define METER_TYPE_UNSUPPORTED   1
+#define METER_TYPE_SDM630        2
+#define METER_TYPE_SDM72V2       3
+#define METER_TYPE_SDM72CTM      4
+#define METER_TYPE_SDM630MCTV2   5
+#define METER_TYPE_DSZ15DZMOD    6
+#define METER_TYPE_DEM4A         7
+#define METER_TYPE_DMED341MID7ER 8
+#define METER_TYPE_DSZ16DZE      9
+#define METER_TYPE_WM3M4C        10
+#define METER_TYPE_WM3M4         11
+
+typedef union {
+	float f;
+	uint32_t u32;
+	int16_t i16_single;
+	uint16_t u16_single;
+	uint32_t data;
+} MeterRegisterType;
+
+typedef struct {
+	uint8_t type;
+	uint8_t slave_address;
+	bool available;
+	bool each_value_read_once;
+	bool phases_connected[3];
+	bool new_fast_value_callback;
+	bool reset_energy_meter;
+	uint32_t register_fast_time;
+	MeterRegisterType relative_energy_sum;
+	MeterRegisterType relative_energy_import;
+	MeterRegisterType relative_energy_export;
+} Meter;
+
+typedef struct {
+	MeterRegisterType VoltageL1N;
+	MeterRegisterType VoltageL2N;
+	MeterRegisterType VoltageL3N;
+	MeterRegisterType FrequencyLAvg;
+	MeterRegisterType CurrentL1ImExSum;
+	MeterRegisterType CurrentL2ImExSum;
+	MeterRegisterType CurrentL3ImExSum;
+	MeterRegisterType PowerActiveLSumImExDiff;
+	MeterRegisterType EnergyActiveLSumImExSum;
+	MeterRegisterType EnergyActiveLSumImport;
+	MeterRegisterType EnergyActiveLSumExport;
+} MeterRegisterSet;
+
+// Chunk of the values of get_all_energy_meter_values_low_level()
+typedef struct {
+	TFPMessageHeader header;
+	uint16_t values_chunk_offset;
+	float values_chunk_data[15];
+} __attribute__((__packed__)) GenericMeterValues_Response;
+
+extern Meter meter;
+extern MeterRegisterSet meter_register_set;
+
+bool meter_supports_eichrecht(void);
+void meter_read_registers(const uint8_t fc, const uint8_t slave_address, const uint16_t start_address, const uint16_t count);
+bool meter_get_read_registers_response(const uint8_t fc, void *data, const uint16_t count);
+bool meter_get_read_registers_response_string(const uint8_t fc, char *data, const uint16_t length);
+void meter_write_register(const uint8_t fc, const uint8_t slave_address, const uint16_t address, MeterRegisterType *payload);
+void meter_write_string(const uint8_t slave_address, const uint16_t address, const char *data, const uint16_t length);
+bool meter_get_write_register_response(const uint8_t fc);
+BootloaderHandleMessageResponse meter_fill_communication_values(GenericMeterValues_Response *response);
+void meter_init(void);
+void meter_tick(void);
+
+#endif
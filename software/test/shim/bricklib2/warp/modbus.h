@@ -0,0 +1,48 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * modbus.h: Host shim of the bricklib2 Modbus definitions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef MODBUS_H
+#define MODBUS_H
+
+#include <stdint.h>
+
+#define MODBUS_FC_READ_HOLDING_REGISTERS   3
+#define MODBUS_FC_READ_INPUT_REGISTERS     4
+#define MODBUS_FC_WRITE_SINGLE_REGISTER    6
+#define MODBUS_FC_WRITE_MULTIPLE_REGISTERS 16
+
+typedef struct {
+	uint32_t timeout;
+	uint32_t illegal_function;
+	uint32_t illegal_data_address;
+	uint32_t illegal_data_value;
+	uint32_t slave_device_failure;
+} ModbusCommonErrorCounters;
+
+typedef struct {
+	ModbusCommonErrorCounters modbus_common_error_counters;
+} RS485;
+
+extern RS485 rs485;
+
+void modbus_clear_request(RS485 *rs485);
+
+#endif
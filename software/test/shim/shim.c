@@ -0,0 +1,71 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * shim.c: State of the host shims of bricklib2 and the XMC library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "xmc_shim.h"
+#include "bricklib2/hal/system_timer/system_timer.h"
+#include "bricklib2/bootloader/bootloader.h"
+#include "bricklib2/warp/contactor_check.h"
+#include "bricklib2/warp/meter.h"
+#include "bricklib2/warp/meter_iskra.h"
+
+uint32_t system_timer_shim_ms = 0;
+
+XMC_GPIO_PORT_t xmc_shim_port[5];
+XMC_CCU4_MODULE_t xmc_shim_ccu4[2];
+XMC_CCU8_MODULE_t xmc_shim_ccu8[2];
+XMC_CCU4_SLICE_t xmc_shim_ccu4_slice[2][4];
+XMC_CCU8_SLICE_t xmc_shim_ccu8_slice[2][4];
+uint32_t xmc_shim_ccu_compare_writes;
+uint32_t xmc_shim_ccu_shadow_transfers;
+uint32_t xmc_shim_nvic_pending;
+XMC_VADC_GLOBAL_t xmc_shim_vadc;
+XMC_VADC_GROUP_t xmc_shim_vadc_group[2];
+XMC_VADC_GLOBAL_SHS_t xmc_shim_vadc_shs;
+SysTick_Type xmc_shim_systick;
+SCB_Type xmc_shim_scb;
+uint32_t SystemCoreClock = 48000000;
+
+BootloaderFirmwareConfiguration bootloader_shim_firmware_configuration = {
+	.firmware_version = (2 << 16) | (6 << 8) | 11
+};
+uint32_t bootloader_shim_eeprom[EEPROM_PAGE_NUM][EEPROM_PAGE_SIZE/sizeof(uint32_t)];
+BootloaderStatus bootloader_status;
+
+ContactorCheck contactor_check;
+Meter meter;
+MeterRegisterSet meter_register_set;
+MeterIskra meter_iskra;
+RS485 rs485;
+
+void bootloader_read_eeprom_page(const uint32_t page_num, uint32_t *data) {
+	memcpy(data, bootloader_shim_eeprom[page_num], EEPROM_PAGE_SIZE);
+}
+
+void bootloader_write_eeprom_page(const uint32_t page_num, uint32_t *data) {
+	memcpy(bootloader_shim_eeprom[page_num], data, EEPROM_PAGE_SIZE);
+}
+
+void NVIC_SystemReset(void) {
+	abort();
+}
@@ -0,0 +1,606 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * xmc_shim.h: Host shim of the XMC peripheral library
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef XMC_SHIM_H
+#define XMC_SHIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+// Only the parts of the XMC peripheral library that are used by the modules
+// under test. Ports are plain memory, peripheral configuration is ignored.
+
+typedef struct {
+	uint32_t IN;
+	uint32_t OUT;
+	uint32_t OMR; // Shim only: Pins that are configured as output
+	uint32_t FLOAT; // Shim only: Pins that are not driven externally, they read the level of the pull device
+} XMC_GPIO_PORT_t;
+
+extern XMC_GPIO_PORT_t xmc_shim_port[5];
+
+#define XMC_GPIO_PORT0 (&xmc_shim_port[0])
+#define XMC_GPIO_PORT1 (&xmc_shim_port[1])
+#define XMC_GPIO_PORT2 (&xmc_shim_port[2])
+#define XMC_GPIO_PORT3 (&xmc_shim_port[3])
+#define XMC_GPIO_PORT4 (&xmc_shim_port[4])
+
+#define P0_0  XMC_GPIO_PORT0, 0
+#define P0_1  XMC_GPIO_PORT0, 1
+#define P0_2  XMC_GPIO_PORT0, 2
+#define P0_3  XMC_GPIO_PORT0, 3
+#define P0_4  XMC_GPIO_PORT0, 4
+#define P0_5  XMC_GPIO_PORT0, 5
+#define P0_6  XMC_GPIO_PORT0, 6
+#define P0_7  XMC_GPIO_PORT0, 7
+#define P0_8  XMC_GPIO_PORT0, 8
+#define P0_9  XMC_GPIO_PORT0, 9
+#define P0_10 XMC_GPIO_PORT0, 10
+#define P0_11 XMC_GPIO_PORT0, 11
+#define P0_12 XMC_GPIO_PORT0, 12
+#define P0_13 XMC_GPIO_PORT0, 13
+#define P0_14 XMC_GPIO_PORT0, 14
+#define P0_15 XMC_GPIO_PORT0, 15
+#define P1_0  XMC_GPIO_PORT1, 0
+#define P1_1  XMC_GPIO_PORT1, 1
+#define P1_2  XMC_GPIO_PORT1, 2
+#define P1_3  XMC_GPIO_PORT1, 3
+#define P1_4  XMC_GPIO_PORT1, 4
+#define P1_5  XMC_GPIO_PORT1, 5
+#define P1_6  XMC_GPIO_PORT1, 6
+#define P1_7  XMC_GPIO_PORT1, 7
+#define P1_8  XMC_GPIO_PORT1, 8
+#define P1_9  XMC_GPIO_PORT1, 9
+#define P1_10 XMC_GPIO_PORT1, 10
+#define P1_11 XMC_GPIO_PORT1, 11
+#define P1_12 XMC_GPIO_PORT1, 12
+#define P1_13 XMC_GPIO_PORT1, 13
+#define P1_14 XMC_GPIO_PORT1, 14
+#define P1_15 XMC_GPIO_PORT1, 15
+#define P2_0  XMC_GPIO_PORT2, 0
+#define P2_1  XMC_GPIO_PORT2, 1
+#define P2_2  XMC_GPIO_PORT2, 2
+#define P2_3  XMC_GPIO_PORT2, 3
+#define P2_4  XMC_GPIO_PORT2, 4
+#define P2_5  XMC_GPIO_PORT2, 5
+#define P2_6  XMC_GPIO_PORT2, 6
+#define P2_7  XMC_GPIO_PORT2, 7
+#define P2_8  XMC_GPIO_PORT2, 8
+#define P2_9  XMC_GPIO_PORT2, 9
+#define P2_10 XMC_GPIO_PORT2, 10
+#define P2_11 XMC_GPIO_PORT2, 11
+#define P2_12 XMC_GPIO_PORT2, 12
+#define P2_13 XMC_GPIO_PORT2, 13
+#define P2_14 XMC_GPIO_PORT2, 14
+#define P2_15 XMC_GPIO_PORT2, 15
+#define P3_0  XMC_GPIO_PORT3, 0
+#define P3_1  XMC_GPIO_PORT3, 1
+#define P3_2  XMC_GPIO_PORT3, 2
+#define P3_3  XMC_GPIO_PORT3, 3
+#define P3_4  XMC_GPIO_PORT3, 4
+#define P3_5  XMC_GPIO_PORT3, 5
+#define P3_6  XMC_GPIO_PORT3, 6
+#define P3_7  XMC_GPIO_PORT3, 7
+#define P3_8  XMC_GPIO_PORT3, 8
+#define P3_9  XMC_GPIO_PORT3, 9
+#define P3_10 XMC_GPIO_PORT3, 10
+#define P3_11 XMC_GPIO_PORT3, 11
+#define P3_12 XMC_GPIO_PORT3, 12
+#define P3_13 XMC_GPIO_PORT3, 13
+#define P3_14 XMC_GPIO_PORT3, 14
+#define P3_15 XMC_GPIO_PORT3, 15
+#define P4_0  XMC_GPIO_PORT4, 0
+#define P4_1  XMC_GPIO_PORT4, 1
+#define P4_2  XMC_GPIO_PORT4, 2
+#define P4_3  XMC_GPIO_PORT4, 3
+#define P4_4  XMC_GPIO_PORT4, 4
+#define P4_5  XMC_GPIO_PORT4, 5
+#define P4_6  XMC_GPIO_PORT4, 6
+#define P4_7  XMC_GPIO_PORT4, 7
+#define P4_8  XMC_GPIO_PORT4, 8
+#define P4_9  XMC_GPIO_PORT4, 9
+#define P4_10 XMC_GPIO_PORT4, 10
+#define P4_11 XMC_GPIO_PORT4, 11
+#define P4_12 XMC_GPIO_PORT4, 12
+#define P4_13 XMC_GPIO_PORT4, 13
+#define P4_14 XMC_GPIO_PORT4, 14
+#define P4_15 XMC_GPIO_PORT4, 15
+
+// Output modes have bit 7 set as on the XMC, a pin that is configured as
+// output reads back the level that it drives
+typedef enum {
+	XMC_GPIO_MODE_INPUT_TRISTATE         = 0x00,
+	XMC_GPIO_MODE_INPUT_PULL_DOWN        = 0x08,
+	XMC_GPIO_MODE_INPUT_PULL_UP          = 0x10,
+	XMC_GPIO_MODE_OUTPUT_PUSH_PULL       = 0x80,
+	XMC_GPIO_MODE_OUTPUT_PUSH_PULL_ALT2  = 0x90,
+	XMC_GPIO_MODE_OUTPUT_PUSH_PULL_ALT4  = 0xa0,
+	XMC_GPIO_MODE_OUTPUT_PUSH_PULL_ALT5  = 0xa8,
+	XMC_GPIO_MODE_OUTPUT_PUSH_PULL_ALT6  = 0xb0,
+	XMC_GPIO_MODE_OUTPUT_PUSH_PULL_ALT7  = 0xb8,
+	XMC_GPIO_MODE_OUTPUT_PUSH_PULL_ALT8  = 0x81,
+	XMC_GPIO_MODE_OUTPUT_PUSH_PULL_ALT9  = 0x82,
+	XMC_GPIO_MODE_OUTPUT_OPEN_DRAIN_ALT7 = 0xf8
+} XMC_GPIO_MODE_t;
+
+#define XMC_GPIO_MODE_OUTPUT 0x80
+
+typedef enum {
+	XMC_GPIO_INPUT_HYSTERESIS_STANDARD,
+	XMC_GPIO_INPUT_HYSTERESIS_LARGE
+} XMC_GPIO_INPUT_HYSTERESIS_t;
+
+typedef enum {
+	XMC_GPIO_OUTPUT_LEVEL_LOW,
+	XMC_GPIO_OUTPUT_LEVEL_HIGH
+} XMC_GPIO_OUTPUT_LEVEL_t;
+
+typedef struct {
+	XMC_GPIO_MODE_t mode;
+	XMC_GPIO_INPUT_HYSTERESIS_t input_hysteresis;
+	XMC_GPIO_OUTPUT_LEVEL_t output_level;
+} XMC_GPIO_CONFIG_t;
+
+// Pins that are not available on a hardware version are NULL, 0 (see
+// configs/config_evse.h), on the target the accesses go to the flash address
+// space and have no effect
+static inline uint32_t XMC_GPIO_GetInput(XMC_GPIO_PORT_t *const port, const uint8_t pin) {
+	if(port == NULL) {
+		return 0;
+	}
+
+	return (port->IN >> pin) & 1;
+}
+
+static inline void XMC_GPIO_SetOutputHigh(XMC_GPIO_PORT_t *const port, const uint8_t pin) {
+	if(port == NULL) {
+		return;
+	}
+
+	port->OUT |= 1UL << pin;
+	port->IN  |= port->OMR & (1UL << pin);
+}
+
+static inline void XMC_GPIO_SetOutputLow(XMC_GPIO_PORT_t *const port, const uint8_t pin) {
+	if(port == NULL) {
+		return;
+	}
+
+	port->OUT &= ~(1UL << pin);
+	port->IN  &= ~(port->OMR & (1UL << pin));
+}
+
+static inline void XMC_GPIO_Init(XMC_GPIO_PORT_t *const port, const uint8_t pin, const XMC_GPIO_CONFIG_t *const config) {
+	if(port == NULL) {
+		return;
+	}
+
+	if(config->mode & XMC_GPIO_MODE_OUTPUT) {
+		port->OMR |= 1UL << pin;
+	} else {
+		port->OMR &= ~(1UL << pin);
+		if(config->mode == XMC_GPIO_MODE_INPUT_PULL_UP) {
+			port->IN |= port->FLOAT & (1UL << pin);
+		} else if(config->mode == XMC_GPIO_MODE_INPUT_PULL_DOWN) {
+			port->IN &= ~(port->FLOAT & (1UL << pin));
+		}
+	}
+
+	if(config->output_level == XMC_GPIO_OUTPUT_LEVEL_HIGH) {
+		XMC_GPIO_SetOutputHigh(port, pin);
+	} else {
+		XMC_GPIO_SetOutputLow(port, pin);
+	}
+}
+
+// CCU4/CCU8 timers, the compare values are kept for the tests and the
+// compare value writes and shadow transfers are counted
+typedef struct {
+	uint32_t period;
+	uint32_t compare[2];
+} XMC_CCU_SLICE_t;
+
+typedef XMC_CCU_SLICE_t XMC_CCU4_SLICE_t;
+typedef XMC_CCU_SLICE_t XMC_CCU8_SLICE_t;
+typedef struct { uint32_t dummy; } XMC_CCU4_MODULE_t;
+typedef struct { uint32_t dummy; } XMC_CCU8_MODULE_t;
+
+extern XMC_CCU4_MODULE_t xmc_shim_ccu4[2];
+extern XMC_CCU8_MODULE_t xmc_shim_ccu8[2];
+extern XMC_CCU4_SLICE_t xmc_shim_ccu4_slice[2][4];
+extern XMC_CCU8_SLICE_t xmc_shim_ccu8_slice[2][4];
+extern uint32_t xmc_shim_ccu_compare_writes;
+extern uint32_t xmc_shim_ccu_shadow_transfers;
+
+#define CCU40      (&xmc_shim_ccu4[0])
+#define CCU41      (&xmc_shim_ccu4[1])
+#define CCU80      (&xmc_shim_ccu8[0])
+#define CCU81      (&xmc_shim_ccu8[1])
+#define CCU40_CC40 (&xmc_shim_ccu4_slice[0][0])
+#define CCU40_CC41 (&xmc_shim_ccu4_slice[0][1])
+#define CCU40_CC42 (&xmc_shim_ccu4_slice[0][2])
+#define CCU40_CC43 (&xmc_shim_ccu4_slice[0][3])
+#define CCU41_CC40 (&xmc_shim_ccu4_slice[1][0])
+#define CCU41_CC41 (&xmc_shim_ccu4_slice[1][1])
+#define CCU41_CC42 (&xmc_shim_ccu4_slice[1][2])
+#define CCU41_CC43 (&xmc_shim_ccu4_slice[1][3])
+#define CCU80_CC80 (&xmc_shim_ccu8_slice[0][0])
+#define CCU80_CC81 (&xmc_shim_ccu8_slice[0][1])
+#define CCU81_CC81 (&xmc_shim_ccu8_slice[1][1])
+
+typedef enum {
+	XMC_CCU4_SLICE_TIMER_COUNT_MODE_EA,
+	XMC_CCU4_SLICE_TIMER_COUNT_MODE_CA
+} XMC_CCU4_SLICE_TIMER_COUNT_MODE_t;
+
+typedef enum {
+	XMC_CCU4_SLICE_PRESCALER_MODE_NORMAL,
+	XMC_CCU4_SLICE_PRESCALER_MODE_FLOAT
+} XMC_CCU4_SLICE_PRESCALER_MODE_t;
+
+typedef enum {
+	XMC_CCU4_SLICE_OUTPUT_PASSIVE_LEVEL_LOW,
+	XMC_CCU4_SLICE_OUTPUT_PASSIVE_LEVEL_HIGH
+} XMC_CCU4_SLICE_OUTPUT_PASSIVE_LEVEL_t;
+
+typedef enum {
+	XMC_CCU8_SLICE_TIMER_COUNT_MODE_EA,
+	XMC_CCU8_SLICE_TIMER_COUNT_MODE_CA
+} XMC_CCU8_SLICE_TIMER_COUNT_MODE_t;
+
+typedef enum {
+	XMC_CCU8_SLICE_PRESCALER_MODE_NORMAL,
+	XMC_CCU8_SLICE_PRESCALER_MODE_FLOAT
+} XMC_CCU8_SLICE_PRESCALER_MODE_t;
+
+typedef enum {
+	XMC_CCU8_SLICE_OUTPUT_PASSIVE_LEVEL_LOW,
+	XMC_CCU8_SLICE_OUTPUT_PASSIVE_LEVEL_HIGH
+} XMC_CCU8_SLICE_OUTPUT_PASSIVE_LEVEL_t;
+
+typedef enum {
+	XMC_CCU8_SLICE_COMPARE_CHANNEL_1,
+	XMC_CCU8_SLICE_COMPARE_CHANNEL_2
+} XMC_CCU8_SLICE_COMPARE_CHANNEL_t;
+
+#define XMC_CCU4_SLICE_MCMS_ACTION_TRANSFER_PR_CR  0
+#define XMC_CCU8_SLICE_MCMS_ACTION_TRANSFER_PR_CR  0
+#define XMC_CCU4_SHADOW_TRANSFER_SLICE_0           (1UL << 0)
+#define XMC_CCU4_SHADOW_TRANSFER_PRESCALER_SLICE_0 (1UL << 2)
+#define XMC_CCU4_SHADOW_TRANSFER_SLICE_1           (1UL << 4)
+#define XMC_CCU4_SHADOW_TRANSFER_PRESCALER_SLICE_1 (1UL << 6)
+#define XMC_CCU4_SHADOW_TRANSFER_SLICE_2           (1UL << 8)
+#define XMC_CCU4_SHADOW_TRANSFER_PRESCALER_SLICE_2 (1UL << 10)
+#define XMC_CCU4_SHADOW_TRANSFER_SLICE_3           (1UL << 12)
+#define XMC_CCU4_SHADOW_TRANSFER_PRESCALER_SLICE_3 (1UL << 14)
+#define XMC_CCU8_SHADOW_TRANSFER_SLICE_0           (1UL << 0)
+#define XMC_CCU8_SHADOW_TRANSFER_PRESCALER_SLICE_0 (1UL << 2)
+#define XMC_CCU8_SHADOW_TRANSFER_SLICE_1           (1UL << 4)
+#define XMC_CCU8_SHADOW_TRANSFER_PRESCALER_SLICE_1 (1UL << 6)
+
+// The configuration structs accept all fields that the modules initialize
+typedef struct {
+	uint32_t timer_mode;
+	uint32_t monoshot;
+	uint32_t shadow_xfer_clear;
+	uint32_t dither_timer_period;
+	uint32_t dither_duty_cycle;
+	uint32_t prescaler_mode;
+	uint32_t mcm_enable;
+	uint32_t prescaler_initval;
+	uint32_t float_limit;
+	uint32_t dither_limit;
+	uint32_t passive_level;
+	uint32_t timer_concatenation;
+} XMC_CCU4_SLICE_COMPARE_CONFIG_t;
+
+typedef struct {
+	uint32_t timer_mode;
+	uint32_t monoshot;
+	uint32_t shadow_xfer_clear;
+	uint32_t dither_timer_period;
+	uint32_t dither_duty_cycle;
+	uint32_t prescaler_mode;
+	uint32_t mcm_ch1_enable;
+	uint32_t mcm_ch2_enable;
+	uint32_t slice_status;
+	uint32_t passive_level_out0;
+	uint32_t passive_level_out1;
+	uint32_t passive_level_out2;
+	uint32_t passive_level_out3;
+	uint32_t asymmetric_pwm;
+	uint32_t invert_out0;
+	uint32_t invert_out1;
+	uint32_t invert_out2;
+	uint32_t invert_out3;
+	uint32_t prescaler_initval;
+	uint32_t float_limit;
+	uint32_t dither_limit;
+	uint32_t timer_concatenation;
+} XMC_CCU8_SLICE_COMPARE_CONFIG_t;
+
+static inline void XMC_CCU4_Init(XMC_CCU4_MODULE_t *const module, const uint32_t mcs_action) {}
+static inline void XMC_CCU4_StartPrescaler(XMC_CCU4_MODULE_t *const module) {}
+static inline void XMC_CCU4_EnableClock(XMC_CCU4_MODULE_t *const module, const uint8_t slice_number) {}
+static inline void XMC_CCU4_EnableShadowTransfer(XMC_CCU4_MODULE_t *const module, const uint32_t shadow_transfer_msk) { xmc_shim_ccu_shadow_transfers++; }
+static inline void XMC_CCU4_SLICE_CompareInit(XMC_CCU4_SLICE_t *const slice, const XMC_CCU4_SLICE_COMPARE_CONFIG_t *const config) {}
+static inline void XMC_CCU4_SLICE_StartTimer(XMC_CCU4_SLICE_t *const slice) {}
+static inline void XMC_CCU4_SLICE_SetTimerPeriodMatch(XMC_CCU4_SLICE_t *const slice, const uint16_t period_val) { slice->period = period_val; }
+static inline void XMC_CCU4_SLICE_SetTimerCompareMatch(XMC_CCU4_SLICE_t *const slice, const uint16_t compare_val) { slice->compare[0] = compare_val; xmc_shim_ccu_compare_writes++; }
+
+// CCU4 events and interrupts, the capture inputs are not simulated
+typedef enum {
+	XMC_CCU4_SLICE_PRESCALER_1,
+	XMC_CCU4_SLICE_PRESCALER_2,
+	XMC_CCU4_SLICE_PRESCALER_64 = 6
+} XMC_CCU4_SLICE_PRESCALER_t;
+
+typedef enum {
+	XMC_CCU4_SLICE_EVENT_NONE,
+	XMC_CCU4_SLICE_EVENT_0,
+	XMC_CCU4_SLICE_EVENT_1,
+	XMC_CCU4_SLICE_EVENT_2
+} XMC_CCU4_SLICE_EVENT_t;
+
+typedef enum {
+	XMC_CCU4_SLICE_EVENT_FILTER_DISABLED,
+	XMC_CCU4_SLICE_EVENT_FILTER_3_CYCLES,
+	XMC_CCU4_SLICE_EVENT_FILTER_5_CYCLES,
+	XMC_CCU4_SLICE_EVENT_FILTER_7_CYCLES
+} XMC_CCU4_SLICE_EVENT_FILTER_t;
+
+#define XMC_CCU4_SLICE_EVENT_EDGE_SENSITIVITY_RISING_EDGE   1
+#define XMC_CCU4_SLICE_EVENT_LEVEL_SENSITIVITY_ACTIVE_HIGH  0
+#define XMC_CCU4_SLICE_INPUT_AI                             8
+#define XMC_CCU4_SLICE_START_MODE_TIMER_START_CLEAR         1
+#define XMC_CCU4_SLICE_IRQ_ID_PERIOD_MATCH                  0
+#define XMC_CCU4_SLICE_IRQ_ID_COMPARE_MATCH_UP              2
+#define XMC_CCU4_SLICE_SR_ID_2                              2
+#define XMC_CCU4_SLICE_SR_ID_3                              3
+
+typedef struct {
+	uint32_t mapped_input;
+	uint32_t edge;
+	uint32_t level;
+	uint32_t duration;
+} XMC_CCU4_SLICE_EVENT_CONFIG_t;
+
+static inline void XMC_CCU4_SLICE_ConfigureEvent(XMC_CCU4_SLICE_t *const slice, const XMC_CCU4_SLICE_EVENT_t event, const XMC_CCU4_SLICE_EVENT_CONFIG_t *const config) {}
+static inline void XMC_CCU4_SLICE_StartConfig(XMC_CCU4_SLICE_t *const slice, const XMC_CCU4_SLICE_EVENT_t event, const uint32_t start_mode) {}
+static inline void XMC_CCU4_SLICE_EnableEvent(XMC_CCU4_SLICE_t *const slice, const uint32_t event) {}
+static inline void XMC_CCU4_SLICE_SetInterruptNode(XMC_CCU4_SLICE_t *const slice, const uint32_t event, const uint32_t sr) {}
+static inline uint16_t XMC_CCU4_SLICE_GetTimerCompareMatch(const XMC_CCU4_SLICE_t *const slice) { return (uint16_t)slice->compare[0]; }
+
+static inline void XMC_CCU8_Init(XMC_CCU8_MODULE_t *const module, const uint32_t mcs_action) {}
+static inline void XMC_CCU8_StartPrescaler(XMC_CCU8_MODULE_t *const module) {}
+static inline void XMC_CCU8_EnableClock(XMC_CCU8_MODULE_t *const module, const uint8_t slice_number) {}
+static inline void XMC_CCU8_EnableShadowTransfer(XMC_CCU8_MODULE_t *const module, const uint32_t shadow_transfer_msk) { xmc_shim_ccu_shadow_transfers++; }
+static inline void XMC_CCU8_SLICE_CompareInit(XMC_CCU8_SLICE_t *const slice, const XMC_CCU8_SLICE_COMPARE_CONFIG_t *const config) {}
+static inline void XMC_CCU8_SLICE_StartTimer(XMC_CCU8_SLICE_t *const slice) {}
+static inline void XMC_CCU8_SLICE_SetTimerPeriodMatch(XMC_CCU8_SLICE_t *const slice, const uint16_t period_val) { slice->period = period_val; }
+static inline void XMC_CCU8_SLICE_SetTimerCompareMatch(XMC_CCU8_SLICE_t *const slice, const XMC_CCU8_SLICE_COMPARE_CHANNEL_t channel, const uint16_t compare_val) { slice->compare[channel] = compare_val; xmc_shim_ccu_compare_writes++; }
+
+// SCU and NVIC, interrupts are not simulated: The tests call the handlers
+// and check the pending flags themselves
+typedef int32_t IRQn_Type;
+
+extern uint32_t xmc_shim_nvic_pending;
+
+#define SCU_GENERAL_CCUCON_GSC40_Msk (1UL << 0)
+#define SCU_GENERAL_CCUCON_GSC41_Msk (1UL << 1)
+
+#define XMC_SCU_IRQCTRL_ERU0_SR3_IRQ6    0
+#define XMC_SCU_IRQCTRL_USIC1_SR2_IRQ11  0
+#define XMC_SCU_IRQCTRL_USIC1_SR3_IRQ12  0
+#define XMC_SCU_IRQCTRL_USIC1_SR4_IRQ13  0
+#define XMC_SCU_IRQCTRL_USIC1_SR5_IRQ14  0
+#define XMC_SCU_IRQCTRL_CCU40_SR2_IRQ30  0
+#define XMC_SCU_IRQCTRL_CCU41_SR2_IRQ30  0
+#define XMC_SCU_IRQCTRL_CCU41_SR3_IRQ31  0
+
+static inline void XMC_SCU_SetCcuTriggerHigh(const uint32_t trigger) {}
+static inline void XMC_SCU_SetInterruptControl(const uint8_t irq_number, const uint32_t source) {}
+
+static inline void NVIC_SetPriority(const IRQn_Type irq, const uint32_t priority) {}
+static inline void NVIC_EnableIRQ(const IRQn_Type irq) {}
+static inline uint32_t NVIC_GetPendingIRQ(const IRQn_Type irq) { return (xmc_shim_nvic_pending >> irq) & 1; }
+static inline void NVIC_SetPendingIRQ(const IRQn_Type irq) { xmc_shim_nvic_pending |= 1UL << irq; }
+static inline void NVIC_ClearPendingIRQ(const IRQn_Type irq) { xmc_shim_nvic_pending &= ~(1UL << irq); }
+void NVIC_SystemReset(void) __attribute__((noreturn));
+
+// VADC, the result registers are plain memory that the tests fill. A result
+// is valid if bit 31 is set, reading it clears the valid flag.
+typedef struct {
+	uint32_t result[16];
+} XMC_VADC_GROUP_t;
+
+typedef struct { uint32_t dummy; } XMC_VADC_GLOBAL_t;
+typedef struct { uint32_t dummy; } XMC_VADC_GLOBAL_SHS_t;
+
+extern XMC_VADC_GLOBAL_t xmc_shim_vadc;
+extern XMC_VADC_GROUP_t xmc_shim_vadc_group[2];
+extern XMC_VADC_GLOBAL_SHS_t xmc_shim_vadc_shs;
+
+#define VADC    (&xmc_shim_vadc)
+#define VADC_G0 (&xmc_shim_vadc_group[0])
+#define VADC_G1 (&xmc_shim_vadc_group[1])
+#define SHS0    (&xmc_shim_vadc_shs)
+
+#define XMC_VADC_CONVMODE_12BIT                           0
+#define XMC_VADC_DMM_REDUCTION_MODE                       0
+#define XMC_VADC_STARTMODE_CIR                            0
+#define XMC_VADC_GROUP_RS_PRIORITY_1                      1
+#define XMC_VADC_REQ_TR_A                                 0
+#define XMC_VADC_REQ_TR_C                                 2
+#define XMC_VADC_REQ_GT_A                                 0
+#define XMC_VADC_REQ_GT_C                                 2
+#define XMC_VADC_TRIGGER_EDGE_RISING                      1
+#define XMC_VADC_SCAN_LOAD_OVERWRITE                      0
+#define XMC_VADC_GROUP_EMUXMODE_SWCTRL                    0
+#define XMC_VADC_GROUP_EMUXCODE_BINARY                    0
+#define XMC_VADC_GROUP_ARBMODE_ALWAYS                     0
+#define XMC_VADC_GROUP_POWERMODE_NORMAL                   3
+#define XMC_VADC_GROUP_INDEX_0                            0
+#define XMC_VADC_GROUP_INDEX_1                            1
+#define XMC_VADC_GROUP_CONV_STD                           0
+#define XMC_VADC_GLOBAL_SHS_AREF_EXTERNAL_VDD_UPPER_RANGE 0
+#define XMC_VADC_CHANNEL_CONV_GLOBAL_CLASS0               2
+#define XMC_VADC_CHANNEL_BOUNDARY_GROUP_BOUND0            0
+#define XMC_VADC_CHANNEL_EVGEN_NEVER                      0
+#define XMC_VADC_CHANNEL_REF_INTREF                       0
+#define XMC_VADC_RESULT_ALIGN_RIGHT                       1
+#define XMC_VADC_CHANNEL_BWDCH_VAGND                      0
+#define XMC_VADC_SR_SHARED_SR0                            4
+
+typedef struct {
+	uint32_t sample_time_std_conv;
+	uint32_t conversion_mode_standard;
+	uint32_t sampling_phase_emux_channel;
+	uint32_t conversion_mode_emux;
+} XMC_VADC_GLOBAL_CLASS_t;
+
+typedef XMC_VADC_GLOBAL_CLASS_t XMC_VADC_GROUP_CLASS_t;
+
+typedef struct {
+	uint32_t data_reduction_control;
+	uint32_t post_processing_mode;
+	uint32_t wait_for_read_mode;
+	uint32_t part_of_fifo;
+	uint32_t event_gen_enable;
+} XMC_VADC_RESULT_CONFIG_t;
+
+typedef struct {
+	uint32_t boundary0;
+	uint32_t boundary1;
+	uint32_t clock_config;
+	XMC_VADC_GLOBAL_CLASS_t class0;
+	XMC_VADC_GLOBAL_CLASS_t class1;
+	uint32_t data_reduction_control;
+	uint32_t wait_for_read_mode;
+	uint32_t event_gen_enable;
+	uint32_t disable_sleep_mode_control;
+} XMC_VADC_GLOBAL_CONFIG_t;
+
+typedef struct {
+	uint32_t conv_start_mode;
+	uint32_t req_src_priority;
+	uint32_t trigger_signal;
+	uint32_t trigger_edge;
+	uint32_t gate_signal;
+	uint32_t timer_mode;
+	uint32_t external_trigger;
+	uint32_t req_src_interrupt;
+	uint32_t enable_auto_scan;
+	uint32_t load_mode;
+} XMC_VADC_BACKGROUND_CONFIG_t;
+
+typedef struct {
+	uint32_t stce_usage;
+	uint32_t emux_mode;
+	uint32_t emux_coding;
+	uint32_t starting_external_channel;
+	uint32_t connected_channel;
+} XMC_VADC_GROUP_EMUXCFG_t;
+
+typedef struct {
+	XMC_VADC_GROUP_EMUXCFG_t emux_config;
+	XMC_VADC_GROUP_CLASS_t class0;
+	XMC_VADC_GROUP_CLASS_t class1;
+	uint32_t boundary0;
+	uint32_t boundary1;
+	uint32_t arbitration_round_length;
+	uint32_t arbiter_mode;
+} XMC_VADC_GROUP_CONFIG_t;
+
+typedef struct {
+	uint32_t input_class;
+	uint32_t lower_boundary_select;
+	uint32_t upper_boundary_select;
+	uint32_t event_gen_criteria;
+	uint32_t sync_conversion;
+	uint32_t alternate_reference;
+	uint32_t result_reg_number;
+	uint32_t use_global_result;
+	uint32_t result_alignment;
+	uint32_t broken_wire_detect_channel;
+	uint32_t broken_wire_detect;
+	uint32_t bfl;
+	uint32_t bfls;
+	uint32_t channel_priority;
+	int32_t  alias_channel;
+} XMC_VADC_CHANNEL_CONFIG_t;
+
+static inline void XMC_VADC_GLOBAL_Init(XMC_VADC_GLOBAL_t *const global, const XMC_VADC_GLOBAL_CONFIG_t *const config) {}
+static inline void XMC_VADC_GLOBAL_StartupCalibration(XMC_VADC_GLOBAL_t *const global) {}
+static inline void XMC_VADC_GLOBAL_InputClassInit(XMC_VADC_GLOBAL_t *const global, const XMC_VADC_GLOBAL_CLASS_t config, const uint32_t conv_type, const uint32_t set_num) {}
+static inline void XMC_VADC_GLOBAL_BackgroundInit(XMC_VADC_GLOBAL_t *const global, const XMC_VADC_BACKGROUND_CONFIG_t *const config) {}
+static inline void XMC_VADC_GLOBAL_ResultInit(XMC_VADC_GLOBAL_t *const global, const XMC_VADC_RESULT_CONFIG_t *const config) {}
+static inline void XMC_VADC_GLOBAL_BackgroundAddChannelToSequence(XMC_VADC_GLOBAL_t *const global, const uint32_t grp_num, const uint32_t ch_num) {}
+static inline void XMC_VADC_GLOBAL_BackgroundRemoveChannelFromSequence(XMC_VADC_GLOBAL_t *const global, const uint32_t grp_num, const uint32_t ch_num) {}
+static inline void XMC_VADC_GLOBAL_BackgroundSetReqSrcEventInterruptNode(XMC_VADC_GLOBAL_t *const global, const uint32_t sr) {}
+static inline void XMC_VADC_GLOBAL_BackgroundTriggerConversion(XMC_VADC_GLOBAL_t *const global) {}
+static inline void XMC_VADC_GLOBAL_SHS_EnableAcceleratedMode(XMC_VADC_GLOBAL_SHS_t *const shs, const uint32_t group_num) {}
+static inline void XMC_VADC_GLOBAL_SHS_SetAnalogReference(XMC_VADC_GLOBAL_SHS_t *const shs, const uint32_t aref) {}
+static inline void XMC_VADC_GROUP_Init(XMC_VADC_GROUP_t *const group, const XMC_VADC_GROUP_CONFIG_t *const config) {}
+static inline void XMC_VADC_GROUP_SetPowerMode(XMC_VADC_GROUP_t *const group, const uint32_t power_mode) {}
+static inline void XMC_VADC_GROUP_ChannelInit(XMC_VADC_GROUP_t *const group, const uint32_t ch_num, const XMC_VADC_CHANNEL_CONFIG_t *const config) {}
+static inline void XMC_VADC_GROUP_ResultInit(XMC_VADC_GROUP_t *const group, const uint32_t res_reg_num, const XMC_VADC_RESULT_CONFIG_t *const config) {}
+
+static inline uint32_t XMC_VADC_GROUP_GetDetailedResult(XMC_VADC_GROUP_t *const group, const uint32_t res_reg) {
+	const uint32_t result = group->result[res_reg];
+	group->result[res_reg] &= ~(1UL << 31);
+	return result;
+}
+
+// SysTick and SCB, the SysTick counter is not simulated
+typedef struct {
+	uint32_t CTRL;
+	uint32_t LOAD;
+	uint32_t VAL;
+} SysTick_Type;
+
+typedef struct {
+	uint32_t ICSR;
+	uint32_t SCR;
+} SCB_Type;
+
+extern SysTick_Type xmc_shim_systick;
+extern SCB_Type xmc_shim_scb;
+
+extern uint32_t SystemCoreClock;
+
+#define SysTick (&xmc_shim_systick)
+#define SCB     (&xmc_shim_scb)
+
+#define SCB_ICSR_PENDSTSET_Msk (1UL << 26)
+#define SCB_SCR_SEVONPEND_Msk  (1UL << 4)
+
+// Cortex-M intrinsics
+#define __DMB()     __sync_synchronize()
+#define __NOP()     do {} while(0)
+#define __WFI()     do {} while(0)
+#define __WFE()     do {} while(0)
+#define __disable_irq() do {} while(0)
+#define __enable_irq()  do {} while(0)
+
+#endif
@@ -0,0 +1,64 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * test.h: Minimal check macros for the host tests
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Each test is a program that returns the number of failed checks,
+// a failed check prints the location and continues.
+
+extern uint32_t test_failures;
+
+#define TEST_DEFINE_FAILURES() uint32_t test_failures = 0
+
+#define CHECK(condition) do { \
+	if(!(condition)) { \
+		printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+		test_failures++; \
+	} \
+} while(0)
+
+#define CHECK_EQUAL(actual, expected) do { \
+	const long long _actual   = (long long)(actual); \
+	const long long _expected = (long long)(expected); \
+	if(_actual != _expected) { \
+		printf("%s:%d: check failed: %s == %lld, expected %lld\n", __FILE__, __LINE__, #actual, _actual, _expected); \
+		test_failures++; \
+	} \
+} while(0)
+
+#define TEST_RESULT() (printf("%s: %s (%u failed checks)\n", __FILE__, (test_failures == 0) ? "OK" : "FAILED", (unsigned int)test_failures), (test_failures == 0) ? 0 : 1)
+
+// Deterministic pseudo random numbers (xorshift32), the same sequence on every run
+static inline uint32_t test_random(uint32_t *state) {
+	uint32_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+#endif
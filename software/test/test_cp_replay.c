@@ -0,0 +1,699 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * test_cp_replay.c: Host replay of CP traces through the ADC -> IEC 61851 pipeline
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+// Host counterpart of the on-target replay (cmake -DCP_TRACE_REPLAY=ON,
+// tests/test_cp_trace_replay.py). The trace is fed through the replay hook
+// in adc_check_result(), everything after it is the real firmware:
+// adc_check_count(), evse_tick() -> iec61851_tick(), evse_set_output(),
+// charging_slot_tick() and phase_control_tick() on a virtual clock.
+//
+// Each virtual ms has two ADC scans (two samples per ms, as on the target)
+// with one main loop iteration after each scan. Meter currents can be set
+// at a trace sample, they are used by the phase auto-switch. The trace
+// pauses while CP is disconnected by the firmware (no samples are consumed).
+//
+// Each scenario runs in its own process, so every scenario starts with a
+// freshly booted firmware (including the static variables of the modules).
+//
+// Usage: test_cp_replay [trace.csv ...]
+// Without trace files the built-in scenarios and the random scenarios are run.
+// Trace files have the format of tests/test_cp_trace_replay.py, additionally
+// meter currents can be given as comment lines (ignored on the target):
+//   # meter: sample, current_l1, current_l2, current_l3
+
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "bricklib2/hal/system_timer/system_timer.h"
+#include "bricklib2/warp/meter.h"
+#include "bricklib2/utility/util_definitions.h"
+
+#include "adc.h"
+#include "cp_replay.h"
+#include "evse.h"
+#include "iec61851.h"
+#include "charging_slot.h"
+#include "phase_control.h"
+#include "hardware_version.h"
+#include "digital_input.h"
+#include "soft_timer.h"
+#include "communication.h"
+#include "configs/config_evse.h"
+
+TEST_DEFINE_FAILURES();
+
+#define TEST_SAMPLES_PER_MS  2
+#define TEST_DIODE_DROP_MV   650
+#define TEST_VCP_HIGH_MV     12000
+#define TEST_VCP_LOW_MV      -12000
+#define TEST_V12P_MV         12000
+#define TEST_PP_RESISTANCE   220 // 32A cable
+#define TEST_TOLERANCE       200 // samples, the contactor is switched off ~150 samples after the state change
+#define TEST_BOOT_MS         2000 // Virtual ms before the replay starts (EVSE startup)
+
+#define TEST_RUNS_MAX        64
+#define TEST_EXPECTED_MAX    16
+#define TEST_METER_MAX       8
+#define TEST_TIMELINE_MAX    64
+#define TEST_NOT_CHECKED     0xFF
+
+#define TEST_RANDOM_SCENARIOS 1000
+
+typedef struct {
+	int32_t vcp1_mv;
+	int32_t vcp2_mv;
+	uint32_t samples;
+	bool pwm;
+} TestRun;
+
+typedef struct {
+	uint32_t sample;
+	IEC61851State state;
+	bool contactor;
+	uint32_t tolerance;
+} TestExpected;
+
+typedef struct {
+	uint32_t sample;
+	float current[3];
+} TestMeter;
+
+typedef struct {
+	const char *name;
+
+	TestRun runs[TEST_RUNS_MAX];
+	uint8_t runs_count;
+
+	TestExpected expected[TEST_EXPECTED_MAX];
+	uint8_t expected_count;
+
+	TestMeter meter[TEST_METER_MAX];
+	uint8_t meter_count;
+
+	uint8_t charging_protocol;
+	bool autoswitch_enabled;
+	uint8_t expected_phases; // Phases at the end of the trace, 0 = not checked
+	uint8_t expected_cp_disconnects; // CP disconnects by the firmware (EV wakeup, phase switch)
+	bool random; // Only the invariants are checked
+} TestTrace;
+
+static const char test_state_names[][3] = {"A", "B", "C", "D", "EF"};
+
+static CPReplayTimelineEntry test_timeline[TEST_TIMELINE_MAX];
+static uint8_t test_timeline_count;
+
+// CP disconnects by the firmware (sample and duration), the trace pauses while CP is disconnected
+static uint32_t test_cp_disconnect_sample[TEST_TIMELINE_MAX];
+static uint32_t test_cp_disconnect_ms[TEST_TIMELINE_MAX];
+static uint8_t test_cp_disconnect_count;
+
+// Sampling IRQ of the digital inputs, not in the header
+void IRQ_Hdlr_31(void);
+
+static uint64_t test_get_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec*1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Conversions --------------------------------------------------------------------
+
+// Inverse of the VCP conversion in adc_check_count()
+static uint16_t test_mv_to_raw_vcp(const int32_t mv) {
+	return (uint16_t)BETWEEN(0, ((mv + 13200)*273 + 880)/1760, 4095);
+}
+
+// Inverse of the PP/PE resistance calculation in adc_check_count()
+static uint16_t test_pp_resistance_to_raw(const uint32_t resistance) {
+	const uint32_t mv = hardware_version.is_v4 ? 15000*resistance/(6000 + 5*resistance) : 10000*resistance/(2000 + 3*resistance);
+	return (uint16_t)BETWEEN(0, (mv*273 + 110)/220, 4095);
+}
+
+// Inverse of the CP/PE resistance calculation in adc_check_count(), 0 = open
+static int32_t test_resistance_to_vcp2_mv(const uint32_t resistance) {
+	const int32_t divider = hardware_version.is_v4 ? 1000 : 910;
+	if(resistance == 0) {
+		return TEST_VCP_HIGH_MV;
+	}
+
+	return ((int32_t)resistance*TEST_VCP_HIGH_MV + divider*TEST_DIODE_DROP_MV)/((int32_t)resistance + divider);
+}
+
+// Traces -------------------------------------------------------------------------
+
+static void test_trace_add(TestTrace *trace, const int32_t vcp1_mv, const int32_t vcp2_mv, const uint32_t samples, const bool pwm) {
+	if(trace->runs_count == TEST_RUNS_MAX) {
+		printf("%s: too many runs\n", trace->name);
+		test_failures++;
+		return;
+	}
+
+	trace->runs[trace->runs_count++] = (TestRun){vcp1_mv, vcp2_mv, samples, pwm};
+}
+
+// CP/PE resistance in ohm (0 = open) for the given time
+static void test_trace_add_resistance(TestTrace *trace, const uint32_t resistance, const uint32_t ms, const bool pwm) {
+	test_trace_add(trace, TEST_VCP_HIGH_MV, test_resistance_to_vcp2_mv(resistance), ms*TEST_SAMPLES_PER_MS, pwm);
+}
+
+static void test_trace_expect(TestTrace *trace, const IEC61851State state, const bool contactor, const uint32_t ms, const uint32_t tolerance) {
+	if(trace->expected_count == TEST_EXPECTED_MAX) {
+		printf("%s: too many expected entries\n", trace->name);
+		test_failures++;
+		return;
+	}
+
+	trace->expected[trace->expected_count++] = (TestExpected){ms*TEST_SAMPLES_PER_MS, state, contactor, tolerance};
+}
+
+static void test_trace_meter(TestTrace *trace, const uint32_t ms, const float l1, const float l2, const float l3) {
+	if(trace->meter_count == TEST_METER_MAX) {
+		printf("%s: too many meter values\n", trace->name);
+		test_failures++;
+		return;
+	}
+
+	trace->meter[trace->meter_count++] = (TestMeter){ms*TEST_SAMPLES_PER_MS, {l1, l2, l3}};
+}
+
+static uint32_t test_trace_get_samples(const TestTrace *trace) {
+	uint32_t samples = 0;
+	for(uint8_t i = 0; i < trace->runs_count; i++) {
+		samples += trace->runs[i].samples;
+	}
+
+	return samples;
+}
+
+static IEC61851State test_parse_state(const char *name) {
+	for(uint8_t i = 0; i < ARRAY_SIZE(test_state_names); i++) {
+		if(strcmp(name, test_state_names[i]) == 0) {
+			return (IEC61851State)i;
+		}
+	}
+
+	return IEC61851_STATE_EF;
+}
+
+static bool test_trace_read(TestTrace *trace, const char *filename) {
+	FILE *f = fopen(filename, "r");
+	if(f == NULL) {
+		printf("%s: can't open\n", filename);
+		return false;
+	}
+
+	memset(trace, 0, sizeof(TestTrace));
+	trace->name                    = filename;
+	trace->expected_cp_disconnects = TEST_NOT_CHECKED;
+
+	char line[256];
+	while(fgets(line, sizeof(line), f) != NULL) {
+		char state[3];
+		unsigned int sample, contactor, samples, tolerance;
+		int pwm;
+		float vcp1_mv, vcp2_mv, l1, l2, l3;
+
+		if(strncmp(line, "# expect:", 9) == 0) {
+			const int count = sscanf(line + 9, " %u , %2[A-F] , %u , %u", &sample, state, &contactor, &tolerance);
+			if(count < 3) {
+				printf("%s: invalid line %s", filename, line);
+				fclose(f);
+				return false;
+			}
+			test_trace_expect(trace, test_parse_state(state), contactor == 1, 0, (count > 3) ? tolerance : TEST_TOLERANCE);
+			trace->expected[trace->expected_count - 1].sample = sample;
+		} else if(strncmp(line, "# meter:", 8) == 0) {
+			if(sscanf(line + 8, " %u , %f , %f , %f", &sample, &l1, &l2, &l3) != 4) {
+				printf("%s: invalid line %s", filename, line);
+				fclose(f);
+				return false;
+			}
+			test_trace_meter(trace, 0, l1, l2, l3);
+			trace->meter[trace->meter_count - 1].sample = sample;
+		} else if((line[0] != '#') && (line[strspn(line, " \t\r\n")] != '\0')) {
+			pwm = 0;
+			if(sscanf(line, " %f , %f , %u , %d", &vcp1_mv, &vcp2_mv, &samples, &pwm) < 3) {
+				printf("%s: invalid line %s", filename, line);
+				fclose(f);
+				return false;
+			}
+			test_trace_add(trace, (int32_t)vcp1_mv, (int32_t)vcp2_mv, samples, pwm == 1);
+		}
+	}
+
+	fclose(f);
+	return true;
+}
+
+// Firmware on the virtual clock ---------------------------------------------------
+
+static void test_set_input(XMC_GPIO_PORT_t *const port, const uint8_t pin, const bool high) {
+	if(high) {
+		port->IN |= 1UL << pin;
+	} else {
+		port->IN &= ~(1UL << pin);
+	}
+}
+
+// The inits of main() that the pipeline depends on, in the same order
+static void test_boot(const TestTrace *trace) {
+	hardware_version.is_v4 = true;
+
+	// Jumper 32A (both pins high with pull-up and pull-down), shutdown input open
+	test_set_input(EVSE_CONFIG_JUMPER_PIN0, true);
+	test_set_input(EVSE_CONFIG_JUMPER_PIN1, true);
+	test_set_input(EVSE_SHUTDOWN_PIN, true);
+
+	evse_init();
+	charging_slot_init();
+	iec61851_init();
+	adc_init();
+	digital_input_init();
+	phase_control_init();
+	cp_replay_init();
+
+	iec61851.charging_protocol      = trace->charging_protocol;
+	phase_control.autoswitch_enabled = trace->autoswitch_enabled;
+	meter.available                 = trace->meter_count > 0;
+}
+
+// One ADC background scan, the VCP results are replaced by the replay hook
+static void test_scan(void) {
+	const uint16_t raw[ADC_NUM] = {
+		[ADC_CHANNEL_VCP1] = test_mv_to_raw_vcp(TEST_VCP_HIGH_MV),
+		[ADC_CHANNEL_VCP2] = test_mv_to_raw_vcp(TEST_VCP_HIGH_MV),
+		[ADC_CHANNEL_VPP]  = test_pp_resistance_to_raw(TEST_PP_RESISTANCE),
+		[ADC_CHANNEL_V12P] = (uint16_t)(TEST_V12P_MV*273/880),
+		[ADC_CHANNEL_V12M] = test_mv_to_raw_vcp(-TEST_V12P_MV)
+	};
+
+	for(uint8_t i = 0; i < ADC_NUM; i++) {
+		adc[i].group->result[adc[i].result_reg] = raw[i] | (1UL << 31);
+	}
+}
+
+static void test_loop(void) {
+	soft_timer_tick();
+	digital_input_tick();
+	adc_tick();
+	evse_tick();
+	charging_slot_tick();
+	phase_control_tick();
+	cp_replay_tick();
+}
+
+static void test_timeline_add(void) {
+	const CPReplayTimelineEntry entry = {
+		.sample         = cp_replay.sample,
+		.iec61851_state = iec61851.state,
+		.contactor      = evse_is_contactor_active(),
+		.cp_duty_cycle  = evse_get_cp_duty_cycle()
+	};
+
+	if(test_timeline_count > 0) {
+		const CPReplayTimelineEntry *last = &test_timeline[test_timeline_count - 1];
+		if((entry.iec61851_state == last->iec61851_state) && (entry.contactor == last->contactor) && (entry.cp_duty_cycle == last->cp_duty_cycle)) {
+			return;
+		}
+	}
+
+	if(test_timeline_count < TEST_TIMELINE_MAX) {
+		test_timeline[test_timeline_count++] = entry;
+	}
+}
+
+// Invariants of the random scenarios
+typedef struct {
+	uint32_t last_state_c;     // Last ms in state C
+	bool contactor;
+	bool cp_connected;
+} TestInvariant;
+
+static void test_check_invariants(TestInvariant *invariant, const char *name) {
+	const bool contactor = evse_is_contactor_active();
+	const uint32_t now   = system_timer_get_ms();
+
+	if(iec61851.state == IEC61851_STATE_C) {
+		invariant->last_state_c = now;
+	}
+
+	// The contactor is only switched on in state C
+	if(contactor && !invariant->contactor && (iec61851.state != IEC61851_STATE_C)) {
+		printf("%s: contactor switched on in state %s at %u ms\n", name, test_state_names[iec61851.state], now);
+		test_failures++;
+	}
+
+	// It is switched off at the latest 6s after state C ended (EV doesn't respond to the CP change)
+	if(contactor && (iec61851.state != IEC61851_STATE_C) && ((now - invariant->last_state_c) > 6500)) {
+		printf("%s: contactor still on %u ms after state C\n", name, now - invariant->last_state_c);
+		test_failures++;
+		invariant->last_state_c = now;
+	}
+
+	invariant->contactor = contactor;
+}
+
+// One virtual ms: The sampling IRQ of the digital inputs and two ADC scans with a main loop iteration after each
+static void test_tick_ms(const TestTrace *trace, TestInvariant *invariant) {
+	system_timer_shim_ms++;
+	IRQ_Hdlr_31();
+
+	for(uint8_t i = 0; i < TEST_SAMPLES_PER_MS; i++) {
+		test_scan();
+		test_loop();
+		if(cp_replay.active) {
+			test_timeline_add();
+			if(trace->random) {
+				test_check_invariants(invariant, trace->name);
+			}
+		}
+	}
+
+	if(!cp_replay.active) {
+		return;
+	}
+
+	const bool cp_connected = evse_is_cp_connected();
+	if(!cp_connected && (test_cp_disconnect_count < TEST_TIMELINE_MAX)) {
+		if(invariant->cp_connected) {
+			test_cp_disconnect_sample[test_cp_disconnect_count] = cp_replay.sample;
+			test_cp_disconnect_ms[test_cp_disconnect_count]     = 0;
+			test_cp_disconnect_count++;
+		}
+		test_cp_disconnect_ms[test_cp_disconnect_count - 1]++;
+	}
+	invariant->cp_connected = cp_connected;
+}
+
+static void test_replay(const TestTrace *trace) {
+	test_boot(trace);
+
+	// Boot until the EVSE startup is done, no vehicle connected
+	TestInvariant invariant = {0};
+	while(system_timer_get_ms() < TEST_BOOT_MS) {
+		test_tick_ms(trace, &invariant);
+	}
+
+	const uint16_t vpp     = test_pp_resistance_to_raw(TEST_PP_RESISTANCE);
+	const uint16_t vcp_low = test_mv_to_raw_vcp(TEST_VCP_LOW_MV);
+	cp_replay_start(vpp, vcp_low);
+	test_timeline_count      = 0;
+	test_cp_disconnect_count = 0;
+	invariant.cp_connected   = true;
+	test_timeline_add();
+
+	// Run-length encoded elements, written as the API would do it
+	uint8_t run          = 0;
+	uint32_t run_written = 0;
+	uint8_t meter_index  = 0;
+	const uint32_t samples = test_trace_get_samples(trace);
+
+	while(cp_replay.sample < samples) {
+		while(run < trace->runs_count) {
+			const TestRun *r     = &trace->runs[run];
+			const uint32_t count = MIN(r->samples - run_written, 128);
+			const uint32_t element = test_mv_to_raw_vcp(r->vcp1_mv) | (test_mv_to_raw_vcp(r->vcp2_mv) << 12) | ((count & 0x7F) << 24) | (r->pwm ? (1UL << 31) : 0);
+			if(cp_replay_write(&element, 1) == 0) {
+				break;
+			}
+
+			run_written += count;
+			if(run_written == r->samples) {
+				run++;
+				run_written = 0;
+			}
+		}
+
+		while((meter_index < trace->meter_count) && (trace->meter[meter_index].sample <= cp_replay.sample)) {
+			meter_register_set.CurrentL1ImExSum.f = trace->meter[meter_index].current[0];
+			meter_register_set.CurrentL2ImExSum.f = trace->meter[meter_index].current[1];
+			meter_register_set.CurrentL3ImExSum.f = trace->meter[meter_index].current[2];
+			meter_index++;
+		}
+
+		test_tick_ms(trace, &invariant);
+
+		// CP stays disconnected by the phase switch/EV wakeup for at most a few minutes
+		if(system_timer_get_ms() > TEST_BOOT_MS + samples/TEST_SAMPLES_PER_MS + 10*60*1000) {
+			printf("%s: replay does not advance\n", trace->name);
+			test_failures++;
+			break;
+		}
+	}
+
+	cp_replay_stop();
+}
+
+// Same check as tests/test_cp_trace_replay.py: The state sequence has to be the
+// expected one and the expected entries have to be found in order within the tolerance
+static void test_check_timeline(const TestTrace *trace) {
+	uint8_t expected_index = 0;
+	IEC61851State last_state = (IEC61851State)0xFF;
+	for(uint8_t i = 0; i < test_timeline_count; i++) {
+		const IEC61851State state = (IEC61851State)test_timeline[i].iec61851_state;
+		if(state == last_state) {
+			continue;
+		}
+		last_state = state;
+
+		while((expected_index < trace->expected_count) && (expected_index > 0) && (trace->expected[expected_index].state == trace->expected[expected_index - 1].state)) {
+			expected_index++;
+		}
+
+		if((expected_index == trace->expected_count) || (trace->expected[expected_index].state != state)) {
+			printf("%s: unexpected state %s at sample %u\n", trace->name, test_state_names[state], test_timeline[i].sample);
+			test_failures++;
+			return;
+		}
+		expected_index++;
+	}
+
+	uint8_t index = 0;
+	for(uint8_t i = 0; i < trace->expected_count; i++) {
+		const TestExpected *expected = &trace->expected[i];
+		while((index < test_timeline_count) && !((test_timeline[index].iec61851_state == expected->state) && (test_timeline[index].contactor == expected->contactor))) {
+			index++;
+		}
+
+		if(index == test_timeline_count) {
+			printf("%s: %s contactor %d missing\n", trace->name, test_state_names[expected->state], expected->contactor);
+			test_failures++;
+			continue;
+		}
+
+		const uint32_t sample = test_timeline[index].sample;
+		if((uint32_t)ABS((int32_t)(sample - expected->sample)) > expected->tolerance) {
+			printf("%s: %s contactor %d at sample %u, expected %u +-%u\n", trace->name, test_state_names[expected->state], expected->contactor, sample, expected->sample, expected->tolerance);
+			test_failures++;
+		}
+		index++;
+	}
+}
+
+static void test_print_timeline(const TestTrace *trace) {
+	printf("%s (%u samples)\n", trace->name, test_trace_get_samples(trace));
+	for(uint8_t i = 0; i < test_timeline_count; i++) {
+		printf("  %8u: %-2s contactor %d, duty cycle %4u\n", test_timeline[i].sample, test_state_names[test_timeline[i].iec61851_state], test_timeline[i].contactor, test_timeline[i].cp_duty_cycle);
+	}
+	for(uint8_t i = 0; i < test_cp_disconnect_count; i++) {
+		printf("  %8u: CP disconnected for %u ms\n", test_cp_disconnect_sample[i], test_cp_disconnect_ms[i]);
+	}
+}
+
+// Runs the scenario in a child process, returns the number of failed checks
+static uint32_t test_run(const TestTrace *trace, const bool print) {
+	fflush(stdout);
+
+	const pid_t pid = fork();
+	if(pid == 0) {
+		test_failures = 0;
+		test_replay(trace);
+		if(!trace->random) {
+			test_check_timeline(trace);
+		}
+		if(trace->expected_phases != 0) {
+			CHECK_EQUAL(phase_control.current, trace->expected_phases);
+		}
+		if(trace->expected_cp_disconnects != TEST_NOT_CHECKED) {
+			CHECK_EQUAL(test_cp_disconnect_count, trace->expected_cp_disconnects);
+		}
+		if(print || (test_failures > 0)) {
+			test_print_timeline(trace);
+		}
+		fflush(stdout);
+		_exit((int)MIN(test_failures, 255));
+	}
+
+	int status = 0;
+	if((pid < 0) || (waitpid(pid, &status, 0) != pid) || !WIFEXITED(status)) {
+		printf("%s: scenario did not complete\n", trace->name);
+		return 1;
+	}
+
+	return (uint32_t)WEXITSTATUS(status);
+}
+
+// Scenarios ----------------------------------------------------------------------
+
+static TestTrace test_trace;
+
+// Same as the synthetic traces of tests/test_cp_trace_replay.py
+static void test_plug_charge_unplug(void) {
+	TestTrace *trace = &test_trace;
+	memset(trace, 0, sizeof(TestTrace));
+	trace->name = "plug, charge, unplug";
+
+	test_trace_add_resistance(trace, 0,    2000,  false);
+	test_trace_add_resistance(trace, 2700, 3000,  false);
+	test_trace_add_resistance(trace, 880,  10000, true);
+	test_trace_add_resistance(trace, 2700, 3000,  true);
+	test_trace_add_resistance(trace, 0,    3000,  false);
+	test_trace_expect(trace, IEC61851_STATE_A, false, 0,     0);
+	test_trace_expect(trace, IEC61851_STATE_B, false, 2000,  TEST_TOLERANCE);
+	test_trace_expect(trace, IEC61851_STATE_C, true,  5000,  2000);
+	test_trace_expect(trace, IEC61851_STATE_B, false, 15000, TEST_TOLERANCE);
+	test_trace_expect(trace, IEC61851_STATE_A, false, 18000, TEST_TOLERANCE);
+
+	test_failures += test_run(trace, true);
+}
+
+static void test_resistance_glitch(void) {
+	TestTrace *trace = &test_trace;
+	memset(trace, 0, sizeof(TestTrace));
+	trace->name = "resistance glitch in C";
+
+	test_trace_add_resistance(trace, 2700, 2000, true);
+	test_trace_add_resistance(trace, 880,  5000, true);
+	for(uint8_t i = 0; i < 5; i++) {
+		test_trace_add_resistance(trace, 2700, 2,    true);
+		test_trace_add_resistance(trace, 880,  1000, true);
+	}
+	test_trace_add_resistance(trace, 2700, 2000, true);
+	test_trace_expect(trace, IEC61851_STATE_A, false, 0,     0); // The replay starts in A
+	test_trace_expect(trace, IEC61851_STATE_B, false, 0,     TEST_TOLERANCE);
+	test_trace_expect(trace, IEC61851_STATE_C, true,  2000,  2000);
+	test_trace_expect(trace, IEC61851_STATE_B, false, 12010, TEST_TOLERANCE);
+
+	test_failures += test_run(trace, true);
+}
+
+// EV stays in B after an ISO 15118 session, the first CP disconnect
+// is after ~10s instead of 90s (iec61851_handle_ev_wakeup()).
+// The trace pauses for the 4s while CP is disconnected.
+static void test_iso15118_fallback(void) {
+	TestTrace *trace = &test_trace;
+	memset(trace, 0, sizeof(TestTrace));
+	trace->name = "ISO 15118 fallback wakeup";
+	trace->charging_protocol       = EVSE_V2_CHARGING_PROTOCOL_IEC61851_TEMPORARY;
+	trace->expected_cp_disconnects = 1;
+
+	test_trace_add_resistance(trace, 0,    1000,  false);
+	test_trace_add_resistance(trace, 2700, 12000, true);
+	test_trace_add_resistance(trace, 880,  5000,  true);
+	test_trace_expect(trace, IEC61851_STATE_A, false, 0,     0);
+	test_trace_expect(trace, IEC61851_STATE_B, false, 1000,  TEST_TOLERANCE);
+	test_trace_expect(trace, IEC61851_STATE_C, true,  13000, 2000);
+
+	test_failures += test_run(trace, true);
+}
+
+// The EV draws current on L1 only (or on all phases): After 2s in C and
+// 30s of L1 > 5A with L2/L3 < 0.5A the phase auto-switch goes to 1-phase.
+// The EV already charges on one phase, so this is done under load without
+// a CP disconnect.
+static void test_phase_autoswitch(const bool one_phase) {
+	TestTrace *trace = &test_trace;
+	memset(trace, 0, sizeof(TestTrace));
+	trace->name = one_phase ? "phase auto-switch, EV charges on L1" : "phase auto-switch, EV charges on L1-L3";
+	trace->autoswitch_enabled = true;
+	trace->expected_phases    = one_phase ? 1 : 3;
+
+	test_trace_add_resistance(trace, 2700, 2000,  true);
+	test_trace_add_resistance(trace, 880,  36000, true);
+	test_trace_add_resistance(trace, 2700, 2000,  true);
+	test_trace_meter(trace, 3000, 16.0f, one_phase ? 0.0f : 16.0f, one_phase ? 0.0f : 16.0f);
+	test_trace_expect(trace, IEC61851_STATE_A, false, 0,     0);
+	test_trace_expect(trace, IEC61851_STATE_B, false, 0,     TEST_TOLERANCE);
+	test_trace_expect(trace, IEC61851_STATE_C, true,  2000,  2000);
+	test_trace_expect(trace, IEC61851_STATE_B, false, 38000, TEST_TOLERANCE);
+
+	test_failures += test_run(trace, true);
+}
+
+// Random sequences of EV states, glitches and PWM, only the invariants are checked
+static void test_random_scenarios(void) {
+	uint32_t random_state = 0x1234567;
+	const uint32_t resistances[] = {0, 2700, 880, 240, 100, 1300, 2200};
+
+	const uint64_t start = test_get_ns();
+	uint32_t samples = 0;
+	for(uint32_t i = 0; i < TEST_RANDOM_SCENARIOS; i++) {
+		TestTrace *trace = &test_trace;
+		memset(trace, 0, sizeof(TestTrace));
+		trace->name   = "random";
+		trace->random = true;
+
+		const uint8_t runs = (uint8_t)(4 + test_random(&random_state) % 8);
+		for(uint8_t run = 0; run < runs; run++) {
+			const uint32_t resistance = resistances[test_random(&random_state) % ARRAY_SIZE(resistances)];
+			const uint32_t ms         = (test_random(&random_state) % 4 == 0) ? 1 + test_random(&random_state) % 20 : 100 + test_random(&random_state) % 1500;
+			test_trace_add_resistance(trace, resistance, ms, (resistance != 0) && (test_random(&random_state) % 4 != 0));
+		}
+
+		samples += test_trace_get_samples(trace);
+		const uint32_t failures = test_run(trace, false);
+		if(failures > 0) {
+			printf("random scenario %u failed\n", i);
+			test_failures += failures;
+		}
+	}
+
+	const uint64_t ns = test_get_ns() - start;
+	printf("{\"benchmark\": \"cp_replay_random_scenarios\", \"host\": true, \"scenarios\": %u, \"samples\": %u, \"scenarios_per_s\": %.0f}\n", TEST_RANDOM_SCENARIOS, samples, (double)(TEST_RANDOM_SCENARIOS*1000000000ULL)/(double)ns);
+}
+
+int main(int argc, char **argv) {
+	if(argc > 1) {
+		for(int i = 1; i < argc; i++) {
+			if(test_trace_read(&test_trace, argv[i])) {
+				test_failures += test_run(&test_trace, true);
+			} else {
+				test_failures++;
+			}
+		}
+
+		return TEST_RESULT();
+	}
+
+	test_plug_charge_unplug();
+	test_resistance_glitch();
+	test_iso15118_fallback();
+	test_phase_autoswitch(true);
+	test_phase_autoswitch(false);
+	test_random_scenarios();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,298 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * test_eichrecht.c: Host test of the Eichrecht OCMF dataset builder
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+// The datasets are compared byte for byte with hand written reference
+// datasets and with the builder before the dataset was split into cached
+// parts (only difference: user strings are JSON escaped now).
+
+#include "test.h"
+
+#include <string.h>
+
+#include "bricklib2/bootloader/bootloader.h"
+#include "bricklib2/utility/util_definitions.h"
+
+#include "eichrecht.h"
+#include "arena.h"
+
+TEST_DEFINE_FAILURES();
+
+HardwareVersion hardware_version = {.is_v4 = true};
+
+// Not in the headers
+void eichrecht_create_dataset(const EichrechtTransaction *t);
+
+static void test_set(const char *gi, const char *gs, const bool is, const uint8_t *if_, const uint8_t it, const char *id, const uint8_t ct, const char *ci) {
+	CHECK(eichrecht_set_gateway_identification(gi, (uint8_t)strlen(gi)));
+	CHECK(eichrecht_set_gateway_serial(gs, (uint8_t)strlen(gs)));
+	CHECK(eichrecht_set_user_assignment(is, if_, it, id, (uint8_t)strlen(id)));
+	CHECK(eichrecht_set_charge_point(ct, ci, (uint8_t)strlen(ci)));
+}
+
+// Queues a transaction (snapshot of the user assignment) and builds its dataset
+static const char *test_dataset(void) {
+	uint16_t sequence = 0;
+
+	eichrecht.queue_start = 0;
+	eichrecht.queue_count = 0;
+	CHECK(eichrecht_queue_transaction('B', 1700000000, 60, 0, &sequence));
+	CHECK(sequence != 0);
+
+	memset(arena.eichrecht.dataset_in, 0xAA, sizeof(arena.eichrecht.dataset_in));
+	eichrecht_create_dataset(&eichrecht.queue[0]);
+
+	CHECK(eichrecht.dataset_in_length < EICHRECHT_DATASET_IN_SIZE);
+	CHECK_EQUAL(arena.eichrecht.dataset_in[eichrecht.dataset_in_length], '\0');
+	CHECK_EQUAL(strlen(arena.eichrecht.dataset_in), eichrecht.dataset_in_length);
+	return arena.eichrecht.dataset_in;
+}
+
+static void test_expect(const char *expected) {
+	const char *dataset = test_dataset();
+	if(strcmp(dataset, expected) != 0) {
+		printf("got      %s\nexpected %s\n", dataset, expected);
+		test_failures++;
+	}
+}
+
+// Reference datasets -----------------------------------------------------------
+
+static void test_reference(void) {
+	const uint8_t if_none[4]    = {255, 255, 255, 255};
+	const uint8_t if_example[4] = {1, 7, 255, 255};
+	const uint8_t if_gaps[4]    = {255, 16, 100, 0};
+
+	// Empty configuration after init
+	test_expect("{\"FV\":\"1.3\",\"GI\":\"\",\"GS\":\"\",\"PG\":\"\",\"MV\":\"\",\"MM\":\"\",\"MS\":\"\",\"MF\":\"\",\"IS\":false,"
+	            "\"IF\":[\"RFID_NONE\",\"RFID_NONE\",\"RFID_NONE\",\"RFID_NONE\"],\"IT\":\"NONE\",\"ID\":\"\","
+	            "\"CF\":\"2.6.11\",\"CT\":\"EVSEID\",\"CI\":\"\",\"RD\":[]}");
+
+	// Example of the WM3M4C manual
+	test_set("Gateway 1", "123456789", true, if_example, 3, "1F2D3A4F5506C7", 0, "");
+	test_expect("{\"FV\":\"1.3\",\"GI\":\"Gateway 1\",\"GS\":\"123456789\",\"PG\":\"\",\"MV\":\"\",\"MM\":\"\",\"MS\":\"\",\"MF\":\"\",\"IS\":true,"
+	            "\"IF\":[\"RFID_PLAIN\",\"OCPP_RS_TLS\"],\"IT\":\"ISO14443\",\"ID\":\"1F2D3A4F5506C7\","
+	            "\"CF\":\"2.6.11\",\"CT\":\"EVSEID\",\"CI\":\"\",\"RD\":[]}");
+
+	// Unknown identification flags are skipped, unknown types are empty
+	test_set("GW", "S", false, if_gaps, 18, "", 2, "CP 7");
+	test_expect("{\"FV\":\"1.3\",\"GI\":\"GW\",\"GS\":\"S\",\"PG\":\"\",\"MV\":\"\",\"MM\":\"\",\"MS\":\"\",\"MF\":\"\",\"IS\":false,"
+	            "\"IF\":[\"PLMN_SMS\",\"RFID_NONE\"],\"IT\":\"\",\"ID\":\"\","
+	            "\"CF\":\"2.6.11\",\"CT\":\"\",\"CI\":\"CP 7\",\"RD\":[]}");
+
+	// No identification flags, last types of the tables
+	test_set("", "", true, if_none, 17, "0815", 1, "DE*TNF*E1234");
+	test_expect("{\"FV\":\"1.3\",\"GI\":\"\",\"GS\":\"\",\"PG\":\"\",\"MV\":\"\",\"MM\":\"\",\"MS\":\"\",\"MF\":\"\",\"IS\":true,"
+	            "\"IF\":[],\"IT\":\"KEY_CODE\",\"ID\":\"0815\","
+	            "\"CF\":\"2.6.11\",\"CT\":\"CBIDC\",\"CI\":\"DE*TNF*E1234\",\"RD\":[]}");
+
+	// Quotes and backslashes in user strings are escaped
+	test_set("a\"b", "c\\d", true, if_none, 0, "\"\\\"", 0, "\\");
+	test_expect("{\"FV\":\"1.3\",\"GI\":\"a\\\"b\",\"GS\":\"c\\\\d\",\"PG\":\"\",\"MV\":\"\",\"MM\":\"\",\"MS\":\"\",\"MF\":\"\",\"IS\":true,"
+	            "\"IF\":[],\"IT\":\"NONE\",\"ID\":\"\\\"\\\\\\\"\","
+	            "\"CF\":\"2.6.11\",\"CT\":\"EVSEID\",\"CI\":\"\\\\\",\"RD\":[]}");
+
+	// Firmware version with one, two and three digits, only applied when the suffix is rebuilt
+	bootloader_shim_firmware_configuration.firmware_version = (100 << 16) | (0 << 8) | 255;
+	test_set("", "", false, if_none, 0, "", 0, "");
+	test_expect("{\"FV\":\"1.3\",\"GI\":\"\",\"GS\":\"\",\"PG\":\"\",\"MV\":\"\",\"MM\":\"\",\"MS\":\"\",\"MF\":\"\",\"IS\":false,"
+	            "\"IF\":[],\"IT\":\"NONE\",\"ID\":\"\","
+	            "\"CF\":\"100.0.255\",\"CT\":\"EVSEID\",\"CI\":\"\",\"RD\":[]}");
+	bootloader_shim_firmware_configuration.firmware_version = (2 << 16) | (6 << 8) | 11;
+	test_set("", "", false, if_none, 0, "", 0, "");
+}
+
+// The user assignment is taken from the snapshot of the queued transaction
+static void test_snapshot(void) {
+	const uint8_t if_none[4] = {255, 255, 255, 255};
+	const uint8_t if_rfid[4] = {1, 255, 255, 255};
+	uint16_t sequence = 0;
+
+	eichrecht.queue_start = 0;
+	eichrecht.queue_count = 0;
+	test_set("GW", "S", true, if_rfid, 3, "CARD1", 0, "CP");
+	CHECK(eichrecht_queue_transaction('B', 1700000000, 60, 0, &sequence));
+	CHECK(eichrecht_set_user_assignment(false, if_none, 13, "CARD2", 5));
+
+	eichrecht_create_dataset(&eichrecht.queue[0]);
+	CHECK(strcmp(arena.eichrecht.dataset_in,
+	             "{\"FV\":\"1.3\",\"GI\":\"GW\",\"GS\":\"S\",\"PG\":\"\",\"MV\":\"\",\"MM\":\"\",\"MS\":\"\",\"MF\":\"\",\"IS\":true,"
+	             "\"IF\":[\"RFID_PLAIN\"],\"IT\":\"ISO14443\",\"ID\":\"CARD1\","
+	             "\"CF\":\"2.6.11\",\"CT\":\"EVSEID\",\"CI\":\"CP\",\"RD\":[]}") == 0);
+}
+
+// Invalid strings are rejected and don't change the dataset
+static void test_invalid(void) {
+	const uint8_t if_none[4] = {255, 255, 255, 255};
+	char long_string[64];
+	memset(long_string, 'x', sizeof(long_string));
+
+	test_set("GW", "S", false, if_none, 0, "ID", 0, "CP");
+	CHECK(!eichrecht_set_gateway_identification("a\nb", 3));
+	CHECK(!eichrecht_set_gateway_serial("\t", 1));
+	CHECK(!eichrecht_set_user_assignment(true, if_none, 0, "\x1F", 1));
+	CHECK(!eichrecht_set_charge_point(0, "\r", 1));
+	CHECK(!eichrecht_set_gateway_identification(long_string, sizeof(eichrecht.ocmf.gi)));
+	CHECK(!eichrecht_set_gateway_serial(long_string, sizeof(eichrecht.ocmf.gs)));
+	CHECK(!eichrecht_set_user_assignment(true, if_none, 0, long_string, sizeof(eichrecht.ocmf.id)));
+	CHECK(!eichrecht_set_charge_point(0, long_string, sizeof(eichrecht.ocmf.ci)));
+
+	test_expect("{\"FV\":\"1.3\",\"GI\":\"GW\",\"GS\":\"S\",\"PG\":\"\",\"MV\":\"\",\"MM\":\"\",\"MS\":\"\",\"MF\":\"\",\"IS\":false,"
+	            "\"IF\":[],\"IT\":\"NONE\",\"ID\":\"ID\","
+	            "\"CF\":\"2.6.11\",\"CT\":\"EVSEID\",\"CI\":\"CP\",\"RD\":[]}");
+
+	// Strings from the API are not necessarily null-terminated, the length counts
+	CHECK(eichrecht_set_gateway_serial("ABCDEF", 3));
+	CHECK(strcmp(eichrecht.ocmf.gs, "ABC") == 0);
+}
+
+// Worst case: maximum length strings of quotes, longest flags and type
+static void test_worst_case(void) {
+	const uint8_t if_long[4] = {10, 10, 10, 10}; // OCPP_WHITELIST
+	char gi[sizeof(eichrecht.ocmf.gi)];
+	char gs[sizeof(eichrecht.ocmf.gs)];
+	char id[sizeof(eichrecht.ocmf.id)];
+	char ci[sizeof(eichrecht.ocmf.ci)];
+
+	memset(gi, '"', sizeof(gi) - 1); gi[sizeof(gi) - 1] = '\0';
+	memset(gs, '"', sizeof(gs) - 1); gs[sizeof(gs) - 1] = '\0';
+	memset(id, '"', sizeof(id) - 1); id[sizeof(id) - 1] = '\0';
+	memset(ci, '"', sizeof(ci) - 1); ci[sizeof(ci) - 1] = '\0';
+
+	bootloader_shim_firmware_configuration.firmware_version = (255 << 16) | (255 << 8) | 255;
+	test_set(gi, gs, false, if_long, 16, id, 0, ci); // PHONE_NUMBER
+	test_dataset();
+	bootloader_shim_firmware_configuration.firmware_version = (2 << 16) | (6 << 8) | 11;
+
+	printf("Worst case dataset: %u bytes\n", eichrecht.dataset_in_length);
+	CHECK(eichrecht.ocmf.dataset_prefix_length < EICHRECHT_DATASET_PREFIX_SIZE);
+	CHECK(eichrecht.ocmf.dataset_suffix_length < EICHRECHT_DATASET_SUFFIX_SIZE);
+	CHECK(eichrecht.dataset_in_length <= 484);
+}
+
+// Builder before the cached parts, user strings without escaping ---------------
+
+static const char *test_if_strings[] = {
+	"RFID_NONE", "RFID_PLAIN", "RFID_RELATED", "RFID_PSK", "OCPP_NONE", "OCPP_RS", "OCPP_AUTH", "OCPP_RS_TLS", "OCPP_AUTH_TLS", "OCPP_CACHE", "OCPP_WHITELIST", "OCPP_CERTIFIED", "ISO15118_NONE", "ISO15118_PNC", "PLMN_NONE", "PLMN_RING", "PLMN_SMS"
+};
+
+static const char *test_it_strings[] = {
+	"NONE", "DENIED", "UNDEFINED", "ISO14443", "ISO15693", "EMAID", "EVCCID", "EVCOID", "ISO7812", "CARD_TXN_NR", "CENTRAL", "CENTRAL_1", "CENTRAL_2", "LOCAL", "LOCAL_1", "LOCAL_2", "PHONE_NUMBER", "KEY_CODE"
+};
+
+static const char *test_ct_strings[] = {
+	"EVSEID", "CBIDC"
+};
+
+static void test_reference_builder(char *ptr, const OCMF *ocmf) {
+	ptr = stpcpy(ptr, "{\"FV\":\"1.3\",\"GI\":\"");
+	ptr = stpcpy(ptr, ocmf->gi);
+	ptr = stpcpy(ptr, "\",\"GS\":\"");
+	ptr = stpcpy(ptr, ocmf->gs);
+	ptr = stpcpy(ptr, "\",\"PG\":\"\",\"MV\":\"\",\"MM\":\"\",\"MS\":\"\",\"MF\":\"\",\"IS\":");
+	ptr = stpcpy(ptr, ocmf->is ? "true" : "false");
+	ptr = stpcpy(ptr, ",\"IF\":[");
+
+	bool first = true;
+	for(int i = 0; i < 4; i++) {
+		if(ocmf->if_[i] < ARRAY_SIZE(test_if_strings)) {
+			if(!first) {
+				*ptr++ = ',';
+			}
+			first = false;
+			*ptr++ = '"';
+			ptr = stpcpy(ptr, test_if_strings[ocmf->if_[i]]);
+			*ptr++ = '"';
+		}
+	}
+
+	ptr = stpcpy(ptr, "],\"IT\":\"");
+	ptr = stpcpy(ptr, (ocmf->it < ARRAY_SIZE(test_it_strings)) ? test_it_strings[ocmf->it] : "");
+	ptr = stpcpy(ptr, "\",\"ID\":\"");
+	ptr = stpcpy(ptr, ocmf->id);
+	ptr = stpcpy(ptr, "\",\"CF\":\"");
+	ptr += sprintf(ptr, "%u.%u.%u", (bootloader_shim_firmware_configuration.firmware_version >> 16) & 0xFF,
+	               (bootloader_shim_firmware_configuration.firmware_version >> 8) & 0xFF,
+	               bootloader_shim_firmware_configuration.firmware_version & 0xFF);
+	ptr = stpcpy(ptr, "\",\"CT\":\"");
+	ptr = stpcpy(ptr, (ocmf->ct < ARRAY_SIZE(test_ct_strings)) ? test_ct_strings[ocmf->ct] : "");
+	ptr = stpcpy(ptr, "\",\"CI\":\"");
+	ptr = stpcpy(ptr, ocmf->ci);
+	stpcpy(ptr, "\",\"RD\":[]}");
+}
+
+static void test_random_string(char *str, const size_t size, uint32_t *random) {
+	// Printable ASCII without '"' and '\' (escaped since the cached dataset parts)
+	const size_t length = test_random(random) % size;
+	for(size_t i = 0; i < length; i++) {
+		char c;
+		do {
+			c = (char)(0x20 + (test_random(random) % 95));
+		} while((c == '"') || (c == '\\'));
+		str[i] = c;
+	}
+	str[length] = '\0';
+}
+
+static void test_random_configurations(void) {
+	uint32_t random = 0xE1C4DEC7;
+	static char expected[EICHRECHT_DATASET_IN_SIZE];
+	const uint32_t failures = test_failures;
+
+	for(uint16_t i = 0; i < 1000; i++) {
+		OCMF ocmf;
+		memset(&ocmf, 0, sizeof(ocmf));
+
+		test_random_string(ocmf.gi, sizeof(ocmf.gi), &random);
+		test_random_string(ocmf.gs, sizeof(ocmf.gs), &random);
+		test_random_string(ocmf.id, sizeof(ocmf.id), &random);
+		test_random_string(ocmf.ci, sizeof(ocmf.ci), &random);
+		ocmf.is = (test_random(&random) & 1) != 0;
+		ocmf.it = (uint8_t)(test_random(&random) % 20);
+		ocmf.ct = (uint8_t)(test_random(&random) % 3);
+		for(uint8_t j = 0; j < 4; j++) {
+			ocmf.if_[j] = (uint8_t)(test_random(&random) % 20);
+		}
+		bootloader_shim_firmware_configuration.firmware_version = test_random(&random) & 0xFFFFFF;
+
+		test_set(ocmf.gi, ocmf.gs, ocmf.is, ocmf.if_, ocmf.it, ocmf.id, ocmf.ct, ocmf.ci);
+		test_reference_builder(expected, &ocmf);
+		test_expect(expected);
+
+		if(test_failures != failures) {
+			printf("Random configuration %u failed\n", i);
+			break;
+		}
+	}
+
+	bootloader_shim_firmware_configuration.firmware_version = (2 << 16) | (6 << 8) | 11;
+}
+
+int main(void) {
+	eichrecht_init();
+
+	test_reference();
+	test_snapshot();
+	test_invalid();
+	test_worst_case();
+	test_random_configurations();
+
+	return TEST_RESULT();
+}
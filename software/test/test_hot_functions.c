@@ -0,0 +1,347 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * test_hot_functions.c: Host check and benchmark of hardware independent hot functions
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+// Host counterpart of the microbenchmark image (cmake -DMICROBENCHMARK=ON)
+// for the hot functions that don't touch the hardware. The results are
+// checked against reference implementations and the run time per call of
+// the firmware and the reference implementation are printed as JSON lines
+// (same keys as tests/microbenchmark.py, ns instead of cycles), to catch
+// algorithmic regressions without the target. Host timings say nothing
+// about the Cortex-M0 cycles.
+
+#include "test.h"
+
+#include <string.h>
+#include <time.h>
+
+#include "bricklib2/bootloader/bootloader.h"
+#include "bricklib2/hal/system_timer/system_timer.h"
+#include "bricklib2/utility/util_definitions.h"
+
+#include "iec61851.h"
+#include "led.h"
+#include "configs/config_led.h"
+#include "soft_timer.h"
+#include "eichrecht.h"
+#include "arena.h"
+
+TEST_DEFINE_FAILURES();
+
+HardwareVersion hardware_version = {.is_v4 = true};
+
+// Not in the headers
+void eichrecht_create_dataset(const EichrechtTransaction *t);
+
+#define TEST_ITERATIONS 1000000
+
+// Results are accumulated here, so the calls can't be removed by the compiler
+static volatile uint32_t test_sink;
+
+static uint64_t test_get_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec*1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void test_print(const char *benchmark, const uint32_t iterations, const uint64_t ns) {
+	printf("{\"benchmark\": \"%s\", \"host\": true, \"iterations\": %u, \"ns_mean\": %.2f}\n", benchmark, iterations, (double)ns/iterations);
+}
+
+// iec61851_get_duty_cycle_for_ma -----------------------------------------------
+
+// IEC 61851-1 Table A.8, in 1/1000 pro mille
+static int32_t test_duty_cycle_reference(const uint32_t ma) {
+	if(ma == 0) {
+		return 1000000;
+	}
+
+	const int64_t duty = (ma <= 51000) ? (ma*1000LL + 30)/60 : ma*4LL + 640000;
+	return (int32_t)MIN(1000000, MAX(80000, duty));
+}
+
+// Difference of the duty cycle to the reference in 1/1000 pro mille
+static int32_t test_duty_cycle_error(const uint32_t ma, const int32_t reference) {
+	return ABS((int32_t)(iec61851_get_duty_cycle_for_ma(ma)*1000) - reference);
+}
+
+static void test_duty_cycle(void) {
+	const uint32_t ma[]       = {0,       1000,  6000,   10000,  16000,  32000,  51000,  52000,  63000,  80000,  90000};
+	const int32_t expected[]  = {1000000, 80000, 100000, 166667, 266667, 533333, 850000, 848000, 892000, 960000, 1000000};
+
+	for(uint8_t i = 0; i < ARRAY_SIZE(ma); i++) {
+		CHECK(test_duty_cycle_error(ma[i], expected[i]) <= 1);
+	}
+
+	for(uint32_t ma_sweep = 0; ma_sweep <= 100000; ma_sweep += 10) {
+		if(test_duty_cycle_error(ma_sweep, test_duty_cycle_reference(ma_sweep)) > 1) {
+			printf("Duty cycle for %u mA differs from reference\n", ma_sweep);
+			test_failures++;
+			break;
+		}
+	}
+
+	// State F overrides the current
+	iec61851.force_state_f = true;
+	CHECK(iec61851_get_duty_cycle_for_ma(16000) == 0);
+	iec61851.force_state_f = false;
+
+	uint64_t start = test_get_ns();
+	for(uint32_t i = 0; i < TEST_ITERATIONS; i++) {
+		test_sink += (uint32_t)iec61851_get_duty_cycle_for_ma(6000 + (i & 0x3FFF)*4);
+	}
+	test_print("iec61851_get_duty_cycle_for_ma", TEST_ITERATIONS, test_get_ns() - start);
+}
+
+// led_hsv_to_rgb -----------------------------------------------------------------
+
+// led_hsv_to_rgb() before the precomputed channel scales
+static void test_hsv_to_rgb_reference(const uint16_t h, const uint8_t s, const uint8_t v, uint8_t *r, uint8_t *g, uint8_t *b) {
+	if(s == 0) {
+		*r = v;
+		*g = v;
+		*b = v;
+	} else {
+		const uint8_t i = (uint8_t)(h / 60);
+		const uint8_t p = (uint8_t)((256*v - s*v) / 256);
+
+		if(i & 1) {
+			const uint8_t q = (uint8_t)((256*60*v - h*s*v + 60*s*v*i) / (256*60));
+			switch(i) {
+				case 1: *r = q; *g = v; *b = p; break;
+				case 3: *r = p; *g = q; *b = v; break;
+				case 5: *r = v; *g = p; *b = q; break;
+			}
+		} else {
+			const uint8_t t = (uint8_t)((256*60*v + h*s*v - 60*s*v*(i+1)) / (256*60));
+			switch(i) {
+				case 0: *r = v; *g = t; *b = p; break;
+				case 2: *r = p; *g = v; *b = t; break;
+				case 4: *r = t; *g = p; *b = v; break;
+			}
+		}
+	}
+}
+
+static void test_hsv_to_rgb(void) {
+	uint8_t max_error = 0;
+
+	// All hues, saturations and values
+	for(uint16_t h = 0; h < 360; h++) {
+		for(uint16_t s = 0; s < 256; s++) {
+			for(uint16_t v = 0; v < 256; v++) {
+				uint8_t rgb[3];
+				uint8_t rgb_reference[3];
+				led_hsv_to_rgb(h, (uint8_t)s, (uint8_t)v, &rgb[0], &rgb[1], &rgb[2]);
+				test_hsv_to_rgb_reference(h, (uint8_t)s, (uint8_t)v, &rgb_reference[0], &rgb_reference[1], &rgb_reference[2]);
+				for(uint8_t i = 0; i < 3; i++) {
+					max_error = MAX(max_error, (uint8_t)ABS(rgb[i] - rgb_reference[i]));
+				}
+			}
+		}
+	}
+
+	// Fixed point scales instead of the exact division
+	printf("led_hsv_to_rgb: max difference to reference %u\n", max_error);
+	CHECK(max_error <= 2);
+
+	// Primary colors and white are exact
+	uint8_t r, g, b;
+	led_hsv_to_rgb(LED_HUE_RED, 255, 255, &r, &g, &b);
+	CHECK((r == 255) && (g == 0) && (b == 0));
+	led_hsv_to_rgb(LED_HUE_GREEN, 255, 255, &r, &g, &b);
+	CHECK((r == 0) && (g == 255) && (b == 0));
+	led_hsv_to_rgb(LED_HUE_BLUE, 255, 255, &r, &g, &b);
+	CHECK((r == 0) && (g == 0) && (b == 255));
+	led_hsv_to_rgb(LED_HUE_BLUE, 0, 255, &r, &g, &b);
+	CHECK((r == 255) && (g == 255) && (b == 255));
+
+	uint64_t start = test_get_ns();
+	for(uint32_t i = 0; i < TEST_ITERATIONS; i++) {
+		led_hsv_to_rgb((uint16_t)(i % 360), (uint8_t)i, (uint8_t)(i >> 8), &r, &g, &b);
+		test_sink += (uint32_t)(r + g + b);
+	}
+	test_print("led_hsv_to_rgb", TEST_ITERATIONS, test_get_ns() - start);
+
+	start = test_get_ns();
+	for(uint32_t i = 0; i < TEST_ITERATIONS; i++) {
+		test_hsv_to_rgb_reference((uint16_t)(i % 360), (uint8_t)i, (uint8_t)(i >> 8), &r, &g, &b);
+		test_sink += (uint32_t)(r + g + b);
+	}
+	test_print("led_hsv_to_rgb_reference", TEST_ITERATIONS, test_get_ns() - start);
+}
+
+// LED subsystem per second -------------------------------------------------------
+
+// Main loop iterations per ms in the simulated seconds. Before, the LED cost
+// grew with the loop rate (conversion and register writes in every
+// iteration), now only led_tick() runs per iteration.
+#define TEST_LED_LOOPS_PER_MS 10
+#define TEST_LED_SECONDS      10
+
+extern const uint16_t led_cie1931[256];
+
+static uint32_t test_breathing_time;
+static int16_t test_breathing_index;
+static bool test_breathing_up;
+
+// led_update() before the 100Hz rendering (v3/v4): Conversion and all compare values in every call
+static void test_led_update_reference(const uint16_t h, const uint8_t s, const uint8_t v) {
+	uint8_t r, g, b;
+	test_hsv_to_rgb_reference(h, s, v, &r, &g, &b);
+
+	XMC_CCU8_SLICE_SetTimerCompareMatch(EVSE_V3_LED_R_SLICE, XMC_CCU8_SLICE_COMPARE_CHANNEL_1, led_cie1931[r]);
+	XMC_CCU8_SLICE_SetTimerCompareMatch(EVSE_V3_LED_G_SLICE, XMC_CCU8_SLICE_COMPARE_CHANNEL_1, led_cie1931[g]);
+	XMC_CCU8_SLICE_SetTimerCompareMatch(EVSE_V3_LED_B_SLICE, XMC_CCU8_SLICE_COMPARE_CHANNEL_1, led_cie1931[b]);
+	XMC_CCU8_EnableShadowTransfer(EVSE_V3_LED_R_CCU, EVSE_V3_LED_R_SHADOW);
+	XMC_CCU8_EnableShadowTransfer(EVSE_V3_LED_G_CCU, EVSE_V3_LED_G_SHADOW);
+	XMC_CCU8_EnableShadowTransfer(EVSE_V3_LED_B_CCU, EVSE_V3_LED_B_SHADOW);
+}
+
+// Start of led_tick(), unchanged
+static void test_led_tick_prelude_reference(void) {
+	if(system_timer_is_time_elapsed_ms(led.enumerate_initial_time, 10*1000)) {
+		led.enumerate_initial_time = 0;
+	}
+
+	if((led.state != LED_STATE_API) || (led.api_indication <= 2000) || (led.api_indication >= 2011)) {
+		led.blink_external  = -1;
+	}
+}
+
+// led_tick() before in state on (without standby)
+static void test_led_tick_on_reference(void) {
+	test_led_tick_prelude_reference();
+	if(system_timer_is_time_elapsed_ms(0, LED_STANDBY_TIME)) {
+		test_led_update_reference(0, 0, 0);
+	} else {
+		test_led_update_reference(LED_HUE_STANDARD, 255, 255);
+	}
+}
+
+// led_tick() before in state breathing
+static void test_led_tick_breathing_reference(void) {
+	test_led_tick_prelude_reference();
+	if(!system_timer_is_time_elapsed_ms(test_breathing_time, 5)) {
+		return;
+	}
+	test_breathing_time = system_timer_get_ms();
+
+	if(test_breathing_up) {
+		test_breathing_index += 1;
+	} else {
+		test_breathing_index -= 1;
+	}
+	test_breathing_index = BETWEEN(0, test_breathing_index, 255);
+
+	if(test_breathing_index == 0) {
+		test_breathing_up = true;
+	} else if(test_breathing_index == 255) {
+		test_breathing_up = false;
+	}
+
+	test_led_update_reference(LED_HUE_STANDARD, 255, (uint8_t)test_breathing_index);
+}
+
+static void test_led_tick_none(void) {
+}
+
+static uint64_t test_led_run_seconds(void (*tick)(void)) {
+	const uint64_t start = test_get_ns();
+	for(uint32_t ms = 0; ms < TEST_LED_SECONDS*1000; ms++) {
+		for(uint32_t i = 0; i < TEST_LED_LOOPS_PER_MS; i++) {
+			tick();
+		}
+		system_timer_shim_ms++;
+
+		// Renders the new LED, the main loop calls soft_timer_tick() anyway
+		soft_timer_tick();
+	}
+
+	return test_get_ns() - start;
+}
+
+// Runs TEST_LED_SECONDS simulated seconds and prints the cost per second,
+// without the cost of the simulation loop itself
+static void test_led_seconds(const char *benchmark, void (*tick)(void), uint32_t *compare_writes) {
+	const uint64_t overhead = test_led_run_seconds(test_led_tick_none);
+
+	xmc_shim_ccu_compare_writes   = 0;
+	xmc_shim_ccu_shadow_transfers = 0;
+	const uint64_t ns = test_led_run_seconds(tick);
+
+	*compare_writes = xmc_shim_ccu_compare_writes/TEST_LED_SECONDS;
+	printf("{\"benchmark\": \"%s\", \"host\": true, \"loops_per_second\": %u, \"ns_per_second\": %.0f, \"compare_writes_per_second\": %u, \"shadow_transfers_per_second\": %u}\n",
+	       benchmark, TEST_LED_LOOPS_PER_MS*1000, (double)(ns > overhead ? ns - overhead : 0)/TEST_LED_SECONDS, *compare_writes, xmc_shim_ccu_shadow_transfers/TEST_LED_SECONDS);
+}
+
+static void test_led_per_second(void) {
+	uint32_t compare_writes;
+
+	led_init();
+	led_set_on(true);
+	test_led_seconds("led_on_per_second", led_tick, &compare_writes);
+	CHECK_EQUAL(compare_writes, 0); // Constant color, nothing to write
+
+	led_set_breathing();
+	test_led_seconds("led_breathing_per_second", led_tick, &compare_writes);
+	CHECK(compare_writes <= 3*1000/LED_RENDER_PERIOD);
+
+	// The old implementation wrote the registers directly
+	soft_timer_stop(&led.render_timer);
+	test_led_seconds("led_on_per_second_reference", test_led_tick_on_reference, &compare_writes);
+	CHECK_EQUAL(compare_writes, 3*TEST_LED_LOOPS_PER_MS*1000);
+	test_led_seconds("led_breathing_per_second_reference", test_led_tick_breathing_reference, &compare_writes);
+	CHECK_EQUAL(compare_writes, 3*1000/5);
+}
+
+// eichrecht_create_dataset -------------------------------------------------------
+
+static void test_create_dataset(void) {
+	const uint8_t if_[4] = {1, 7, 255, 255};
+	uint16_t sequence    = 0;
+
+	eichrecht_init();
+	CHECK(eichrecht_set_gateway_identification("Gateway 1", 9));
+	CHECK(eichrecht_set_gateway_serial("123456789", 9));
+	CHECK(eichrecht_set_user_assignment(true, if_, 3, "1F2D3A4F5506C7", 14));
+	CHECK(eichrecht_set_charge_point(0, "DE*TNF*E1234", 12));
+	CHECK(eichrecht_queue_transaction('B', 1700000000, 60, 0, &sequence));
+
+	const uint32_t iterations = TEST_ITERATIONS/10;
+	const uint64_t start = test_get_ns();
+	for(uint32_t i = 0; i < iterations; i++) {
+		eichrecht_create_dataset(&eichrecht.queue[0]);
+		test_sink += eichrecht.dataset_in_length;
+	}
+	test_print("eichrecht_create_dataset", iterations, test_get_ns() - start);
+
+	// Content is checked by test_eichrecht
+	CHECK_EQUAL(eichrecht.dataset_in_length, strlen(arena.eichrecht.dataset_in));
+}
+
+int main(void) {
+	test_duty_cycle();
+	test_hsv_to_rgb();
+	test_led_per_second();
+	test_create_dataset();
+
+	return TEST_RESULT();
+}
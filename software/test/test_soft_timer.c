@@ -0,0 +1,620 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * test_soft_timer.c: Host test of the software timer service and the sequences that use it
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+// Runs the soft_timer queue against a brute force reference for randomized
+// start/stop sequences, replays the EV wakeup of iec61851.c side by side
+// with the previous system_timer_is_time_elapsed_ms() polling and checks
+// the phase switch timing of phase_control.c. Everything runs on the
+// virtual clock of the system timer shim, including the 32-bit wrap-around.
+
+#include "test.h"
+
+#include <string.h>
+
+#include "bricklib2/hal/system_timer/system_timer.h"
+#include "bricklib2/utility/util_definitions.h"
+#include "xmc_gpio.h"
+
+#include "soft_timer.h"
+#include "iec61851.h"
+#include "phase_control.h"
+#include "evse.h"
+#include "adc.h"
+#include "charging_slot.h"
+#include "communication.h"
+#include "hardware_version.h"
+
+TEST_DEFINE_FAILURES();
+
+// Not in the headers
+void phase_control_done(void);
+void iec61851_handle_ev_wakeup(uint32_t ma);
+
+#define TEST_SEQUENCES 300
+
+// Environment of iec61851.c and phase_control.c. The EV wakeup is run by two
+// implementations (0 = firmware, 1 = reference) with separate CP state.
+EVSE evse;
+ADCResult adc_result;
+HardwareVersion hardware_version = {.is_v3 = true};
+
+static uint8_t test_impl = 0;
+static bool test_cp_connected[2];
+static uint32_t test_cp_changes[2];
+static uint16_t test_duty_cycle;
+static bool test_contactor;
+static uint16_t test_max_ma;
+
+bool evse_is_cp_connected(void) {
+	return test_cp_connected[test_impl];
+}
+
+void evse_cp_connect(void) {
+	if(!test_cp_connected[test_impl]) {
+		test_cp_connected[test_impl] = true;
+		test_cp_changes[test_impl]++;
+	}
+}
+
+void evse_cp_disconnect(void) {
+	if(test_cp_connected[test_impl]) {
+		test_cp_connected[test_impl] = false;
+		test_cp_changes[test_impl]++;
+	}
+}
+
+uint16_t evse_get_cp_duty_cycle(void) {
+	return test_duty_cycle;
+}
+
+// The contactor is switched immediately, the pin is active low
+void evse_set_output(const float cp_duty_cycle, const bool contactor) {
+	test_duty_cycle = (uint16_t)cp_duty_cycle;
+	test_contactor  = contactor;
+	if(contactor) {
+		XMC_GPIO_PORT1->IN &= ~(1UL << 6);
+	} else {
+		XMC_GPIO_PORT1->IN |= 1UL << 6;
+	}
+}
+
+bool evse_is_contactor_active(void) {
+	return test_contactor;
+}
+
+uint16_t charging_slot_get_max_current(void) {
+	return test_max_ma;
+}
+
+// The contactor pin of V3/V4 is P1_6
+XMC_GPIO_PORT_t *hardware_version_get_port(const uint8_t pin_num) {
+	return XMC_GPIO_PORT1;
+}
+
+uint8_t hardware_version_get_pin(const uint8_t pin_num) {
+	return 6;
+}
+
+static void test_advance(const uint32_t ms) {
+	system_timer_shim_ms += ms;
+}
+
+// Queue against brute force reference ----------------------------------------
+
+#define TEST_TIMER_NUM 8
+
+typedef struct {
+	bool running;
+	bool queued;
+	bool expired;
+	bool periodic;
+	uint32_t deadline;
+	uint32_t period;
+	uint32_t order; // Start order for timers with the same deadline
+} TestReferenceTimer;
+
+static SoftTimer test_timer[TEST_TIMER_NUM];
+static TestReferenceTimer test_reference[TEST_TIMER_NUM];
+static uint32_t test_order;
+
+static uint8_t test_log_timer[256];
+static uint8_t test_log_reference[256];
+static uint16_t test_log_timer_count;
+static uint16_t test_log_reference_count;
+
+static void test_timer_callback(SoftTimer *timer) {
+	if(test_log_timer_count < sizeof(test_log_timer)) {
+		test_log_timer[test_log_timer_count++] = (uint8_t)(timer - test_timer);
+	}
+}
+
+static bool test_is_before(const uint32_t a, const uint32_t b) {
+	return ((int32_t)(a - b)) < 0;
+}
+
+static void test_reference_start(const uint8_t i, const uint32_t timeout, const bool periodic) {
+	TestReferenceTimer *r = &test_reference[i];
+	r->running  = true;
+	r->queued   = true;
+	r->expired  = false;
+	r->periodic = periodic;
+	r->period   = (periodic && (timeout == 0)) ? 1 : timeout;
+	r->deadline = system_timer_get_ms() + r->period;
+	r->order    = test_order++;
+}
+
+static void test_reference_tick(void) {
+	const uint32_t now = system_timer_get_ms();
+	while(true) {
+		int8_t next = -1;
+		for(uint8_t i = 0; i < TEST_TIMER_NUM; i++) {
+			const TestReferenceTimer *r = &test_reference[i];
+			if(!r->queued || test_is_before(now, r->deadline)) {
+				continue;
+			}
+			if((next < 0) ||
+			   test_is_before(r->deadline, test_reference[next].deadline) ||
+			   ((r->deadline == test_reference[next].deadline) && (r->order < test_reference[next].order))) {
+				next = (int8_t)i;
+			}
+		}
+
+		if(next < 0) {
+			return;
+		}
+
+		TestReferenceTimer *r = &test_reference[next];
+		r->expired = true;
+		if(r->periodic) {
+			r->deadline += r->period;
+			r->order     = test_order++;
+		} else {
+			r->queued = false;
+		}
+
+		if(test_log_reference_count < sizeof(test_log_reference)) {
+			test_log_reference[test_log_reference_count++] = (uint8_t)next;
+		}
+	}
+}
+
+static void test_queue(void) {
+	uint32_t random = 0x2342B00B;
+
+	for(uint16_t sequence = 0; sequence < TEST_SEQUENCES; sequence++) {
+		// Half of the sequences run across the 32-bit wrap-around
+		system_timer_shim_ms = (sequence & 1) ? (0xFFFFFFFF - (test_random(&random) % 100000)) : test_random(&random);
+
+		for(uint8_t i = 0; i < TEST_TIMER_NUM; i++) {
+			soft_timer_stop(&test_timer[i]);
+			test_timer[i].callback = test_timer_callback;
+		}
+		memset(test_reference, 0, sizeof(test_reference));
+
+		for(uint16_t step = 0; step < 2000; step++) {
+			const uint8_t i = (uint8_t)(test_random(&random) % TEST_TIMER_NUM);
+			switch(test_random(&random) % 8) {
+				case 0: {
+					const uint32_t timeout = test_random(&random) % 200;
+					soft_timer_start(&test_timer[i], timeout);
+					test_reference_start(i, timeout, false);
+					break;
+				}
+
+				case 1: {
+					const uint32_t period = test_random(&random) % 50;
+					soft_timer_start_periodic(&test_timer[i], period);
+					test_reference_start(i, period, true);
+					break;
+				}
+
+				case 2: {
+					soft_timer_stop(&test_timer[i]);
+					test_reference[i].running = false;
+					test_reference[i].queued  = false;
+					test_reference[i].expired = false;
+					break;
+				}
+
+				default: {
+					// Main loop iterations are 0 to 30ms apart
+					test_advance(test_random(&random) % 31);
+					break;
+				}
+			}
+
+			test_log_timer_count     = 0;
+			test_log_reference_count = 0;
+			soft_timer_tick();
+			test_reference_tick();
+
+			CHECK_EQUAL(test_log_timer_count, test_log_reference_count);
+			CHECK(memcmp(test_log_timer, test_log_reference, test_log_timer_count) == 0);
+
+			bool next_expected = false;
+			uint32_t remaining_expected = UINT32_MAX;
+			for(uint8_t j = 0; j < TEST_TIMER_NUM; j++) {
+				CHECK_EQUAL(soft_timer_is_running(&test_timer[j]), test_reference[j].running);
+				CHECK_EQUAL(soft_timer_is_expired(&test_timer[j]), test_reference[j].expired);
+				if(test_reference[j].queued) {
+					const uint32_t remaining = test_is_before(system_timer_get_ms(), test_reference[j].deadline) ? test_reference[j].deadline - system_timer_get_ms() : 0;
+					remaining_expected = MIN(remaining_expected, remaining);
+					next_expected      = true;
+				}
+			}
+
+			uint32_t remaining = 0;
+			CHECK_EQUAL(soft_timer_get_next_deadline(&remaining), next_expected);
+			if(next_expected) {
+				CHECK_EQUAL(remaining, remaining_expected);
+			}
+
+			if(test_failures > 0) {
+				printf("Queue sequence %u step %u failed\n", sequence, step);
+				return;
+			}
+		}
+	}
+
+	for(uint8_t i = 0; i < TEST_TIMER_NUM; i++) {
+		soft_timer_stop(&test_timer[i]);
+	}
+}
+
+// EV wakeup side by side with the previous polling implementation ------------
+
+typedef struct {
+	uint32_t state_b1b2_transition_time;
+	bool state_b1b2_transition_seen;
+	bool first_b1b2_transition;
+	bool currently_beeing_woken_up;
+	bool force_state_f;
+	bool instant_phase_switch_allowed;
+} TestWakeupReference;
+
+static TestWakeupReference test_wakeup;
+
+// iec61851_reset_ev_wakeup() before the migration to soft_timer
+static void test_wakeup_reference_reset(void) {
+	test_wakeup.state_b1b2_transition_time = 0;
+	test_wakeup.state_b1b2_transition_seen = false;
+	test_wakeup.currently_beeing_woken_up = false;
+	test_wakeup.force_state_f = false;
+
+	if(evse_is_cp_connected()) {
+		return;
+	}
+
+	if((phase_control.progress_state > 0)  && (phase_control.progress_state < 6)) {
+		return;
+	}
+
+	if(evse.control_pilot_disconnect) {
+		return;
+	}
+
+	evse_cp_connect();
+}
+
+// iec61851_handle_ev_wakeup() before the migration to soft_timer
+static void test_wakeup_reference_handle(uint32_t ma) {
+	if(test_wakeup.state_b1b2_transition_seen) {
+		if(test_wakeup.first_b1b2_transition && (iec61851.charging_protocol == EVSE_V2_CHARGING_PROTOCOL_IEC61851_TEMPORARY)) {
+			test_wakeup.state_b1b2_transition_time = system_timer_get_ms() - 80*1000;
+		} else {
+			test_wakeup.state_b1b2_transition_time = system_timer_get_ms();
+		}
+		test_wakeup.first_b1b2_transition = false;
+		test_wakeup.state_b1b2_transition_seen = false;
+	}
+
+	if(ma == 0) {
+		test_wakeup_reference_reset();
+	}
+
+	if((test_wakeup.state_b1b2_transition_time != 0) && (!evse.control_pilot_disconnect)) {
+		const bool use_state_f = (iec61851.force_state_f_time != 0) && system_timer_is_time_elapsed_ms(iec61851.force_state_f_time, 1000*60*60);
+
+		if(!use_state_f) {
+			test_wakeup.force_state_f = false;
+		}
+
+		if(use_state_f && system_timer_is_time_elapsed_ms(test_wakeup.state_b1b2_transition_time, 90*1000 + 4*1000 + 30*1000 + 30*1000 + 30*1000 + 4*1000 + 30*1000 + 30*1000)) {
+			if(test_wakeup.force_state_f) {
+				test_wakeup.currently_beeing_woken_up = false;
+				test_wakeup.force_state_f = false;
+			} else {
+				test_wakeup.state_b1b2_transition_time = 0;
+			}
+		} else if(use_state_f && system_timer_is_time_elapsed_ms(test_wakeup.state_b1b2_transition_time, 90*1000 + 4*1000 + 30*1000 + 30*1000 + 30*1000 + 4*1000 + 30*1000)) {
+			if(evse.ev_wakeup_enabled) {
+				if(!test_wakeup.force_state_f) {
+					test_wakeup.currently_beeing_woken_up = true;
+					test_wakeup.force_state_f = true;
+				}
+			}
+		} else if(use_state_f && system_timer_is_time_elapsed_ms(test_wakeup.state_b1b2_transition_time, 90*1000 + 4*1000 + 30*1000 + 30*1000 + 30*1000 + 4*1000)) {
+			if(test_wakeup.force_state_f) {
+				test_wakeup.currently_beeing_woken_up = false;
+				test_wakeup.force_state_f = false;
+			}
+		} else if(use_state_f && system_timer_is_time_elapsed_ms(test_wakeup.state_b1b2_transition_time, 90*1000 + 4*1000 + 30*1000 + 30*1000 + 30*1000)) {
+			if(evse.ev_wakeup_enabled) {
+				if(!test_wakeup.force_state_f) {
+					test_wakeup.currently_beeing_woken_up = true;
+					test_wakeup.force_state_f = true;
+				}
+			}
+		} else if(system_timer_is_time_elapsed_ms(test_wakeup.state_b1b2_transition_time, 90*1000 + 4*1000 + 30*1000 + 30*1000)) {
+			if(!evse_is_cp_connected()) {
+				test_wakeup.currently_beeing_woken_up = false;
+				evse_cp_connect();
+				if(!use_state_f) {
+					test_wakeup.state_b1b2_transition_time = 0;
+				}
+			}
+		} else if(system_timer_is_time_elapsed_ms(test_wakeup.state_b1b2_transition_time, 90*1000 + 4*1000 + 30*1000)) {
+			if(evse.ev_wakeup_enabled) {
+				test_wakeup.currently_beeing_woken_up = true;
+				evse_cp_disconnect();
+			}
+		} else if(system_timer_is_time_elapsed_ms(test_wakeup.state_b1b2_transition_time, 90*1000 + 4*1000)) {
+			if(!evse_is_cp_connected()) {
+				test_wakeup.currently_beeing_woken_up = false;
+				evse_cp_connect();
+				test_wakeup.instant_phase_switch_allowed = true;
+			}
+		} else if(system_timer_is_time_elapsed_ms(test_wakeup.state_b1b2_transition_time, 90*1000)) {
+			if(evse.ev_wakeup_enabled) {
+				test_wakeup.currently_beeing_woken_up = true;
+				evse_cp_disconnect();
+			}
+		}
+	} else {
+		test_wakeup.force_state_f = false;
+	}
+}
+
+static void test_wakeup_compare(const uint16_t sequence, const uint32_t step) {
+	CHECK_EQUAL(test_cp_connected[0], test_cp_connected[1]);
+	CHECK_EQUAL(test_cp_changes[0], test_cp_changes[1]);
+	CHECK_EQUAL(iec61851.currently_beeing_woken_up, test_wakeup.currently_beeing_woken_up);
+	CHECK_EQUAL(iec61851.force_state_f, test_wakeup.force_state_f);
+	CHECK_EQUAL(iec61851.instant_phase_switch_allowed, test_wakeup.instant_phase_switch_allowed);
+	CHECK_EQUAL(iec61851.first_b1b2_transition, test_wakeup.first_b1b2_transition);
+	CHECK_EQUAL(soft_timer_is_running(&iec61851.ev_wakeup_timer), test_wakeup.state_b1b2_transition_time != 0);
+
+	if(test_failures > 0) {
+		printf("EV wakeup sequence %u step %u (%u ms) failed\n", sequence, step, system_timer_get_ms());
+	}
+}
+
+static void test_ev_wakeup(void) {
+	uint32_t random = 0x0815CAFE;
+	uint32_t cp_changes = 0;
+
+	// The timer callback is set in iec61851_init()
+	const SoftTimerCallback callback = iec61851.ev_wakeup_timer.callback;
+
+	for(uint16_t sequence = 0; sequence < TEST_SEQUENCES; sequence++) {
+		system_timer_shim_ms = (sequence & 1) ? (0xFFFFFFFF - (test_random(&random) % 300000)) : (test_random(&random) | 1);
+
+		soft_timer_stop(&iec61851.ev_wakeup_timer);
+		memset(&iec61851, 0, sizeof(iec61851));
+		memset(&test_wakeup, 0, sizeof(test_wakeup));
+		iec61851.ev_wakeup_timer.callback = callback;
+
+		const bool first = (test_random(&random) & 1) != 0;
+		iec61851.first_b1b2_transition    = first;
+		test_wakeup.first_b1b2_transition = first;
+		iec61851.charging_protocol        = (uint8_t)(test_random(&random) % 3);
+
+		// State F is only used if the last state C is more than one hour ago
+		switch(test_random(&random) % 3) {
+			case 0:  iec61851.force_state_f_time = 0;                                 break;
+			case 1:  iec61851.force_state_f_time = system_timer_get_ms() - 2*60*60*1000; break;
+			default: iec61851.force_state_f_time = system_timer_get_ms() - 50*60*1000;   break;
+		}
+
+		evse.ev_wakeup_enabled        = (test_random(&random) % 4) != 0;
+		evse.control_pilot_disconnect = false;
+		phase_control.progress_state  = 0;
+		test_cp_connected[0]          = true;
+		test_cp_connected[1]          = true;
+		test_cp_changes[0]            = 0;
+		test_cp_changes[1]            = 0;
+
+		uint32_t ma = 16000;
+		bool transition = true;
+
+		// About 7 minutes, enough for all wakeup stages including state F
+		for(uint32_t step = 0; step < 30000; step++) {
+			const uint32_t event = test_random(&random) % 30000;
+			if(event < 1) {
+				transition = true;
+			} else if(event < 2) {
+				ma = (ma == 0) ? 16000 : 0;
+			} else if(event < 3) {
+				evse.control_pilot_disconnect = !evse.control_pilot_disconnect;
+			}
+
+			if(transition) {
+				iec61851.state_b1b2_transition_seen    = true;
+				test_wakeup.state_b1b2_transition_seen = true;
+				transition = false;
+			}
+
+			soft_timer_tick();
+
+			test_impl = 0;
+			iec61851_handle_ev_wakeup(ma);
+			test_impl = 1;
+			test_wakeup_reference_handle(ma);
+			test_impl = 0;
+
+			test_wakeup_compare(sequence, step);
+			if(test_failures > 0) {
+				return;
+			}
+
+			test_advance(1 + (test_random(&random) % 25));
+		}
+
+		cp_changes += test_cp_changes[0];
+	}
+
+	// Make sure that the sequences actually woke up EVs
+	printf("EV wakeup: %u sequences, %u CP changes identical\n", TEST_SEQUENCES, cp_changes);
+	CHECK(cp_changes > TEST_SEQUENCES);
+}
+
+// EV wakeup edges relative to the B1->B2 transition --------------------------
+
+static void test_ev_wakeup_edges(void) {
+	const uint32_t expected[] = {90*1000, 94*1000, 124*1000, 154*1000};
+	uint32_t edges[4];
+	uint8_t edge_count = 0;
+
+	const SoftTimerCallback callback = iec61851.ev_wakeup_timer.callback;
+	soft_timer_stop(&iec61851.ev_wakeup_timer);
+	memset(&iec61851, 0, sizeof(iec61851));
+	iec61851.ev_wakeup_timer.callback = callback;
+
+	system_timer_shim_ms = 0xFFFFFFFF - 100*1000; // Wrap-around between the edges
+	evse.ev_wakeup_enabled        = true;
+	evse.control_pilot_disconnect = false;
+	test_cp_connected[0]          = true;
+	iec61851.state_b1b2_transition_seen = true;
+
+	const uint32_t start = system_timer_get_ms();
+	bool connected = true;
+	for(uint32_t ms = 0; ms < 200*1000; ms++) {
+		soft_timer_tick();
+		iec61851_handle_ev_wakeup(16000);
+		if((test_cp_connected[0] != connected) && (edge_count < 4)) {
+			connected = test_cp_connected[0];
+			edges[edge_count++] = system_timer_get_ms() - start;
+		}
+		test_advance(1);
+	}
+
+	CHECK_EQUAL(edge_count, 4);
+	for(uint8_t i = 0; i < edge_count; i++) {
+		CHECK_EQUAL(edges[i], expected[i]);
+	}
+	CHECK(!soft_timer_is_running(&iec61851.ev_wakeup_timer));
+}
+
+// Phase switch ---------------------------------------------------------------
+
+static uint32_t test_phase_switch_state_time[8];
+
+static void test_phase_switch_run(const uint32_t ms, void (*during)(const uint32_t ms)) {
+	uint8_t last_state = phase_control.progress_state;
+	const uint32_t start = system_timer_get_ms();
+
+	for(uint32_t i = 0; i < ms; i++) {
+		if(during != NULL) {
+			during(i);
+		}
+
+		soft_timer_tick();
+		if(phase_control.in_progress) {
+			phase_control_state_phase_change();
+		}
+
+		if(phase_control.progress_state != last_state) {
+			last_state = phase_control.progress_state;
+			test_phase_switch_state_time[last_state] = system_timer_get_ms() - start;
+		}
+		test_advance(1);
+	}
+}
+
+static void test_phase_switch_start(const uint8_t wait_time, const bool under_load) {
+	memset(test_phase_switch_state_time, 0xFF, sizeof(test_phase_switch_state_time));
+
+	phase_control_done();
+	phase_control.current                = 3;
+	phase_control.requested              = 1;
+	phase_control.in_progress            = true;
+	phase_control.phase_switch_wait_time = wait_time;
+	evse.contactor_maybe_switched_under_load = under_load;
+	iec61851.state       = IEC61851_STATE_B;
+	test_impl            = 0;
+	test_cp_connected[0] = true;
+	test_max_ma          = 16000;
+	evse_set_output(1000, false);
+}
+
+// The phases are switched 500ms after the CP disconnect
+static void test_phase_switch_during(const uint32_t ms) {
+	if(ms == 600) {
+		phase_control.current = phase_control.requested;
+	}
+}
+
+// The wait time is changed to 15s after the phase switch waited for 19.4s of 30s
+static void test_phase_switch_during_change(const uint32_t ms) {
+	test_phase_switch_during(ms);
+	if(ms == 20*1000) {
+		phase_control.phase_switch_wait_time = 0 + 1; // 10s + 1*5s
+	}
+}
+
+static void test_phase_switch(void) {
+	system_timer_shim_ms = 0xFFFFFFFF - 1000;
+
+	// Default wait time (60s)
+	test_phase_switch_start(EVSE_V2_PHASE_SWITCH_WAIT_TIME_DEFAULT, false);
+	test_phase_switch_run(70*1000, test_phase_switch_during);
+	CHECK_EQUAL(test_phase_switch_state_time[4], 100);
+	CHECK_EQUAL(test_phase_switch_state_time[5], 600);
+	CHECK_EQUAL(test_phase_switch_state_time[6], 600 + 60*1000);
+	CHECK_EQUAL(test_phase_switch_state_time[0], 600 + 60*1000 + 100);
+	CHECK(test_cp_connected[0]);
+	CHECK(!phase_control.in_progress);
+	CHECK_EQUAL(test_duty_cycle, (uint16_t)iec61851_get_duty_cycle_for_ma(16000));
+
+	// 30s wait time (10s + 4*5s), changed to 15s after 20s of waiting: reconnect is relative to the start of the wait
+	test_phase_switch_start(4, false);
+	test_phase_switch_run(40*1000, test_phase_switch_during_change);
+	CHECK_EQUAL(test_phase_switch_state_time[5], 600);
+	CHECK_EQUAL(test_phase_switch_state_time[6], 20*1000 + 1);
+	CHECK(!phase_control.in_progress);
+
+	// Contactor maybe switched under load: at least 60s even with 10s configured
+	test_phase_switch_start(0 + 1, true);
+	test_phase_switch_run(70*1000, test_phase_switch_during);
+	CHECK_EQUAL(test_phase_switch_state_time[6], 600 + 60*1000);
+	CHECK(!phase_control.in_progress);
+}
+
+int main(void) {
+	iec61851_init();
+
+	test_queue();
+	test_ev_wakeup();
+	test_ev_wakeup_edges();
+	test_phase_switch();
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,212 @@
+/* evse-v2-bricklet
+ * Copyright (C) 2026 Olaf Lüke <olaf@tinkerforge.com>
+ *
+ * test_spsc_queue.c: Host stress test of the single producer single consumer queue
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+// The producer (IRQ on the XMC) and the consumer (main loop) run in two
+// threads on different cores. Other than the Cortex-M0, the host reorders
+// memory accesses, so the barrier is replaced by a full hardware fence.
+
+#include "test.h"
+
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define SPSC_QUEUE_BARRIER() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#include "spsc_queue.h"
+
+TEST_DEFINE_FAILURES();
+
+#define TEST_QUEUE_SIZE 16
+#define TEST_ELEMENTS   (5*1000*1000) // Head and tail wrap around many times
+
+typedef struct {
+	SPSCQueue queue;
+	uint32_t buffer[TEST_QUEUE_SIZE];
+	bool retry;           // Producer retries if the queue is full, otherwise the element is dropped
+	uint32_t pushed;      // Accepted by spsc_queue_push()
+	uint32_t received;
+	uint32_t errors;      // Elements received out of order or modified
+	volatile bool done;
+} TestStress;
+
+static TestStress test_stress;
+
+static void *test_producer(void *argument) {
+	TestStress *stress = argument;
+	uint32_t random    = 0x5EED1234;
+
+	// The elements are the sequence numbers, starting at 1
+	for(uint32_t sequence = 1; sequence <= TEST_ELEMENTS; sequence++) {
+		// Bursts of random length, so that the consumer also runs if both threads share a core
+		if((test_random(&random) % 32) == 0) {
+			sched_yield();
+		}
+
+		while(true) {
+			if(spsc_queue_push(&stress->queue, sequence)) {
+				stress->pushed++;
+				break;
+			}
+
+			if(!stress->retry) {
+				break;
+			}
+
+			sched_yield();
+		}
+	}
+
+	stress->done = true;
+	return NULL;
+}
+
+// A stale or reordered slot shows up as a sequence number that is not
+// larger than the last one
+static void test_receive(TestStress *stress, const uint32_t sequence, uint32_t *last) {
+	if(stress->retry ? (sequence != *last + 1) : (sequence <= *last)) {
+		stress->errors++;
+	}
+	*last = sequence;
+	stress->received++;
+}
+
+static void *test_consumer(void *argument) {
+	TestStress *stress = argument;
+	uint32_t last      = 0;
+	uint32_t random    = 0xC0FFEE11;
+	uint32_t values[TEST_QUEUE_SIZE];
+
+	while(true) {
+		const bool done = stress->done;
+		uint32_t value  = 0;
+
+		// Mix of the three consumer functions
+		switch(test_random(&random) % 3) {
+			case 0: {
+				if(spsc_queue_pop(&stress->queue, &value)) {
+					test_receive(stress, value, &last);
+				}
+				break;
+			}
+
+			case 1: {
+				uint32_t peeked = 0;
+				if(spsc_queue_peek(&stress->queue, &peeked)) {
+					if(!spsc_queue_pop(&stress->queue, &value) || (peeked != value)) {
+						stress->errors++;
+					}
+					test_receive(stress, value, &last);
+				}
+				break;
+			}
+
+			default: {
+				const uint16_t count = spsc_queue_drain(&stress->queue, values, (uint16_t)(1 + (test_random(&random) % TEST_QUEUE_SIZE)));
+				for(uint16_t i = 0; i < count; i++) {
+					test_receive(stress, values[i], &last);
+				}
+				break;
+			}
+		}
+
+		if(spsc_queue_is_empty(&stress->queue)) {
+			// Producer finished before this iteration and the queue is empty
+			if(done) {
+				break;
+			}
+
+			sched_yield();
+		}
+	}
+
+	return NULL;
+}
+
+static void test_threads(const bool retry) {
+	pthread_t producer;
+	pthread_t consumer;
+
+	memset(&test_stress, 0, sizeof(test_stress));
+	spsc_queue_init(&test_stress.queue, test_stress.buffer, TEST_QUEUE_SIZE);
+	test_stress.retry = retry;
+
+	CHECK(pthread_create(&consumer, NULL, test_consumer, &test_stress) == 0);
+	CHECK(pthread_create(&producer, NULL, test_producer, &test_stress) == 0);
+	pthread_join(producer, NULL);
+	pthread_join(consumer, NULL);
+
+	printf("%s: %u pushed, %u received, %u overflows, max used %u\n", retry ? "Retry" : "Drop",
+	       test_stress.pushed, test_stress.received, test_stress.queue.overflows, test_stress.queue.max_used);
+
+	CHECK_EQUAL(test_stress.errors, 0);
+	CHECK_EQUAL(test_stress.received, test_stress.pushed);
+	CHECK(test_stress.queue.max_used <= TEST_QUEUE_SIZE);
+	CHECK(spsc_queue_is_empty(&test_stress.queue));
+	if(retry) {
+		// Every failed attempt counts as overflow
+		CHECK_EQUAL(test_stress.pushed, TEST_ELEMENTS);
+	} else {
+		CHECK_EQUAL(test_stress.pushed + test_stress.queue.overflows, TEST_ELEMENTS);
+	}
+}
+
+// Fill level, overflow counter and high-water mark across the 16-bit wrap-around
+static void test_single(void) {
+	SPSCQueue queue;
+	uint32_t buffer[4];
+	uint32_t value = 0;
+
+	spsc_queue_init(&queue, buffer, 4);
+	queue.head = 0xFFFE;
+	queue.tail = 0xFFFE;
+
+	for(uint32_t i = 0; i < 4; i++) {
+		CHECK(spsc_queue_push(&queue, i));
+	}
+	CHECK(!spsc_queue_push(&queue, 4));
+	CHECK_EQUAL(queue.overflows, 1);
+	CHECK_EQUAL(queue.max_used, 4);
+	CHECK_EQUAL(spsc_queue_get_used(&queue), 4);
+
+	CHECK(spsc_queue_pop(&queue, &value));
+	CHECK_EQUAL(value, 0);
+	CHECK(spsc_queue_push(&queue, 5));
+
+	uint32_t values[8];
+	CHECK_EQUAL(spsc_queue_drain(&queue, values, 2), 2);
+	CHECK_EQUAL(values[0], 1);
+	CHECK_EQUAL(values[1], 2);
+	CHECK_EQUAL(spsc_queue_drain(&queue, values, 8), 2);
+	CHECK_EQUAL(values[0], 3);
+	CHECK_EQUAL(values[1], 5);
+	CHECK(spsc_queue_is_empty(&queue));
+	CHECK(!spsc_queue_pop(&queue, &value));
+	CHECK_EQUAL(spsc_queue_drain(&queue, values, 8), 0);
+	CHECK_EQUAL(queue.max_used, 4);
+}
+
+int main(void) {
+	test_single();
+	test_threads(true);
+	test_threads(false);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# asyncio variant of tinkerforge/ip_connection.py for driving many devices
+# concurrently from one test script without threads and sleep polling.
+#
+# * Getters and setters are awaitable. Several requests per device can be
+#   outstanding at the same time (pipelining), the responses are matched by
+#   UID, function ID and sequence number like in ip_connection.py.
+# * Callbacks and enumerate are async iterators.
+# * The device classes are derived from the generated bindings: Each method
+#   of the generated device is run twice, once to capture the request (with
+#   argument conversion) and once with the response to get the same return
+#   value (e.g. namedtuples) as the synchronous bindings.
+#
+# Example:
+#   ipcon = AsyncIPConnection()
+#   await ipcon.connect('localhost', 4223)
+#   evse = AsyncBrickletEVSEV2('2CpXU5', ipcon)
+#   state, hardware = await asyncio.gather(evse.get_state(), evse.get_hardware_configuration())
+#   async for values in evse.callback_stream(evse.CALLBACK_ENERGY_METER_VALUES): ...
+
+from tinkerforge.ip_connection import IPConnection, Device, Error, pack_payload, unpack_payload
+from tinkerforge.ip_connection import get_uid_from_data, get_length_from_data, get_function_id_from_data
+from tinkerforge.ip_connection import get_sequence_number_from_data, get_error_code_from_data
+from tinkerforge.bricklet_evse_v2 import BrickletEVSEV2
+
+import asyncio
+import inspect
+import struct
+
+SEQUENCE_NUMBER_MAX = 15 # 4 bit, 0 is used for callbacks
+
+# Raised by the capture stand-in of the connection, carries the request
+class _Request(Exception):
+    def __init__(self, function_id, data, form, length_ret, form_ret):
+        Exception.__init__(self)
+        self.function_id = function_id
+        self.data        = data
+        self.form        = form
+        self.length_ret  = length_ret
+        self.form_ret    = form_ret
+
+# Stand-in for IPConnection that is given to the generated device
+class _GeneratedDeviceConnection:
+    def __init__(self):
+        self.response = None
+
+    def add_device(self, device):
+        pass
+
+    def send_request(self, device, function_id, data, form, length_ret, form_ret):
+        if self.response is None:
+            raise _Request(function_id, data, form, length_ret, form_ret)
+
+        return self.response
+
+class AsyncIPConnection:
+    def __init__(self):
+        self.timeout   = 2.5
+        self.reader    = None
+        self.writer    = None
+        self.task      = None
+        self.pending   = {}    # (uid, function_id, sequence_number) -> future
+        self.slots     = {}    # (uid, function_id) -> semaphore of free sequence numbers
+        self.callbacks = {}    # (uid, function_id) -> list of queues
+        self.enumerate_queues = []
+
+    async def connect(self, host, port):
+        if self.writer is not None:
+            raise Error(Error.ALREADY_CONNECTED, 'Already connected to {0}:{1}'.format(host, port))
+
+        self.reader, self.writer = await asyncio.open_connection(host, port)
+        self.task = asyncio.get_running_loop().create_task(self.receive_loop())
+
+    async def disconnect(self):
+        if self.writer is None:
+            raise Error(Error.NOT_CONNECTED, 'Not connected')
+
+        self.task.cancel()
+        self.writer.close()
+        try:
+            await self.writer.wait_closed()
+        except ConnectionError:
+            pass
+
+        self.reader = None
+        self.writer = None
+        self.fail_pending(Error(Error.NOT_CONNECTED, 'Disconnected'))
+
+    def set_timeout(self, timeout):
+        self.timeout = timeout
+
+    def fail_pending(self, error):
+        for future in self.pending.values():
+            if not future.done():
+                future.set_exception(error)
+        self.pending.clear()
+
+    async def receive_loop(self):
+        try:
+            while True:
+                header = await self.reader.readexactly(8)
+                length = get_length_from_data(header)
+                packet = header + (await self.reader.readexactly(length - 8) if length > 8 else b'')
+                self.dispatch_packet(packet)
+        except (asyncio.IncompleteReadError, ConnectionError):
+            self.fail_pending(Error(Error.NOT_CONNECTED, 'Disconnected by peer'))
+            for queues in list(self.callbacks.values()) + [self.enumerate_queues]:
+                for queue in queues:
+                    queue.put_nowait(None)
+
+    def dispatch_packet(self, packet):
+        uid             = get_uid_from_data(packet)
+        function_id     = get_function_id_from_data(packet)
+        sequence_number = get_sequence_number_from_data(packet)
+
+        if sequence_number == 0:
+            if function_id == IPConnection.CALLBACK_ENUMERATE:
+                if len(packet) == 34:
+                    args = unpack_payload(packet[8:], '8s 8s c 3B 3B H B')
+                    for queue in self.enumerate_queues:
+                        queue.put_nowait(args)
+            else:
+                for queue in self.callbacks.get((uid, function_id), []):
+                    queue.put_nowait(packet)
+            return
+
+        future = self.pending.pop((uid, function_id, sequence_number), None)
+        if future is not None and not future.done():
+            future.set_result(packet)
+
+    async def send(self, packet):
+        if self.writer is None:
+            raise Error(Error.NOT_CONNECTED, 'Not connected')
+
+        self.writer.write(packet)
+        await self.writer.drain()
+
+    # Returns the response packet (None if no response is expected)
+    async def send_request(self, uid, function_id, payload, response_expected):
+        length = 8 + len(payload)
+
+        if not response_expected:
+            # Sequence numbers of requests without response are never matched
+            await self.send(struct.pack('<IBBBB', uid, length, function_id, 1 << 4, 0) + payload)
+            return None
+
+        slot = self.slots.setdefault((uid, function_id), asyncio.Semaphore(SEQUENCE_NUMBER_MAX))
+        async with slot:
+            sequence_number = next(s for s in range(1, SEQUENCE_NUMBER_MAX + 1) if (uid, function_id, s) not in self.pending)
+            key    = (uid, function_id, sequence_number)
+            future = asyncio.get_running_loop().create_future()
+            self.pending[key] = future
+
+            try:
+                await self.send(struct.pack('<IBBBB', uid, length, function_id, (sequence_number << 4) | (1 << 3), 0) + payload)
+                return await asyncio.wait_for(future, self.timeout)
+            except asyncio.TimeoutError:
+                raise Error(Error.TIMEOUT, 'Did not receive response for function {0} in time'.format(function_id), suppress_context=True)
+            finally:
+                # The sequence number might already be reused by the next request
+                if self.pending.get(key) is future:
+                    del self.pending[key]
+
+    async def enumerate_stream(self):
+        queue = asyncio.Queue()
+        self.enumerate_queues.append(queue)
+        try:
+            await self.send(struct.pack('<IBBBB', IPConnection.BROADCAST_UID, 8, IPConnection.FUNCTION_ENUMERATE, 1 << 4, 0))
+            while True:
+                args = await queue.get()
+                if args is None:
+                    return
+                yield args
+        finally:
+            self.enumerate_queues.remove(queue)
+
+class AsyncDevice:
+    GENERATED_DEVICE_CLASS = None
+
+    def __init__(self, uid, ipcon):
+        self.ipcon      = ipcon
+        self.connection = _GeneratedDeviceConnection()
+        self.device     = self.GENERATED_DEVICE_CLASS(uid, self.connection)
+        self.device.device_identifier_check = Device.DEVICE_IDENTIFIER_CHECK_MATCH # Checked in check_identity()
+        self.uid        = self.device.uid
+
+    # Raises WRONG_DEVICE_TYPE if the UID belongs to a different device
+    async def check_identity(self):
+        identity = await self.get_identity()
+        if identity.device_identifier != self.device.device_identifier:
+            raise Error(Error.WRONG_DEVICE_TYPE, 'UID {0} belongs to device {1} instead of the expected {2}'
+                        .format(self.device.uid_string, identity.device_identifier, self.device.device_display_name))
+
+    async def call(self, method, *args, **kwargs):
+        self.connection.response = None
+        try:
+            method(self.device, *args, **kwargs)
+            raise Error(Error.NOT_SUPPORTED, '{0} does not send a request'.format(method.__name__))
+        except _Request as e:
+            request = e
+
+        response_expected = self.device.get_response_expected(request.function_id)
+        packet = await self.ipcon.send_request(self.uid, request.function_id, pack_payload(request.data, request.form), response_expected)
+        if packet is None:
+            return None
+
+        error_code = get_error_code_from_data(packet)
+        if error_code == 1:
+            raise Error(Error.INVALID_PARAMETER, 'Got invalid parameter for function {0}'.format(request.function_id))
+        elif error_code == 2:
+            raise Error(Error.NOT_SUPPORTED, 'Function {0} is not supported'.format(request.function_id))
+        elif error_code != 0:
+            raise Error(Error.UNKNOWN_ERROR_CODE, 'Function {0} returned an unknown error'.format(request.function_id))
+
+        length_ret = request.length_ret if request.length_ret > 0 else 8
+        if len(packet) != length_ret:
+            raise Error(Error.WRONG_RESPONSE_LENGTH, 'Expected response of {0} byte for function ID {1}, got {2} byte instead'
+                        .format(length_ret, request.function_id, len(packet)))
+
+        if len(request.form_ret) == 0:
+            return None
+
+        self.connection.response = unpack_payload(packet[8:], request.form_ret)
+        try:
+            return method(self.device, *args, **kwargs)
+        finally:
+            self.connection.response = None
+
+    # Yields the unpacked callback values until the connection is closed
+    async def callback_stream(self, callback_id):
+        length, form = self.device.callback_formats[callback_id]
+        queue = asyncio.Queue()
+        queues = self.ipcon.callbacks.setdefault((self.uid, callback_id), [])
+        queues.append(queue)
+        try:
+            while True:
+                packet = await queue.get()
+                if packet is None:
+                    return
+                if len(packet) == length:
+                    yield unpack_payload(packet[8:], form)
+        finally:
+            queues.remove(queue)
+
+# Creates an async device class with an awaitable method for each method of
+# the generated device that sends exactly one request. High level stream
+# functions are not available, their _low_level functions can be used.
+def create_async_device_class(generated_class):
+    def make_method(method):
+        async def async_method(self, *args, **kwargs):
+            return await self.call(method, *args, **kwargs)
+        async_method.__name__ = method.__name__
+        async_method.__doc__  = method.__doc__
+        return async_method
+
+    attributes = {'GENERATED_DEVICE_CLASS': generated_class}
+    for name, value in vars(generated_class).items():
+        if name.startswith('_'):
+            continue
+        if inspect.isfunction(value):
+            source = inspect.getsource(value)
+            if 'send_request' in source and 'stream_lock' not in source:
+                attributes[name] = make_method(value)
+        else:
+            attributes[name] = value # Constants
+
+    for name in ('get_response_expected', 'set_response_expected', 'set_response_expected_all', 'get_api_version'):
+        attributes[name] = (lambda name: lambda self, *args: getattr(self.device, name)(*args))(name)
+
+    return type('Async' + generated_class.__name__, (AsyncDevice,), attributes)
+
+AsyncBrickletEVSEV2 = create_async_device_class(BrickletEVSEV2)
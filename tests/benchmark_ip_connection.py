@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Measures requests per second and latency percentiles of the synchronous
+# IPConnection and the AsyncIPConnection (with 1 to 64 outstanding requests).
+# Without arguments the EVSE 2.0 simulator (evse_v2_simulator.py) is started
+# as separate process on a free port, once without and once with a response
+# latency of 1ms (network/brickd round trip). Otherwise the given brickd is used.
+#
+# Usage: benchmark_ip_connection.py [--host localhost --port 4223 --uid 2CpXU5] [--requests 2000]
+
+from tinkerforge.ip_connection import IPConnection
+from tinkerforge.bricklet_evse_v2 import BrickletEVSEV2
+from async_ip_connection import AsyncIPConnection, AsyncBrickletEVSEV2
+
+import subprocess
+import asyncio
+import socket
+import time
+import sys
+import os
+
+CONCURRENCY       = [1, 4, 16, 64]
+SIMULATOR_LATENCY = [0, 1] # ms
+
+def percentile(latencies, p):
+    return latencies[min(len(latencies) - 1, int(len(latencies)*p/100))]
+
+def report(name, duration, latencies):
+    latencies = sorted(latencies)
+    print('{0:24s} {1:8.0f} req/s   latency p50 {2:6.2f}ms  p90 {3:6.2f}ms  p99 {4:6.2f}ms  max {5:6.2f}ms'.format(
+          name, len(latencies)/duration,
+          percentile(latencies, 50)*1000, percentile(latencies, 90)*1000, percentile(latencies, 99)*1000, latencies[-1]*1000))
+
+def benchmark_sync(host, port, uid, requests):
+    ipcon = IPConnection()
+    evse = BrickletEVSEV2(uid, ipcon)
+    ipcon.connect(host, port)
+    evse.get_identity()
+
+    latencies = []
+    start = time.perf_counter()
+    for _ in range(requests):
+        t = time.perf_counter()
+        evse.get_low_level_state()
+        latencies.append(time.perf_counter() - t)
+    duration = time.perf_counter() - start
+
+    ipcon.disconnect()
+    report('sync', duration, latencies)
+
+async def benchmark_async(host, port, uid, requests, concurrency):
+    ipcon = AsyncIPConnection()
+    await ipcon.connect(host, port)
+    evse = AsyncBrickletEVSEV2(uid, ipcon)
+    await evse.check_identity()
+
+    latencies = []
+    remaining = [requests]
+
+    async def worker():
+        while remaining[0] > 0:
+            remaining[0] -= 1
+            t = time.perf_counter()
+            await evse.get_low_level_state()
+            latencies.append(time.perf_counter() - t)
+
+    start = time.perf_counter()
+    await asyncio.gather(*[worker() for _ in range(concurrency)])
+    duration = time.perf_counter() - start
+
+    await ipcon.disconnect()
+    report('async, {0} outstanding'.format(concurrency), duration, latencies)
+
+def run(host, port, uid, requests):
+    print('{0} x get_low_level_state'.format(requests))
+    benchmark_sync(host, port, uid, requests)
+    for concurrency in CONCURRENCY:
+        asyncio.run(benchmark_async(host, port, uid, requests, concurrency))
+
+if __name__ == "__main__":
+    args     = sys.argv[1:]
+    requests = int(args[args.index('--requests') + 1]) if '--requests' in args else 2000
+    uid      = args[args.index('--uid') + 1]           if '--uid'      in args else '2CpXU5'
+
+    if '--port' in args:
+        host = args[args.index('--host') + 1] if '--host' in args else 'localhost'
+        port = int(args[args.index('--port') + 1])
+        run(host, port, uid, requests)
+    else:
+        for latency in SIMULATOR_LATENCY:
+            with socket.socket() as s:
+                s.bind(('localhost', 0))
+                host, port = s.getsockname()
+
+            simulator = os.path.join(os.path.dirname(os.path.realpath(__file__)), 'evse_v2_simulator.py')
+            process   = subprocess.Popen([sys.executable, simulator, '--port', str(port), '--uid', uid, '--latency', str(latency)],
+                                         stdin=subprocess.PIPE, stdout=subprocess.DEVNULL)
+            while True:
+                try:
+                    socket.create_connection((host, port)).close()
+                    break
+                except ConnectionRefusedError:
+                    time.sleep(0.1)
+
+            print('EVSE 2.0 simulator with {0}ms latency'.format(latency))
+            run(host, port, uid, requests)
+            process.terminate()
+            process.wait()
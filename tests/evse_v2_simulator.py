@@ -0,0 +1,419 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# brickd with an EVSE 2.0 Bricklet and the industrial bricklets of the EVSE
+# 2.0 tester (see evse_v2_tester.py) for running the test scripts without
+# hardware. Speaks the TFP protocol of tinkerforge/ip_connection.py on
+# localhost:4223, so the test scripts can be run unmodified on any machine.
+#
+# The EVSE is the firmware itself: The host build software/test/host_evse.c
+# runs the main loop of the firmware with the real modules on a virtual
+# clock, the TFP messages are forwarded to handle_message() of
+# communication.c and the callbacks of the firmware are sent to all clients.
+# The tester bricklets are Python models, their relay states are the inputs
+# of the host build (CP/PE and PP/PE resistance, diode, shutdown input,
+# AC1/AC2), the analog in reads the CP/PE and PP/PE voltage from it.
+# Without a host model are frequency measurement, temperature sensor, meter
+# (none connected), Iskra display and the contactor check (never an error),
+# see host_evse.c.
+#
+# The simulation runs in real time by default, the test scripts use wall
+# clock sleeps. run_simulated.py runs a test script faster than real time
+# against the simulator with --time-scale.
+#
+# The tester bricklets are wired as in the test setup:
+#   Quad Relay 1 (CP): diode, 2700 Ohm, 1300 Ohm, 330 Ohm CP/PE
+#   Quad Relay 2 (PP): 1500 Ohm, 680 Ohm, 220 Ohm, 100 Ohm PP/PE
+#   Quad Relay 3:      shutdown input
+#   Dual Relay:        AC0 (contactor input), AC1 (contactor output)
+#   Dual Analog In:    PP/PE voltage (channel 0), CP/PE voltage (channel 1)
+#   GP output is connected to GP input
+#
+# Commands on stdin (for the manual steps of full_test.py):
+#   button             press the button (released after 0.5s)
+#   jumper <0-8>       set the jumper configuration (read at reset)
+#   state              print the EVSE state
+#
+# Usage: evse_v2_simulator.py [--port 4223] [--uid 2CpXU5] [--latency ms] [--time-scale factor] [--host-firmware path]
+# --latency delays each response (network/brickd round trip) without
+# blocking the following requests. --time-scale runs the simulated time
+# faster than the wall clock. --host-firmware is the host build of the
+# firmware (default build/host_evse, cmake -S software/test -B build).
+
+from tinkerforge.ip_connection import IPConnection, pack_payload, unpack_payload, base58decode
+from tinkerforge.ip_connection import get_uid_from_data, get_length_from_data, get_function_id_from_data
+from tinkerforge.bricklet_evse_v2 import BrickletEVSEV2
+from tinkerforge.bricklet_industrial_quad_relay_v2 import BrickletIndustrialQuadRelayV2
+from tinkerforge.bricklet_industrial_dual_relay import BrickletIndustrialDualRelay
+from tinkerforge.bricklet_industrial_dual_analog_in_v2 import BrickletIndustrialDualAnalogInV2
+
+import socketserver
+import subprocess
+import threading
+import struct
+import time
+import sys
+import os
+
+import evse_v2_tester
+
+HOST = "localhost"
+PORT = 4223
+
+HOST_FIRMWARE = os.path.join(os.path.dirname(os.path.realpath(__file__)), '..', 'build', 'host_evse')
+
+ERROR_CODE_OK            = 0
+ERROR_CODE_NOT_SUPPORTED = 2
+
+TICK_INTERVAL      = 0.005 # s, wall clock
+BUTTON_PRESS_TIME  = 0.5
+
+CP_RESISTORS       = [2700, 1300, 330]
+PP_RESISTORS       = [1500, 680, 220, 100]
+
+# Simulated time in s, runs time_scale times faster than the wall clock
+time_scale = 1
+
+def sim_time():
+    return time.monotonic()*time_scale
+
+def parallel(resistors):
+    if len(resistors) == 0:
+        return None
+    return 1/sum(1/r for r in resistors)
+
+class Device:
+    def __init__(self, uid, device_identifier, position):
+        self.uid               = uid
+        self.uid_number        = base58decode(uid)
+        self.device_identifier = device_identifier
+        self.position          = position
+        self.functions         = {} # function id -> (request form, response form, handler)
+
+    def identity(self):
+        return (self.uid, '0', self.position, (1, 0, 0), (2, 0, 0), self.device_identifier)
+
+    # Returns (error code, response payload)
+    def handle(self, function_id, payload):
+        if function_id == 255: # get_identity
+            return ERROR_CODE_OK, pack_payload(self.identity(), '8s 8s c 3B 3B H')
+        if function_id == 243: # reset
+            self.reset()
+            return ERROR_CODE_OK, b''
+        if function_id not in self.functions:
+            return ERROR_CODE_NOT_SUPPORTED, b''
+
+        form, form_ret, handler = self.functions[function_id]
+        args = ()
+        if len(form) > 0:
+            args = unpack_payload(payload, form)
+            if len(form.split(' ')) == 1: # Single values are not returned as tuple
+                args = (args,)
+
+        ret = handler(*args)
+        if len(form_ret) == 0:
+            return ERROR_CODE_OK, b''
+        if len(form_ret.split(' ')) == 1:
+            ret = (ret,)
+        return ERROR_CODE_OK, pack_payload(ret, form_ret)
+
+    def reset(self):
+        pass
+
+    def tick(self, now):
+        pass
+
+class QuadRelay(Device):
+    def __init__(self, uid, position):
+        Device.__init__(self, uid, BrickletIndustrialQuadRelayV2.DEVICE_IDENTIFIER, position)
+        self.value = [False]*4
+        self.functions = {
+            BrickletIndustrialQuadRelayV2.FUNCTION_SET_VALUE:          ('4!',  '',   self.set_value),
+            BrickletIndustrialQuadRelayV2.FUNCTION_GET_VALUE:          ('',    '4!', lambda: self.value),
+            BrickletIndustrialQuadRelayV2.FUNCTION_SET_SELECTED_VALUE: ('B !', '',   self.set_selected_value)
+        }
+
+    def set_value(self, value):
+        self.value = list(value)
+
+    def set_selected_value(self, channel, value):
+        self.value[channel] = value
+
+    def reset(self):
+        self.value = [False]*4
+
+class DualRelay(Device):
+    def __init__(self, uid, position):
+        Device.__init__(self, uid, BrickletIndustrialDualRelay.DEVICE_IDENTIFIER, position)
+        self.value = [False]*2
+        self.functions = {
+            BrickletIndustrialDualRelay.FUNCTION_SET_VALUE:          ('! !', '',    self.set_value),
+            BrickletIndustrialDualRelay.FUNCTION_GET_VALUE:          ('',    '! !', lambda: self.value),
+            BrickletIndustrialDualRelay.FUNCTION_SET_SELECTED_VALUE: ('B !', '',    self.set_selected_value)
+        }
+
+    def set_value(self, channel0, channel1):
+        self.value = [channel0, channel1]
+
+    def set_selected_value(self, channel, value):
+        self.value[channel] = value
+
+    def reset(self):
+        self.value = [False]*2
+
+class DualAnalogIn(Device):
+    def __init__(self, uid, position, evse):
+        Device.__init__(self, uid, BrickletIndustrialDualAnalogInV2.DEVICE_IDENTIFIER, position)
+        self.evse        = evse
+        self.sample_rate = BrickletIndustrialDualAnalogInV2.SAMPLE_RATE_4_SPS
+        self.functions = {
+            BrickletIndustrialDualAnalogInV2.FUNCTION_GET_VOLTAGE:     ('B', 'i', self.get_voltage),
+            BrickletIndustrialDualAnalogInV2.FUNCTION_SET_SAMPLE_RATE: ('B', '',  self.set_sample_rate),
+            BrickletIndustrialDualAnalogInV2.FUNCTION_GET_SAMPLE_RATE: ('',  'B', lambda: self.sample_rate)
+        }
+
+    def get_voltage(self, channel):
+        cp_pe_mv, pp_pe_mv = self.evse.analog()
+        return pp_pe_mv if channel == 0 else cp_pe_mv
+
+    def set_sample_rate(self, rate):
+        self.sample_rate = rate
+
+class EVSEV2(Device):
+    def __init__(self, uid, position, host_firmware, iqr1, iqr2, iqr3, idr):
+        Device.__init__(self, uid, BrickletEVSEV2.DEVICE_IDENTIFIER, position)
+        self.iqr1 = iqr1
+        self.iqr2 = iqr2
+        self.iqr3 = iqr3
+        self.idr  = idr
+
+        self.jumper_configuration = 6 # 32A
+        self.button_release       = 0
+        self.firmware_version     = (0, 0, 0)
+        self.callbacks            = [] # packets
+        self.input                = None # last input line, None after a reset
+        self.start                = sim_time()
+        self.ms                   = 0 # simulated time that the firmware has run
+
+        self.process = subprocess.Popen([host_firmware, str(self.uid_number)], stdin=subprocess.PIPE,
+                                        stdout=subprocess.PIPE, universal_newlines=True, bufsize=1)
+        self.read_answer()
+
+    def identity(self):
+        return (self.uid, '0', self.position, (1, 0, 0), self.firmware_version, self.device_identifier)
+
+    # Returns the answer line of the host build, None if the firmware was reset instead
+    def read_answer(self):
+        while True:
+            line = self.process.stdout.readline()
+            if len(line) == 0:
+                raise RuntimeError('Host build of the firmware exited')
+
+            line = line.strip()
+            if line.startswith('callback '):
+                self.callbacks.append(bytes.fromhex(line[9:]))
+            elif line.startswith('reset '):
+                self.firmware_version = tuple(int(x) for x in line[6:].split('.'))
+                self.input            = None
+                return None
+            else:
+                return line
+
+    def command(self, line):
+        self.process.stdin.write(line + '\n')
+        self.process.stdin.flush()
+        return self.read_answer()
+
+    def update_input(self):
+        cp_pe = parallel([r for r, on in zip(CP_RESISTORS, self.iqr1.value[1:]) if on])
+        pp_pe = parallel([r for r, on in zip(PP_RESISTORS, self.iqr2.value) if on])
+        line  = 'input {0} {1} {2:d} {3:d} {4:d} {5:d} {6:d} {7}'.format(round(cp_pe or 0), round(pp_pe or 0), self.iqr1.value[0], self.iqr3.value[0],
+                                                                      self.idr.value[0], self.idr.value[1], sim_time() < self.button_release, self.jumper_configuration)
+        if line != self.input:
+            self.command(line)
+            self.input = line
+
+    # The relay changes since the last tick take effect now, the jumper is read at boot
+    def tick(self, now):
+        if self.input is None:
+            self.update_input()
+
+        ms = int((now - self.start)*1000)
+        if ms > self.ms:
+            self.command('run {0}'.format(ms - self.ms))
+            self.ms = ms
+
+        self.update_input()
+
+    # Returns the response packet or None
+    def message(self, packet):
+        answer = self.command('message ' + packet.hex())
+        if get_function_id_from_data(packet) == 243 and answer is not None: # reset, wait for the new firmware process
+            self.read_answer()
+
+        if answer is None or len(answer) <= len('response '):
+            return None
+        return bytes.fromhex(answer[9:])
+
+    def analog(self):
+        return [int(x) for x in self.command('analog').split()[1:]]
+
+    def state(self):
+        return self.command('state')[6:]
+
+class Simulation:
+    def __init__(self, uid_evse, host_firmware):
+        self.lock    = threading.Lock()
+        self.clients = set() # Handlers, the callbacks are sent to all clients
+        self.iqr1 = QuadRelay(evse_v2_tester.UID_IQR1, 'a')
+        self.iqr2 = QuadRelay(evse_v2_tester.UID_IQR2, 'b')
+        self.iqr3 = QuadRelay(evse_v2_tester.UID_IQR3, 'c')
+        self.idr  = DualRelay(evse_v2_tester.UID_IDR,  'd')
+        self.evse = EVSEV2(uid_evse, 'e', host_firmware, self.iqr1, self.iqr2, self.iqr3, self.idr)
+        self.idai = DualAnalogIn(evse_v2_tester.UID_IDAI, 'f', self.evse)
+
+        self.devices = {device.uid_number: device for device in (self.iqr1, self.iqr2, self.iqr3, self.idr, self.evse, self.idai)}
+
+        thread = threading.Thread(target=self.tick_loop)
+        thread.daemon = True
+        thread.start()
+
+    def tick_loop(self):
+        while True:
+            with self.lock:
+                now = sim_time()
+                for device in self.devices.values():
+                    device.tick(now)
+            self.send_callbacks()
+            time.sleep(max(0.001, TICK_INTERVAL/time_scale))
+
+    # Returns the list of packets to send back
+    def handle_packet(self, packet):
+        uid         = get_uid_from_data(packet)
+        function_id = get_function_id_from_data(packet)
+        options     = packet[6]
+        payload     = packet[8:]
+
+        if uid == IPConnection.BROADCAST_UID:
+            if function_id != IPConnection.FUNCTION_ENUMERATE:
+                return []
+            packets = []
+            for device in self.devices.values():
+                data = pack_payload(device.identity() + (IPConnection.ENUMERATION_TYPE_AVAILABLE,), '8s 8s c 3B 3B H B')
+                packets.append(struct.pack('<IBBBB', device.uid_number, 8 + len(data), IPConnection.CALLBACK_ENUMERATE, 0, 0) + data)
+            return packets
+
+        device = self.devices.get(uid)
+        if device is None: # Like brickd: unknown UIDs are not answered
+            return []
+
+        with self.lock:
+            self.evse.tick(sim_time())
+            if device is self.evse and function_id != 255: # get_identity is answered by the bootloader
+                response = self.evse.message(packet)
+                return [] if response is None else [response]
+            error_code, data = device.handle(function_id, payload)
+
+        if (options & 0x08) == 0: # Response not expected
+            return []
+
+        return [struct.pack('<IBBBB', uid, 8 + len(data), function_id, options, error_code << 6) + data]
+
+    def send_callbacks(self):
+        with self.lock:
+            callbacks, self.evse.callbacks = self.evse.callbacks, []
+            clients = list(self.clients)
+
+        for packet in callbacks:
+            for client in clients:
+                client.send(packet)
+
+    def command(self, line):
+        args = line.split()
+        with self.lock:
+            if args[0] == 'button':
+                self.evse.button_release = sim_time() + BUTTON_PRESS_TIME
+            elif args[0] == 'jumper' and len(args) > 1:
+                self.evse.jumper_configuration = int(args[1])
+            elif args[0] == 'state':
+                print(self.evse.state())
+            else:
+                print('Unknown command: ' + line)
+
+class Handler(socketserver.BaseRequestHandler):
+    def recv_exactly(self, length):
+        data = b''
+        while len(data) < length:
+            chunk = self.request.recv(length - len(data))
+            if len(chunk) == 0:
+                return None
+            data += chunk
+        return data
+
+    def handle(self):
+        while True:
+            header = self.recv_exactly(8)
+            if header is None:
+                return
+
+            length  = get_length_from_data(header)
+            payload = self.recv_exactly(length - 8) if length > 8 else b''
+            if payload is None:
+                return
+
+            for packet in self.server.simulation.handle_packet(header + payload):
+                if self.server.latency > 0:
+                    threading.Timer(self.server.latency, self.send, [packet]).start()
+                else:
+                    self.send(packet)
+            self.server.simulation.send_callbacks()
+
+    def setup(self):
+        self.send_lock = threading.Lock()
+        with self.server.simulation.lock:
+            self.server.simulation.clients.add(self)
+
+    def finish(self):
+        with self.server.simulation.lock:
+            self.server.simulation.clients.discard(self)
+
+    def send(self, packet):
+        with self.send_lock:
+            try:
+                self.request.sendall(packet)
+            except OSError: # Disconnected before the delayed response
+                pass
+
+class Server(socketserver.ThreadingMixIn, socketserver.TCPServer):
+    daemon_threads      = True
+    allow_reuse_address = True
+    latency             = 0
+
+if __name__ == "__main__":
+    args = sys.argv[1:]
+    port = int(args[args.index('--port') + 1]) if '--port' in args else PORT
+    uid  = args[args.index('--uid') + 1]       if '--uid'  in args else "2CpXU5"
+    host_firmware = args[args.index('--host-firmware') + 1] if '--host-firmware' in args else HOST_FIRMWARE
+
+    if '--time-scale' in args:
+        time_scale = float(args[args.index('--time-scale') + 1])
+
+    server = Server((HOST, port), Handler)
+    server.simulation = Simulation(uid, host_firmware)
+    if '--latency' in args:
+        server.latency = float(args[args.index('--latency') + 1])/1000
+
+    thread = threading.Thread(target=server.serve_forever)
+    thread.daemon = True
+    thread.start()
+
+    print('Simulating EVSE 2.0 Bricklet {0} and tester on {1}:{2} ({3}x real time)'.format(uid, HOST, port, time_scale), flush=True)
+    try:
+        for line in sys.stdin:
+            if len(line.strip()) > 0:
+                server.simulation.command(line.strip())
+        thread.join()
+    except KeyboardInterrupt:
+        pass
+
+    server.shutdown()
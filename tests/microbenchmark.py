@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Runs the microbenchmarks of the firmware hot functions and prints one JSON
+# object per benchmark (cycles at 48MHz). Needs the microbenchmark image
+# ("cmake -DMICROBENCHMARK=ON"), test bench only: The benchmarks call the
+# IEC 61851 state functions with fixed inputs, the outputs are switched
+# accordingly. The EVSE is reset afterwards.
+#
+# Run once on each hardware version (EVSE 2.0, 3.0 and 4.0) to cover all
+# variants. Benchmarks that are not available on the hardware version are
+# reported with "available": false.
+#
+# The cycles per second of the LED subsystem are derived from the led_tick
+# and led_render benchmarks and the main loop period (get hot path
+# statistics) that is measured before the benchmarks run, only if the image
+# is also built with "cmake -DHOT_PATH_STATISTICS=ON".
+#
+# The hardware independent functions (duty cycle, HSV to RGB, Eichrecht
+# dataset) are also checked and timed on the host by software/test
+# (test_hot_functions), without the target.
+#
+# Usage: microbenchmark.py [iterations] > results.jsonl
+
+HOST     = "localhost"
+PORT     = 4223
+UID_EVSE = "2CpXU5"
+
+from tinkerforge.ip_connection import IPConnection, Error
+from tinkerforge.bricklet_evse_v2 import BrickletEVSEV2
+import subprocess
+import json
+import time
+import sys
+import os
+
+FUNCTION_START_MICROBENCHMARK    = 97
+FUNCTION_GET_MICROBENCHMARK      = 98
+FUNCTION_GET_HOT_PATH_STATISTICS = 87
+
+CPU_CLOCK_HZ = 48000000
+
+LED_RENDER_PER_SECOND = 100 # LED_RENDER_PERIOD of 10ms
+
+STATE_IDLE          = 0
+STATE_RUNNING       = 1
+STATE_DONE          = 2
+STATE_NOT_AVAILABLE = 3
+
+# Same order as MICROBENCHMARK_* in microbenchmark.h
+BENCHMARKS = [
+    'adc_check_count_vcp2',
+    'adc_check_count_vpp',
+    'iec61851_tick_a',
+    'iec61851_tick_b',
+    'iec61851_tick_c',
+    'iec61851_tick_d',
+    'iec61851_tick_ef',
+    'iec61851_get_duty_cycle_for_ma',
+    'evse_set_cp_duty_cycle',
+    'charging_slot_get_max_current',
+    'led_hsv_to_rgb',
+    'eichrecht_create_dataset',
+    'ove_r37_tick',
+    'frequency_tick',
+    'handle_message',
+    'led_tick',
+    'led_render',
+]
+
+def git_commit():
+    try:
+        return subprocess.check_output(['git', 'rev-parse', '--short', 'HEAD'], cwd=os.path.dirname(os.path.realpath(__file__)), stderr=subprocess.DEVNULL).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+def run(ipcon, evse, benchmark, iterations):
+    ipcon.send_request(evse, FUNCTION_START_MICROBENCHMARK, (benchmark, iterations), 'B H', 0, '')
+
+    while True:
+        result = ipcon.send_request(evse, FUNCTION_GET_MICROBENCHMARK, (), '', 28, 'B B H I I I I')
+        if result[1] != STATE_RUNNING:
+            return result
+        time.sleep(0.05)
+
+if __name__ == "__main__":
+    iterations = int(sys.argv[1]) if len(sys.argv) > 1 else 1000
+
+    ipcon = IPConnection()
+    evse = BrickletEVSEV2(UID_EVSE, ipcon)
+    ipcon.connect(HOST, PORT)
+
+    identity      = evse.get_identity()
+    configuration = evse.get_hardware_configuration()
+    common        = {
+        'commit':            git_commit(),
+        'firmware_version':  '.'.join(str(v) for v in identity.firmware_version),
+        'evse_version':      configuration.evse_version,
+    }
+
+    # Statistics are reset on read
+    try:
+        ipcon.send_request(evse, FUNCTION_GET_HOT_PATH_STATISTICS, (), '', 33, '! I I I I I I')
+        time.sleep(1)
+        loop_period_mean = ipcon.send_request(evse, FUNCTION_GET_HOT_PATH_STATISTICS, (), '', 33, '! I I I I I I')[2]
+    except Error:
+        loop_period_mean = 0 # Image without hot path statistics
+
+    cycles_mean_by_name = {}
+    for benchmark, name in enumerate(BENCHMARKS):
+        _, state, done, overhead, cycles_min, cycles_mean, cycles_max = run(ipcon, evse, benchmark, iterations)
+
+        result = dict(common)
+        result['benchmark'] = name
+        result['available'] = state == STATE_DONE
+        if state == STATE_DONE:
+            result['iterations']  = done
+            result['overhead']    = overhead
+            result['cycles_min']  = cycles_min
+            result['cycles_mean'] = cycles_mean
+            result['cycles_max']  = cycles_max
+            result['ns_min']      = cycles_min*1000000000//CPU_CLOCK_HZ
+            cycles_mean_by_name[name] = cycles_mean
+        print(json.dumps(result), flush=True)
+
+    if loop_period_mean > 0 and 'led_tick' in cycles_mean_by_name and 'led_render' in cycles_mean_by_name:
+        loops_per_second = 1000000000//loop_period_mean
+
+        result = dict(common)
+        result['benchmark']         = 'led_per_second'
+        result['loops_per_second']  = loops_per_second
+        result['cycles_per_second'] = loops_per_second*cycles_mean_by_name['led_tick'] + LED_RENDER_PER_SECOND*cycles_mean_by_name['led_render']
+        print(json.dumps(result), flush=True)
+
+    # The benchmarks leave the IEC 61851 state machine and ADC results in an undefined state
+    evse.reset()
+    ipcon.disconnect()
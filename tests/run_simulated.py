@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Runs a test script against the EVSE 2.0 simulator (evse_v2_simulator.py)
+# faster than real time. The simulator is started with --time-scale and the
+# script is run unmodified in this process with time.sleep(), time.time()
+# and time.monotonic() scaled by the same factor, so wall clock waits of the
+# script (e.g. for the IEC 61851 state changes) take only a fraction of the
+# time. Request timeouts of the bindings stay in real time.
+#
+# The EVSE of the simulator is the host build of the firmware
+# (software/test/host_evse.c), the script runs against the message handling
+# and the state machine of the firmware. The manual steps of full_test.py
+# need the simulator on stdin, run the simulator separately for them.
+#
+# --duration stops the script after the given simulated time in s (for the
+# endless evse_v2_tester.py), this counts as success.
+#
+# Usage: run_simulated.py [--time-scale factor] [--duration s] [--host-firmware path] script.py [script arguments]
+
+PORT       = 4223
+TIME_SCALE = 10
+
+import subprocess
+import threading
+import _thread
+import socket
+import runpy
+import time
+import sys
+import os
+
+if __name__ == "__main__":
+    args          = sys.argv[1:]
+    time_scale    = TIME_SCALE
+    duration      = None
+    host_firmware = []
+    while len(args) > 1 and args[0] in ('--time-scale', '--duration', '--host-firmware'):
+        if args[0] == '--time-scale':
+            time_scale = float(args[1])
+        elif args[0] == '--duration':
+            duration = float(args[1])
+        else:
+            host_firmware = ['--host-firmware', args[1]]
+        args = args[2:]
+
+    if len(args) == 0:
+        print('Usage: run_simulated.py [--time-scale factor] [--duration s] [--host-firmware path] script.py [script arguments]')
+        sys.exit(1)
+
+    simulator = os.path.join(os.path.dirname(os.path.realpath(__file__)), 'evse_v2_simulator.py')
+    process   = subprocess.Popen([sys.executable, simulator, '--port', str(PORT), '--time-scale', str(time_scale)] + host_firmware,
+                                 stdin=subprocess.PIPE, stdout=subprocess.DEVNULL)
+    while True:
+        try:
+            socket.create_connection(('localhost', PORT)).close()
+            break
+        except ConnectionRefusedError:
+            if process.poll() is not None:
+                print('Simulator exited')
+                sys.exit(1)
+            time.sleep(0.1)
+
+    real_sleep     = time.sleep
+    real_time      = time.time
+    real_monotonic = time.monotonic
+    start_time     = real_time()
+    start_monotonic = real_monotonic()
+
+    time.sleep     = lambda seconds: real_sleep(seconds/time_scale)
+    time.time      = lambda: start_time + (real_time() - start_time)*time_scale
+    time.monotonic = lambda: start_monotonic + (real_monotonic() - start_monotonic)*time_scale
+
+    timeout = threading.Event()
+    if duration is not None:
+        def stop():
+            timeout.set()
+            _thread.interrupt_main()
+
+        timer = threading.Timer(duration/time_scale, stop)
+        timer.daemon = True
+        timer.start()
+
+    sys.argv = args
+    sys.path.insert(0, os.path.dirname(os.path.realpath(args[0])))
+    exit_code = 0
+    try:
+        runpy.run_path(args[0], run_name='__main__')
+    except SystemExit as e:
+        exit_code = e.code
+    except KeyboardInterrupt:
+        if timeout.is_set():
+            print('Stopped after {0}s simulated time'.format(duration))
+        else:
+            exit_code = 1
+    finally:
+        process.terminate()
+        process.wait()
+
+    sys.exit(exit_code)
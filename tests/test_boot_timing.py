@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Prints the boot timing breakdown: Duration of each init in main() and the
+# time of the boot milestones after the main loop started.
+
+HOST     = "localhost"
+PORT     = 4223
+UID_EVSE = "2CpXU5"
+
+from tinkerforge.ip_connection import IPConnection
+from tinkerforge.bricklet_evse_v2 import BrickletEVSEV2
+
+FUNCTION_GET_BOOT_TIMING = 90
+
+# Phase IDs of boot_timing.h
+INITS = {
+    0: 'main', 1: 'ram_usage_init', 2: 'warm_restart_init', 3: 'logging_init', 4: 'hardware_version_init',
+    5: 'communication_init', 6: 'ove_r37_init', 7: 'eichrecht_init', 8: 'evse_init', 9: 'charging_slot_init',
+    10: 'iec61851_init', 11: 'lock_init', 12: 'contactor_check_init', 13: 'led_init', 14: 'button_init',
+    15: 'adc_init', 16: 'dc_fault_init', 17: 'rs485_init', 18: 'meter_init', 19: 'phase_control_init',
+    20: 'tmp1075n_init', 21: 'derating_init', 22: 'plc_init', 23: 'frequency_init', 24: 'iskra_display_init',
+    25: 'hot_path_init', 26: 'warm_restart_resume', 33: 'cpu_load_init', 34: 'digital_input_init',
+    35: 'cp_replay_init'
+}
+
+MILESTONES = {
+    27: 'startup hold done', 28: 'dc fault calibration done', 29: 'cp/pe resistance valid',
+    30: 'meter value', 31: 'eichrecht init done', 32: 'frequency valid'
+}
+
+if __name__ == "__main__":
+    ipcon = IPConnection()
+    evse = BrickletEVSEV2(UID_EVSE, ipcon)
+    ipcon.connect(HOST, PORT)
+
+    phase_count, _ = ipcon.send_request(evse, FUNCTION_GET_BOOT_TIMING, (0,), 'B', 13, 'B I')
+    times = [ipcon.send_request(evse, FUNCTION_GET_BOOT_TIMING, (i,), 'B', 13, 'B I')[1] for i in range(phase_count)]
+
+    def name(phase):
+        return INITS.get(phase, MILESTONES.get(phase, 'phase {0}'.format(phase)))
+
+    # Inits sorted by time (IDs are fixed, not in the order of main()), unknown phases are shown as inits
+    inits      = [phase for phase in range(phase_count) if phase not in MILESTONES]
+    milestones = [phase for phase in range(phase_count) if phase in MILESTONES]
+
+    last = times[0]
+    for phase in sorted(inits, key=lambda phase: (times[phase] == 0, times[phase])):
+        if times[phase] == 0:
+            print('{0:30s} not reached'.format(name(phase)))
+        else:
+            print('{0:30s} {1:10.3f}ms (+{2:.3f}ms)'.format(name(phase), times[phase]/1000, (times[phase] - last)/1000))
+            last = times[phase]
+
+    for phase in milestones:
+        if times[phase] == 0:
+            print('{0:30s} not reached'.format(name(phase)))
+        else:
+            print('{0:30s} {1:10.3f}ms'.format(name(phase), times[phase]/1000))
+
+    ipcon.disconnect()
@@ -0,0 +1,261 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Replays CP traces through the ADC -> IEC 61851 pipeline of the firmware and
+# compares the resulting IEC 61851 state/contactor/CP duty cycle timeline with
+# the expected timeline. The firmware replaces the raw VCP1/VCP2/VPP ADC
+# results with the trace, everything after the ADC (averaging, resistance
+# calculation, IEC 61851 state machine, charging slots) is the real firmware.
+#
+# Timestamps are in ADC samples (two scans per CP PWM period, 2 per ms), the
+# firmware advances the trace with each sample it consumes. The timeline is
+# therefore independent of the API latency as long as there are no underruns.
+#
+# Needs a firmware built with the CP_TRACE_REPLAY cmake option, the replay
+# only starts in state A (no vehicle connected) with the contactor off.
+# While a trace is replayed the contactor is not switched, the timeline has
+# the contactor state that the charging logic requested.
+#
+# The same traces can be replayed without hardware on a virtual clock with
+# the host harness software/test/test_cp_replay.c (e.g. in CI), which runs
+# thousands of random scenarios per run. There the trace files can
+# additionally have meter currents (ignored here):
+#   # meter: sample, current_l1, current_l2, current_l3
+#
+# Usage: test_cp_trace_replay.py [--v4] [trace.csv ...]
+# Without trace files the built-in synthetic scenarios are replayed.
+# Charging has to be allowed (e.g. autostart) for the scenarios that go to C.
+#
+# Trace file format, one run of samples per line:
+#   vcp1_mv, vcp2_mv, samples[, pwm]
+# pwm = 1: every second sample is the PWM low level (-12V).
+# Expected timeline entries as comment lines:
+#   # expect: sample, state (A/B/C/D/EF), contactor (0/1)[, tolerance in samples]
+
+HOST     = "localhost"
+PORT     = 4223
+UID_EVSE = "2CpXU5"
+
+from tinkerforge.ip_connection import IPConnection
+from tinkerforge.bricklet_evse_v2 import BrickletEVSEV2
+import time
+import sys
+
+FUNCTION_SET_CP_TRACE_REPLAY       = 93
+FUNCTION_WRITE_CP_TRACE            = 94
+FUNCTION_GET_CP_TRACE_REPLAY_STATE = 95
+FUNCTION_GET_CP_TRACE_TIMELINE     = 96
+
+CP_REPLAY_PASSWORD = 0x5EB1A7C3
+
+WRITE_CHUNK       = 14
+SAMPLES_PER_MS    = 2
+DIODE_DROP_MV     = 650
+VCP_HIGH_MV       = 12000
+VCP_LOW_MV        = -12000
+PP_RESISTANCE     = 220 # 32A cable
+DEFAULT_TOLERANCE = 200 # samples, the contactor is switched off ~150 samples after the state change
+
+STATES = ['A', 'B', 'C', 'D', 'EF']
+
+def mv_to_raw_vcp(mv):
+    return max(0, min(4095, int(round((mv + 13200)*273/1760))))
+
+def mv_to_raw_vpp(mv):
+    return max(0, min(4095, int(round(mv*273/220))))
+
+# Inverse of the CP/PE resistance calculation in adc_check_count()
+def resistance_to_vcp2_mv(resistance, divider):
+    if resistance is None: # Open
+        return VCP_HIGH_MV
+    return (resistance*VCP_HIGH_MV + divider*DIODE_DROP_MV) / (resistance + divider)
+
+# Inverse of the PP/PE resistance calculation in adc_check_count()
+def pp_resistance_to_mv(resistance, is_v4):
+    if is_v4:
+        return 15000*resistance / (6000 + 5*resistance)
+    return 10000*resistance / (2000 + 3*resistance)
+
+class Trace:
+    def __init__(self, name, is_v4):
+        self.name     = name
+        self.divider  = 1000 if is_v4 else 910
+        self.runs     = [] # (vcp1_mv, vcp2_mv, samples, pwm)
+        self.expected = [] # (sample, state, contactor, tolerance)
+
+    @property
+    def samples(self):
+        return sum(run[2] for run in self.runs)
+
+    def add(self, vcp1_mv, vcp2_mv, samples, pwm=False):
+        self.runs.append((vcp1_mv, vcp2_mv, samples, pwm))
+
+    # CP/PE resistance in ohm (None = open) for the given time
+    def add_resistance(self, resistance, ms, pwm=False):
+        self.add(VCP_HIGH_MV, resistance_to_vcp2_mv(resistance, self.divider), ms*SAMPLES_PER_MS, pwm)
+
+    def expect(self, state, contactor, ms=None, sample=None, tolerance=DEFAULT_TOLERANCE):
+        if sample is None:
+            sample = ms*SAMPLES_PER_MS
+        self.expected.append((sample, state, contactor, tolerance))
+
+    # Run-length encoded elements, see cp_replay.h
+    def elements(self):
+        for vcp1_mv, vcp2_mv, samples, pwm in self.runs:
+            vcp1 = mv_to_raw_vcp(vcp1_mv)
+            vcp2 = mv_to_raw_vcp(vcp2_mv)
+            while samples > 0:
+                count    = min(samples, 128)
+                samples -= count
+                yield vcp1 | (vcp2 << 12) | ((count & 0x7F) << 24) | ((1 << 31) if pwm else 0)
+
+def read_trace(filename, is_v4):
+    trace = Trace(filename, is_v4)
+    with open(filename) as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith('# expect:'):
+                values = [v.strip() for v in line[len('# expect:'):].split(',')]
+                tolerance = int(values[3]) if len(values) > 3 else DEFAULT_TOLERANCE
+                trace.expect(values[1], values[2] == '1', sample=int(values[0]), tolerance=tolerance)
+            elif len(line) == 0 or line.startswith('#'):
+                continue
+            else:
+                values = [v.strip() for v in line.split(',')]
+                trace.add(float(values[0]), float(values[1]), int(values[2]), len(values) > 3 and values[3] == '1')
+    return trace
+
+def synthetic_traces(is_v4):
+    traces = []
+
+    # Plug in, charge, stop charging, unplug
+    trace = Trace('plug, charge, unplug', is_v4)
+    trace.add_resistance(None, 2000)
+    trace.add_resistance(2700, 3000)
+    trace.add_resistance(880,  10000, pwm=True)
+    trace.add_resistance(2700, 3000,  pwm=True)
+    trace.add_resistance(None, 3000)
+    trace.expect('A',  False, ms=0,     tolerance=0)
+    trace.expect('B',  False, ms=2000)
+    trace.expect('C',  True,  ms=5000,  tolerance=2000) # Contactor is switched after lock/contactor delay
+    trace.expect('B',  False, ms=15000)
+    trace.expect('A',  False, ms=18000)
+    traces.append(trace)
+
+    # Short resistance glitches in C (e.g. after duty cycle change) are averaged out
+    trace = Trace('resistance glitch in C', is_v4)
+    trace.add_resistance(2700, 2000, pwm=True)
+    trace.add_resistance(880,  5000, pwm=True)
+    for _ in range(5):
+        trace.add_resistance(2700, 2,    pwm=True)
+        trace.add_resistance(880,  1000, pwm=True)
+    trace.add_resistance(2700, 2000, pwm=True)
+    trace.expect('A',  False, ms=0,     tolerance=0) # The replay starts in A
+    trace.expect('B',  False, ms=0)
+    trace.expect('C',  True,  ms=2000,  tolerance=2000)
+    trace.expect('B',  False, ms=12010)
+    traces.append(trace)
+
+    return traces
+
+def replay(ipcon, evse, trace, is_v4):
+    vpp     = mv_to_raw_vpp(pp_resistance_to_mv(PP_RESISTANCE, is_v4))
+    vcp_low = mv_to_raw_vcp(VCP_LOW_MV)
+
+    elements = list(trace.elements())
+
+    ipcon.send_request(evse, FUNCTION_SET_CP_TRACE_REPLAY, (CP_REPLAY_PASSWORD, False, vpp, vcp_low), 'I ! H H', 0, '')
+
+    # Prefill the queue before the start, then stream the rest
+    started = False
+    index   = 0
+    while index < len(elements):
+        chunk   = elements[index:index + WRITE_CHUNK]
+        written = ipcon.send_request(evse, FUNCTION_WRITE_CP_TRACE, (len(chunk), chunk + [0]*(WRITE_CHUNK - len(chunk))), 'B 14I', 9, 'B')
+        index  += written
+
+        if written < len(chunk):
+            if not started:
+                ipcon.send_request(evse, FUNCTION_SET_CP_TRACE_REPLAY, (CP_REPLAY_PASSWORD, True, vpp, vcp_low), 'I ! H H', 0, '')
+                started = True
+            else:
+                time.sleep(0.005)
+
+    if not started:
+        ipcon.send_request(evse, FUNCTION_SET_CP_TRACE_REPLAY, (CP_REPLAY_PASSWORD, True, vpp, vcp_low), 'I ! H H', 0, '')
+
+    while True:
+        active, sample, queued, underruns, timeline_count = ipcon.send_request(evse, FUNCTION_GET_CP_TRACE_REPLAY_STATE, (), '', 19, '! I B I B')
+        if sample >= trace.samples:
+            break
+        time.sleep(0.1)
+
+    ipcon.send_request(evse, FUNCTION_SET_CP_TRACE_REPLAY, (CP_REPLAY_PASSWORD, False, vpp, vcp_low), 'I ! H H', 0, '')
+
+    timeline = []
+    for i in range(timeline_count):
+        timeline.append(ipcon.send_request(evse, FUNCTION_GET_CP_TRACE_TIMELINE, (i,), 'B', 16, 'I B ! H'))
+
+    return timeline, underruns
+
+def dedup(states):
+    return [s for i, s in enumerate(states) if i == 0 or s != states[i - 1]]
+
+# The state sequence has to be the expected one (no additional state changes)
+# and the expected entries have to be found in order within the tolerance
+def check(trace, timeline):
+    ok = True
+
+    states          = dedup([STATES[entry[1]] for entry in timeline])
+    expected_states = dedup([entry[1] for entry in trace.expected])
+    if states != expected_states:
+        print('  State sequence {0}, expected {1}'.format(' '.join(states), ' '.join(expected_states)))
+        ok = False
+
+    index = 0
+    for sample, state, contactor, tolerance in trace.expected:
+        while index < len(timeline) and not (STATES[timeline[index][1]] == state and timeline[index][2] == contactor):
+            index += 1
+
+        if index == len(timeline):
+            print('  {0} contactor {1:d}: missing'.format(state, contactor))
+            ok = False
+            continue
+
+        t_sample = timeline[index][0]
+        index   += 1
+        if abs(t_sample - sample) > tolerance:
+            print('  {0} contactor {1:d}: at sample {2}, expected {3} +-{4}'.format(state, contactor, t_sample, sample, tolerance))
+            ok = False
+
+    return ok
+
+if __name__ == "__main__":
+    args  = sys.argv[1:]
+    is_v4 = '--v4' in args
+    files = [arg for arg in args if arg != '--v4']
+
+    traces = [read_trace(f, is_v4) for f in files] if len(files) > 0 else synthetic_traces(is_v4)
+
+    ipcon = IPConnection()
+    evse = BrickletEVSEV2(UID_EVSE, ipcon)
+    ipcon.connect(HOST, PORT)
+
+    ok = True
+    for trace in traces:
+        print('{0} ({1} samples)'.format(trace.name, trace.samples))
+        timeline, underruns = replay(ipcon, evse, trace, is_v4)
+
+        for sample, state, contactor, duty_cycle in timeline:
+            print('  {0:8d}: {1:2s} contactor {2:d}, duty cycle {3:4d}'.format(sample, STATES[state], contactor, duty_cycle))
+        if underruns > 0:
+            print('  {0} underruns, timeline not exact'.format(underruns))
+
+        trace_ok = check(trace, timeline)
+        print('  ' + ('OK' if trace_ok else 'FAIL'))
+        ok &= trace_ok
+
+    ipcon.disconnect()
+
+    print('All OK' if ok else 'FAILED')
+    sys.exit(0 if ok else 1)
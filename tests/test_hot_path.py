@@ -0,0 +1,44 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Prints main loop period and ADC to output latency. Needs firmware built
+# with -DHOT_PATH_STATISTICS=ON. Run once with that firmware and once with
+# -DHOT_PATH_IN_RAM=ON added to compare flash and RAM execution of the hot
+# path. Stop with Ctrl-C.
+
+HOST     = "localhost"
+PORT     = 4223
+UID_EVSE = "2CpXU5"
+
+from tinkerforge.ip_connection import IPConnection
+from tinkerforge.bricklet_evse_v2 import BrickletEVSEV2
+import time
+import sys
+
+FUNCTION_GET_HOT_PATH_STATISTICS = 87
+
+if __name__ == "__main__":
+    ipcon = IPConnection()
+    evse = BrickletEVSEV2(UID_EVSE, ipcon)
+    ipcon.connect(HOST, PORT)
+
+    duration = 10
+    if len(sys.argv) > 1:
+        duration = int(sys.argv[1])
+
+    # Reset statistics
+    ipcon.send_request(evse, FUNCTION_GET_HOT_PATH_STATISTICS, (), '', 33, '! I I I I I I')
+
+    try:
+        while True:
+            time.sleep(duration)
+            in_ram, loop_count, loop_mean, loop_max, adc_count, adc_mean, adc_max = ipcon.send_request(evse, FUNCTION_GET_HOT_PATH_STATISTICS, (), '', 33, '! I I I I I I')
+
+            print('Hot path in {0}'.format('RAM' if in_ram else 'flash'))
+            print('Loop period: n {0:7d}, mean {1:8.3f}us, max {2:8.3f}us'.format(loop_count, loop_mean/1000, loop_max/1000))
+            print('ADC latency: n {0:7d}, mean {1:8.3f}us, max {2:8.3f}us'.format(adc_count, adc_mean/1000, adc_max/1000))
+            print('')
+    except KeyboardInterrupt:
+        pass
+
+    ipcon.disconnect()
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Uploads keyframe LED animations into the persistent slots, reads them back,
+# checks that invalid animations are rejected and plays the first slot as
+# indicator LED (indication 3001) for a few seconds. With --reset the
+# Bricklet is reset afterwards and the slots are read back again, they have
+# to survive the reset.
+#
+# Keyframe: (duration in ms to the next keyframe, h, s, v, flags)
+# flags: interpolation (0 = step, 1 = linear) | 0x80 (use indication color)
+#
+# Usage: test_led_animation.py [--reset]
+
+HOST     = "localhost"
+PORT     = 4223
+UID_EVSE = "2CpXU5"
+
+from tinkerforge.ip_connection import IPConnection, Error
+from tinkerforge.bricklet_evse_v2 import BrickletEVSEV2
+import time
+import sys
+
+FUNCTION_SET_LED_ANIMATION_KEYFRAMES = 99
+FUNCTION_GET_LED_ANIMATION_KEYFRAMES = 100
+FUNCTION_SET_LED_ANIMATION           = 101
+FUNCTION_GET_LED_ANIMATION           = 102
+
+KEYFRAMES_MAX   = 14
+KEYFRAMES_CHUNK = 6
+SLOT_NUM        = 2
+INDICATION      = 3001
+
+STEP       = 0
+LINEAR     = 1
+BASE_COLOR = 0x80
+
+# Slot 0: color wheel with linear interpolation, three fast flashes, forever
+ANIMATION_WHEEL = {
+    'keyframes': [(1000, 0, 255, 255, LINEAR), (1000, 120, 255, 255, LINEAR), (1000, 240, 255, 255, LINEAR),
+                  (100, 0, 0, 0, STEP), (100, 0, 255, 255, BASE_COLOR), (100, 0, 0, 0, STEP)],
+    'loop_start': 4, 'loop_end': 5, 'loop_count': 3, 'repeat': True
+}
+
+# Slot 1: fade in with the indication color and hold the last keyframe
+ANIMATION_FADE = {
+    'keyframes': [(2000, 0, 0, 0, BASE_COLOR | LINEAR), (0, 0, 0, 255, BASE_COLOR)],
+    'loop_start': 0, 'loop_end': 0, 'loop_count': 1, 'repeat': False
+}
+
+def write_keyframes(ipcon, evse, keyframes):
+    for offset in range(0, len(keyframes), KEYFRAMES_CHUNK):
+        chunk = keyframes[offset:offset + KEYFRAMES_CHUNK]
+        chunk = chunk + [(0, 0, 0, 0, 0)]*(KEYFRAMES_CHUNK - len(chunk))
+        ipcon.send_request(evse, FUNCTION_SET_LED_ANIMATION_KEYFRAMES,
+                           (offset, min(KEYFRAMES_CHUNK, len(keyframes) - offset), [k[0] for k in chunk], [k[1] for k in chunk],
+                            [k[2] for k in chunk], [k[3] for k in chunk], [k[4] for k in chunk]),
+                           'B B 6H 6H 6B 6B 6B', 0, '')
+
+def set_animation(ipcon, evse, slot, animation):
+    write_keyframes(ipcon, evse, animation['keyframes'])
+    ipcon.send_request(evse, FUNCTION_SET_LED_ANIMATION,
+                       (slot, len(animation['keyframes']), animation['loop_start'], animation['loop_end'], animation['loop_count'], animation['repeat']),
+                       'B B B B B !', 0, '')
+
+def get_animation(ipcon, evse, slot):
+    keyframe_count, loop_start, loop_end, loop_count, repeat = ipcon.send_request(evse, FUNCTION_GET_LED_ANIMATION, (slot,), 'B', 13, 'B B B B !')
+
+    keyframes = []
+    for offset in range(0, keyframe_count, KEYFRAMES_CHUNK):
+        duration, h, s, v, flags = ipcon.send_request(evse, FUNCTION_GET_LED_ANIMATION_KEYFRAMES, (slot, offset), 'B B', 50, '6H 6H 6B 6B 6B')
+        keyframes += list(zip(duration, h, s, v, flags))[:keyframe_count - offset]
+
+    return {'keyframes': keyframes, 'loop_start': loop_start, 'loop_end': loop_end, 'loop_count': loop_count, 'repeat': repeat}
+
+def check_animation(ipcon, evse, slot, expected):
+    animation = get_animation(ipcon, evse, slot)
+    ok = animation == expected
+    print('Slot {0}: {1} keyframes {2}'.format(slot, len(animation['keyframes']), 'OK' if ok else 'FAIL'))
+    if not ok:
+        print('  got      {0}'.format(animation))
+        print('  expected {0}'.format(expected))
+    return ok
+
+def check_invalid(ipcon, evse, name, animation):
+    try:
+        set_animation(ipcon, evse, 1, animation)
+        print('Invalid animation ({0}) accepted FAIL'.format(name))
+        return False
+    except Error as e:
+        ok = e.value == Error.INVALID_PARAMETER
+        print('Invalid animation ({0}) rejected {1}'.format(name, 'OK' if ok else 'FAIL'))
+        return ok
+
+if __name__ == "__main__":
+    ipcon = IPConnection()
+    evse = BrickletEVSEV2(UID_EVSE, ipcon)
+    ipcon.connect(HOST, PORT)
+
+    ok = True
+
+    set_animation(ipcon, evse, 0, ANIMATION_WHEEL)
+    set_animation(ipcon, evse, 1, ANIMATION_FADE)
+    ok &= check_animation(ipcon, evse, 0, ANIMATION_WHEEL)
+    ok &= check_animation(ipcon, evse, 1, ANIMATION_FADE)
+
+    ok &= check_invalid(ipcon, evse, 'hue 360',                   dict(ANIMATION_FADE, keyframes=[(100, 360, 255, 255, STEP)]))
+    ok &= check_invalid(ipcon, evse, 'unknown interpolation',     dict(ANIMATION_FADE, keyframes=[(100, 0, 255, 255, 2)]))
+    ok &= check_invalid(ipcon, evse, 'loop end after last',       dict(ANIMATION_FADE, loop_end=2))
+    ok &= check_invalid(ipcon, evse, 'endless loop of duration 0', dict(ANIMATION_FADE, keyframes=[(0, 0, 255, 255, STEP)], loop_count=0))
+    ok &= check_invalid(ipcon, evse, 'too many keyframes',        dict(ANIMATION_FADE, keyframes=[(100, 0, 255, 255, STEP)]*(KEYFRAMES_MAX + 1)))
+    ok &= check_animation(ipcon, evse, 1, ANIMATION_FADE) # Unchanged by the invalid animations
+
+    status = evse.set_indicator_led(INDICATION, 5000, 0, 0, 0)
+    indication = evse.get_indicator_led().indication
+    print('Play slot 0: status {0}, indication {1} {2}'.format(status, indication, 'OK' if indication == INDICATION else 'FAIL (LED busy?)'))
+    ok &= indication == INDICATION
+    time.sleep(5)
+
+    if '--reset' in sys.argv[1:]:
+        evse.reset()
+        ipcon.disconnect()
+        time.sleep(5)
+
+        ipcon = IPConnection()
+        evse = BrickletEVSEV2(UID_EVSE, ipcon)
+        ipcon.connect(HOST, PORT)
+        print('After reset')
+        ok &= check_animation(ipcon, evse, 0, ANIMATION_WHEEL)
+        ok &= check_animation(ipcon, evse, 1, ANIMATION_FADE)
+
+    ipcon.disconnect()
+
+    print('All OK' if ok else 'FAILED')
+    sys.exit(0 if ok else 1)
@@ -0,0 +1,53 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Compares the mains period measurement of the timer read in the IRQ with the
+# CCU4 hardware capture. Run with energy meter connected, so that there is
+# RS485 traffic (higher priority IRQs) during the measurement.
+#
+# Usage: test_mains_frequency.py [duration in s] [number of measurements, 0 = until Ctrl+C]
+
+HOST     = "localhost"
+PORT     = 4223
+UID_EVSE = "2CpXU5"
+
+from tinkerforge.ip_connection import IPConnection
+from tinkerforge.bricklet_evse_v2 import BrickletEVSEV2
+import time
+import sys
+
+FUNCTION_GET_MAINS_FREQUENCY                   = 82
+FUNCTION_GET_MAINS_FREQUENCY_SOURCE_COMPARISON = 83
+
+if __name__ == "__main__":
+    ipcon = IPConnection()
+    evse = BrickletEVSEV2(UID_EVSE, ipcon)
+    ipcon.connect(HOST, PORT)
+
+    duration = 10
+    if len(sys.argv) > 1:
+        duration = int(sys.argv[1])
+
+    count = 6
+    if len(sys.argv) > 2:
+        count = int(sys.argv[2])
+
+    # Reset statistics
+    ipcon.send_request(evse, FUNCTION_GET_MAINS_FREQUENCY_SOURCE_COMPARISON, (), '', 40, 'I I I I I I I I')
+
+    try:
+        i = 0
+        while count == 0 or i < count:
+            time.sleep(duration)
+            i += 1
+            timer_read_count, timer_read_mean, timer_read_sd, capture_count, capture_mean, capture_sd, capture_missed, edges_dropped = ipcon.send_request(evse, FUNCTION_GET_MAINS_FREQUENCY_SOURCE_COMPARISON, (), '', 40, 'I I I I I I I I')
+            frequency, frequency_valid, rocof, rocof_valid, period_min, period_max, period_variance, periods_rejected = ipcon.send_request(evse, FUNCTION_GET_MAINS_FREQUENCY, (), '', 34, 'I ! i ! I I I I')
+
+            print('Timer read: n {0:5d}, mean {1:.3f}us, sd {2:.3f}us'.format(timer_read_count, timer_read_mean/1000, timer_read_sd/1000))
+            print('Capture:    n {0:5d}, mean {1:.3f}us, sd {2:.3f}us, missed {3}'.format(capture_count, capture_mean/1000, capture_sd/1000, capture_missed))
+            print('Frequency {0:.3f}Hz (valid {1}), ROCOF {2}mHz/s (valid {3}), rejected {4}, dropped {5}'.format(frequency/1000, frequency_valid, rocof, rocof_valid, periods_rejected, edges_dropped))
+            print('')
+    except KeyboardInterrupt:
+        pass
+
+    ipcon.disconnect()
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Checks the timing of the EV wakeup and phase switch sequences with the
+# EVSE 3.0 tester simulating the EV. The deadlines of both sequences are
+# handled by the software timer service, they have to stay identical to the
+# previous system_timer_is_time_elapsed_ms() polling.
+#
+# EV wakeup (IEC 61851-1 Annex A.5.3), relative to the B1->B2 transition:
+#   90s CP disconnect, 94s CP connect, 124s CP disconnect, 154s CP connect
+#
+# Phase switch (phases state = phase control progress state):
+#   3 -> 4 after 100ms (CP disconnect), 5 -> 6 after the phase switch wait
+#   time (CP connect), 6 -> 0 after 100ms (PWM on)
+
+from evse_v3_tester import EVSEV3Tester
+import time
+import sys
+
+GPIO_CP_DISCONNECT = 16 # V3/V4
+
+POLL_INTERVAL = 0.01
+MARGIN        = 0.25 # s, polling interval and API round trip
+
+WAKEUP_EDGES  = [90, 94, 124, 154]
+
+FUNCTION_SET_PHASE_SWITCH_WAIT_TIME = 65
+
+def no_log(s):
+    pass
+
+def check(name, value, expected):
+    ok = abs(value - expected) < MARGIN
+    print('{0:40s} {1:8.3f}s (expected {2:8.3f}s) {3}'.format(name, value, expected, 'OK' if ok else 'FAIL'))
+    return ok
+
+def test_ev_wakeup(evse_tester):
+    evse = evse_tester.evse
+
+    print('EV wakeup sequence (takes about 3 minutes)')
+    evse.set_ev_wakeup(True)
+    evse_tester.set_max_charging_current(0)
+    evse_tester.set_cp_pe_resistor(True, False, False) # State B
+    time.sleep(5)
+
+    # B1 -> B2: PWM is turned on
+    evse_tester.set_max_charging_current(16000)
+    while evse.get_low_level_state().cp_pwm_duty_cycle == 1000:
+        time.sleep(POLL_INTERVAL)
+    t0 = time.monotonic()
+
+    ok = True
+    last = evse.get_low_level_state().gpio[GPIO_CP_DISCONNECT]
+    for i, expected in enumerate(WAKEUP_EDGES):
+        while True:
+            gpio = evse.get_low_level_state().gpio[GPIO_CP_DISCONNECT]
+            if gpio != last:
+                last = gpio
+                break
+            if time.monotonic() - t0 > expected + 5:
+                print('CP {0} missing'.format('disconnect' if i % 2 == 0 else 'connect'))
+                return False
+            time.sleep(POLL_INTERVAL)
+
+        ok &= check('CP {0}'.format('disconnect' if i % 2 == 0 else 'connect'), time.monotonic() - t0, expected)
+
+    evse_tester.set_max_charging_current(0)
+    return ok
+
+def test_phase_switch(evse_tester):
+    evse = evse_tester.evse
+
+    print('Phase switch sequence')
+    evse_tester.set_contactor_fb(True)
+    evse_tester.set_cp_pe_resistor(True, False, False) # State B
+    evse_tester.set_max_charging_current(16000)
+    time.sleep(5)
+
+    wait_time = 60
+    phases    = 1 if evse.get_phase_control().phases_current == 3 else 3
+
+    evse.set_phase_control(phases)
+
+    last  = None
+    times = {}
+    start = time.monotonic()
+    while time.monotonic() - start < wait_time + 30:
+        state = evse.get_phase_control().phases_state
+        if state != last:
+            times[state] = time.monotonic()
+            last = state
+            if state == 0 and len(times) > 1:
+                break
+        time.sleep(POLL_INTERVAL)
+
+    if not all(s in times for s in (3, 4, 5, 6, 0)):
+        print('Phase switch states seen: {0}'.format(sorted(times.keys())))
+        return False
+
+    ok  = check('CP disconnect (state 3 -> 4)', times[4] - times[3], 0.1)
+    ok &= check('CP connect (state 5 -> 6)',    times[6] - times[5], wait_time)
+    ok &= check('PWM on (state 6 -> done)',     times[0] - times[6], 0.1)
+
+    evse_tester.set_max_charging_current(0)
+    return ok
+
+if __name__ == "__main__":
+    evse_tester = EVSEV3Tester(log_func = no_log)
+    evse_tester.ipcon.send_request(evse_tester.evse, FUNCTION_SET_PHASE_SWITCH_WAIT_TIME, (0,), 'B', 0, '') # Default (60s)
+
+    ok  = test_ev_wakeup(evse_tester)
+    ok &= test_phase_switch(evse_tester)
+
+    print('All OK' if ok else 'FAILED')
+    evse_tester.exit(0 if ok else 1)